@@ -0,0 +1,211 @@
+/*
+ * AudioAnalyzeCrossCorr_F32.cpp
+ *
+ * See AudioAnalyzeCrossCorr_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioAnalyzeCrossCorr_F32.h"
+
+uint16_t AudioAnalyzeCrossCorr_F32::begin(uint16_t _N, float32_t nAverage)  {
+    if(_N!=256 && _N!=512 && _N!=1024 && _N!=2048)
+        return XCORR_ERR_N;
+    uint16_t maxPairs = nCh*(nCh - 1)/2;
+    uint32_t nSpec = _N + 2;       // N/2+1 complex
+    uint32_t size = nCh*(uint32_t)_N + nCh*nSpec + maxPairs*nSpec + 4*(uint32_t)_N;
+    float32_t *newMem = new float32_t[size];
+    if(newMem == NULL)
+        return XCORR_ERR_MEMORY;
+    for(uint32_t i=0; i<size; i++)
+        newMem[i] = 0.0f;
+
+    __disable_irq();
+    float32_t *oldMem = pMem;
+    pMem = newMem;
+    N = _N;
+    float32_t *p = pMem;
+    for(int ch=0; ch<nCh; ch++)  {
+        pIn[ch] = p;     p += N;
+        pSpec[ch] = p;   p += nSpec;
+        }
+    for(int k=0; k<maxPairs; k++)  {
+        pAve[k] = p;     p += nSpec;
+        }
+    pFFT = p;      p += 2*N;
+    pWindow = p;   p += N;
+    pCorr = p;
+    // Hann, with the sum of N/2 shifted windows 1.0
+    for(int i=0; i<N; i++)
+        pWindow[i] = 0.5f - 0.5f*cosf(6.28318530718f*(float32_t)i/(float32_t)N);
+    nIn = N/2;
+    maxLag = N/4;
+    setAverage(nAverage);
+    nPairs = 0;
+    newMask = 0;
+#if defined(__IMXRT1062__)
+    if(N == 256)        Sfft = arm_cfft_sR_f32_len256;
+    else if(N == 512)   Sfft = arm_cfft_sR_f32_len512;
+    else if(N == 1024)  Sfft = arm_cfft_sR_f32_len1024;
+    else                Sfft = arm_cfft_sR_f32_len2048;
+#else
+    arm_cfft_radix2_init_f32(&fft_inst,  N, 0, 1);
+    arm_cfft_radix2_init_f32(&ifft_inst, N, 1, 1);
+#endif
+    __enable_irq();
+
+    if(oldMem)  delete [] oldMem;
+    return 0;
+    }
+
+int AudioAnalyzeCrossCorr_F32::addPair(uint16_t a, uint16_t b)  {
+    if(N==0 || a>=nCh || b>=nCh || a==b || nPairs >= nCh*(nCh - 1)/2)
+        return -1;
+    uint16_t k = nPairs;
+    for(uint32_t i=0; i<(uint32_t)N+2; i++)
+        pAve[k][i] = 0.0f;
+    pairA[k] = a;
+    pairB[k] = b;
+    delay[k] = 0.0f;
+    peak[k] = 0.0f;
+    __disable_irq();
+    nPairs = k + 1;
+    __enable_irq();
+    return k;
+    }
+
+void AudioAnalyzeCrossCorr_F32::fft(float32_t *p, bool inverse)  {
+#if defined(__IMXRT1062__)
+    arm_cfft_f32(&Sfft, p, inverse ? 1 : 0, 1);
+#else
+    arm_cfft_radix2_f32(inverse ? &ifft_inst : &fft_inst, p);
+#endif
+    }
+
+void AudioAnalyzeCrossCorr_F32::update(void)  {
+    audio_block_f32_t *block[XCORR_MAX_CHANNELS];
+
+    for(int ch=0; ch<nCh; ch++)
+        block[ch] = AudioStream_F32::receiveReadOnly_f32(ch);
+    if(N > 0)  {
+        uint16_t done = 0;
+        while(done < block_size)  {
+            uint16_t n = N - nIn;
+            if(n > block_size - done)
+                n = block_size - done;
+            for(int ch=0; ch<nCh; ch++)  {
+                if(block[ch])
+                    memcpy(pIn[ch] + nIn, block[ch]->data + done, n*sizeof(float32_t));
+                else
+                    memset(pIn[ch] + nIn, 0, n*sizeof(float32_t));
+                }
+            nIn += n;
+            done += n;
+            if(nIn >= N)  {
+                frame();
+                // The second half is the first half of the next frame
+                for(int ch=0; ch<nCh; ch++)
+                    memcpy(pIn[ch], pIn[ch] + N/2, (N/2)*sizeof(float32_t));
+                nIn = N/2;
+                }
+            }
+        }
+    for(int ch=0; ch<nCh; ch++)
+        if(block[ch])  AudioStream_F32::release(block[ch]);
+    }
+
+// The spectra of all inputs, two at a time, then the correlation of each pair
+void AudioAnalyzeCrossCorr_F32::frame(void)  {
+    if(nPairs == 0)
+        return;
+    for(int ch=0; ch<nCh; ch+=2)  {
+        const float32_t *x0 = pIn[ch];
+        const float32_t *x1 = (ch+1 < nCh) ? pIn[ch+1] : NULL;
+        for(int i=0; i<N; i++)  {
+            pFFT[2*i]   = pWindow[i]*x0[i];
+            pFFT[2*i+1] = x1 ? pWindow[i]*x1[i] : 0.0f;
+            }
+        fft(pFFT, false);
+        // Z = X0 + j*X1, and X0 and X1 have conjugate symmetry, so
+        // X0[k] = (Z[k] + conj(Z[N-k]))/2 and X1[k] = -j*(Z[k] - conj(Z[N-k]))/2
+        float32_t *s0 = pSpec[ch];
+        float32_t *s1 = (ch+1 < nCh) ? pSpec[ch+1] : NULL;
+        for(int k=0; k<=N/2; k++)  {
+            int kk = (N - k) & (N - 1);
+            float32_t zr = pFFT[2*k],   zi = pFFT[2*k+1];
+            float32_t cr = pFFT[2*kk],  ci = -pFFT[2*kk+1];
+            s0[2*k]   = 0.5f*(zr + cr);
+            s0[2*k+1] = 0.5f*(zi + ci);
+            if(s1)  {
+                s1[2*k]   =  0.5f*(zi - ci);
+                s1[2*k+1] = -0.5f*(zr - cr);
+                }
+            }
+        }
+    for(int k=0; k<nPairs; k++)
+        correlate(k);
+    }
+
+void AudioAnalyzeCrossCorr_F32::correlate(uint16_t pair)  {
+    const float32_t *a = pSpec[pairA[pair]];
+    const float32_t *b = pSpec[pairB[pair]];
+    float32_t *ave = pAve[pair];
+    uint16_t N2 = N/2;
+
+    // Average the weighted cross spectrum, conj(A)*B.  DC and fs/2 are
+    // left out, as they have no phase to give.
+    for(int k=1; k<N2; k++)  {
+        float32_t gr = a[2*k]*b[2*k]   + a[2*k+1]*b[2*k+1];
+        float32_t gi = a[2*k]*b[2*k+1] - a[2*k+1]*b[2*k];
+        if(weighting == XCORR_PHAT)  {
+            float32_t mag = sqrtf(gr*gr + gi*gi);
+            if(mag > 1.0E-20f)  {
+                gr /= mag;
+                gi /= mag;
+                }
+            else  {
+                gr = 0.0f;
+                gi = 0.0f;
+                }
+            }
+        ave[2*k]   += alpha*(gr - ave[2*k]);
+        ave[2*k+1] += alpha*(gi - ave[2*k+1]);
+        }
+
+    // The full spectrum has conjugate symmetry, so the inverse FFT is real
+    pFFT[0] = 0.0f;     pFFT[1] = 0.0f;
+    pFFT[N] = 0.0f;     pFFT[N+1] = 0.0f;
+    for(int k=1; k<N2; k++)  {
+        pFFT[2*k]   = ave[2*k];
+        pFFT[2*k+1] = ave[2*k+1];
+        pFFT[2*(N-k)]   =  ave[2*k];
+        pFFT[2*(N-k)+1] = -ave[2*k+1];
+        }
+    fft(pFFT, true);
+    for(int i=0; i<N; i++)
+        pCorr[i] = pFFT[2*i];
+
+    // The largest within +/- maxLag, with lag m at [m] or [N+m]
+    int iMax = 0;
+    float32_t cMax = pCorr[0];
+    for(int m=-maxLag; m<=maxLag; m++)  {
+        int i = m & (N - 1);
+        if(pCorr[i] > cMax)  {
+            cMax = pCorr[i];
+            iMax = m;
+            }
+        }
+    // Parabola through the peak and its neighbors
+    float32_t ym = pCorr[(iMax - 1) & (N - 1)];
+    float32_t yp = pCorr[(iMax + 1) & (N - 1)];
+    float32_t den = ym - 2.0f*cMax + yp;
+    float32_t frac = 0.0f;
+    if(den < 0.0f)  {
+        frac = 0.5f*(ym - yp)/den;
+        if(frac > 0.5f)   frac = 0.5f;
+        if(frac < -0.5f)  frac = -0.5f;
+        }
+    delay[pair] = (float32_t)iMax + frac;
+    peak[pair] = cMax - 0.25f*(ym - yp)*frac;
+    newMask |= (1 << pair);
+    }
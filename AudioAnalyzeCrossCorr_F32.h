@@ -0,0 +1,170 @@
+/*
+ * AudioAnalyzeCrossCorr_F32.h
+ *
+ * Time delay between pairs of inputs, from the cross-correlation found
+ * with the FFT.  For the delays across a microphone array, or to follow
+ * the skew between ADC channels, as it changes.  AudioAlignLR_F32 sums
+ * the products at 4 lags, and that does not grow to more lags, where the
+ * FFT gives all N lags for about the work of three FFTs.  Oct 2026
+ *
+ * Up to 4 inputs and up to 6 pairs of them.  Each frame is N samples, Hann
+ * windowed, and a new frame starts every N/2 samples.  Two real inputs go
+ * into each complex FFT, and are separated after.  For each pair the cross
+ * spectrum, conj(A)*B, is weighted by GCC-PHAT, dividing by its magnitude,
+ * so that only the phase is left and the correlation peak is sharp for any
+ * spectrum.  XCORR_PLAIN leaves out the weighting, for the ordinary
+ * cross-correlation.  The weighted cross spectra are averaged over frames,
+ * with an exponential average, and the inverse FFT of the average is the
+ * correlation.  The largest peak within +/- the maximum lag, and the
+ * parabola through it and its neighbors, gives the delay, to a fraction
+ * of a sample.
+ *
+ * The delay is positive when input b of the pair is later than input a.
+ * The peak, 0 to 1 for GCC-PHAT, is a measure of how good the delay is:
+ * 1.0 for a pure delay, less with noise or more than one path.
+ *
+ * The FFT work is done in the update that completes each frame, every
+ * N/(2*128) updates, and is two or three N-point FFTs for two inputs.
+ *
+ * Functions:
+ *   AudioAnalyzeCrossCorr_F32(nInputs)  2 to 4, default 2.  The second
+ *         constructor takes AudioSettings_F32 and nInputs.
+ *   uint16_t begin(N, nAverage)  N 256, 512, 1024 or 2048, default 1024.
+ *         nAverage, default 8, is the time constant of the average, in
+ *         frames.  Clears the pairs.  Returns 0 or XCORR_ERR_.
+ *   int addPair(a, b)  Inputs a and b.  Returns the pair number, 0 up, or -1.
+ *   clearPairs()
+ *   setWeighting(w)  XCORR_PHAT, the default, or XCORR_PLAIN.
+ *   setMaxLag(lag)  In samples, up to N/2-2.  Default N/4.
+ *   setAverage(nAverage)  In frames, 1 for none.
+ *   bool available(pair)  true when there is a new delay.
+ *   float32_t readDelay(pair)  In samples, with the fraction.
+ *   float32_t readDelay_us(pair)  In microseconds.
+ *   float32_t readPeak(pair)  The correlation at the delay.
+ *   float32_t* getCorrelation()  The N correlation values of the last
+ *         pair found, lag 0 at [0] and negative lags from [N-1] down.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioAnalyzeCrossCorr_F32_h_
+#define AudioAnalyzeCrossCorr_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#if defined(__IMXRT1062__)
+#include "arm_const_structs.h"
+#endif
+
+#define XCORR_MAX_CHANNELS 4
+#define XCORR_MAX_PAIRS    6
+
+#define XCORR_PHAT   0
+#define XCORR_PLAIN  1
+
+#define XCORR_ERR_N       1
+#define XCORR_ERR_MEMORY  2
+
+class AudioAnalyzeCrossCorr_F32 : public AudioStream_F32
+{
+//GUI: inputs:2, outputs:0  //this line used for automatic generation of GUI node
+//GUI: shortName:XCorr
+public:
+    AudioAnalyzeCrossCorr_F32(uint16_t _nIn=2) :
+                AudioStream_F32(nInputs(_nIn), inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        nCh = nInputs(_nIn);
+        }
+    AudioAnalyzeCrossCorr_F32(const AudioSettings_F32 &settings, uint16_t _nIn=2) :
+                AudioStream_F32(nInputs(_nIn), inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        nCh = nInputs(_nIn);
+        }
+    ~AudioAnalyzeCrossCorr_F32(void)  {
+        if(pMem)  delete [] pMem;
+        }
+
+    uint16_t begin(uint16_t _N=1024, float32_t nAverage=8.0f);
+    int addPair(uint16_t a, uint16_t b);
+    void clearPairs(void)  {
+        __disable_irq();
+        nPairs = 0;
+        newMask = 0;
+        __enable_irq();
+        }
+    void setWeighting(uint16_t w)  { weighting = w; }
+    void setMaxLag(uint16_t lag)  {
+        if(N > 0 && lag > N/2 - 2)  lag = N/2 - 2;
+        if(lag < 1)  lag = 1;
+        maxLag = lag;
+        }
+    void setAverage(float32_t nAverage)  {
+        alpha = (nAverage < 1.0f) ? 1.0f : 1.0f/nAverage;
+        }
+
+    bool available(uint16_t pair)  {
+        uint16_t bit = 1 << pair;
+        __disable_irq();
+        bool flag = (newMask & bit) != 0;
+        newMask &= ~bit;
+        __enable_irq();
+        return flag;
+        }
+    float32_t readDelay(uint16_t pair)  {
+        return pair<nPairs ? delay[pair] : 0.0f;
+        }
+    float32_t readDelay_us(uint16_t pair)  {
+        return 1000000.0f*readDelay(pair)/sample_rate_Hz;
+        }
+    float32_t readPeak(uint16_t pair)  {
+        return pair<nPairs ? peak[pair] : 0.0f;
+        }
+    float32_t* getCorrelation(void)  { return pCorr; }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[XCORR_MAX_CHANNELS];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    uint16_t nCh = 2;
+    uint16_t N = 0;           // 0 until begin()
+    uint16_t weighting = XCORR_PHAT;
+    uint16_t maxLag = 0;
+    float32_t alpha = 0.125f;
+
+    // All from one new, in begin()
+    float32_t *pMem = NULL;
+    float32_t *pIn[XCORR_MAX_CHANNELS];     // N each, the frame
+    float32_t *pSpec[XCORR_MAX_CHANNELS];   // N/2+1 complex each
+    float32_t *pAve[XCORR_MAX_PAIRS];       // N/2+1 complex each
+    float32_t *pFFT;          // N complex
+    float32_t *pWindow;       // N
+    float32_t *pCorr;         // N, real part of the inverse FFT
+    uint16_t nIn = 0;         // Samples in the frame
+
+    uint16_t nPairs = 0;
+    uint16_t pairA[XCORR_MAX_PAIRS];
+    uint16_t pairB[XCORR_MAX_PAIRS];
+    float32_t delay[XCORR_MAX_PAIRS];
+    float32_t peak[XCORR_MAX_PAIRS];
+    volatile uint16_t newMask = 0;
+
+#if defined(__IMXRT1062__)
+    arm_cfft_instance_f32 Sfft;
+#else
+    arm_cfft_radix2_instance_f32 fft_inst;
+    arm_cfft_radix2_instance_f32 ifft_inst;
+#endif
+
+    static uint16_t nInputs(uint16_t n)  {
+        return (n<2 || n>XCORR_MAX_CHANNELS) ? 2 : n;
+        }
+    void fft(float32_t *p, bool inverse);
+    void frame(void);
+    void correlate(uint16_t pair);
+};
+#endif
@@ -0,0 +1,273 @@
+/*
+ * AudioAnalyzeSpectralPeaks_F32.cpp
+ *
+ * See AudioAnalyzeSpectralPeaks_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioAnalyzeSpectralPeaks_F32.h"
+
+// Keeps the compiler from moving the results past the count
+#define PEAKS_BARRIER()  __asm__ volatile("" ::: "memory")
+
+void AudioAnalyzeSpectralPeaks_F32::beginPeaks(uint16_t _nPeaks)  {
+    if(_nPeaks < 1)          _nPeaks = 1;
+    if(_nPeaks > PEAKS_MAX)  _nPeaks = PEAKS_MAX;
+    setOutputType(FFT_POWER);
+    __disable_irq();
+    nPeaks = _nPeaks;
+    clearAll();
+    __enable_irq();
+    }
+
+void AudioAnalyzeSpectralPeaks_F32::clearTracks(void)  {
+    __disable_irq();
+    clearAll();
+    __enable_irq();
+    }
+
+// With interrupts off
+void AudioAnalyzeSpectralPeaks_F32::clearAll(void)  {
+    seq++;
+    for(int i=0; i<PEAKS_MAX; i++)
+        tracks[i].live = false;
+    nCand = 0;
+    nResult = 0;
+    seq++;
+    }
+
+// In update(), a new power output is ready
+void AudioAnalyzeSpectralPeaks_F32::outputReady(void)  {
+    const float32_t *pw = getData();
+    uint32_t nB = getNBins();
+    if(nPeaks==0 || pw==NULL || nB<3 || getOutputType()!=FFT_POWER)
+        return;
+
+    // The power of a full scale sine wave, with the window gain
+    uint32_t n = getN();
+    float32_t cg = 1.0f;
+    const float32_t *w = getWindow();
+    if(getWindowType()!=SPECTRUM_WINDOW_NONE && w!=NULL)  {
+        float32_t sum = 0.0f;
+        for(uint32_t i=0; i<n; i++)
+            sum += w[i];
+        cg = sum/(float32_t)n;
+        }
+    ampScale = 0.5f*cg*(float32_t)n;
+
+    findPeaks(pw, nB);
+    trackPeaks();
+    putResults();
+    }
+
+// The noise, and the strongest peaks above snrOff, largest first
+void AudioAnalyzeSpectralPeaks_F32::findPeaks(const float32_t *pw, uint32_t nB)  {
+    float32_t sum = 0.0f;
+    for(uint32_t k=1; k<nB-1; k++)
+        sum += pw[k];
+    float32_t lim = 4.0f*sum/(float32_t)(nB - 2);
+    float32_t sumN = 0.0f;
+    uint32_t nN = 0;
+    for(uint32_t k=1; k<nB-1; k++)  {
+        if(pw[k] < lim)  {
+            sumN += pw[k];
+            nN++;
+            }
+        }
+    noise = nN ? sumN/(float32_t)nN : 0.25f*lim;
+    if(noise < 1.0E-30f)  noise = 1.0E-30f;
+
+    // For I-Q the spectrum is circular, so the end bins are neighbors
+    float32_t thr = snrOff*noise;
+    int winType = getWindowType();
+    bool wrap = getIQ();
+    nCand = 0;
+    for(uint32_t k=(wrap ? 0 : 1); k<(wrap ? nB : nB-1); k++)  {
+        uint32_t km = (k == 0) ? nB - 1 : k - 1;
+        uint32_t kp = (k == nB - 1) ? 0 : k + 1;
+        float32_t p = pw[k];
+        if(p<=thr || p<=pw[km] || p<pw[kp])
+            continue;
+        candidate c;
+        interpolate(pw, km, k, kp, winType, &c);
+        if(fHigh>fLow && (c.frequency<fLow || c.frequency>fHigh))
+            continue;
+        if(nCand==PEAKS_MAX_CANDIDATES && c.power<=cand[nCand-1].power)
+            continue;
+        // Into the list, in order of power
+        int i = (nCand < PEAKS_MAX_CANDIDATES) ? nCand++ : nCand - 1;
+        while(i>0 && cand[i-1].power < c.power)  {
+            cand[i] = cand[i-1];
+            i--;
+            }
+        cand[i] = c;
+        }
+    }
+
+// The fraction of a bin, toward the larger neighbor, and the power there
+void AudioAnalyzeSpectralPeaks_F32::interpolate(const float32_t *pw,
+             uint32_t km, uint32_t k, uint32_t kp, int winType, candidate *pC)  {
+    float32_t pc = pw[k];
+    float32_t off;        // Bins, + toward kp
+    if(winType==SPECTRUM_WINDOW_NONE || winType==SPECTRUM_WINDOW_HANN)  {
+        bool up = (pw[kp] > pw[km]);
+        float32_t a = sqrtf((up ? pw[kp] : pw[km])/pc);
+        float32_t d;
+        if(winType == SPECTRUM_WINDOW_NONE)
+            d = a/(1.0f + a);
+        else
+            d = (2.0f*a - 1.0f)/(a + 1.0f);
+        if(d < 0.0f)  d = 0.0f;
+        if(d > 0.5f)  d = 0.5f;
+        // The window response at d, sinc(d), and sinc(d)/(1 - d^2) for Hann
+        float32_t x = 3.14159265f*d;
+        float32_t g = (d > 1.0E-4f) ? sinf(x)/x : 1.0f;
+        if(winType == SPECTRUM_WINDOW_HANN)
+            g /= (1.0f - d*d);
+        pC->power = pc/(g*g);
+        off = up ? d : -d;
+        }
+    else  {
+        float32_t lm = logf(pw[km] + 1.0E-30f);
+        float32_t l0 = logf(pc);
+        float32_t lp = logf(pw[kp] + 1.0E-30f);
+        float32_t den = lm - 2.0f*l0 + lp;
+        off = 0.0f;
+        if(den < 0.0f)  {
+            off = 0.5f*(lm - lp)/den;
+            if(off > 0.5f)   off = 0.5f;
+            if(off < -0.5f)  off = -0.5f;
+            }
+        pC->power = expf(l0 - 0.25f*(lm - lp)*off);
+        }
+
+    // Bins next to each other in the output are next in frequency, but for
+    // I-Q the order can run down, or wrap between +fs/2 and -fs/2.
+    float32_t binHz = getBinHz();
+    float32_t fk = getBinFrequency(k);
+    float32_t step = getBinFrequency(off >= 0.0f ? kp : km) - fk;
+    if(fabsf(step) > 1.5f*binHz)
+        step = (step > 0.0f) ? -binHz : binHz;
+    pC->frequency = fk + fabsf(off)*step;
+    pC->used = false;
+    }
+
+void AudioAnalyzeSpectralPeaks_F32::trackPeaks(void)  {
+    float32_t jump = (maxJump_Hz > 0.0f) ? maxJump_Hz : 2.0f*getBinHz();
+    float32_t pOff = snrOff*noise;
+    float32_t pOn = snrOn*noise;
+
+    // Live tracks, strongest first, take the nearest peak
+    uint16_t order[PEAKS_MAX];
+    uint16_t nLive = 0;
+    for(int t=0; t<nPeaks; t++)  {
+        if(!tracks[t].live)  continue;
+        int i = nLive++;
+        while(i>0 && tracks[order[i-1]].power < tracks[t].power)  {
+            order[i] = order[i-1];
+            i--;
+            }
+        order[i] = t;
+        }
+    for(int j=0; j<nLive; j++)  {
+        track *pT = &tracks[order[j]];
+        int best = -1;
+        float32_t bestDist = jump;
+        for(int c=0; c<nCand; c++)  {
+            if(cand[c].used || cand[c].power < pOff)
+                continue;
+            float32_t dist = fabsf(cand[c].frequency - pT->pk.frequency);
+            if(dist <= bestDist)  {
+                bestDist = dist;
+                best = c;
+                }
+            }
+        if(pT->pk.frames < 65535)  pT->pk.frames++;
+        if(best >= 0)  {
+            cand[best].used = true;
+            pT->pk.frequency = cand[best].frequency;
+            pT->power = cand[best].power;
+            if(pT->hits < 65535)  pT->hits++;
+            pT->misses = 0;
+            }
+        else if(++pT->misses > holdFrames)
+            pT->live = false;
+        }
+
+    // New tracks from the strongest of the rest, while there is room
+    int tFree = 0;
+    for(int c=0; c<nCand; c++)  {
+        if(cand[c].used || cand[c].power < pOn)
+            continue;
+        while(tFree<nPeaks && tracks[tFree].live)
+            tFree++;
+        if(tFree >= nPeaks)
+            break;
+        track *pT = &tracks[tFree];
+        pT->live = true;
+        pT->hits = 1;
+        pT->misses = 0;
+        pT->power = cand[c].power;
+        pT->pk.frequency = cand[c].frequency;
+        pT->pk.id = nextId++;
+        pT->pk.frames = 1;
+        }
+
+    for(int t=0; t<nPeaks; t++)  {
+        if(!tracks[t].live)  continue;
+        tracks[t].pk.amplitude = sqrtf(tracks[t].power)/ampScale;
+        tracks[t].pk.snr_dB = 10.0f*log10f(tracks[t].power/noise);
+        }
+    }
+
+// Confirmed tracks, strongest first, with the count odd while written
+void AudioAnalyzeSpectralPeaks_F32::putResults(void)  {
+    uint16_t order[PEAKS_MAX];
+    uint16_t n = 0;
+    for(int t=0; t<nPeaks; t++)  {
+        if(!tracks[t].live || tracks[t].hits < confirmFrames)
+            continue;
+        int i = n++;
+        while(i>0 && tracks[order[i-1]].power < tracks[t].power)  {
+            order[i] = order[i-1];
+            i--;
+            }
+        order[i] = t;
+        }
+    seq++;
+    PEAKS_BARRIER();
+    for(int i=0; i<n; i++)
+        result[i] = tracks[order[i]].pk;
+    nResult = n;
+    PEAKS_BARRIER();
+    seq++;
+    }
+
+bool AudioAnalyzeSpectralPeaks_F32::readPeak(uint16_t i, peak *pPeak)  {
+    uint32_t s;
+    bool ok;
+    do  {
+        s = seq;
+        PEAKS_BARRIER();
+        ok = (i < nResult);
+        if(ok)  *pPeak = result[i];
+        PEAKS_BARRIER();
+        } while((s & 1) || s != seq);
+    return ok;
+    }
+
+uint16_t AudioAnalyzeSpectralPeaks_F32::readPeaks(peak *pPeaks, uint16_t maxN)  {
+    uint32_t s;
+    uint16_t n;
+    do  {
+        s = seq;
+        PEAKS_BARRIER();
+        n = nResult;
+        if(n > maxN)  n = maxN;
+        for(int i=0; i<n; i++)
+            pPeaks[i] = result[i];
+        PEAKS_BARRIER();
+        } while((s & 1) || s != seq);
+    return n;
+    }
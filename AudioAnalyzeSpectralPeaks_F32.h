@@ -0,0 +1,170 @@
+/*
+ * AudioAnalyzeSpectralPeaks_F32.h
+ *
+ * The peaks of the spectrum from AudioAnalyzeSpectrum_F32, found to a
+ * fraction of a bin and tracked from one output to the next, all in the
+ * update() that finishes each spectrum.  The INO reads the frequency,
+ * amplitude and SNR of each peak, where examples like FFTFrequencyMeter
+ * search the getData() array in loop() and interpolate there.  Oct 2026
+ *
+ * This is AudioAnalyzeSpectrum_F32, with all of its functions, begin(),
+ * beginZoom(), windows, averaging and so on, plus the peaks.  The peaks
+ * are found from the power output, so beginPeaks() sets FFT_POWER, and
+ * setOutputType() should not be changed after.
+ *
+ * Finding - The noise is the mean power of the bins, leaving out bins more
+ * than 4 times the mean of all of them.  A peak is a bin larger than both
+ * of its neighbors, within the frequency range, and above the noise by
+ * the threshold.  The strongest PEAKS_MAX_CANDIDATES are kept for each
+ * spectrum.  That is one pass over the bins, plus one for the noise.
+ *
+ * Interpolation - The spectrum keeps only the power of each bin, so the
+ * fraction of a bin comes from the bin and its larger neighbor:
+ *   SPECTRUM_WINDOW_NONE  a = ratio of their magnitudes, d = a/(1 + a).
+ *   SPECTRUM_WINDOW_HANN  d = (2a - 1)/(a + 1), as FFTFrequencyMeter.
+ * These are exact for one sine wave, apart from leakage from other signals,
+ * and that is large with no window.  For the other windows, a parabola
+ * through the log of the power of the three bins, good to about 1% of a
+ * bin with SPECTRUM_WINDOW_BLACKMAN_HARRIS.  The amplitude is corrected
+ * for the window gain and for the offset from the bin center.  With
+ * beginZoom() the bins are fine, and with 3 Hz bins 1% is 30 mHz.
+ *
+ * Tracking - Each track is one peak, followed from spectrum to spectrum.
+ * Tracks, strongest first, take the nearest peak within maxJump_Hz.  A
+ * peak with no track starts one if it is snrOn_dB above the noise, and a
+ * track holds with peaks down to snrOff_dB, the hysteresis.  A track is
+ * reported after confirmFrames spectra, and is dropped after it misses
+ * holdFrames + 1 in a row.  Up to nPeaks tracks, PEAKS_MAX at most.
+ *
+ * The results can be read with no __disable_irq().  update() puts a count
+ * around writing them, and a read is repeated if the count changed.
+ *
+ * Functions, beyond AudioAnalyzeSpectrum_F32:
+ *   beginPeaks(nPeaks)  Tracks, 1 to PEAKS_MAX, default 4.  Before or
+ *         after begin().  Clears the tracks.
+ *   setFrequencyRange(f1_Hz, f2_Hz)  Peaks only from f1 to f2.  Default,
+ *         and for f2 <= f1, all bins.
+ *   setThresholds(snrOn_dB, snrOff_dB)  Defaults 12 and 8 dB.
+ *   setTracking(maxJump_Hz, confirmFrames, holdFrames)  Defaults 0, for
+ *         two bins, 2 and 2.
+ *   clearTracks()
+ *   bool available()  As AudioAnalyzeSpectrum_F32, new peaks as well.
+ *   uint16_t readPeaks(peak *pPeaks, maxN)  Up to maxN tracks, strongest
+ *         first.  Returns the number.
+ *   uint16_t getNumberPeaks()
+ *   float32_t readFrequency(i)  Of the i-th strongest, in Hz.  0 if none.
+ *   float32_t readAmplitude(i)  1.0 for a full scale sine wave, real
+ *         input or zoom.  A full scale I-Q tone is 2.0.
+ *   float32_t readSNR_dB(i)
+ *   float32_t readNoise()  Mean bin power of the noise, as FFT_POWER.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioAnalyzeSpectralPeaks_F32_h_
+#define AudioAnalyzeSpectralPeaks_F32_h_
+
+#include "AudioAnalyzeSpectrum_F32.h"
+
+#define PEAKS_MAX  8
+#define PEAKS_MAX_CANDIDATES  16
+
+class AudioAnalyzeSpectralPeaks_F32 : public AudioAnalyzeSpectrum_F32  {
+//GUI: inputs:2, outputs:0  //this line used for automatic generation of GUI node
+//GUI: shortName:SpectralPeaks
+public:
+    AudioAnalyzeSpectralPeaks_F32(void) : AudioAnalyzeSpectrum_F32() { }
+    AudioAnalyzeSpectralPeaks_F32(const AudioSettings_F32 &settings) :
+                   AudioAnalyzeSpectrum_F32(settings) { }
+
+    // One tracked peak
+    struct peak {
+        float32_t frequency;   // Hz
+        float32_t amplitude;   // 1.0 for a full scale sine wave
+        float32_t snr_dB;
+        uint16_t id;           // The same for the life of the track
+        uint16_t frames;       // Spectra since the track started
+        };
+
+    void beginPeaks(uint16_t _nPeaks=4);
+    void setFrequencyRange(float32_t f1_Hz, float32_t f2_Hz)  {
+        fLow = f1_Hz;
+        fHigh = f2_Hz;
+        }
+    void setThresholds(float32_t snrOn_dB, float32_t snrOff_dB)  {
+        if(snrOff_dB > snrOn_dB)  snrOff_dB = snrOn_dB;
+        snrOn = powf(10.0f, 0.1f*snrOn_dB);
+        snrOff = powf(10.0f, 0.1f*snrOff_dB);
+        }
+    void setTracking(float32_t _maxJump_Hz, uint16_t _confirmFrames,
+                     uint16_t _holdFrames)  {
+        maxJump_Hz = _maxJump_Hz;
+        confirmFrames = (_confirmFrames < 1) ? 1 : _confirmFrames;
+        holdFrames = _holdFrames;
+        }
+    void clearTracks(void);
+
+    uint16_t readPeaks(peak *pPeaks, uint16_t maxN);
+    uint16_t getNumberPeaks(void)  { return nResult; }
+    float32_t readFrequency(uint16_t i)  {
+        peak p;
+        return readPeak(i, &p) ? p.frequency : 0.0f;
+        }
+    float32_t readAmplitude(uint16_t i)  {
+        peak p;
+        return readPeak(i, &p) ? p.amplitude : 0.0f;
+        }
+    float32_t readSNR_dB(uint16_t i)  {
+        peak p;
+        return readPeak(i, &p) ? p.snr_dB : 0.0f;
+        }
+    float32_t readNoise(void)  { return noise; }
+
+protected:
+    virtual void outputReady(void);
+
+private:
+    uint16_t nPeaks = 0;       // 0 until beginPeaks()
+    float32_t fLow = 0.0f;
+    float32_t fHigh = 0.0f;
+    float32_t snrOn = 15.85f;  // 12 dB
+    float32_t snrOff = 6.31f;  // 8 dB
+    float32_t maxJump_Hz = 0.0f;
+    uint16_t confirmFrames = 2;
+    uint16_t holdFrames = 2;
+
+    // A peak of one spectrum
+    struct candidate {
+        float32_t power;       // Interpolated
+        float32_t frequency;
+        bool used;
+        };
+    candidate cand[PEAKS_MAX_CANDIDATES];
+    uint16_t nCand = 0;
+
+    struct track {
+        peak pk;
+        float32_t power;
+        uint16_t hits;
+        uint16_t misses;
+        bool live;
+        };
+    track tracks[PEAKS_MAX];
+    uint16_t nextId = 0;
+    float32_t noise = 0.0f;
+    float32_t ampScale = 1.0f; // sqrt(power) of a full scale sine wave
+
+    // Results, with the count around writing them
+    peak result[PEAKS_MAX];
+    volatile uint16_t nResult = 0;
+    volatile uint32_t seq = 0;
+
+    bool readPeak(uint16_t i, peak *pPeak);
+    void clearAll(void);
+    void findPeaks(const float32_t *pw, uint32_t nB);
+    void interpolate(const float32_t *pw, uint32_t km, uint32_t k,
+                     uint32_t kp, int winType, candidate *pC);
+    void trackPeaks(void);
+    void putResults(void);
+    };
+#endif
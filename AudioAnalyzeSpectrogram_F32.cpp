@@ -0,0 +1,106 @@
+/*
+ * AudioAnalyzeSpectrogram_F32.cpp
+ *
+ * See AudioAnalyzeSpectrogram_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioAnalyzeSpectrogram_F32.h"
+
+// Keeps the compiler from moving the frame data past the counts
+#define SPECTROGRAM_BARRIER()  __asm__ volatile("" ::: "memory")
+
+uint16_t AudioAnalyzeSpectrogram_F32::beginFrames(uint16_t _width, uint16_t _nFrames)  {
+    if(_width < 1)    _width = 1;
+    if(_nFrames < 1)  _nFrames = 1;
+    uint8_t *newFrames = new uint8_t[(uint32_t)_width*_nFrames];
+    uint32_t *newSeqs = new uint32_t[_nFrames];
+    if(newFrames==NULL || newSeqs==NULL)  {
+        if(newFrames)  delete [] newFrames;
+        if(newSeqs)    delete [] newSeqs;
+        return SPECTRUM_ERR_MEMORY;
+        }
+    setOutputType(FFT_DBFS);
+
+    __disable_irq();
+    uint8_t *oldFrames = frames;
+    uint32_t *oldSeqs = seqs;
+    frames = newFrames;
+    seqs = newSeqs;
+    width = _width;
+    nFrames = _nFrames;
+    head = 0;
+    tail = 0;
+    seq = 0;
+    dropped = 0;
+    __enable_irq();
+
+    if(oldFrames)  delete [] oldFrames;
+    if(oldSeqs)    delete [] oldSeqs;
+    return 0;
+    }
+
+// In update(), a new dBFS output is ready
+void AudioAnalyzeSpectrogram_F32::outputReady(void)  {
+    if(frames==NULL || getOutputType()!=FFT_DBFS)
+        return;
+    uint32_t s = seq++;
+    if(head - tail >= nFrames)  {
+        dropped++;              // Full, the reader is behind
+        return;
+        }
+    uint32_t slot = head % nFrames;
+    uint8_t *pF = frames + slot*width;
+    const float32_t *pOut = getData();
+    uint32_t nB = getNBins();
+
+    for(uint32_t c=0; c<width; c++)  {
+        uint32_t b0 = (c*nB)/width;
+        uint32_t b1 = ((c + 1)*nB)/width;
+        if(b1 <= b0)  b1 = b0 + 1;     // Fewer bins than columns
+        float32_t v = pOut[b0];
+        if(pooling == SPECTROGRAM_POOL_MAX)  {
+            for(uint32_t b=b0+1; b<b1; b++)
+                if(pOut[b] > v)  v = pOut[b];
+            }
+        else if(pooling == SPECTROGRAM_POOL_MEAN)  {
+            for(uint32_t b=b0+1; b<b1; b++)
+                v += pOut[b];
+            v /= (float32_t)(b1 - b0);
+            }
+        float32_t q = (v - dbMin)*dbScale;
+        if(q < 0.0f)         pF[c] = 0;
+        else if(q > 255.0f)  pF[c] = 255;
+        else                 pF[c] = (uint8_t)(q + 0.5f);
+        }
+    seqs[slot] = s;
+    SPECTROGRAM_BARRIER();
+    head = head + 1;            // The frame is now the reader's
+    }
+
+const uint8_t* AudioAnalyzeSpectrogram_F32::peekFrame(uint32_t *pSeq)  {
+    uint32_t t = tail;
+    if(frames==NULL || head == t)
+        return NULL;
+    SPECTROGRAM_BARRIER();
+    uint32_t slot = t % nFrames;
+    if(pSeq)  *pSeq = seqs[slot];
+    return frames + slot*width;
+    }
+
+void AudioAnalyzeSpectrogram_F32::releaseFrame(void)  {
+    if(head == tail)
+        return;
+    SPECTROGRAM_BARRIER();
+    tail = tail + 1;            // The slot is now update()'s
+    }
+
+bool AudioAnalyzeSpectrogram_F32::readFrame(uint8_t *pDest, uint32_t *pSeq)  {
+    const uint8_t *pF = peekFrame(pSeq);
+    if(pF == NULL)
+        return false;
+    memcpy(pDest, pF, width);
+    releaseFrame();
+    return true;
+    }
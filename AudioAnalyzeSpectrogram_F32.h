@@ -0,0 +1,110 @@
+/*
+ * AudioAnalyzeSpectrogram_F32.h
+ *
+ * Spectrogram, or waterfall, frames for a display, from
+ * AudioAnalyzeSpectrum_F32.  Each spectrum is reduced to the width of the
+ * display and each point to one byte of dB, and the frames go into a ring
+ * with a sequence number, for the INO to read whenever it is ready.  A
+ * 1024 bin spectrum of floats is 4 kBytes, where a 256 wide frame is 256
+ * bytes, so the RAM for a history and the bytes sent on to a remote
+ * display, over Serial or USB, are 4 to 16 times less.  Oct 2026
+ *
+ * This is AudioAnalyzeSpectrum_F32, with all of its functions, begin(),
+ * beginZoom(), windows, averaging and so on, plus the frames.  The frames
+ * are made from the dBFS output, so beginFrames() sets FFT_DBFS, and
+ * setOutputType() should not be changed after.  read() and getData() still
+ * give the float output.
+ *
+ * Reducing the bins to the width, setPooling():
+ *   SPECTROGRAM_POOL_MAX  The largest bin of each group, the default.  A
+ *         narrow signal shows however many bins there are per column.
+ *   SPECTROGRAM_POOL_MEAN  The mean of the dB of the group.
+ *   SPECTROGRAM_POOL_DECIMATE  The first bin of each group.
+ * Each column is nBins/width bins, or, if the width is more than the bins,
+ * the bins are repeated.  The byte is 0 at dbMin and below, to 255 at
+ * dbMax and above, default -120 to 0 dBFS.
+ *
+ * Reading - There is one writer, update(), and one reader, the INO, and
+ * each has its own count, so neither has to stop the other.  A frame is
+ * only written to a slot the reader has finished with, and is only read
+ * after update() has finished it, so a frame is never torn.  If the ring
+ * is full, the new frame is dropped and counted.  Sequence numbers count
+ * every frame made, dropped or not, so a gap shows the reader a drop.
+ * The pooling is one pass over the bins, in the update() that finishes
+ * the spectrum.
+ *
+ * Functions, beyond AudioAnalyzeSpectrum_F32:
+ *   uint16_t beginFrames(width, nFrames)  The ring, nFrames of width
+ *         bytes, from new.  Before or after begin().  Returns 0 or
+ *         SPECTRUM_ERR_MEMORY.
+ *   setRange(dbMin, dbMax)
+ *   setPooling(mode)
+ *   uint16_t framesAvailable()
+ *   bool readFrame(uint8_t *pDest, uint32_t *pSeq)  Copies width bytes,
+ *         the oldest frame, and frees it.  false if none.  pSeq may be NULL.
+ *   const uint8_t* peekFrame(uint32_t *pSeq)  The oldest frame, in place,
+ *         or NULL.  For Serial.write() without a copy.  Then releaseFrame().
+ *   releaseFrame()
+ *   uint32_t getDropped()
+ *   uint16_t getWidth()
+ *   float32_t byteTo_dB(q)  The dBFS for a byte of a frame.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioAnalyzeSpectrogram_F32_h_
+#define AudioAnalyzeSpectrogram_F32_h_
+
+#include "AudioAnalyzeSpectrum_F32.h"
+
+#define SPECTROGRAM_POOL_MAX       0
+#define SPECTROGRAM_POOL_MEAN      1
+#define SPECTROGRAM_POOL_DECIMATE  2
+
+class AudioAnalyzeSpectrogram_F32 : public AudioAnalyzeSpectrum_F32  {
+//GUI: inputs:2, outputs:0  //this line used for automatic generation of GUI node
+//GUI: shortName:Spectrogram
+public:
+    AudioAnalyzeSpectrogram_F32(void) : AudioAnalyzeSpectrum_F32() { }
+    AudioAnalyzeSpectrogram_F32(const AudioSettings_F32 &settings) :
+                   AudioAnalyzeSpectrum_F32(settings) { }
+    ~AudioAnalyzeSpectrogram_F32(void)  {
+        if(frames)  delete [] frames;
+        if(seqs)    delete [] seqs;
+        }
+
+    uint16_t beginFrames(uint16_t _width, uint16_t _nFrames);
+    void setRange(float32_t _dbMin, float32_t _dbMax)  {
+        if(_dbMax <= _dbMin)  _dbMax = _dbMin + 1.0f;
+        dbMin = _dbMin;
+        dbScale = 255.0f/(_dbMax - _dbMin);
+        }
+    void setPooling(int mode)  { pooling = mode; }
+
+    uint16_t framesAvailable(void)  { return (uint16_t)(head - tail); }
+    bool readFrame(uint8_t *pDest, uint32_t *pSeq=NULL);
+    const uint8_t* peekFrame(uint32_t *pSeq=NULL);
+    void releaseFrame(void);
+    uint32_t getDropped(void)  { return dropped; }
+    uint16_t getWidth(void)    { return width; }
+    float32_t byteTo_dB(uint8_t q)  { return dbMin + (float32_t)q/dbScale; }
+
+protected:
+    virtual void outputReady(void);
+
+private:
+    uint8_t *frames = NULL;      // nFrames of width
+    uint32_t *seqs = NULL;
+    uint16_t width = 0;
+    uint16_t nFrames = 0;
+    // Counts of frames written and read.  Only update() changes head, and
+    // only the reader changes tail.
+    volatile uint32_t head = 0;
+    volatile uint32_t tail = 0;
+    uint32_t seq = 0;
+    volatile uint32_t dropped = 0;
+    float32_t dbMin = -120.0f;
+    float32_t dbScale = 255.0f/120.0f;
+    int pooling = SPECTROGRAM_POOL_MAX;
+    };
+#endif
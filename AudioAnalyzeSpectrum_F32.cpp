@@ -0,0 +1,522 @@
+/*
+ * AudioAnalyzeSpectrum_F32.cpp
+ *
+ * See AudioAnalyzeSpectrum_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioAnalyzeSpectrum_F32.h"
+
+// The steps of each FFT, in order
+#define SP_IDLE 0
+#define SP_COPY 1
+#define SP_FFT  2
+#define SP_POST 3
+#define SP_OUT  4
+
+// Relative cost of the work on one point in each step, for metering.
+// Roughly cycles/8 on a Cortex-M7.
+#define SP_UNIT_COPY  1
+#define SP_UNIT_BFLY  3
+#define SP_UNIT_POST  2
+#define SP_UNIT_OUT   1
+#define SP_UNIT_RMS   2
+#define SP_UNIT_DB    8
+
+// Zoom decimation, pass band each side as a fraction of fs/ratio, and
+// stop band
+#define SP_ZOOM_PASS  0.4f
+#define SP_ZOOM_DB   90.0f
+
+// Window wNum into w[0] to w[n-1], the same as the fixed size classes
+static void makeWindow(float32_t *w, uint32_t n, int wNum, float32_t kdb)  {
+    float32_t kx = 6.28318530718f/(float32_t)(n - 1);
+    if(wNum == SPECTRUM_WINDOW_KAISER)  {
+        mathDSP_F32 mathW;  // For Bessel function
+        float32_t beta = -2.17f + 0.17153f*kdb - 0.0002841f*kdb*kdb;
+        float32_t kbes = 1.0f/mathW.i0f(beta);
+        float32_t kx2 = 4.0f/((float32_t)(n - 1)*(float32_t)(n - 1));
+        for(uint32_t i=0; i<n/2; i++)  {
+            float32_t xn2 = 0.5f + (float32_t)i;
+            xn2 = kx2*xn2*xn2;
+            w[n/2 - 1 - i] = kbes*mathW.i0f(beta*sqrtf(1.0f - xn2));
+            w[n/2 + i] = w[n/2 - 1 - i];
+            }
+        }
+    else if(wNum == SPECTRUM_WINDOW_BLACKMAN_HARRIS)  {
+        for(uint32_t i=0; i<n; i++)
+            w[i] = 0.35875f - 0.48829f*cosf(kx*(float32_t)i)
+                 + 0.14128f*cosf(2.0f*kx*(float32_t)i)
+                 - 0.01168f*cosf(3.0f*kx*(float32_t)i);
+        }
+    else  {
+        for(uint32_t i=0; i<n; i++)
+            w[i] = 0.5f*(1.0f - cosf(kx*(float32_t)i));
+        }
+    }
+
+uint32_t AudioAnalyzeSpectrum_F32::getMemorySize(uint16_t _N, bool _iq, float32_t overlap)  {
+    if(overlap < 0.0f)  overlap = 0.0f;
+    if(overlap > 0.9f)  overlap = 0.9f;
+    uint32_t h = (uint32_t)((float32_t)_N*(1.0f - overlap) + 0.5f);
+    if(h < 1)  h = 1;
+    uint32_t r = (uint32_t)_N + h;
+    return _iq ? 2*r + 6*(uint32_t)_N : r + 4*(uint32_t)_N;
+    }
+
+uint16_t AudioAnalyzeSpectrum_F32::begin(uint16_t _N, bool _iq, float32_t overlap,
+                                         float32_t *pMem)  {
+    if(_N<64 || _N>SPECTRUM_MAX_N || (_N & (_N - 1)))
+        return SPECTRUM_ERR_N;
+    endZoom();
+    return beginFFT(_N, _iq, _iq, overlap, pMem);
+    }
+
+uint16_t AudioAnalyzeSpectrum_F32::beginZoom(uint16_t _N, uint16_t ratio,
+             float32_t center_Hz, bool _iq, float32_t overlap, float32_t *pMem)  {
+    FIRDesign_F32::stage newStages[MULTIRATE_MAX_STAGES];
+    uint16_t nNew;
+    float32_t *newBuffer;
+
+    if(_N<64 || _N>SPECTRUM_MAX_N || (_N & (_N - 1)))
+        return SPECTRUM_ERR_N;
+    if(ratio<2 || ratio>DECIMATE_MAX_RATIO)
+        return SPECTRUM_ERR_ZOOM;
+    nNew = FIRDesign_F32::multirateStages(ratio, SP_ZOOM_PASS/(float32_t)ratio,
+                    SP_ZOOM_DB, newStages, MULTIRATE_MAX_STAGES);
+    if(nNew == 0)
+        return SPECTRUM_ERR_ZOOM;
+    // As AudioFilterDecimate_F32, for I and Q
+    uint32_t size = 0;
+    uint16_t nIn = block_size;
+    for(int s=0; s<nNew; s++)  {
+        size += newStages[s].nTaps - 1 + nIn;
+        nIn = nIn/newStages[s].factor + 1;
+        }
+    newBuffer = new float32_t[2*size];
+    if(newBuffer == NULL)  {
+        FIRDesign_F32::freeStages(newStages, nNew);
+        return SPECTRUM_ERR_MEMORY;
+        }
+    for(uint32_t i=0; i<2*size; i++)
+        newBuffer[i] = 0.0f;
+
+    endZoom();
+    __disable_irq();
+    N = 0;                   // update() waits for beginFFT()
+    for(int s=0; s<MULTIRATE_MAX_STAGES; s++)
+        zStages[s] = newStages[s];
+    nZStages = nNew;
+    zBuffer = newBuffer;
+    zoom = ratio;
+    float32_t *p = zBuffer;
+    for(int ch=0; ch<2; ch++)  {
+        nIn = block_size;
+        for(int s=0; s<nZStages; s++)  {
+            zBuf[ch][s] = p;
+            p += zStages[s].nTaps - 1 + nIn;
+            nIn = nIn/zStages[s].factor + 1;
+            zPhase[ch][s] = 0;
+            }
+        }
+    ncoPhase = 0.0;
+    __enable_irq();
+    setZoomCenter(center_Hz);
+    return beginFFT(_N, true, _iq, overlap, pMem);
+    }
+
+// Back to no zoom
+void AudioAnalyzeSpectrum_F32::endZoom(void)  {
+    FIRDesign_F32::stage oldStages[MULTIRATE_MAX_STAGES];
+    uint16_t nOld;
+    float32_t *oldBuffer;
+
+    if(nZStages == 0)
+        return;
+    __disable_irq();
+    for(int s=0; s<MULTIRATE_MAX_STAGES; s++)
+        oldStages[s] = zStages[s];
+    nOld = nZStages;
+    nZStages = 0;
+    oldBuffer = zBuffer;
+    zBuffer = NULL;
+    zoom = 1;
+    zoomCenter_Hz = 0.0f;
+    __enable_irq();
+    FIRDesign_F32::freeStages(oldStages, nOld);
+    if(oldBuffer)  delete [] oldBuffer;
+    }
+
+void AudioAnalyzeSpectrum_F32::setZoomCenter(float32_t center_Hz)  {
+    double step = (double)center_Hz/(double)sample_rate_Hz;
+    float32_t c = (float32_t)cos(2.0*M_PI*step);
+    float32_t s = (float32_t)sin(2.0*M_PI*step);
+    __disable_irq();
+    zoomCenter_Hz = center_Hz;
+    ncoStep = step;
+    ncoC = c;
+    ncoS = s;
+    count = 0;               // Do not average across the change
+    __enable_irq();
+    }
+
+// The FFT index of output k, for xAxis.  I-Q only.
+uint32_t AudioAnalyzeSpectrum_F32::fftIndex(uint32_t k)  {
+    uint32_t ii = k;
+    // xAxis, bit 0 left/right;  bit 1 low to high
+    if((xAxis & 0X02) == 0)
+        ii ^= N/2;
+    if(xAxis & 0X01)
+        ii = N - 1 - ii;
+    return ii ^ N/2;
+    }
+
+float32_t AudioAnalyzeSpectrum_F32::getBinFrequency(unsigned int binNumber)  {
+    if(N==0 || binNumber>=nBins)
+        return 0.0f;
+    if(!iq)
+        return (float32_t)binNumber*getBinHz();
+    int32_t ii = (int32_t)fftIndex(binNumber);
+    if(ii >= (int32_t)N/2)
+        ii -= (int32_t)N;              // Negative frequencies
+    return zoomCenter_Hz + (float32_t)ii*getBinHz();
+    }
+
+uint16_t AudioAnalyzeSpectrum_F32::beginFFT(uint16_t _N, bool _iq, bool _iqIn,
+                                            float32_t overlap, float32_t *pMem)  {
+    float32_t *pOld = pMemOwn;
+    float32_t *pOwn = NULL;
+
+    if(_N<64 || _N>SPECTRUM_MAX_N || (_N & (_N - 1)))
+        return SPECTRUM_ERR_N;
+    uint32_t size = getMemorySize(_N, _iq, overlap);
+    if(pMem == NULL)  {
+        pOwn = new float32_t[size];
+        if(pOwn == NULL)
+            return SPECTRUM_ERR_MEMORY;
+        pMem = pOwn;
+        }
+    for(uint32_t i=0; i<size; i++)
+        pMem[i] = 0.0f;
+
+    uint32_t n = _N;
+    uint32_t m = _iq ? n : n/2;
+    uint32_t nb = _iq ? n : n/2;
+    uint32_t r = size - (_iq ? 6*n : 4*n);     // Floats of input
+    float32_t *pRing = pMem;
+    float32_t *pWork = pRing + r;
+    float32_t *pTw = pWork + 2*m;
+    float32_t *pWin = pTw + (_iq ? m : 2*m);
+    float32_t *pSum = pWin + n;
+    float32_t *pOut = pSum + nb;
+    // Real input needs the angles to fs/N for the split after the FFT,
+    // and the FFT uses every other one.
+    uint32_t nTw = _iq ? m/2 : m;
+    double dAngle = (_iq ? 2.0 : 1.0)*M_PI/(double)m;
+    for(uint32_t t=0; t<nTw; t++)  {
+        pTw[2*t] = (float32_t)cos(dAngle*(double)t);
+        pTw[2*t + 1] = -(float32_t)sin(dAngle*(double)t);
+        }
+    makeWindow(pWin, n, winType, winKdb);
+    uint16_t lm = 0;
+    while((1UL << lm) < m)  lm++;
+
+    __disable_irq();
+    N = n;
+    iq = _iq;
+    iqIn = _iqIn;
+    M = m;
+    logM = lm;
+    nBins = nb;
+    R = _iq ? r/2 : r;
+    hop = R - N;
+    ring = pRing;
+    work = pWork;
+    twiddle = pTw;
+    twStride = _iq ? 1 : 2;
+    window = pWin;
+    sumsq = pSum;
+    output = pOut;
+    pMemOwn = pOwn;
+    ringWrite = 0;
+    nFilled = 0;
+    sinceFrame = 0;
+    phase = SP_IDLE;
+    count = 0;
+    outputflag = false;
+    kMaxDB = 20.0f*log10f(0.5f*(float32_t)N);  // 54.1854 for 1024
+    setQuota();
+    __enable_irq();
+
+    if(pOld)  delete [] pOld;
+    return 0;
+    }
+
+int AudioAnalyzeSpectrum_F32::windowFunction(int wNum, float _kdb)  {
+    winType = wNum;
+    winKdb = (_kdb < 20.0f) ? 20.0f : _kdb;
+    useWindow = (wNum != SPECTRUM_WINDOW_NONE);
+    if(useWindow && window)
+        makeWindow(window, N, winType, winKdb);
+    return 0;
+    }
+
+// The work for one FFT, spread evenly over the updates until the next
+void AudioAnalyzeSpectrum_F32::setQuota(void)  {
+    uint32_t unitOut = SP_UNIT_OUT;
+    if(outputType == FFT_RMS)        unitOut = SP_UNIT_RMS;
+    else if(outputType == FFT_DBFS)  unitOut = SP_UNIT_DB;
+    uint32_t total = M*SP_UNIT_COPY + logM*(M/2)*SP_UNIT_BFLY
+                   + nBins*(SP_UNIT_POST + unitOut);
+    uint32_t nUpdates = hop*zoom/block_size;
+    if(nUpdates < 1)  nUpdates = 1;
+    // Each step rounds up by a point, so a little to spare
+    quota = (total + nUpdates - 1)/nUpdates + 4*SP_UNIT_DB;
+    }
+
+void AudioAnalyzeSpectrum_F32::startFrame(uint32_t start)  {
+    frameStart = start;
+    phase = SP_COPY;
+    index = 0;
+    rev = 0;
+    }
+
+// Points for this pass, at least one, and what is left of the budget
+static inline uint32_t take(uint32_t left, uint32_t *pBudget, uint32_t unit)  {
+    uint32_t n = *pBudget/unit;
+    if(n < 1)     n = 1;
+    if(n > left)  n = left;
+    *pBudget = (n*unit >= *pBudget) ? 0 : *pBudget - n*unit;
+    return n;
+    }
+
+void AudioAnalyzeSpectrum_F32::runFrame(uint32_t budget)  {
+    uint32_t n, k;
+
+    while(phase!=SP_IDLE && budget>0)  {
+        if(phase == SP_COPY)  {
+            // Window, and to the bit reversed place for the FFT
+            n = take(M - index, &budget, SP_UNIT_COPY);
+            for(k=index; k<index+n; k++)  {
+                float32_t re, im;
+                if(iq)  {
+                    uint32_t p = frameStart + k;
+                    if(p >= R)  p -= R;
+                    re = ring[2*p];
+                    im = ring[2*p + 1];
+                    if(useWindow)  { re *= window[k];  im *= window[k]; }
+                    }
+                else  {
+                    // Real, even samples to re and odd to im
+                    uint32_t p = frameStart + 2*k;
+                    if(p >= R)  p -= R;
+                    re = ring[p];
+                    if(++p >= R)  p = 0;
+                    im = ring[p];
+                    if(useWindow)  { re *= window[2*k];  im *= window[2*k + 1]; }
+                    }
+                work[2*rev] = re;
+                work[2*rev + 1] = im;
+                uint32_t bit = M >> 1;
+                while(rev & bit)  {
+                    rev ^= bit;
+                    bit >>= 1;
+                    }
+                rev |= bit;
+                }
+            index += n;
+            if(index >= M)  {
+                phase = SP_FFT;
+                stage = 0;
+                index = 0;
+                }
+            }
+
+        else if(phase == SP_FFT)  {
+            // Butterfly b of stage s is at i, j = i + 2^s, in group b>>s
+            uint32_t half = 1UL << stage;
+            uint32_t tShift = logM - 1 - stage;
+            n = take(M/2 - index, &budget, SP_UNIT_BFLY);
+            for(uint32_t b=index; b<index+n; b++)  {
+                uint32_t kk = b & (half - 1);
+                uint32_t i = ((b >> stage) << (stage + 1)) + kk;
+                uint32_t j = i + half;
+                uint32_t t = (kk << tShift)*twStride;
+                float32_t wr = twiddle[2*t];
+                float32_t wi = twiddle[2*t + 1];
+                float32_t xr = work[2*j]*wr - work[2*j + 1]*wi;
+                float32_t xi = work[2*j]*wi + work[2*j + 1]*wr;
+                work[2*j]     = work[2*i] - xr;
+                work[2*j + 1] = work[2*i + 1] - xi;
+                work[2*i]     += xr;
+                work[2*i + 1] += xi;
+                }
+            index += n;
+            if(index >= M/2)  {
+                index = 0;
+                if(++stage >= logM)  {
+                    phase = SP_POST;
+                    if(aveMode == SPECTRUM_AVE_EXP)  {
+                        firstAve = (count == 0);
+                        count = 1;
+                        doOutput = true;
+                        }
+                    else  {
+                        count++;
+                        firstAve = (count == 1);
+                        doOutput = (count >= nAverage);
+                        }
+                    }
+                }
+            }
+
+        else if(phase == SP_POST)  {
+            float32_t alpha = 1.0f/(float32_t)nAverage;
+            n = take(nBins - index, &budget, SP_UNIT_POST);
+            for(k=index; k<index+n; k++)  {
+                float32_t p;
+                if(iq)  {
+                    p = work[2*k]*work[2*k] + work[2*k + 1]*work[2*k + 1];
+                    }
+                else  {
+                    // Split the N/2 complex FFT of the even and odd
+                    // samples into the N point real one
+                    uint32_t k2 = (M - k) & (M - 1);
+                    float32_t rns = 0.5f*(work[2*k] + work[2*k2]);
+                    float32_t ins = 0.5f*(work[2*k + 1] + work[2*k2 + 1]);
+                    float32_t rnd = 0.5f*(work[2*k] - work[2*k2]);
+                    float32_t ind = 0.5f*(work[2*k + 1] - work[2*k2 + 1]);
+                    float32_t c = twiddle[2*k];
+                    float32_t s = -twiddle[2*k + 1];
+                    float32_t xr = rns + c*ins - s*rnd;
+                    float32_t xi = ind - s*ins - c*rnd;
+                    p = xr*xr + xi*xi;
+                    }
+                if(firstAve)
+                    sumsq[k] = p;
+                else if(aveMode == SPECTRUM_AVE_EXP)
+                    sumsq[k] += alpha*(p - sumsq[k]);
+                else if(aveMode == SPECTRUM_AVE_PEAK)
+                    sumsq[k] = (p > sumsq[k]) ? p : sumsq[k];
+                else
+                    sumsq[k] += p;
+                }
+            index += n;
+            if(index >= nBins)  {
+                index = 0;
+                if(doOutput)  {
+                    phase = SP_OUT;
+                    outputflag = false;   // Being changed
+                    }
+                else
+                    phase = SP_IDLE;
+                }
+            }
+
+        else  {   // SP_OUT
+            float32_t inAf = (aveMode == SPECTRUM_AVE_LINEAR) ?
+                             1.0f/(float32_t)nAverage : 1.0f;
+            uint32_t unitOut = SP_UNIT_OUT;
+            if(outputType == FFT_RMS)        unitOut = SP_UNIT_RMS;
+            else if(outputType == FFT_DBFS)  unitOut = SP_UNIT_DB;
+            n = take(nBins - index, &budget, unitOut);
+            for(k=index; k<index+n; k++)  {
+                uint32_t ii = iq ? fftIndex(k) : k;
+                float32_t p = inAf*sumsq[ii];
+                if(outputType == FFT_RMS)
+                    output[k] = sqrtf(p);
+                else if(outputType == FFT_POWER)
+                    output[k] = p;
+                else if(outputType == FFT_DBFS)  {
+                    if(p > 0.0f)
+                        output[k] = 10.0f*log10f(p) - kMaxDB;  // Scaled to FS sine wave
+                    else
+                        output[k] = -193.0f;   // lsb for 23 bit mantissa
+                    }
+                else
+                    output[k] = 0.0f;
+                }
+            index += n;
+            if(index >= nBins)  {
+                if(aveMode != SPECTRUM_AVE_EXP)
+                    count = 0;
+                outputflag = true;
+                phase = SP_IDLE;
+                outputReady();
+                }
+            }
+        }
+    }
+
+// One sample, or I-Q pair, to the ring, and start an FFT when due
+void AudioAnalyzeSpectrum_F32::putSample(float32_t re, float32_t im)  {
+    if(iq)  {
+        ring[2*ringWrite] = re;
+        ring[2*ringWrite + 1] = im;
+        }
+    else
+        ring[ringWrite] = re;
+    if(++ringWrite >= R)  ringWrite = 0;
+    if(nFilled < N)  nFilled++;
+    sinceFrame++;
+    if(nFilled>=N && sinceFrame>=hop)  {
+        // The ring holds hop more than N, so the last FFT must be
+        // done now, if the quota has not kept up.
+        if(phase != SP_IDLE)
+            runFrame(0xFFFFFFFF);
+        startFrame((ringWrite + R - N) % R);
+        sinceFrame = 0;
+        }
+    }
+
+void AudioAnalyzeSpectrum_F32::update(void)  {
+    audio_block_f32_t *blockI, *blockQ;
+
+    blockI = AudioStream_F32::receiveReadOnly_f32(0);
+    blockQ = AudioStream_F32::receiveReadOnly_f32(1);
+    if(!blockI || N==0 || (iqIn && !blockQ))  {
+        if(blockI)  AudioStream_F32::release(blockI);
+        if(blockQ)  AudioStream_F32::release(blockQ);
+        return;
+        }
+
+    uint32_t n = blockI->length;
+    if(iqIn && (uint32_t)blockQ->length < n)
+        n = blockQ->length;
+    if(zoom > 1)  {
+        // Mix center_Hz down to 0 Hz, times exp(-j*phase), and decimate
+        float32_t zI[AUDIO_BLOCK_SAMPLES];
+        float32_t zQ[AUDIO_BLOCK_SAMPLES];
+        if(n > AUDIO_BLOCK_SAMPLES)  n = AUDIO_BLOCK_SAMPLES;
+        float32_t ph = (float32_t)(2.0*M_PI*ncoPhase);
+        float32_t c = cosf(ph);
+        float32_t s = sinf(ph);
+        for(uint32_t i=0; i<n; i++)  {
+            float32_t xr = blockI->data[i];
+            float32_t xi = iqIn ? blockQ->data[i] : 0.0f;
+            zI[i] = xr*c + xi*s;
+            zQ[i] = xi*c - xr*s;
+            float32_t cc = c*ncoC - s*ncoS;
+            s = s*ncoC + c*ncoS;
+            c = cc;
+            }
+        ncoPhase += (double)n*ncoStep;
+        ncoPhase -= floor(ncoPhase);
+        uint16_t nOut = AudioFilterDecimate_F32::runStages(zStages, nZStages,
+                              zBuf[0], zPhase[0], zI, n, zI);
+        AudioFilterDecimate_F32::runStages(zStages, nZStages,
+                              zBuf[1], zPhase[1], zQ, n, zQ);
+        for(uint16_t k=0; k<nOut; k++)
+            putSample(zI[k], zQ[k]);
+        }
+    else  {
+        for(uint32_t i=0; i<n; i++)
+            putSample(blockI->data[i], iqIn ? blockQ->data[i] : 0.0f);
+        }
+    AudioStream_F32::release(blockI);
+    if(blockQ)  AudioStream_F32::release(blockQ);
+
+    if(phase != SP_IDLE)
+        runFrame(spread ? quota : 0xFFFFFFFF);
+    }
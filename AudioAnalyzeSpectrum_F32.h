@@ -0,0 +1,302 @@
+/*
+ * AudioAnalyzeSpectrum_F32.h
+ *
+ * A power spectrum analyzer for any FFT size, real or I-Q input, in place
+ * of the fixed size AudioAnalyzeFFT1024_F32 and AudioAnalyzeFFT256_IQ_F32
+ * to AudioAnalyzeFFT4096_IQEM_F32.  Those remain for existing INOs.  The
+ * output is as theirs, RMS, power or dBFS in each bin, with the same
+ * scaling, windows, averaging and, for I-Q, setXAxis().  Oct 2026
+ *
+ * The difference is in the timing.  The fixed classes gather the blocks
+ * and then do the whole FFT, magnitudes and log10f() in one update(), so
+ * that one update in 8, or in 32, takes most of the time.  Here the work
+ * for each FFT, window, butterflies stage by stage, magnitudes, averaging
+ * and output, is metered out over the updates until the next FFT is due,
+ * so every update takes about the same time.  The worst case update is
+ * then close to the average, that is what sets the limit on all the
+ * other audio objects.  The FFT is a radix-2 one here, so it can be
+ * stopped and started at any butterfly.  With setSpread(false) all the
+ * work is done in the update() that completes the data, as before.
+ *
+ * Real input, In 0, does an N/2 complex FFT of N samples and gives N/2
+ * bins, 0 to fs/2.  I-Q input, In 0 I and In 1 Q, gives N bins, fs wide,
+ * arranged by setXAxis().  A new FFT is started every N*(1 - overlap)
+ * samples, so overlap 0.5 is the same as the fixed classes, and 0.75 gives
+ * twice as many spectra.  Bins are fs/N wide.
+ *
+ * Memory is from the heap with new, as (R + 4N) floats for real and
+ * (2R + 6N) for I-Q, where R = N + N*(1 - overlap) is the input buffer.
+ * No audio blocks are held, where AudioAnalyzeFFT4096_IQ_F32 holds 64.
+ * For 4096 I-Q and overlap 0.5 this is 144 kBytes.
+ * Or, as AudioAnalyzeFFT4096_IQEM_F32, the INO can supply the memory, of
+ * getMemorySize() floats, to begin().
+ *
+ * Zoom - beginZoom() looks at a narrow band, fs/ratio wide, around
+ * center_Hz, with bins ratio times finer than begin() gives for the same N.
+ * The input is mixed down by center_Hz, to I-Q at 0 Hz, and decimated by
+ * ratio, with the multirate stages of AudioFilterDecimate_F32, and then the
+ * N point I-Q FFT is at fs/ratio.  So +/-1 kHz around a carrier, at 96 kHz,
+ * is ratio 32 and 1024 points, 2.9 Hz bins, where 4096 points at the full
+ * rate gives 23.4 Hz.  The memory is as for I-Q, and the decimation filters
+ * are a few hundred floats more.  The FFT is at the low rate, so the work
+ * each update is about the mixing and filtering.  The filters pass to 0.4
+ * of fs/ratio each side, so the outer bins, beyond +/-0.4*fs/ratio of the
+ * center, are in the transition band and are less accurate.  Bins are
+ * fs/(N*ratio) wide, and getBinFrequency() gives the frequency of each,
+ * in Hz, for the setXAxis() in use.
+ *
+ * AudioAnalyzeSpectrogram_F32 is this class with the dBFS output reduced
+ * to one byte per display column, in a ring of frames for a waterfall.
+ * AudioAnalyzeSpectralPeaks_F32 is this class with the peaks found, to a
+ * fraction of a bin, and tracked from one output to the next.
+ *
+ * Averaging, setAverageMode():
+ *   SPECTRUM_AVE_LINEAR  The mean power of nAverage FFTs, one output per
+ *         nAverage FFTs.  The default, and as the fixed classes.
+ *   SPECTRUM_AVE_EXP  Exponential average, 1/nAverage of each new power,
+ *         an output for every FFT.
+ *   SPECTRUM_AVE_PEAK  The highest power in each bin over nAverage FFTs.
+ *
+ * Functions:
+ *   begin(N, iq, overlap, pMem)  N a power of 2 from 64 to
+ *         SPECTRUM_MAX_N.  iq true for I-Q.  overlap 0.0 to 0.9.  pMem
+ *         NULL to use new.  Returns 0 or an error, SPECTRUM_ERR_N or
+ *         SPECTRUM_ERR_MEMORY.  Nothing happens before begin().
+ *   beginZoom(N, ratio, center_Hz, iq, overlap, pMem)  As begin(), with
+ *         the zoom, above.  ratio is 2's times 3, 5 and 7, to
+ *         DECIMATE_MAX_RATIO.  iq false for real input on In 0.  Returns 0
+ *         or an error, also SPECTRUM_ERR_ZOOM.  Then begin() for no zoom.
+ *   setZoomCenter(center_Hz)  At any time, restarts the averaging.
+ *   getMemorySize(N, iq, overlap)  Floats needed for pMem.  iq true for
+ *         beginZoom().
+ *   bool available()
+ *   float read(binNumber)
+ *   float read(binFirst, binLast)  Sum of the bins.
+ *   windowFunction(wNum)  SPECTRUM_WINDOW_NONE, _HANN, _BLACKMAN_HARRIS.
+ *         The AudioWindowNone, AudioWindowHanning1024 and so on of the
+ *         fixed classes are the same numbers.
+ *   windowFunction(SPECTRUM_WINDOW_KAISER, kdb)
+ *   float* getData()  The output, getNBins() long.
+ *   float* getWindow()  N long.
+ *   putWindow(*pWin)  Copies N floats.
+ *   setNAverage(n)
+ *   setAverageMode(mode)
+ *   setOutputType(type)  FFT_RMS, FFT_POWER or FFT_DBFS
+ *   getOutputType()
+ *   setXAxis(xAxis)  I-Q only, as AudioAnalyzeFFT1024_IQ_F32.
+ *   setSpread(bool)  Default true.
+ *   getNBins()
+ *   getBinHz()
+ *   getBinFrequency(binNumber)  In Hz, for the data from read(binNumber).
+ *   getZoom()  The ratio, 1 with no zoom.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef analyze_spectrum_f32_h_
+#define analyze_spectrum_f32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#include "mathDSP_F32.h"
+#include "FIRDesign_F32.h"
+#include "AudioFilterDecimate_F32.h"
+
+#ifndef FFT_RMS
+#define FFT_RMS 0
+#define FFT_POWER 1
+#define FFT_DBFS 2
+#endif
+
+#define SPECTRUM_WINDOW_NONE            0
+#define SPECTRUM_WINDOW_HANN            1
+#define SPECTRUM_WINDOW_KAISER          2
+#define SPECTRUM_WINDOW_BLACKMAN_HARRIS 3
+
+#define SPECTRUM_AVE_LINEAR 0
+#define SPECTRUM_AVE_EXP    1
+#define SPECTRUM_AVE_PEAK   2
+
+#define SPECTRUM_MAX_N 16384
+
+#define SPECTRUM_ERR_N      1
+#define SPECTRUM_ERR_MEMORY 2
+#define SPECTRUM_ERR_ZOOM   3
+
+class AudioAnalyzeSpectrum_F32 : public AudioStream_F32  {
+//GUI: inputs:2, outputs:0  //this line used for automatic generation of GUI node
+//GUI: shortName:Spectrum
+public:
+    AudioAnalyzeSpectrum_F32(void) : AudioStream_F32(2, inputQueueArray) {
+        block_size = AUDIO_BLOCK_SAMPLES;
+        }
+    AudioAnalyzeSpectrum_F32(const AudioSettings_F32 &settings) :
+                   AudioStream_F32(2, inputQueueArray) {
+        block_size = settings.audio_block_samples;
+        sample_rate_Hz = settings.sample_rate_Hz;
+        }
+    ~AudioAnalyzeSpectrum_F32(void)  {
+        if(pMemOwn)  delete [] pMemOwn;
+        FIRDesign_F32::freeStages(zStages, nZStages);
+        if(zBuffer)  delete [] zBuffer;
+        }
+
+    uint16_t begin(uint16_t _N, bool _iq=false, float32_t overlap=0.5f,
+                   float32_t *pMem=NULL);
+    uint16_t beginZoom(uint16_t _N, uint16_t ratio, float32_t center_Hz,
+                   bool _iq=false, float32_t overlap=0.5f, float32_t *pMem=NULL);
+    void setZoomCenter(float32_t center_Hz);
+    static uint32_t getMemorySize(uint16_t _N, bool _iq, float32_t overlap);
+
+    bool available(void) {
+        if (outputflag == true) {
+            outputflag = false;  // No double returns
+            return true;
+            }
+        return false;
+        }
+
+    float read(unsigned int binNumber) {
+        if (output==NULL || binNumber>=nBins) return 0.0f;
+        return output[binNumber];
+        }
+
+    // Return sum of several bins. Normally use with power output.
+    float read(unsigned int binFirst, unsigned int binLast) {
+        if (binFirst > binLast) {
+            unsigned int tmp = binLast;
+            binLast = binFirst;
+            binFirst = tmp;
+            }
+        if (output==NULL || binFirst>=nBins) return 0.0f;
+        if (binLast >= nBins) binLast = nBins - 1;
+        float sum = 0.0f;
+        do {
+            sum += output[binFirst++];
+            } while (binFirst <= binLast);
+        return sum;
+        }
+
+    int windowFunction(int wNum) {
+        if(wNum == SPECTRUM_WINDOW_KAISER)
+            return -1;                 // Kaiser needs the kdb
+        return windowFunction(wNum, 0.0f);
+        }
+    int windowFunction(int wNum, float _kdb);
+
+    float* getData(void)    { return output; }
+    float* getWindow(void)  { return window; }
+
+    void putWindow(float *pwin)  {
+        if(window == NULL)  return;
+        for(uint32_t i=0; i<N; i++)
+            window[i] = pwin[i];
+        useWindow = true;
+        }
+
+    void setNAverage(int _nAverage)  {
+        nAverage = (_nAverage < 1) ? 1 : _nAverage;
+        count = 0;
+        }
+    void setAverageMode(int mode)  {
+        aveMode = mode;
+        count = 0;
+        }
+    void setOutputType(int _type)  {
+        outputType = _type;
+        setQuota();
+        }
+    int getOutputType(void)        { return outputType; }
+    void setXAxis(uint8_t _xAxis)  { xAxis = _xAxis; }
+    void setSpread(bool _spread)   { spread = _spread; }
+    uint16_t getNBins(void)        { return nBins; }
+    uint16_t getZoom(void)         { return zoom; }
+    float32_t getBinHz(void)  {
+        return N ? sample_rate_Hz/(float32_t)(N*zoom) : 0.0f;
+        }
+    float32_t getBinFrequency(unsigned int binNumber);
+
+    virtual void update(void);
+
+protected:
+    // Called from update() each time a new output is complete, as
+    // available() goes true.  For AudioAnalyzeSpectrogram_F32 and
+    // AudioAnalyzeSpectralPeaks_F32.
+    virtual void outputReady(void)  { }
+    uint32_t getN(void)        { return N; }
+    bool getIQ(void)           { return iq; }
+    int getWindowType(void)    { return useWindow ? winType : SPECTRUM_WINDOW_NONE; }
+
+private:
+    audio_block_f32_t *inputQueueArray[2];
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    uint32_t N = 0;           // 0 until begin()
+    bool iq = false;          // Complex FFT, for I-Q in or zoom
+    bool iqIn = false;        // In 1 is used
+    uint32_t M = 0;           // Complex FFT size, N/2 for real
+    uint16_t logM = 0;
+    uint32_t nBins = 0;
+    uint32_t hop = 0;
+    float32_t *pMemOwn = NULL;
+
+    // The input, R samples circular, interleaved for I-Q
+    float32_t *ring = NULL;
+    uint32_t R = 0;
+    uint32_t ringWrite = 0;
+    uint32_t nFilled = 0;
+    uint32_t sinceFrame = 0;
+
+    float32_t *work = NULL;   // M complex
+    float32_t *twiddle = NULL;
+    uint16_t twStride = 1;
+    float32_t *window = NULL;
+    bool useWindow = true;
+    float32_t *sumsq = NULL;
+    float32_t *output = NULL;
+
+    bool outputflag = false;
+    int outputType = FFT_RMS;
+    int nAverage = 1;
+    int aveMode = SPECTRUM_AVE_LINEAR;
+    int count = 0;
+    uint8_t xAxis = 0x03;
+    bool spread = true;
+
+    // The FFT in progress
+    uint16_t phase = 0;
+    uint32_t frameStart = 0;
+    uint32_t index = 0;       // Within the phase
+    uint32_t rev = 0;         // Bit reversed index for the copy
+    uint16_t stage = 0;
+    bool doOutput = false;
+    bool firstAve = true;
+    int winType = SPECTRUM_WINDOW_HANN;
+    float32_t winKdb = 0.0f;
+    float32_t kMaxDB = 0.0f;
+    uint32_t quota = 0;       // Work units per update
+
+    // Zoom, mixer and decimation ahead of the ring
+    uint16_t zoom = 1;
+    float32_t zoomCenter_Hz = 0.0f;
+    double ncoPhase = 0.0;    // Cycles
+    double ncoStep = 0.0;     // Cycles per sample
+    float32_t ncoC = 1.0f;    // cos and sin of the step
+    float32_t ncoS = 0.0f;
+    FIRDesign_F32::stage zStages[MULTIRATE_MAX_STAGES];
+    uint16_t nZStages = 0;
+    float32_t *zBuffer = NULL;
+    float32_t *zBuf[2][MULTIRATE_MAX_STAGES];
+    uint16_t zPhase[2][MULTIRATE_MAX_STAGES];
+
+    uint16_t beginFFT(uint16_t _N, bool _iq, bool _iqIn, float32_t overlap,
+                      float32_t *pMem);
+    void endZoom(void);
+    void putSample(float32_t re, float32_t im);
+    uint32_t fftIndex(uint32_t k);
+    void setQuota(void);
+    void startFrame(uint32_t start);
+    void runFrame(uint32_t budget);
+    };
+#endif
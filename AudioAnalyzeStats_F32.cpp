@@ -0,0 +1,240 @@
+/*
+ * AudioAnalyzeStats_F32.cpp
+ *
+ * See AudioAnalyzeStats_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioAnalyzeStats_F32.h"
+
+// Keeps the compiler from moving reads or writes of the results past
+// the count.  One core, so nothing more is needed.
+#define STATS_BARRIER()  __asm__ volatile("" ::: "memory")
+
+bool AudioAnalyzeStats_F32::begin(float32_t short_ms, float32_t long_ms)  {
+    float32_t blockMs = 1000.0f*(float32_t)block_size/sample_rate_Hz;
+    uint16_t newSegBlocks = (uint16_t)(0.5f + STATS_SEGMENT_MS/blockMs);
+    if(newSegBlocks < 1)  newSegBlocks = 1;
+    float32_t segMs = blockMs*(float32_t)newSegBlocks;
+    if(long_ms > STATS_MAX_MS)  long_ms = STATS_MAX_MS;
+    uint16_t newShort = (uint16_t)(0.5f + short_ms/segMs);
+    uint16_t newLong = (uint16_t)(0.5f + long_ms/segMs);
+    if(newShort < 1)  newShort = 1;
+    if(newLong < newShort)  newLong = newShort;
+
+    segment *newSegs = new segment[newLong*nCh];
+    if(newSegs == NULL)
+        return false;
+    designK();
+
+    __disable_irq();
+    segment *oldSegs = segs;
+    segs = newSegs;
+    nSegs = newLong;
+    segBlocks = newSegBlocks;
+    nShort = newShort;
+    nLong = newLong;
+    for(int ch=0; ch<nCh; ch++)
+        arm_biquad_cascade_df1_init_f32(&kInst[ch], 2, kCoeffs, kState[ch]);
+    clearWindows();
+    __enable_irq();
+
+    if(oldSegs)  delete [] oldSegs;
+    return true;
+    }
+
+void AudioAnalyzeStats_F32::reset(void)  {
+    __disable_irq();
+    clearWindows();
+    __enable_irq();
+    }
+
+// With interrupts off
+void AudioAnalyzeStats_F32::clearWindows(void)  {
+    seq++;
+    for(int ch=0; ch<nCh; ch++)  {
+        cur[ch] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for(int i=0; i<8; i++)
+            kState[ch][i] = 0.0f;
+        result[0][ch] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        result[1][ch] = result[0][ch];
+        }
+    loudness[0] = STATS_LUFS_MIN;
+    loudness[1] = STATS_LUFS_MIN;
+    seq++;
+    segWrite = 0;
+    segFull = 0;
+    blockCount = 0;
+    new_output = false;
+    }
+
+/* The K-weighting of ITU-R BS.1770, a high shelf and a high pass, from
+ * their analog prototypes, so that any sample rate can be used.  At 48 kHz
+ * these are the coefficients in the standard.  ARM biquads want -a1, -a2.
+ */
+void AudioAnalyzeStats_F32::designK(void)  {
+    double fs = (double)sample_rate_Hz;
+    double f0 = 1681.974450955533;
+    double Q  = 0.7071752369554196;
+    double K  = tan(M_PI*f0/fs);
+    double Vh = pow(10.0, 3.999843853973347/20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K/Q + K*K;
+    kCoeffs[0] = (float32_t)((Vh + Vb*K/Q + K*K)/a0);
+    kCoeffs[1] = (float32_t)(2.0*(K*K - Vh)/a0);
+    kCoeffs[2] = (float32_t)((Vh - Vb*K/Q + K*K)/a0);
+    kCoeffs[3] = (float32_t)(-2.0*(K*K - 1.0)/a0);
+    kCoeffs[4] = (float32_t)(-(1.0 - K/Q + K*K)/a0);
+
+    f0 = 38.13547087602444;
+    Q  = 0.5003270373238773;
+    K  = tan(M_PI*f0/fs);
+    a0 = 1.0 + K/Q + K*K;
+    kCoeffs[5] =  1.0f;
+    kCoeffs[6] = -2.0f;
+    kCoeffs[7] =  1.0f;
+    kCoeffs[8] = (float32_t)(-2.0*(K*K - 1.0)/a0);
+    kCoeffs[9] = (float32_t)(-(1.0 - K/Q + K*K)/a0);
+    }
+
+void AudioAnalyzeStats_F32::update(void)  {
+    audio_block_f32_t *block;
+    float32_t kOut[AUDIO_BLOCK_SAMPLES];
+
+    for(int ch=0; ch<nCh; ch++)  {
+        block = AudioStream_F32::receiveReadOnly_f32(ch);
+        if(segs == NULL)  {        // Not started
+            if(block)  AudioStream_F32::release(block);
+            continue;
+            }
+        segment *pc = &cur[ch];
+        if(!block)  {              // Silence, but the min and max see it
+            if(pc->min > 0.0f)  pc->min = 0.0f;
+            if(pc->max < 0.0f)  pc->max = 0.0f;
+            continue;
+            }
+
+        // One pass, four at a time, for independent FPU operations
+        const float32_t *x = block->data;
+        uint16_t n = block->length;
+        if(n > AUDIO_BLOCK_SAMPLES)  n = AUDIO_BLOCK_SAMPLES;
+        float32_t s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        float32_t q0 = 0.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;
+        float32_t mn = x[0], mx = x[0];
+        uint16_t i = 0;
+        for(; i+4<=n; i+=4)  {
+            float32_t x0 = x[i],  x1 = x[i+1],  x2 = x[i+2],  x3 = x[i+3];
+            s0 += x0;  s1 += x1;  s2 += x2;  s3 += x3;
+            q0 += x0*x0;  q1 += x1*x1;  q2 += x2*x2;  q3 += x3*x3;
+            float32_t mn01 = x0<x1 ? x0 : x1;   float32_t mn23 = x2<x3 ? x2 : x3;
+            float32_t mx01 = x0>x1 ? x0 : x1;   float32_t mx23 = x2>x3 ? x2 : x3;
+            if(mn01 < mn)  mn = mn01;
+            if(mn23 < mn)  mn = mn23;
+            if(mx01 > mx)  mx = mx01;
+            if(mx23 > mx)  mx = mx23;
+            }
+        for(; i<n; i++)  {
+            s0 += x[i];
+            q0 += x[i]*x[i];
+            if(x[i] < mn)  mn = x[i];
+            if(x[i] > mx)  mx = x[i];
+            }
+        // K-weighting, and its power
+        float32_t kq;
+        arm_biquad_cascade_df1_f32(&kInst[ch], (float32_t *)x, kOut, n);
+        arm_dot_prod_f32(kOut, kOut, n, &kq);
+        AudioStream_F32::release(block);
+
+        if(blockCount == 0)  {
+            pc->min = mn;
+            pc->max = mx;
+            }
+        else  {
+            if(mn < pc->min)  pc->min = mn;
+            if(mx > pc->max)  pc->max = mx;
+            }
+        pc->sum += (s0 + s1) + (s2 + s3);
+        pc->sumSq += (q0 + q1) + (q2 + q3);
+        pc->kSumSq += kq;
+        }
+    if(segs == NULL)
+        return;
+
+    if(++blockCount < segBlocks)
+        return;
+    // The end of a segment, into the ring
+    blockCount = 0;
+    for(int ch=0; ch<nCh; ch++)  {
+        segs[segWrite*nCh + ch] = cur[ch];
+        cur[ch] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        }
+    if(++segWrite >= nSegs)  segWrite = 0;
+    if(segFull < nSegs)  segFull++;
+
+    // New results, with the count odd while they are written
+    seq++;
+    STATS_BARRIER();
+    windowStats(nShort, result[0], &loudness[0]);
+    windowStats(nLong,  result[1], &loudness[1]);
+    STATS_BARRIER();
+    seq++;
+    new_output = true;
+    }
+
+// Sums of the last nW segments, or as many as there are since reset()
+void AudioAnalyzeStats_F32::windowStats(uint16_t nW, stats *pRes, float32_t *pLoud)  {
+    if(nW > segFull)  nW = segFull;
+    float32_t nSamples = (float32_t)nW*(float32_t)segBlocks*(float32_t)block_size;
+    double zSum = 0.0;
+    for(int ch=0; ch<nCh; ch++)  {
+        double sum = 0.0, sumSq = 0.0, kSumSq = 0.0;
+        float32_t mn = 0.0f, mx = 0.0f;
+        int s = segWrite;
+        for(int j=0; j<nW; j++)  {
+            if(--s < 0)  s = nSegs - 1;
+            const segment *ps = &segs[s*nCh + ch];
+            sum += ps->sum;
+            sumSq += ps->sumSq;
+            kSumSq += ps->kSumSq;
+            if(j==0 || ps->min < mn)  mn = ps->min;
+            if(j==0 || ps->max > mx)  mx = ps->max;
+            }
+        stats *pr = &pRes[ch];
+        pr->min = mn;
+        pr->max = mx;
+        pr->peak = (-mn > mx) ? -mn : mx;
+        pr->dc = (float32_t)(sum/nSamples);
+        pr->rms = sqrtf((float32_t)(sumSq/nSamples));
+        pr->crest = pr->rms>0.0f ? pr->peak/pr->rms : 0.0f;
+        zSum += weight[ch]*kSumSq/nSamples;
+        }
+    float32_t lufs = -0.691f + 10.0f*log10f((float32_t)zSum);
+    *pLoud = (zSum>0.0 && lufs>STATS_LUFS_MIN) ? lufs : STATS_LUFS_MIN;
+    }
+
+// No __disable_irq(), try again if update() wrote new results meanwhile
+bool AudioAnalyzeStats_F32::readStats(uint16_t ch, bool longWindow, stats *pStats)  {
+    if(ch >= nCh)
+        return false;
+    uint32_t s;
+    do  {
+        s = seq;
+        STATS_BARRIER();
+        *pStats = result[longWindow][ch];
+        STATS_BARRIER();
+        } while((s & 1) || s != seq);
+    return true;
+    }
+
+float32_t AudioAnalyzeStats_F32::readLoudness(bool longWindow)  {
+    uint32_t s;
+    float32_t l;
+    do  {
+        s = seq;
+        STATS_BARRIER();
+        l = loudness[longWindow];
+        STATS_BARRIER();
+        } while((s & 1) || s != seq);
+    return l;
+    }
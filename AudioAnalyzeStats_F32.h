@@ -0,0 +1,178 @@
+/*
+ * AudioAnalyzeStats_F32.h
+ *
+ * Level statistics for up to 8 inputs in one object, in place of an
+ * AudioAnalyzePeak_F32 and an AudioAnalyzeRMS_F32 for each channel.  For
+ * each input there is the peak, minimum, maximum, RMS, DC and crest factor,
+ * over two sliding windows, short and long, by default 400 msec and 3 sec.
+ * Also the ITU-R BS.1770 K-weighted loudness, over all the inputs, for the
+ * same two windows.  With the defaults these are the EBU R128 Momentary
+ * and Short-term loudness.  Oct 2026
+ *
+ * The work is one pass over each block for the min, max, sum and sum of
+ * squares, four samples at a time with separate accumulators, plus the two
+ * biquads of the K-weighting filter and a dot product for its power.  The
+ * block results go into a segment of about 100 msec.  The windows are the
+ * sums of the last few segments, so a new result is ready every segment,
+ * about 10 per second.  Window lengths are rounded to whole segments and
+ * segments to whole blocks.  getWindow_ms() gives the actual length.
+ *
+ * The results can be read with no __disable_irq().  update() puts a count
+ * around writing them, and a read is repeated if the count changed.
+ *
+ * Loudness is -0.691 + 10*log10(sum over inputs of G*z), LUFS, where z is
+ * the mean square of the K-weighted input and G is the channel weight,
+ * 1.0 by default, and 1.41 for the surround channels of BS.1770.  A full
+ * scale 1 kHz sine wave in one channel reads -3.01 LUFS.  Gating, for the
+ * Integrated loudness, is not done.  Silence reads STATS_LUFS_MIN.
+ *
+ * Inputs that are not connected read as silence.  The K-weighting is
+ * designed for the sample rate, as in BS.1770 for 48 kHz.
+ *
+ * Functions:
+ *   AudioAnalyzeStats_F32(nInputs)  1 to 8, default 8.  The second
+ *         constructor takes AudioSettings_F32 and nInputs.
+ *   bool begin(short_ms, long_ms)  Defaults 400 and 3000 msec, long up
+ *         to STATS_MAX_MS.  Returns false if out of memory.  Needed
+ *         before any results.
+ *   setChannelWeight(ch, G)  For loudness.
+ *   bool available()  true for new results, every segment.
+ *   bool readStats(ch, longWindow, stats *pStats)  All of them, for one
+ *         input and window, from the same segment.
+ *   float32_t readPeak(ch, longWindow)  Largest |x|.
+ *   float32_t readRMS(ch, longWindow)   Including DC.
+ *   float32_t readDC(ch, longWindow)
+ *   float32_t readCrest(ch, longWindow)   peak/RMS, 1.414 for a sine wave.
+ *   float32_t readLoudness(longWindow)  LUFS.
+ *   float32_t getWindow_ms(longWindow)
+ *   reset()  Clears the windows.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioAnalyzeStats_F32_h_
+#define AudioAnalyzeStats_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+
+#define STATS_MAX_CHANNELS  8
+#define STATS_SEGMENT_MS  100.0f
+#define STATS_MAX_MS  10000.0f
+#define STATS_LUFS_MIN  -120.0f
+
+class AudioAnalyzeStats_F32 : public AudioStream_F32
+{
+//GUI: inputs:8, outputs:0  //this line used for automatic generation of GUI node
+//GUI: shortName:Stats
+public:
+    AudioAnalyzeStats_F32(uint16_t _nIn=STATS_MAX_CHANNELS) :
+                AudioStream_F32(nInputs(_nIn), inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        nCh = nInputs(_nIn);
+        }
+    AudioAnalyzeStats_F32(const AudioSettings_F32 &settings,
+                uint16_t _nIn=STATS_MAX_CHANNELS) :
+                AudioStream_F32(nInputs(_nIn), inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        nCh = nInputs(_nIn);
+        }
+    ~AudioAnalyzeStats_F32(void)  {
+        if(segs)  delete [] segs;
+        }
+
+    // The results for one input and window
+    struct stats {
+        float32_t peak;
+        float32_t min;
+        float32_t max;
+        float32_t rms;
+        float32_t dc;
+        float32_t crest;
+        };
+
+    bool begin(float32_t short_ms=400.0f, float32_t long_ms=3000.0f);
+    void setChannelWeight(uint16_t ch, float32_t G)  {
+        if(ch < STATS_MAX_CHANNELS)  weight[ch] = G;
+        }
+    void reset(void);
+
+    bool available(void)  {
+        __disable_irq();
+        bool flag = new_output;
+        new_output = false;
+        __enable_irq();
+        return flag;
+        }
+
+    bool readStats(uint16_t ch, bool longWindow, stats *pStats);
+    float32_t readPeak(uint16_t ch, bool longWindow=false)  {
+        stats s;
+        return readStats(ch, longWindow, &s) ? s.peak : 0.0f;
+        }
+    float32_t readRMS(uint16_t ch, bool longWindow=false)  {
+        stats s;
+        return readStats(ch, longWindow, &s) ? s.rms : 0.0f;
+        }
+    float32_t readDC(uint16_t ch, bool longWindow=false)  {
+        stats s;
+        return readStats(ch, longWindow, &s) ? s.dc : 0.0f;
+        }
+    float32_t readCrest(uint16_t ch, bool longWindow=false)  {
+        stats s;
+        return readStats(ch, longWindow, &s) ? s.crest : 0.0f;
+        }
+    float32_t readLoudness(bool longWindow=false);
+    float32_t getWindow_ms(bool longWindow=false)  {
+        return (longWindow ? nLong : nShort)*segBlocks*block_size*1000.0f/sample_rate_Hz;
+        }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[STATS_MAX_CHANNELS];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    uint16_t nCh = STATS_MAX_CHANNELS;
+    float32_t weight[STATS_MAX_CHANNELS] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+
+    // A segment, for each input, of segBlocks blocks
+    struct segment {
+        float32_t sum;
+        float32_t sumSq;
+        float32_t kSumSq;     // K-weighted
+        float32_t min;
+        float32_t max;
+        };
+    segment *segs = NULL;     // nSegs of nCh, from new
+    segment cur[STATS_MAX_CHANNELS];
+    uint16_t nSegs = 0;       // In the ring, nLong
+    uint16_t segWrite = 0;
+    uint16_t segFull = 0;     // Segments filled since reset()
+    uint16_t segBlocks = 1;
+    uint16_t blockCount = 0;
+    uint16_t nShort = 0;
+    uint16_t nLong = 0;
+
+    // K-weighting, the shelf then the high pass, for each input
+    float32_t kCoeffs[10];
+    float32_t kState[STATS_MAX_CHANNELS][8];
+    arm_biquad_casd_df1_inst_f32 kInst[STATS_MAX_CHANNELS];
+
+    // Results, [0] short and [1] long, with the count around writing them
+    stats result[2][STATS_MAX_CHANNELS];
+    float32_t loudness[2] = {STATS_LUFS_MIN, STATS_LUFS_MIN};
+    volatile uint32_t seq = 0;
+    volatile bool new_output = false;
+
+    static uint16_t nInputs(uint16_t n)  {
+        return (n<1 || n>STATS_MAX_CHANNELS) ? STATS_MAX_CHANNELS : n;
+        }
+    void designK(void);
+    void clearWindows(void);
+    void windowStats(uint16_t nW, stats *pRes, float32_t *pLoud);
+};
+#endif
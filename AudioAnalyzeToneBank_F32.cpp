@@ -0,0 +1,316 @@
+/*
+ * AudioAnalyzeToneBank_F32.cpp
+ *
+ * See AudioAnalyzeToneBank_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioAnalyzeToneBank_F32.h"
+
+// Decimation pass band, as a fraction of fs/ratio, and stop band
+#define TONEBANK_PASS  0.4f
+#define TONEBANK_DB   80.0f
+
+uint16_t AudioAnalyzeToneBank_F32::begin(uint16_t _ratio)  {
+    FIRDesign_F32::stage newStages[MULTIRATE_MAX_STAGES];
+    FIRDesign_F32::stage oldStages[MULTIRATE_MAX_STAGES];
+    uint16_t nNew = 0;
+    uint16_t nOld;
+    float32_t *newBuffer = NULL;
+    float32_t *oldBuffer;
+
+    if(_ratio<1 || _ratio>DECIMATE_MAX_RATIO)
+        return TONEBANK_ERR_RATIO;
+    if(_ratio > 1)  {
+        nNew = FIRDesign_F32::multirateStages(_ratio, TONEBANK_PASS/(float32_t)_ratio,
+                        TONEBANK_DB, newStages, MULTIRATE_MAX_STAGES);
+        if(nNew == 0)
+            return TONEBANK_ERR_RATIO;
+        uint32_t size = 0;
+        uint16_t nIn = block_size;
+        for(int s=0; s<nNew; s++)  {
+            size += newStages[s].nTaps - 1 + nIn;
+            nIn = nIn/newStages[s].factor + 1;
+            }
+        newBuffer = new float32_t[size];
+        if(newBuffer == NULL)  {
+            FIRDesign_F32::freeStages(newStages, nNew);
+            return TONEBANK_ERR_MEMORY;
+            }
+        for(uint32_t i=0; i<size; i++)
+            newBuffer[i] = 0.0f;
+        }
+
+    __disable_irq();
+    nOld = nStages;
+    oldBuffer = buffer;
+    for(int s=0; s<MULTIRATE_MAX_STAGES; s++)  {
+        oldStages[s] = stages[s];
+        stages[s] = newStages[s];
+        }
+    nStages = nNew;
+    buffer = newBuffer;
+    ratio = _ratio;
+    float32_t *p = buffer;
+    uint16_t nIn = block_size;
+    for(int s=0; s<nStages; s++)  {
+        pBuf[s] = p;
+        p += stages[s].nTaps - 1 + nIn;
+        nIn = nIn/stages[s].factor + 1;
+        phase[s] = 0;
+        }
+    nTones = 0;
+    newMask = 0;
+    __enable_irq();
+
+    FIRDesign_F32::freeStages(oldStages, nOld);
+    if(oldBuffer)  delete [] oldBuffer;
+    return 0;
+    }
+
+int AudioAnalyzeToneBank_F32::addTone(float32_t freq_Hz, float32_t tMeas_ms,
+                                      float32_t level)  {
+    uint16_t i = nTones;
+    if(i >= TONEBANK_MAX_TONES)
+        return -1;
+    thresh[i] = level;
+    if(!toneParams(i, freq_Hz, tMeas_ms))
+        return -1;
+    nTones = i + 1;
+    return i;
+    }
+
+bool AudioAnalyzeToneBank_F32::setTone(uint16_t i, float32_t freq_Hz, float32_t tMeas_ms)  {
+    if(i >= nTones)
+        return false;
+    return toneParams(i, freq_Hz, tMeas_ms);
+    }
+
+// Sets up tone i, and starts its measurement over
+bool AudioAnalyzeToneBank_F32::toneParams(uint16_t i, float32_t freq_Hz,
+                                          float32_t tMeas_ms)  {
+    float32_t fs = rate();
+    float32_t fMax = (ratio > 1) ? TONEBANK_PASS*fs : 0.5f*fs;
+    float32_t len = 0.001f*tMeas_ms*fs + 0.5f;
+    if(freq_Hz<=0.0f || freq_Hz>=fMax || len<4.0f || len>65535.0f)
+        return false;
+    uint16_t L = (uint16_t)len;
+    if(sliding && L>ringSize && !sizeRing(L))
+        return false;
+
+    double step = (double)freq_Hz/(double)fs;
+    double w = 2.0*M_PI*step;
+    float32_t c = (float32_t)(2.0*cos(w));
+    float32_t cLr = (float32_t)cos(w*(double)L);
+    float32_t cLi = (float32_t)sin(w*(double)L);
+    float32_t str = (float32_t)cos(w);
+    float32_t sti = -(float32_t)sin(w);
+    __disable_irq();
+    freq[i] = freq_Hz;
+    length[i] = L;
+    count[i] = L;
+    power[i] = 0.0f;
+    coef[i] = c;
+    s1[i] = 0.0f;
+    s2[i] = 0.0f;
+    aRe[i] = 0.0f;   aIm[i] = 0.0f;
+    bRe[i] = 0.0f;   bIm[i] = 0.0f;
+    cLRe[i] = cLr;   cLIm[i] = cLi;
+    stRe[i] = str;   stIm[i] = sti;
+    ncoPhase[i] = 0.0;
+    ncoStep[i] = step;
+    if(ringSize)
+        ringRead[i] = (uint16_t)(((uint32_t)ringWrite + ringSize - L) % ringSize);
+    readyMask &= ~(1ULL << i);
+    newMask &= ~(1ULL << i);
+    __enable_irq();
+    return true;
+    }
+
+// A new input buffer of at least L, and all the sliding sums restarted
+bool AudioAnalyzeToneBank_F32::sizeRing(uint16_t L)  {
+    float32_t *newRing = new float32_t[L];
+    if(newRing == NULL)
+        return false;
+    for(uint16_t j=0; j<L; j++)
+        newRing[j] = 0.0f;
+    __disable_irq();
+    float32_t *oldRing = ring;
+    ring = newRing;
+    ringSize = L;
+    ringWrite = 0;
+    for(uint16_t i=0; i<nTones; i++)  {
+        ringRead[i] = (uint16_t)(ringSize - length[i]);
+        count[i] = length[i];
+        aRe[i] = 0.0f;   aIm[i] = 0.0f;
+        bRe[i] = 0.0f;   bIm[i] = 0.0f;
+        }
+    readyMask = 0;
+    __enable_irq();
+    if(oldRing)  delete [] oldRing;
+    return true;
+    }
+
+bool AudioAnalyzeToneBank_F32::setSliding(bool _sliding)  {
+    if(_sliding && !sliding)  {
+        // A new, empty, buffer and the sums restarted
+        uint16_t lMax = 4;
+        for(uint16_t i=0; i<nTones; i++)
+            if(length[i] > lMax)  lMax = length[i];
+        if(!sizeRing(lMax))
+            return false;
+        }
+    __disable_irq();
+    sliding = _sliding;
+    for(uint16_t i=0; i<nTones; i++)  {
+        count[i] = length[i];
+        s1[i] = 0.0f;
+        s2[i] = 0.0f;
+        }
+    newMask = 0;
+    __enable_irq();
+    return true;
+    }
+
+float AudioAnalyzeToneBank_F32::read(uint16_t i)  {
+    if(i >= nTones)
+        return 0.0f;
+    __disable_irq();
+    float32_t p = power[i];
+    uint16_t len = length[i];
+    __enable_irq();
+    return 2.0f*gain*sqrtf(p)/(float32_t)len;   // Scaled to gain*(0.0, 1.0)
+    }
+
+// Goertzel, nT tones over x[0] to x[n-1], four at a time.  Each sample is
+// loaded once for four tones, and their recurrences are independent.  Any
+// last one to three tones are run one at a time.
+void AudioAnalyzeToneBank_F32::goertzel(const float32_t *x, uint16_t n,
+              const float32_t *pCoef, float32_t *pS1, float32_t *pS2, uint16_t nT)  {
+    uint16_t t = 0;
+    for(; t+4<=nT; t+=4)  {
+        float32_t c0 = pCoef[t],   c1 = pCoef[t+1];
+        float32_t c2 = pCoef[t+2], c3 = pCoef[t+3];
+        float32_t a0 = pS1[t],   a1 = pS1[t+1],   a2 = pS1[t+2],   a3 = pS1[t+3];
+        float32_t b0 = pS2[t],   b1 = pS2[t+1],   b2 = pS2[t+2],   b3 = pS2[t+3];
+        for(uint16_t j=0; j<n; j++)  {
+            float32_t xj = x[j];
+            float32_t q0 = xj + c0*a0 - b0;
+            float32_t q1 = xj + c1*a1 - b1;
+            float32_t q2 = xj + c2*a2 - b2;
+            float32_t q3 = xj + c3*a3 - b3;
+            b0 = a0;  a0 = q0;
+            b1 = a1;  a1 = q1;
+            b2 = a2;  a2 = q2;
+            b3 = a3;  a3 = q3;
+            }
+        pS1[t] = a0;    pS1[t+1] = a1;  pS1[t+2] = a2;  pS1[t+3] = a3;
+        pS2[t] = b0;    pS2[t+1] = b1;  pS2[t+2] = b2;  pS2[t+3] = b3;
+        }
+    for(; t<nT; t++)  {
+        float32_t c = pCoef[t], a = pS1[t], b = pS2[t];
+        for(uint16_t j=0; j<n; j++)  {
+            float32_t q = x[j] + c*a - b;
+            b = a;  a = q;
+            }
+        pS1[t] = a;  pS2[t] = b;
+        }
+    }
+
+// Goertzel, four tones at a time.  Each run is up to where one of the four
+// finishes a measurement.
+void AudioAnalyzeToneBank_F32::runGoertzel(const float32_t *x, uint16_t n)  {
+    for(uint16_t g=0; g<nTones; g+=4)  {
+        uint16_t nt = (nTones - g < 4) ? nTones - g : 4;
+        uint16_t i = 0;
+        while(i < n)  {
+            uint16_t m = n - i;
+            for(uint16_t t=0; t<nt; t++)
+                if(count[g+t] < m)  m = count[g+t];
+            goertzel(x + i, m, &coef[g], &s1[g], &s2[g], nt);
+            i += m;
+            for(uint16_t t=g; t<g+nt; t++)  {
+                count[t] -= m;
+                if(count[t] == 0)  {     // Measurement done
+                    power[t] = s1[t]*s1[t] + s2[t]*s2[t] - s1[t]*s2[t]*coef[t];
+                    s1[t] = 0.0f;
+                    s2[t] = 0.0f;
+                    count[t] = length[t];
+                    newMask |= 1ULL << t;
+                    }
+                }
+            }
+        }
+    }
+
+// Sliding DFT.  With p = exp(-j*w*n), A += (x[n] - x[n-L]*exp(j*w*L))*p, the
+// sum of x*exp(-j*w*n) over the last L.  B += x[n]*p from the last
+// restart, so after L samples it is the same sum without the rounding of
+// the adds and subtracts, and replaces A.  p is from the double phase
+// each update, and goes by stRe, stIm each sample.
+void AudioAnalyzeToneBank_F32::runSliding(const float32_t *x, uint16_t n)  {
+    float32_t pRe[TONEBANK_MAX_TONES];
+    float32_t pIm[TONEBANK_MAX_TONES];
+
+    for(uint16_t t=0; t<nTones; t++)  {
+        float32_t ph = (float32_t)(2.0*M_PI*ncoPhase[t]);
+        pRe[t] = cosf(ph);
+        pIm[t] = -sinf(ph);
+        ncoPhase[t] += (double)n*ncoStep[t];
+        ncoPhase[t] -= floor(ncoPhase[t]);
+        }
+    for(uint16_t j=0; j<n; j++)  {
+        float32_t xn = x[j];
+        for(uint16_t t=0; t<nTones; t++)  {
+            float32_t xo = ring[ringRead[t]];
+            if(++ringRead[t] >= ringSize)  ringRead[t] = 0;
+            float32_t dr = xn - xo*cLRe[t];
+            float32_t di = -xo*cLIm[t];
+            float32_t pr = pRe[t], pi = pIm[t];
+            aRe[t] += dr*pr - di*pi;
+            aIm[t] += dr*pi + di*pr;
+            bRe[t] += xn*pr;
+            bIm[t] += xn*pi;
+            pRe[t] = pr*stRe[t] - pi*stIm[t];
+            pIm[t] = pr*stIm[t] + pi*stRe[t];
+            if(--count[t] == 0)  {
+                aRe[t] = bRe[t];   aIm[t] = bIm[t];
+                bRe[t] = 0.0f;     bIm[t] = 0.0f;
+                count[t] = length[t];
+                readyMask |= 1ULL << t;
+                }
+            }
+        ring[ringWrite] = xn;
+        if(++ringWrite >= ringSize)  ringWrite = 0;
+        }
+    for(uint16_t t=0; t<nTones; t++)
+        power[t] = aRe[t]*aRe[t] + aIm[t]*aIm[t];
+    newMask |= readyMask;
+    }
+
+void AudioAnalyzeToneBank_F32::update(void)  {
+    audio_block_f32_t *block;
+    float32_t work[AUDIO_BLOCK_SAMPLES];
+
+    block = AudioStream_F32::receiveReadOnly_f32();
+    if (!block)
+        return;
+    if(nTones == 0)  {
+        AudioStream_F32::release(block);
+        return;
+        }
+    uint16_t n = block->length;
+    if(n > AUDIO_BLOCK_SAMPLES)  n = AUDIO_BLOCK_SAMPLES;
+    const float32_t *x = block->data;
+    if(nStages)  {
+        n = AudioFilterDecimate_F32::runStages(stages, nStages, pBuf, phase,
+                                               block->data, n, work);
+        x = work;
+        }
+    if(sliding)
+        runSliding(x, n);
+    else
+        runGoertzel(x, n);
+    AudioStream_F32::release(block);
+    }
@@ -0,0 +1,191 @@
+/*
+ * AudioAnalyzeToneBank_F32.h
+ *
+ * Many tone detectors in one object, in place of an
+ * AudioAnalyzeToneDetect_F32 for each tone.  For DTMF, 8 tones, or a scan of
+ * all 50 CTCSS tones.  Each tone has its own frequency, measuring time and
+ * threshold.  Oct 2026
+ *
+ * Each tone is a Goertzel filter, as AudioAnalyzeToneDetect_F32, and read()
+ * is scaled the same, so that a sine wave of amplitude A reads A.  The state
+ * of all the tones is kept as arrays, coefficient, s1, s2 and so on, and the
+ * tones are run four at a time over the samples, so each sample is loaded
+ * once for four tones and the four recurrences are independent for the FPU
+ * pipeline.  A run of four stops only where one of them finishes its
+ * measurement, and the last one to three tones are run singly.
+ *
+ * Most of the saving is from begin(ratio), which decimates the input first,
+ * with the multirate stages of AudioFilterDecimate_F32.  The tones must be
+ * below 0.4*fs/ratio.  For CTCSS, 67 to 254 Hz, by 64 at 44.1 kHz is
+ * 689 Hz, and the 50 Goertzel filters then take about as much time as one
+ * AudioAnalyzeToneDetect_F32 at the full rate, plus the decimation, about
+ * 3 multiplies per input sample.
+ *
+ * Sliding - With setSliding(true) each tone is a sliding DFT over the last
+ * measuring time, brought up to date every sample, rather than a Goertzel
+ * that gives a result at the end of each measuring time.  Each update the
+ * values from the last sample are ready for read() and present().  This
+ * takes about 5 times the work of the Goertzel, and a buffer, from new, of
+ * the longest measuring time.  The sums are restarted each measuring time,
+ * so rounding errors do not build up.
+ *
+ * Functions:
+ *   begin(ratio)  1, the default, for no decimation.  Otherwise 2's times
+ *         3, 5 and 7 up to DECIMATE_MAX_RATIO.  Returns 0 or TONEBANK_ERR_.
+ *         Clears the tones, so call it before addTone().
+ *   int addTone(freq_Hz, tMeas_ms, threshold)  Returns the tone number, 0
+ *         up, or -1 if full or too high.  tMeas_ms default 100 ms, and
+ *         threshold default 0.1.
+ *   setTone(i, freq_Hz, tMeas_ms)  Changes tone i.
+ *   threshold(i, level)  For present(), in the units of read().
+ *   clearTones()
+ *   setSliding(bool)  All tones.  Returns false if out of memory.
+ *   setGain(gain)  For read(), as AudioAnalyzeToneDetect_F32.
+ *   bool available()  true if any tone has new output.
+ *   bool available(i)  For tone i.
+ *   float read(i)  The amplitude of tone i.
+ *   bool present(i)  read(i) at or above the threshold.
+ *   uint64_t presentMask()  Bit i for tone i.
+ *   getNumTones()
+ *   getLength(i)  Samples, at fs/ratio, of the measurement.
+ *   getFrequency(i)
+ *   static goertzel(x, n, pCoef, pS1, pS2, nT)  The four at a time Goertzel
+ *         of update(), for other tone detectors.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioAnalyzeToneBank_F32_h_
+#define AudioAnalyzeToneBank_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#include "FIRDesign_F32.h"
+#include "AudioFilterDecimate_F32.h"
+
+#define TONEBANK_MAX_TONES 64
+
+#define TONEBANK_ERR_RATIO   1
+#define TONEBANK_ERR_MEMORY  2
+
+class AudioAnalyzeToneBank_F32 : public AudioStream_F32
+{
+//GUI: inputs:1, outputs:0  //this line used for automatic generation of GUI node
+//GUI: shortName:ToneBank
+public:
+    AudioAnalyzeToneBank_F32(void) : AudioStream_F32(1, inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        }
+    AudioAnalyzeToneBank_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(1, inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        }
+    ~AudioAnalyzeToneBank_F32(void)  {
+        FIRDesign_F32::freeStages(stages, nStages);
+        if(buffer)  delete [] buffer;
+        if(ring)  delete [] ring;
+        }
+
+    uint16_t begin(uint16_t _ratio=1);
+    int addTone(float32_t freq_Hz, float32_t tMeas_ms=100.0f, float32_t level=0.1f);
+    bool setTone(uint16_t i, float32_t freq_Hz, float32_t tMeas_ms);
+    void threshold(uint16_t i, float32_t level)  {
+        if(i < TONEBANK_MAX_TONES)  thresh[i] = level;
+        }
+    void clearTones(void)  {
+        __disable_irq();
+        nTones = 0;
+        newMask = 0;
+        __enable_irq();
+        }
+    bool setSliding(bool _sliding);
+    void setGain(float32_t _gain)  { gain = _gain; }
+
+    bool available(void)  {
+        __disable_irq();
+        bool flag = (newMask != 0);
+        newMask = 0;
+        __enable_irq();
+        return flag;
+        }
+    bool available(uint16_t i)  {
+        uint64_t bit = 1ULL << i;
+        __disable_irq();
+        bool flag = (newMask & bit) != 0;
+        newMask &= ~bit;
+        __enable_irq();
+        return flag;
+        }
+
+    float read(uint16_t i);
+    bool present(uint16_t i)  {
+        return (i < nTones) && read(i) >= thresh[i];
+        }
+    uint64_t presentMask(void)  {
+        uint64_t mask = 0;
+        for(uint16_t i=0; i<nTones; i++)
+            if(present(i))  mask |= 1ULL << i;
+        return mask;
+        }
+    uint16_t getNumTones(void)       { return nTones; }
+    uint16_t getLength(uint16_t i)   { return i<nTones ? length[i] : 0; }
+    float32_t getFrequency(uint16_t i)  { return i<nTones ? freq[i] : 0.0f; }
+
+    virtual void update(void);
+
+    // nT Goertzel filters, coefficients pCoef[], state pS1[] and pS2[], run
+    // over x[0] to x[n-1].  Also used by analyze_CTCSS_F32.
+    static void goertzel(const float32_t *x, uint16_t n, const float32_t *pCoef,
+                         float32_t *pS1, float32_t *pS2, uint16_t nT);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[1];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    float32_t gain = 1.0f;
+    uint16_t ratio = 1;
+    bool sliding = false;
+
+    // Decimation, as AudioFilterDecimate_F32, one channel
+    FIRDesign_F32::stage stages[MULTIRATE_MAX_STAGES];
+    uint16_t nStages = 0;
+    float32_t *buffer = NULL;
+    float32_t *pBuf[MULTIRATE_MAX_STAGES];
+    uint16_t phase[MULTIRATE_MAX_STAGES];
+
+    // The tones, as arrays
+    uint16_t nTones = 0;
+    float32_t freq[TONEBANK_MAX_TONES];
+    float32_t thresh[TONEBANK_MAX_TONES];
+    uint16_t length[TONEBANK_MAX_TONES];
+    uint16_t count[TONEBANK_MAX_TONES];
+    float32_t power[TONEBANK_MAX_TONES];   // Of the last measurement
+    volatile uint64_t newMask = 0;
+    uint64_t readyMask = 0;     // Sliding, a full length has been seen
+    // Goertzel
+    float32_t coef[TONEBANK_MAX_TONES];
+    float32_t s1[TONEBANK_MAX_TONES];
+    float32_t s2[TONEBANK_MAX_TONES];
+    // Sliding, the sum A over the last length samples of x*exp(-j*w*n), and
+    // B of the samples since the last restart, which replaces A each length.
+    float32_t aRe[TONEBANK_MAX_TONES], aIm[TONEBANK_MAX_TONES];
+    float32_t bRe[TONEBANK_MAX_TONES], bIm[TONEBANK_MAX_TONES];
+    float32_t cLRe[TONEBANK_MAX_TONES], cLIm[TONEBANK_MAX_TONES];  // exp(j*w*length)
+    float32_t stRe[TONEBANK_MAX_TONES], stIm[TONEBANK_MAX_TONES];  // exp(-j*w)
+    double ncoPhase[TONEBANK_MAX_TONES];   // Cycles
+    double ncoStep[TONEBANK_MAX_TONES];
+    uint16_t ringRead[TONEBANK_MAX_TONES];
+    float32_t *ring = NULL;     // The input, for sliding
+    uint16_t ringSize = 0;
+    uint16_t ringWrite = 0;
+
+    float32_t rate(void)  { return sample_rate_Hz/(float32_t)ratio; }
+    bool toneParams(uint16_t i, float32_t freq_Hz, float32_t tMeas_ms);
+    bool sizeRing(uint16_t L);
+    void runGoertzel(const float32_t *x, uint16_t n);
+    void runSliding(const float32_t *x, uint16_t n);
+};
+#endif
@@ -8,6 +8,11 @@
  *     As of Feb 2017, CHAPRO license is listed as "Creative Commons?"
  *          
  * This processes a single stream fo audio data (ie, it is mono)       
+ *
+ * Oct 2026: Control output 0.  The envelope is also sent on any
+ * AudioControlConnection_F32 from this object, as setControlPoints(n)
+ * values per block, default 4.  If nothing is connected to the audio
+ * output, no block is allocated for it.  See AudioStream_F32.h.
  *          
  * MIT License.  use at your own risk.
 */
@@ -43,6 +48,15 @@ class AudioCalcEnvelope_F32 : public AudioStream_F32
 			setSampleRate_Hz(in_block->fs_Hz);
 		}
 
+		//with only control connections, no output block is needed
+		float32_t pts[AUDIO_F32_CONTROL_POINTS];
+		if (!AudioStream_F32::outputConnected()) {
+			smooth_env_points(in_block->data, in_block->length, pts, control_points);
+			AudioStream_F32::transmitControl(pts, control_points);
+			AudioStream_F32::release(in_block);
+			return;
+		}
+
 		//prepare an output data block
 		audio_block_f32_t *out_block = AudioStream_F32::allocate_f32();
 		if (!out_block) return;
@@ -50,6 +64,9 @@ class AudioCalcEnvelope_F32 : public AudioStream_F32
 		// /////////// put the actual processing here
 		smooth_env(in_block->data, out_block->data, in_block->length);
 		out_block->length = in_block->length; out_block->fs_Hz = in_block->fs_Hz;
+		for (int k = 0; k < control_points; k++)
+			pts[k] = out_block->data[((k + 1) * in_block->length) / control_points - 1];
+		AudioStream_F32::transmitControl(pts, control_points);
 		
 		//transmit the block and be done
 		AudioStream_F32::transmit(out_block);
@@ -79,6 +96,33 @@ class AudioCalcEnvelope_F32 : public AudioStream_F32
         //*ppk = xpk;                     // save xpk for next time
 		state_ppk = xpk;
 	}
+
+	//as smooth_env(), but only the envelope at the end of each of nPts
+	//equal parts of the block is kept, in pts[]
+	void smooth_env_points(float x[], const int n, float pts[], const int nPts) {
+        float  xab, xpk = state_ppk;
+        int k = 0;
+        for (int j = 0; j < nPts; j++) {
+          int kEnd = ((j + 1) * n) / nPts;
+          for ( ; k < kEnd; k++) {
+            xab = (x[k] >= 0.0f) ? x[k] : -x[k];
+            if (xab >= xpk) {
+                xpk = alfa * xpk + (1.f-alfa) * xab;
+            } else {
+                xpk = beta * xpk;
+            }
+          }
+          pts[j] = xpk;
+        }
+		state_ppk = xpk;
+	}
+
+	//number of values per block on the control output, 1 to AUDIO_F32_CONTROL_POINTS
+	void setControlPoints(int n) {
+		if (n < 1) n = 1;
+		if (n > AUDIO_F32_CONTROL_POINTS) n = AUDIO_F32_CONTROL_POINTS;
+		control_points = n;
+	}
 	
 	//convert time constants from seconds to unitless parameters, from CHAPRO, agc_prepare.c
 	void setAttackRelease_msec(const float atk_msec, const float rel_msec) {
@@ -113,6 +157,7 @@ class AudioCalcEnvelope_F32 : public AudioStream_F32
 	float32_t given_attack_msec, given_release_msec;
 	float32_t alfa, beta;  //time constants, but in terms of samples, not seconds
 	float32_t state_ppk = 1.0f;
+	int control_points = 4;
 };
 
 #endif
\ No newline at end of file
@@ -8,6 +8,13 @@
  *     As of Feb 2017, CHAPRO license is listed as "Creative Commons?"
  *          
  * This processes a single stream fo audio data (ie, it is mono)       
+ *
+ * Oct 2026: Control input 0 and control output 0.  With an
+ * AudioControlConnection_F32 from AudioCalcEnvelope_F32, the gain is found
+ * only at the few envelope values sent each block, not at every sample, and
+ * the audio output, if connected, is interpolated from those.  The gain is
+ * also sent on control output 0, so that AudioMathMultiply_F32 can apply
+ * it with no pool blocks at all.  See AudioStream_F32.h.
  *          
  * MIT License.  use at your own risk.
 */
@@ -28,13 +35,33 @@ class AudioCalcGainWDRC_F32 : public AudioStream_F32
   public:
     //constructors
     AudioCalcGainWDRC_F32(void) : AudioStream_F32(1, inputQueueArray_f32) { setDefaultValues(); };
-	AudioCalcGainWDRC_F32(const AudioSettings_F32 &settings) : AudioStream_F32(1, inputQueueArray_f32) { setDefaultValues(); };
+	AudioCalcGainWDRC_F32(const AudioSettings_F32 &settings) : AudioStream_F32(1, inputQueueArray_f32) {
+      sample_rate_Hz = settings.sample_rate_Hz;
+      block_size = settings.audio_block_samples;
+      setDefaultValues();
+    };
 	
     //here's the method that does all the work
     void update(void) {
       
+      //the envelope from a control connection, if there is one
+      float32_t env[AUDIO_F32_CONTROL_POINTS];
+      int n_ctl = AudioStream_F32::receiveControl(env);
+
       //get the input audio data block
       audio_block_f32_t *in_block = AudioStream_F32::receiveReadOnly_f32(); // must be the envelope!
+
+      //with only control connections out, the gain is only needed at a few points
+      if (n_ctl == 0 && in_block && !AudioStream_F32::outputConnected()) {
+        for (int k = 0; k < control_points; k++)
+          env[k] = in_block->data[((k + 1) * in_block->length) / control_points - 1];
+        n_ctl = control_points;
+      }
+      if (n_ctl > 0) {
+        if (in_block) AudioStream_F32::release(in_block);
+        updateFromControl(env, n_ctl);
+        return;
+      }
       if (!in_block) return;
   
       //prepare an output data block
@@ -44,6 +71,10 @@ class AudioCalcGainWDRC_F32 : public AudioStream_F32
       // ////////////////////// do the processing here!
       calcGainFromEnvelope(in_block->data, out_block->data, in_block->length);
       out_block->length = in_block->length; out_block->fs_Hz = in_block->fs_Hz;
+      float32_t gain[AUDIO_F32_CONTROL_POINTS];
+      for (int k = 0; k < control_points; k++)
+        gain[k] = out_block->data[((k + 1) * out_block->length) / control_points - 1];
+      AudioStream_F32::transmitControl(gain, control_points);
       
       //transmit the block and be done
       AudioStream_F32::transmit(out_block);
@@ -69,6 +100,21 @@ class AudioCalcGainWDRC_F32 : public AudioStream_F32
       AudioStream_F32::release(env_dB_block);
     }
 
+    //as calcGainFromEnvelope(), for up to AUDIO_F32_CONTROL_POINTS values, with no pool block
+    void calcGainFromEnvelopePoints(const float *env, float *gain_out, int n)  {
+      float env_dB[AUDIO_F32_CONTROL_POINTS];
+      if (n > AUDIO_F32_CONTROL_POINTS) n = AUDIO_F32_CONTROL_POINTS;
+      for (int k=0; k < n; k++) env_dB[k] = maxdB + db2(env[k]);
+      WDRC_circuit_gain(env_dB, gain_out, n, tkgn, tk, cr, bolt);
+    }
+
+    //number of values per block on the control output, from an audio input
+    void setControlPoints(int n) {
+      if (n < 1) n = 1;
+      if (n > AUDIO_F32_CONTROL_POINTS) n = AUDIO_F32_CONTROL_POINTS;
+      control_points = n;
+    }
+
     //original call to WDRC_circuit
     //void WDRC_circuit(float *x, float *y, float *pdb, int n, float tkgn, float tk, float cr, float bolt)
     //void WDRC_circuit(float *orig_signal, float *signal_out, float *env_dB, int n, float tkgn, float tk, float cr, float bolt)
@@ -193,6 +239,25 @@ class AudioCalcGainWDRC_F32 : public AudioStream_F32
     audio_block_f32_t *inputQueueArray_f32[1]; //memory pointer for the input to this module
     float maxdB, tkgn, tk, cr, bolt;
 	float last_gain = 1.0;  //what was the last gain value computed for the signal
+    float sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    int block_size = AUDIO_BLOCK_SAMPLES;
+    int control_points = 4;
+
+    //the gain at the control points, sent on, and ramped to an audio block if that is connected
+    void updateFromControl(const float32_t *env, int n) {
+      float32_t gain[AUDIO_F32_CONTROL_POINTS];
+      float32_t prev_gain = last_gain;
+      calcGainFromEnvelopePoints(env, gain, n);
+      AudioStream_F32::transmitControl(gain, n);
+      if (!AudioStream_F32::outputConnected()) return;
+
+      audio_block_f32_t *out_block = AudioStream_F32::allocate_f32();
+      if (!out_block) return;
+      AudioStream_F32::controlToBlock(prev_gain, gain, n, out_block->data, block_size);
+      out_block->length = block_size; out_block->fs_Hz = sample_rate_Hz;
+      AudioStream_F32::transmit(out_block);
+      AudioStream_F32::release(out_block);
+    }
 };
 
 #endif
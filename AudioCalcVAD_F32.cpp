@@ -0,0 +1,128 @@
+/*
+ * AudioCalcVAD_F32.cpp
+ *
+ * See AudioCalcVAD_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioCalcVAD_F32.h"
+
+static inline float32_t limit3(float32_t x)  {
+    return (x > 3.0f) ? 3.0f : ((x < -3.0f) ? -3.0f : x);
+    }
+
+void AudioCalcVAD_F32::update(void)  {
+    audio_block_f32_t *blockIn = AudioStream_F32::receiveReadOnly_f32();
+    if(!blockIn)
+        return;
+    audio_block_f32_t *blockOut = AudioStream_F32::allocate_f32();
+    if(!blockOut)  {
+        AudioStream_F32::release(blockIn);
+        return;
+        }
+
+    // Decimate, DC block, and sum the lag products and sign changes
+    float32_t r[VAD_LPC_ORDER + 1];
+    for(int k=0; k<=VAD_LPC_ORDER; k++)
+        r[k] = 0.0f;
+    uint32_t nOut = 0;
+    uint32_t nCross = 0;
+    float32_t invD = 1.0f/(float32_t)decimate;
+    for(int i=0; i<blockIn->length; i++)  {
+        decSum += blockIn->data[i];
+        if(++decCount < decimate)
+            continue;
+        float32_t x = decSum*invD;
+        decSum = 0.0f;
+        decCount = 0;
+        float32_t y = x - xDC + 0.995f*yDC;
+        xDC = x;
+        yDC = y;
+        if((y < 0.0f) != (hist[0] < 0.0f))
+            nCross++;
+        for(int k=VAD_LPC_ORDER; k>0; k--)
+            hist[k] = hist[k-1];
+        hist[0] = y;
+        for(int k=0; k<=VAD_LPC_ORDER; k++)
+            r[k] += y*hist[k];
+        nOut++;
+        }
+
+    if(nOut > 0)  {
+        float32_t a = first ? 0.0f : aAve;
+        float32_t b = (1.0f - a)/(float32_t)nOut;
+        for(int k=0; k<=VAD_LPC_ORDER; k++)
+            R[k] = a*R[k] + b*r[k];
+        zcrAve = a*zcrAve + b*(float32_t)nCross;
+
+        // The noise floor down at once, and up slowly
+        float32_t p = R[0];
+        float32_t n = noise;
+        if(first || p < n)
+            n = p;
+        else
+            n *= floorRise;
+        if(n < 1.0E-20f)  n = 1.0E-20f;
+        first = false;
+
+        float32_t ref = (n > minPower) ? n : minPower;
+        float32_t s = toDB(p/ref);
+        float32_t f = toDB(flatness());
+        float32_t z = zcrAve*sample_rate_Hz/(float32_t)decimate;
+        float32_t logit = limit3((s - snrThreshold)/3.0f)
+                        + wFlat*limit3((flatThreshold - f)/3.0f)
+                        + wZCR*limit3((zcrThreshold - z)/1000.0f);
+        float32_t pInst = 1.0f/(1.0f + expf(-logit));
+        float32_t p0 = prob;
+        float32_t p1 = p0 + ((pInst > p0) ? aAttack : aRelease)*(pInst - p0);
+
+        // The output ramps from the last probability to the new
+        float32_t step = (p1 - p0)/(float32_t)blockIn->length;
+        for(int i=0; i<blockIn->length; i++)
+            blockOut->data[i] = p0 + step*(float32_t)(i + 1);
+        power = p;
+        noise = n;
+        snr_dB = s;
+        flat_dB = f;
+        zcr = z;
+        prob = p1;
+        }
+    else  {
+        for(int i=0; i<blockIn->length; i++)
+            blockOut->data[i] = prob;
+        }
+
+    blockOut->length = blockIn->length;
+    blockOut->fs_Hz = blockIn->fs_Hz;
+    blockOut->id = blockIn->id;
+    AudioStream_F32::transmit(blockOut);
+    AudioStream_F32::release(blockOut);
+    AudioStream_F32::release(blockIn);
+    }
+
+// Prediction error power over signal power, from the Levinson recursion
+float32_t AudioCalcVAD_F32::flatness(void)  {
+    float32_t a[VAD_LPC_ORDER + 1];
+    float32_t t[VAD_LPC_ORDER + 1];
+    if(R[0] < 1.0E-20f)
+        return 1.0f;
+    // A little white noise, -40 dB, keeps the recursion stable for tones
+    float32_t e = 1.0001f*R[0];
+    a[0] = 1.0f;
+    for(int i=1; i<=VAD_LPC_ORDER; i++)  {
+        float32_t acc = R[i];
+        for(int j=1; j<i; j++)
+            acc += a[j]*R[i-j];
+        float32_t k = -acc/e;
+        for(int j=1; j<i; j++)
+            t[j] = a[j];
+        for(int j=1; j<i; j++)
+            a[j] = t[j] + k*t[i-j];
+        a[i] = k;
+        e *= (1.0f - k*k);
+        if(e <= 0.0f)
+            return 1.0E-4f;
+        }
+    return e/R[0];
+    }
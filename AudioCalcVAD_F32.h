@@ -0,0 +1,187 @@
+/*
+ * AudioCalcVAD_F32.h
+ *
+ * Voice activity detector, as a control signal.  The output is the
+ * probability of speech, 0.0 to 1.0, as an audio block, so that one VAD can
+ * drive AudioEffectNoiseGate_F32, AudioEffectCompressor_F32,
+ * AudioEffectCompressor2_F32 and AudioSpectralDenoise_F32 on their In 1,
+ * in place of each finding speech its own way.  Oct 2026
+ *
+ * Three measures, from one pass over each block:
+ *   Energy - The level over a noise floor.  The floor follows the level
+ *         down at once and rises slowly, setFloorRise(), 2 dB/sec default,
+ *         so it settles on the level of the pauses between words.
+ *   Spectral flatness - From the linear prediction gain.  For the all-pole
+ *         model, the geometric over the arithmetic mean of the spectrum is
+ *         the prediction error power over the signal power.  That is the
+ *         autocorrelation, lags 0 to VAD_LPC_ORDER, and a Levinson
+ *         recursion, with no FFT.  0 dB for white noise, and -10 to -25 dB
+ *         for voiced speech.
+ *   Zero crossings - Per second.  Voiced speech is under 2000 or so, and
+ *         wide band noise is many more.
+ * The autocorrelation and crossings are averaged over about 20 msec, with
+ * the previous block carried, so that each block gives a new measure.
+ * Each measure is scored, limited to +/-3 so no one of them rules, and
+ *     logit = (snr_dB - snrThreshold)/3 + wF*(flatThreshold - flat_dB)/3
+ *             + wZ*(zcrThreshold - zcr)/1000
+ * is turned to a probability, 1/(1 + exp(-logit)).  That is smoothed with
+ * a fast attack and a slower release, the hangover, that holds the
+ * probability over short gaps in speech.
+ *
+ * setDecimation(D) averages D samples to one first, so that the work is 1/D.
+ * The voice band, to 4 kHz, is all that matters, so at 44.1 kHz D = 4 is
+ * a good choice.  The zero crossings are counted at the low rate.
+ *
+ * The output block ramps from the last probability to the new one, so
+ * that a gain taken from it has no steps.  The work is about 10 multiply
+ * and adds per sample, less by D, plus the recursion once per block.
+ *
+ * Functions:
+ *   setDecimation(D)  1 to VAD_MAX_DECIMATE, default 1.
+ *   setThresholds(snr_dB, flat_dB, zcr)  Defaults 6 dB, -6 dB and 3000
+ *         per second.
+ *   setWeights(wFlat, wZCR)  Defaults 1.0 and 0.5.  0 leaves a measure out.
+ *   setAttackRelease_ms(attack, release)  Defaults 10 and 300 msec.
+ *   setFloorRise(dB_per_sec)
+ *   setMinLevel_dBFS(dB)  Below this, no speech, default -70 dBFS.
+ *   float32_t readProbability()  0.0 to 1.0, the last of the output.
+ *   bool isSpeech()  Probability over 0.5.
+ *   float32_t readLevel_dBFS()  A full scale sine wave is 0 dBFS.
+ *   float32_t readNoise_dBFS()  The noise floor.
+ *   float32_t readSNR_dB()
+ *   float32_t readFlatness_dB()
+ *   float32_t readZCR()  Crossings per second.
+ *   reset()
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioCalcVAD_F32_h_
+#define AudioCalcVAD_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+
+#define VAD_LPC_ORDER  8
+#define VAD_MAX_DECIMATE  8
+
+class AudioCalcVAD_F32 : public AudioStream_F32
+{
+//GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
+//GUI: shortName:VAD
+public:
+    AudioCalcVAD_F32(void) : AudioStream_F32(1, inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        setDecimation(1);
+        setAttackRelease_ms(10.0f, 300.0f);
+        setFloorRise(2.0f);
+        reset();
+        }
+    AudioCalcVAD_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(1, inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        setDecimation(1);
+        setAttackRelease_ms(10.0f, 300.0f);
+        setFloorRise(2.0f);
+        reset();
+        }
+
+    void setDecimation(uint16_t D)  {
+        if(D < 1)  D = 1;
+        if(D > VAD_MAX_DECIMATE)  D = VAD_MAX_DECIMATE;
+        __disable_irq();
+        decimate = D;
+        decSum = 0.0f;
+        decCount = 0;
+        // About 20 msec of averaging, at one update per block
+        aAve = expf(-(float32_t)block_size/(0.020f*sample_rate_Hz));
+        __enable_irq();
+        }
+    void setThresholds(float32_t snr_dB, float32_t flat_dB, float32_t zcr)  {
+        snrThreshold = snr_dB;
+        flatThreshold = flat_dB;
+        zcrThreshold = zcr;
+        }
+    void setWeights(float32_t _wFlat, float32_t _wZCR)  {
+        wFlat = _wFlat;
+        wZCR = _wZCR;
+        }
+    void setAttackRelease_ms(float32_t attack_ms, float32_t release_ms)  {
+        float32_t tBlock = 1000.0f*(float32_t)block_size/sample_rate_Hz;
+        aAttack = 1.0f - expf(-tBlock/(attack_ms < 0.1f ? 0.1f : attack_ms));
+        aRelease = 1.0f - expf(-tBlock/(release_ms < 0.1f ? 0.1f : release_ms));
+        }
+    void setFloorRise(float32_t dB_per_sec)  {
+        floorRise = powf(10.0f, 0.1f*dB_per_sec*(float32_t)block_size/sample_rate_Hz);
+        }
+    void setMinLevel_dBFS(float32_t dB)  {
+        minPower = 0.5f*powf(10.0f, 0.1f*dB);
+        }
+
+    float32_t readProbability(void)  { return prob; }
+    bool isSpeech(void)              { return prob > 0.5f; }
+    float32_t readLevel_dBFS(void)   { return toDB(2.0f*power); }
+    float32_t readNoise_dBFS(void)   { return toDB(2.0f*noise); }
+    float32_t readSNR_dB(void)       { return snr_dB; }
+    float32_t readFlatness_dB(void)  { return flat_dB; }
+    float32_t readZCR(void)          { return zcr; }
+    void reset(void)  {
+        __disable_irq();
+        for(int k=0; k<=VAD_LPC_ORDER; k++)  {
+            R[k] = 0.0f;
+            hist[k] = 0.0f;
+            }
+        zcrAve = 0.0f;
+        xDC = 0.0f;
+        yDC = 0.0f;
+        noise = 0.0f;
+        power = 0.0f;
+        prob = 0.0f;
+        first = true;
+        __enable_irq();
+        }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[1];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+
+    uint16_t decimate = 1;
+    float32_t decSum = 0.0f;
+    uint16_t decCount = 0;
+    float32_t xDC = 0.0f;       // DC block state
+    float32_t yDC = 0.0f;
+    float32_t hist[VAD_LPC_ORDER + 1];   // The last samples, newest at [0]
+
+    float32_t aAve = 0.9f;      // Averaging, per block
+    float32_t R[VAD_LPC_ORDER + 1];      // Averaged autocorrelation
+    float32_t zcrAve = 0.0f;    // Crossings per sample, averaged
+    float32_t snrThreshold = 6.0f;
+    float32_t flatThreshold = -6.0f;
+    float32_t zcrThreshold = 3000.0f;
+    float32_t wFlat = 1.0f;
+    float32_t wZCR = 0.5f;
+    float32_t aAttack = 0.25f;
+    float32_t aRelease = 0.01f;
+    float32_t floorRise = 1.0f;
+    float32_t minPower = 0.5E-7f;   // -70 dBFS
+    bool first = true;
+
+    volatile float32_t power = 0.0f;
+    volatile float32_t noise = 0.0f;
+    volatile float32_t snr_dB = 0.0f;
+    volatile float32_t flat_dB = 0.0f;
+    volatile float32_t zcr = 0.0f;
+    volatile float32_t prob = 0.0f;
+
+    static float32_t toDB(float32_t p)  {
+        return (p > 1.0E-20f) ? 10.0f*log10f(p) : -200.0f;
+        }
+    float32_t flatness(void);
+};
+#endif
@@ -0,0 +1,60 @@
+/*
+ * AudioEffectAlignLatency_F32.cpp
+ *
+ * See AudioEffectAlignLatency_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include <Arduino.h>
+#include "AudioEffectAlignLatency_F32.h"
+
+// Set the delays so that every path from source arrives at the outputs
+// with the same latency.  If an input has more than one path from source,
+// the longest is used, since only one delay can be applied.  If a delay
+// is more than ALIGN_MAX_DELAY it is clamped, and -2 is returned.
+int32_t AudioEffectAlignLatency_F32::align(AudioStream_F32 &source) {
+    int32_t lIn[ALIGN_CHANNELS];
+    int32_t lMax = -1;
+    uint16_t ch;
+    bool clamped = false;
+
+    for(ch=0; ch<ALIGN_CHANNELS; ch++)  {
+        lIn[ch] = AudioStream_F32::getPathLatencySamples(source, *this, ch);
+        if(lIn[ch] > lMax)
+            lMax = lIn[ch];
+        }
+    if(lMax < 0)
+        return -1;     // Nothing connected to source
+    for(ch=0; ch<ALIGN_CHANNELS; ch++)  {
+        if(lIn[ch] >= 0 && !setDelaySamples(ch, (uint32_t)(lMax - lIn[ch])))
+            clamped = true;
+        }
+    return clamped ? -2 : lMax;
+    }
+
+void AudioEffectAlignLatency_F32::update(void) {
+    audio_block_f32_t *block;
+    uint16_t ch, i, d, k;
+    float32_t x;
+
+    for(ch=0; ch<ALIGN_CHANNELS; ch++)  {
+        // The delay line is run even for zero delay, so that it holds
+        // current data when the delay is changed.
+        d = delaySamples[ch];
+        block = receiveWritable_f32(ch);
+        if(!block) continue;
+        k = inIndex[ch];
+        for(i=0; i<block_size; i++)  {
+            x = block->data[i];
+            delayData[ch][k] = x;
+            block->data[i] = delayData[ch][(k - d) & (ALIGN_BUFFER_SIZE - 1)];
+            k = (k + 1) & (ALIGN_BUFFER_SIZE - 1);
+            }
+        inIndex[ch] = k;
+        if(block->sampleIndex != AUDIO_F32_NO_SAMPLE_INDEX)
+            block->sampleIndex = (block->sampleIndex >= d) ? block->sampleIndex - d : 0;
+        AudioStream_F32::transmit(block, ch);
+        AudioStream_F32::release(block);
+        }
+    }
@@ -0,0 +1,116 @@
+/*
+ * AudioEffectAlignLatency_F32.h
+ *
+ * Delay equalizer for parallel paths in an F32 audio graph.  Up to four
+ * channels each have a delay of 0 to ALIGN_MAX_DELAY samples.  The delays can
+ * be set directly, or align() can find them.  align(source) uses
+ * AudioStream_F32::getPathLatencySamples() to find the latency from the
+ * output of source to each input of this object.  Each channel is then
+ * delayed so that all paths have the latency of the longest.  Inputs that
+ * are not connected to source are not changed.
+ *
+ * An example is a hearing aid with a linear phase FIR on one path, a
+ * compressor with lookahead on another and the paths summed in a mixer.
+ * Put this object in front of the mixer and call align(i2sIn) in setup().
+ * Then getPathLatencySamples(i2sIn, mixer) gives the total, to check against
+ * the budget.  Call align() again after changing anything that changes a
+ * latency, such as a new FIR length.
+ *
+ * AudioFilter90Deg_F32 does not need this, as the q path already has a delay
+ * equal to the group delay of the Hilbert FIR.
+ *
+ * Outputs blocks have sampleIndex moved back by the delay, so that it
+ * still refers to the first sample of the block.
+ *
+ * The largest delay is ALIGN_MAX_DELAY, 1023 samples, which covers
+ * AudioFilterConvolution_F32 (768 samples) and the FFT overlap classes.
+ * A long FIR, as from AudioFilterFIRGeneral_F32, can need more.  Then
+ * setDelaySamples() and align() report that the delay was clamped, and the
+ * buffer can be made larger by defining ALIGN_BUFFER_SIZE, a power of 2,
+ * before including this file.
+ *
+ * Functions:
+ *   setDelaySamples(ch, n)    Channel 0 to 3, n=0 to ALIGN_MAX_DELAY.
+ *                             Returns false if n was clamped or ch is bad.
+ *   getDelaySamples(ch)
+ *   align(source)             Returns the aligned latency, -1 if no path, or
+ *                             -2 if a delay was clamped to ALIGN_MAX_DELAY
+ *   getLatencySamples()       Delay of channel 0, as for any AudioStream_F32
+ *   getInputLatencySamples(ch)
+ *
+ * Data memory is 4*ALIGN_BUFFER_SIZE floats, 16 kB as supplied.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioEffectAlignLatency_F32_h_
+#define AudioEffectAlignLatency_F32_h_
+
+#include "Arduino.h"
+#include "AudioSettings_F32.h"
+#include "AudioStream_F32.h"
+
+#define ALIGN_CHANNELS    4
+#ifndef ALIGN_BUFFER_SIZE
+#define ALIGN_BUFFER_SIZE 1024     // Power of 2, up to 32768
+#endif
+#define ALIGN_MAX_DELAY   (ALIGN_BUFFER_SIZE - 1)
+
+class AudioEffectAlignLatency_F32 : public AudioStream_F32
+{
+//GUI: inputs:4, outputs:4  //this line used for automatic generation of GUI nodes
+//GUI: shortName:alignLatency
+public:
+    AudioEffectAlignLatency_F32(void) : AudioStream_F32(ALIGN_CHANNELS, inputQueueArray_f32) {
+        block_size = AUDIO_BLOCK_SAMPLES;
+        clearDelays();
+        }
+
+    AudioEffectAlignLatency_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(ALIGN_CHANNELS, inputQueueArray_f32) {
+        block_size = settings.audio_block_samples;
+        clearDelays();
+        }
+
+    bool setDelaySamples(uint16_t ch, uint32_t n) {
+        bool ok = true;
+        if(ch >= ALIGN_CHANNELS) return false;
+        if(n > ALIGN_MAX_DELAY)  {
+            n = ALIGN_MAX_DELAY;
+            ok = false;
+            }
+        delaySamples[ch] = (uint16_t)n;
+        return ok;
+        }
+
+    uint32_t getDelaySamples(uint16_t ch) {
+        if(ch >= ALIGN_CHANNELS) return 0;
+        return delaySamples[ch];
+        }
+
+    int32_t align(AudioStream_F32 &source);
+
+    uint32_t getLatencySamples(void) { return delaySamples[0]; }
+    uint32_t getInputLatencySamples(unsigned int inputIndex) {
+        return getDelaySamples((uint16_t)inputIndex);
+        }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[ALIGN_CHANNELS];
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    float32_t delayData[ALIGN_CHANNELS][ALIGN_BUFFER_SIZE];
+    uint16_t delaySamples[ALIGN_CHANNELS];
+    uint16_t inIndex[ALIGN_CHANNELS];
+
+    void clearDelays(void) {
+        for(int ch=0; ch<ALIGN_CHANNELS; ch++)  {
+            delaySamples[ch] = 0;
+            inIndex[ch] = 0;
+            for(int i=0; i<ALIGN_BUFFER_SIZE; i++)
+                delayData[ch][i] = 0.0f;
+            }
+        }
+};
+#endif
@@ -5,6 +5,12 @@
  * Derived From: WDRC_circuit from CHAPRO from BTNRC: https://github.com/BTNRH/chapro
  *     As of Feb 2017, CHAPRO license is listed as "Creative Commons?"
  *
+ * Oct 2026: setControlPoints(n), 1 to AUDIO_F32_CONTROL_POINTS, finds the
+ * envelope and gain at only n points in each block and ramps the gain
+ * between them, as for a control-rate connection, see AudioStream_F32.h.
+ * That is n log and exp per block, not one per sample, and no pool blocks
+ * for the envelope and gain.  0, the default, is every sample.
+ *
  * MIT License.  Use at your own risk.
  *
  */
@@ -72,6 +78,17 @@ class AudioEffectCompWDRC_F32 : public AudioStream_F32
      //y, output, audio waveform data after compression
      //n, input, number of samples in this audio block
     {
+        // with control points, the envelope and gain at those only, and ramp the gain
+        if (control_points > 0) {
+          float env[AUDIO_F32_CONTROL_POINTS];
+          float gain[AUDIO_F32_CONTROL_POINTS];
+          float prev_gain = calcGain.getCurrentGain();
+          calcEnvelope.smooth_env_points(x, n, env, control_points);
+          calcGain.calcGainFromEnvelopePoints(env, gain, control_points);
+          AudioStream_F32::multiplyControl(x, y, n, prev_gain, gain, control_points);
+          return;
+        }
+
         // find smoothed envelope
         audio_block_f32_t *envelope_block = AudioStream_F32::allocate_f32();
         if (!envelope_block) return;
@@ -146,6 +163,11 @@ class AudioEffectCompWDRC_F32 : public AudioStream_F32
     void setKneeCompressor_dBFS(float _tk_dBFS) { calcGain.setKneeCompressor_dBFS(_tk_dBFS); }
     void setCompRatio(float _cr) { calcGain.setCompRatio(_cr); }
     void setMaxdB(float _maxdB) { calcGain.setMaxdB(_maxdB); };
+    void setControlPoints(int n) {  // gain at n points per block, 0 for every sample
+      if (n < 0) n = 0;
+      if (n > AUDIO_F32_CONTROL_POINTS) n = AUDIO_F32_CONTROL_POINTS;
+      control_points = n;
+    }
 
     float getCurrentLevel_dB(void) { return AudioCalcGainWDRC_F32::db2(calcEnvelope.getCurrentLevel()); }  //this is 20*log10(abs(signal)) after the envelope smoothing
 
@@ -158,6 +180,7 @@ class AudioEffectCompWDRC_F32 : public AudioStream_F32
 
   private:
     audio_block_f32_t *inputQueueArray[1];
+    int control_points = 0;
     float given_sample_rate_Hz;
 };
 
@@ -76,25 +76,33 @@ void AudioEffectCompressor2_F32::begin(void)  {
    float vOutDB = 0.0f;
    float targetGain;
 
-   // Receive the input audio data
+   // Receive the VAD, if connected, and the input audio data
+   audio_block_f32_t *vad_block = AudioStream_F32::receiveReadOnly_f32(1);
    audio_block_f32_t *block = AudioStream_F32::receiveWritable_f32();
-   if (!block) return;
+   if (!block)  {
+      if(vad_block)  release(vad_block);
+      return;
+      }
    // Allocate memory for the output
    audio_block_f32_t *out_block = AudioStream_F32::allocate_f32();
    if (!out_block)  {
       release(block);
+      if(vad_block)  release(vad_block);
       return;
       }
 
-   // Find the smoothed envelope, target gain and compressed output
+   // Find the smoothed envelope, target gain and compressed output.  The
+   // VAD block may be shorter, as from an island, so hold its last value.
+   int kVadLast = vad_block ? vad_block->length - 1 : 0;
    vPeak = vPeakSave;
    for (int k=0; k<block->length; k++) {
        vAbs = (block->data[k] >= 0.0f) ? block->data[k] : -block->data[k];
        if (vAbs >= vPeak) {     // Attack (rising level)
            vPeak = alpha * vPeak + (oneMinusAlpha) * vAbs;
-       } else {                 // Release (decay for falling level)
-           vPeak = beta * vPeak;
-           }
+       } else if(vad_block==NULL ||
+                 vad_block->data[k<kVadLast ? k : kVadLast]>=vadThreshold) {
+           vPeak = beta * vPeak;  // Release (decay for falling level)
+           }                      // else no speech, hold
        // Convert to dB
        // At all levels and quite frequency flat, this under estimates by about 1.05 dB
        vInDB = v2DB_Approx(vPeak) + 1.05f;
@@ -129,6 +137,7 @@ void AudioEffectCompressor2_F32::begin(void)  {
    sampleInputDB = vInDB;        // Last values for get...() functions
    sampleGainDB = vOutDB - vInDB;
    // transmit the block and release memory
+   if(vad_block)  AudioStream_F32::release(vad_block);
    AudioStream_F32::release(block);
    AudioStream_F32::transmit(out_block); // send the FIR output
    AudioStream_F32::release(out_block);
@@ -74,6 +74,11 @@
  *
  * Timing: For 44.1 kHz sample rate and 256 samples per update, the update( ) time
  * runs 240 to 270 icroseconds using Teensy 3.6.
+ *
+ * Oct 2026: Optional In 1, the speech probability from AudioCalcVAD_F32.  When
+ * connected, the envelope does not release while the VAD is below
+ * setVADThreshold(), default 0.5, so the gain holds through the pauses
+ * between words rather than rising with the noise.  Unconnected, as before.
  */
 
 #ifndef _AUDIO_EFFECT_COMPRESSOR2_F32_H
@@ -124,14 +129,14 @@ struct compressionCurve {
 
 class AudioEffectCompressor2_F32 : public AudioStream_F32
 {
-//GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
+//GUI: inputs:2, outputs:1  //this line used for automatic generation of GUI node
 //GUI: shortName: Compressor2
   public:
-    AudioEffectCompressor2_F32(void): AudioStream_F32(1, inputQueueArray) {
+    AudioEffectCompressor2_F32(void): AudioStream_F32(2, inputQueueArray) {
        setAttackReleaseSec(0.005f, 0.100f);
        }
 
-    AudioEffectCompressor2_F32(const AudioSettings_F32 &settings): AudioStream_F32(1, inputQueueArray) {
+    AudioEffectCompressor2_F32(const AudioSettings_F32 &settings): AudioStream_F32(2, inputQueueArray) {
        //setSampleRate_Hz(settings.sample_rate_Hz);
        setAttackReleaseSec(0.005f, 0.100f);
        }
@@ -145,7 +150,11 @@ class AudioEffectCompressor2_F32 : public AudioStream_F32
        delayBufferMask = _delaySize - 1;
        in_index = 0;
        }
+    // The lookahead delay line
+    uint32_t getLatencySamples(void) { return delayBufferMask + 1; }
     void printOn(bool _printIO) { printIO = _printIO; } // Diagnostics ONLY. Not for general INO
+    // With AudioCalcVAD_F32 on In 1, the speech probability below which the envelope holds
+    void setVADThreshold(float p) { vadThreshold = p; }
     float getCurrentInputDB(void) { return sampleInputDB; }
     float getCurrentGainDB(void)  { return sampleGainDB; }
     float getvInMaxDB(void)  {
@@ -164,7 +173,7 @@ class AudioEffectCompressor2_F32 : public AudioStream_F32
         }
 
   private:
-    audio_block_f32_t *inputQueueArray[1];
+    audio_block_f32_t *inputQueueArray[2];
     float delayData[256];   // The circular delay line for the signal
     uint16_t in_index = 0;      // Pointer to next block update entry
     // And a mask to make the circular buffer limit to a power of 2
@@ -220,6 +229,7 @@ class AudioEffectCompressor2_F32 : public AudioStream_F32
     float vPeakSave = 0.0f;
     float vInMaxDB = -1000.0f;    // Only for reporting
     bool printIO = false;      // Diagnostics Only
+    float vadThreshold = 0.5f;
     float sampleInputDB, sampleGainDB;
 };
 #endif
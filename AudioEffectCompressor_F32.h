@@ -7,6 +7,18 @@
 
    This processes a single stream fo audio data (ie, it is mono)
 
+   Oct 2026: Optional In 1, the speech probability from AudioCalcVAD_F32.
+   When connected, the gain does not release while the VAD is below
+   setVADThreshold(), default 0.5, so the pauses between words are not
+   brought up with the noise in them.  Unconnected, as before.
+
+   Oct 2026: setControlPoints(n), 1 to AUDIO_F32_CONTROL_POINTS, finds the
+   gain at only n points in each block, and ramps between them, as for a
+   control-rate connection, see AudioStream_F32.h.  The level is still
+   smoothed at every sample.  That is n log and exp per block, not one per
+   sample, and no pool blocks beyond the audio.  The attack and release are
+   the same, to within the ramp.  0, the default, is every sample.
+
    MIT License.  use at your own risk.
 */
 
@@ -18,14 +30,14 @@
 
 class AudioEffectCompressor_F32 : public AudioStream_F32
 {
-  //GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
+  //GUI: inputs:2, outputs:1  //this line used for automatic generation of GUI node
   public:
     //constructor
-    AudioEffectCompressor_F32(void) : AudioStream_F32(1, inputQueueArray_f32) {
+    AudioEffectCompressor_F32(void) : AudioStream_F32(2, inputQueueArray_f32) {
 	  setDefaultValues(AUDIO_SAMPLE_RATE);   resetStates();
     };
 	
-    AudioEffectCompressor_F32(const AudioSettings_F32 &settings) : AudioStream_F32(1, inputQueueArray_f32) {
+    AudioEffectCompressor_F32(const AudioSettings_F32 &settings) : AudioStream_F32(2, inputQueueArray_f32) {
 	  setDefaultValues(settings.sample_rate_Hz);   resetStates();
     };
 	
@@ -40,8 +52,13 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
     //here's the method that does all the work
     void update(void) {
       //Serial.println("AudioEffectGain_F32: updating.");  //for debugging.
+      vad_block = AudioStream_F32::receiveReadOnly_f32(1);  //the VAD, if connected
       audio_block_f32_t *audio_block = AudioStream_F32::receiveWritable_f32();
-      if (!audio_block) return;
+      if (!audio_block) {
+        if (vad_block) AudioStream_F32::release(vad_block);
+        vad_block = NULL;
+        return;
+      }
 
       //apply a high-pass filter to get rid of the DC offset
       if (use_HP_prefilter) arm_biquad_cascade_df1_f32(&hp_filt_struct, audio_block->data, audio_block->data, audio_block->length);
@@ -49,6 +66,16 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
       //apply the pre-gain...a negative gain value will disable
       if (pre_gain > 0.0f) arm_scale_f32(audio_block->data, pre_gain, audio_block->data, audio_block->length); //use ARM DSP for speed!
 
+      //the gain at a few points, ramped between them, if setControlPoints() has been used
+      if (control_points > 0) {
+        calcGainPoints(audio_block);
+        AudioStream_F32::transmit(audio_block);
+        AudioStream_F32::release(audio_block);
+        if (vad_block) AudioStream_F32::release(vad_block);
+        vad_block = NULL;
+        return;
+      }
+
       //calculate the level of the audio (ie, calculate a smoothed version of the signal power)
       audio_block_f32_t *audio_level_dB_block = AudioStream_F32::allocate_f32();
       calcAudioLevel_dB(audio_block, audio_level_dB_block); //returns through audio_level_dB_block
@@ -65,6 +92,8 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
       AudioStream_F32::release(audio_block);
       AudioStream_F32::release(gain_block);
       AudioStream_F32::release(audio_level_dB_block);
+      if (vad_block) AudioStream_F32::release(vad_block);
+      vad_block = NULL;
     }
 
     // Here's the method that estimates the level of the audio (in dB)
@@ -168,6 +197,8 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
         //smooth the gain using the attack or release constants
         if (gain_dB < prev_gain_dB) {  //are we in the attack phase?
           gain_dB_block->data[i] = attack_const*prev_gain_dB + one_minus_attack_const*gain_dB;
+        } else if (vadNoSpeech(i)) {  //no speech, hold the gain
+          gain_dB_block->data[i] = prev_gain_dB;
         } else {   //or, we're in the release phase
           gain_dB_block->data[i] = release_const*prev_gain_dB + one_minus_release_const*gain_dB;
         }
@@ -181,6 +212,45 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
     }
 
 
+    //As calcAudioLevel_dB(), calcGain() and the multiply, but the gain is found at
+    //the end of each of control_points equal parts of the block and ramped between
+    void calcGainPoints(audio_block_f32_t *audio_block) {
+      float32_t gain[AUDIO_F32_CONTROL_POINTS];
+      float32_t prev_gain = pow10f(prev_gain_dB / 20.0f);
+      float c1 = level_lp_const, c2 = 1.0f - c1;
+      int i0 = 0;
+      for (int k = 0; k < control_points; k++) {
+        int i1 = ((k + 1) * audio_block->length) / control_points;
+        int m = i1 - i0;
+        if (m != seg_len) {  //the smoothing constants over m samples
+          seg_len = m;
+          attack_seg = powf(attack_const, (float)m);
+          release_seg = powf(release_const, (float)m);
+        }
+        for (int i = i0; i < i1; i++) {
+          float32_t x = audio_block->data[i];
+          prev_level_lp_pow = c1*prev_level_lp_pow + c2*x*x;
+        }
+        if (prev_level_lp_pow < (1.0E-13)) prev_level_lp_pow = 1.0E-13;  //never go less than -130 dBFS
+
+        //the target gain, as calcInstantaneousTargetGain()
+        float32_t above_thresh_dB = 10.0f*log10f_approx(prev_level_lp_pow) - thresh_dBFS;
+        float32_t gain_dB = above_thresh_dB/comp_ratio - above_thresh_dB;
+        if (gain_dB > 0.0f) gain_dB = 0.0f;
+
+        //smooth, as calcSmoothedGain_dB() over m samples with a constant target
+        if (gain_dB < prev_gain_dB) {
+          prev_gain_dB = attack_seg*prev_gain_dB + (1.0f - attack_seg)*gain_dB;
+        } else if (!vadNoSpeech(i1 - 1)) {
+          prev_gain_dB = release_seg*prev_gain_dB + (1.0f - release_seg)*gain_dB;
+        }
+        gain[k] = pow10f(prev_gain_dB / 20.0f);
+        i0 = i1;
+      }
+      AudioStream_F32::multiplyControl(audio_block->data, audio_block->data, audio_block->length,
+                                       prev_gain, gain, control_points);
+    }
+
     //methods to set parameters of this module
     void resetStates(void) {
       prev_level_lp_pow = 1.0f;
@@ -198,6 +268,7 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
     void setAttack_sec(float a, float fs_Hz) {
       attack_sec = a;
       attack_const = expf(-1.0f / (attack_sec * fs_Hz)); //expf() is much faster than exp()
+      seg_len = 0;  //recompute the constants for calcGainPoints()
 
       //also update the time constant for the envelope extraction
       setLevelTimeConst_sec(min(attack_sec,release_sec) / 5.0, fs_Hz);  //make the level time-constant one-fifth the gain time constants
@@ -205,6 +276,7 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
     void setRelease_sec(float r, float fs_Hz) {
       release_sec = r;
       release_const = expf(-1.0f / (release_sec * fs_Hz)); //expf() is much faster than exp()
+      seg_len = 0;
 
       //also update the time constant for the envelope extraction
       setLevelTimeConst_sec(min(attack_sec,release_sec) / 5.0, fs_Hz);  //make the level time-constant one-fifth the gain time constants
@@ -219,6 +291,12 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
       setThreshPow(pow(10.0, thresh_dBFS / 10.0));
     }
     void enableHPFilter(boolean flag) { use_HP_prefilter = flag; };
+    void setVADThreshold(float p) { vad_threshold = p; }  //with AudioCalcVAD_F32 on In 1
+    void setControlPoints(int n) {  //gain at n points per block, 0 for every sample
+      if (n < 0) n = 0;
+      if (n > AUDIO_F32_CONTROL_POINTS) n = AUDIO_F32_CONTROL_POINTS;
+      control_points = n;
+    }
 
     //methods to return information about this module
     float32_t getPreGain_dB(void) { return 20.0 * log10f_approx(pre_gain);  }
@@ -239,7 +317,19 @@ class AudioEffectCompressor_F32 : public AudioStream_F32
     
   private:
     //state-related variables
-    audio_block_f32_t *inputQueueArray_f32[1]; //memory pointer for the input to this module
+    audio_block_f32_t *inputQueueArray_f32[2]; //memory pointer for the inputs to this module
+    audio_block_f32_t *vad_block = NULL;  //In 1, during update() only
+    float32_t vad_threshold = 0.5f;
+    //true if the VAD is connected and says no speech at sample i.  A shorter
+    //VAD block, as from an island, has its last value used past its end.
+    bool vadNoSpeech(int i) {
+      if (!vad_block) return false;
+      if (i >= vad_block->length) i = vad_block->length - 1;
+      return vad_block->data[i] < vad_threshold;
+    }
+    int control_points = 0;  //0 for the gain at every sample
+    int seg_len = 0;         //samples per control point, for attack_seg and release_seg
+    float32_t attack_seg, release_seg;
     float32_t prev_level_lp_pow = 1.0;
     float32_t prev_gain_dB = 0.0; //last gain^2 used
 
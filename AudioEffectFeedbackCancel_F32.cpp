@@ -0,0 +1,353 @@
+/*
+ * AudioEffectFeedbackCancel_F32.cpp
+ *
+ * See AudioEffectFeedbackCancel_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include <Arduino.h>
+#include "AudioEffectFeedbackCancel_F32.h"
+
+uint16_t AudioEffectFeedbackCancel_F32::initialize(uint16_t _lengthFIR,
+              uint16_t _bulkDelay, uint16_t _mode, uint16_t _subBlock)
+    {
+    bool wasOn;
+    float32_t *pOld, *pNew;
+
+    // update() is an interrupt, so stop it while things change.
+    __disable_irq();
+    wasOn = doFBC;
+    doFBC = false;
+    __enable_irq();
+
+    if(_lengthFIR < 2)  _lengthFIR = 2;
+    lengthFIR = powf(2.0f, (int)(log2f(_lengthFIR)+0.000001f));  // Power of 2
+    if(lengthFIR > FBC_MAX_FIR)  lengthFIR = FBC_MAX_FIR;
+    bulkDelay = (_bulkDelay > FBC_MAX_BULK ? FBC_MAX_BULK : _bulkDelay);
+    mode = (_mode==FBC_SUBBAND ? FBC_SUBBAND : FBC_TIME);
+    if(block_size > 128)  block_size = 128;
+
+    for(int i=0; i<FBC_MAX_FIR; i++)  coeff[i] = 0.0f;
+    for(int i=0; i<FBC_MAX_BULK+FBC_MAX_FIR+128; i++)  {
+        hist[i] = 0.0f;
+        histF[i] = 0.0f;
+        }
+    for(int i=0; i<FBC_MAX_ORDER+128; i++)  {
+        uBuf[i] = 0.0f;
+        eBuf[i] = 0.0f;
+        }
+    clearPredictor();
+
+    // Partition size, a power of 2 from 8 up, no more than the block and
+    // at least two partitions, so that the 2*subBlock FFT input is all
+    // in hist[].
+    if(_subBlock == 0)
+        _subBlock = 32;
+    subBlock = powf(2.0f, (int)(log2f(_subBlock)+0.000001f));
+    if(subBlock > block_size)     subBlock = block_size;
+    if(subBlock > lengthFIR/2)    subBlock = lengthFIR/2;
+    if(subBlock < 8)              mode = FBC_TIME;   // FIR too short
+
+    pOld = sbMem;
+    pNew = NULL;
+    W = NULL;
+    if(mode == FBC_SUBBAND)
+        {
+        uint32_t P = subBlock;
+        nPart = lengthFIR/P;
+        // W[nPart*4P], X[nPart*4P], Xf[nPart*4P], Pw[2P], bufA[4P], bufB[4P]
+        uint32_t nFloat = 12*nPart*P + 10*P;
+        pNew = new float32_t[nFloat];
+        if(pNew == NULL)
+            {
+            mode = FBC_TIME;     // Not enough memory
+            }
+        else
+            {
+            for(uint32_t i=0; i<nFloat; i++)  pNew[i] = 0.0f;
+            W = pNew;
+            X = W + nPart*4*P;
+            Xf = X + nPart*4*P;
+            Pw = Xf + nPart*4*P;
+            bufA = Pw + 2*P;
+            bufB = bufA + 4*P;
+            for(uint32_t i=0; i<2*P; i++)  Pw[i] = 1.0E-6f;
+            xNewest = 0;
+            nConstrain = 0;
+            if(nFFTsetup != (int)(2*P))
+                {
+                fftF.setup(2*P);
+                fftF.useRectangularWindow();
+                ifftF.setup(2*P);
+                ifftF.useRectangularWindow();
+                nFFTsetup = 2*P;
+                }
+            }
+        }
+    sbMem = pNew;
+    if(pOld)  delete [] pOld;
+
+    __disable_irq();
+    doFBC = wasOn;
+    __enable_irq();
+    return lengthFIR;
+    }
+
+void AudioEffectFeedbackCancel_F32::update(void)
+    {
+    audio_block_f32_t *blockMic, *blockRef;
+    uint16_t nNew = bulkDelay + lengthFIR - 1;   // Start of newest reference
+
+    blockMic = AudioStream_F32::receiveWritable_f32(0);
+    blockRef = AudioStream_F32::receiveReadOnly_f32(1);
+    if (!blockMic)
+        {
+        if(blockRef)  AudioStream_F32::release(blockRef);
+        return;
+        }
+
+    if(!doFBC)
+        {
+        if(blockRef)  AudioStream_F32::release(blockRef);
+        AudioStream_F32::transmit(blockMic);
+        AudioStream_F32::release(blockMic);
+        return;
+        }
+
+    // New reference, zero if not connected, and its whitened version
+    if(blockRef)
+        {
+        arm_copy_f32(blockRef->data, &hist[nNew], block_size);
+        AudioStream_F32::release(blockRef);
+        }
+    else
+        arm_fill_f32(0.0f, &hist[nNew], block_size);
+    arm_copy_f32(&hist[nNew], &uBuf[FBC_MAX_ORDER], block_size);
+    prefilter(&uBuf[FBC_MAX_ORDER], &histF[nNew], block_size);
+
+    // The output replaces the microphone data in blockMic
+    if(mode==FBC_SUBBAND && sbMem!=NULL)
+        updateSubband(blockMic->data);
+    else
+        updateTime(blockMic->data);
+
+    updatePredictor();
+
+    // Keep the old data for the next block
+    arm_copy_f32(&hist[block_size], hist, nNew);
+    arm_copy_f32(&histF[block_size], histF, nNew);
+    arm_copy_f32(&uBuf[block_size], uBuf, FBC_MAX_ORDER);
+    arm_copy_f32(&eBuf[block_size], eBuf, FBC_MAX_ORDER);
+
+    AudioStream_F32::transmit(blockMic);
+    AudioStream_F32::release(blockMic);
+    }
+
+// Applies A(z) to n samples.  pIn[-order] to pIn[-1] are the old samples.
+void AudioEffectFeedbackCancel_F32::prefilter(float32_t *pIn, float32_t *pOut, uint16_t n)
+    {
+    if(order == 0)
+        {
+        arm_copy_f32(pIn, pOut, n);
+        return;
+        }
+    for(uint16_t i=0; i<n; i++)
+        arm_dot_prod_f32(aRev, &pIn[i-order], order+1, &pOut[i]);
+    }
+
+// Sample by sample NLMS, the error whitened by A(z)
+void AudioEffectFeedbackCancel_F32::updateTime(float32_t *pMic)
+    {
+    uint16_t L = lengthFIR;
+    float32_t *pF;
+    float32_t yEst, e, ef, pNorm;
+    float32_t delta = 1.0E-6f*(float32_t)L;     // Keeps the step finite
+
+    // Power of the whitened reference over the FIR.  This is started
+    // fresh each block, so that round-off can not build up.
+    arm_dot_prod_f32(histF, histF, L, &pNorm);
+    for(uint16_t n=0; n<block_size; n++)
+        {
+        if(n > 0)
+            pNorm += histF[n+L-1]*histF[n+L-1] - histF[n-1]*histF[n-1];
+        if(pNorm < 0.0f)  pNorm = 0.0f;
+
+        arm_dot_prod_f32(coeff, &hist[n], L, &yEst);
+        e = pMic[n] - yEst;
+        pMic[n] = e;
+        eBuf[FBC_MAX_ORDER + n] = e;
+        if(!adapt)
+            continue;
+
+        prefilter(&eBuf[FBC_MAX_ORDER + n], &ef, 1);
+        float32_t kcf = mu*ef/(pNorm + delta);
+        pF = &histF[n];
+        for(uint16_t j=0; j<L; j++)
+            coeff[j] += kcf*pF[j];
+        }
+    }
+
+// Partitioned block frequency domain NLMS, with P=subBlock samples per
+// partition and 2P point complex FFTs.  Partition k of the FIR is W[k]
+// and uses the spectra from k sub-blocks ago.  The filtering is with X,
+// the reference spectra, and the update with Xf, the whitened ones.
+void AudioEffectFeedbackCancel_F32::updateSubband(float32_t *pMic)
+    {
+    uint32_t P = subBlock;
+    uint32_t N2 = 4*P;        // Floats in a 2P complex spectrum
+    uint32_t i, k, kx;
+    uint16_t L = lengthFIR;
+    float32_t *pW, *pX, *pXf;
+
+    for(uint32_t n0=0; n0<block_size; n0+=P)
+        {
+        // Spectra of the last 2P delayed reference samples, newest in X.
+        // hist[L-1+n] is the reference sample bulkDelay before sample n.
+        if(xNewest == 0)  xNewest = nPart;
+        xNewest--;
+        pX = X + xNewest*N2;
+        pXf = Xf + xNewest*N2;
+        for(i=0; i<2*P; i++)
+            {
+            pX[2*i] = hist[L-1+n0-P+i];     pX[2*i+1] = 0.0f;
+            pXf[2*i] = histF[L-1+n0-P+i];   pXf[2*i+1] = 0.0f;
+            }
+        fftF.execute(pX);
+        fftF.execute(pXf);
+
+        // Smoothed power per bin, for the normalization, with fast rise
+        for(i=0; i<2*P; i++)
+            {
+            float32_t p2 = pXf[2*i]*pXf[2*i] + pXf[2*i+1]*pXf[2*i+1];
+            Pw[i] = 0.9f*Pw[i] + 0.1f*p2;
+            if(p2 > Pw[i])  Pw[i] = p2;
+            }
+
+        // Feedback estimate, the last half of the IFFT of sum W[k]X[k]
+        arm_fill_f32(0.0f, bufA, N2);
+        for(k=0; k<nPart; k++)
+            {
+            kx = (xNewest + k) % nPart;
+            pW = W + k*N2;
+            pX = X + kx*N2;
+            for(i=0; i<2*P; i++)
+                {
+                bufA[2*i]   += pW[2*i]*pX[2*i]   - pW[2*i+1]*pX[2*i+1];
+                bufA[2*i+1] += pW[2*i]*pX[2*i+1] + pW[2*i+1]*pX[2*i];
+                }
+            }
+        ifftF.execute(bufA);
+        for(i=0; i<P; i++)
+            {
+            float32_t e = pMic[n0+i] - bufA[2*(i+P)];
+            pMic[n0+i] = e;
+            eBuf[FBC_MAX_ORDER + n0 + i] = e;
+            }
+        if(!adapt)
+            continue;
+
+        // Whitened error, with zeros in the first half for the FFT
+        prefilter(&eBuf[FBC_MAX_ORDER + n0], bufA, P);
+        for(i=0; i<P; i++)
+            {
+            bufB[2*i] = 0.0f;           bufB[2*i+1] = 0.0f;
+            bufB[2*(i+P)] = bufA[i];    bufB[2*(i+P)+1] = 0.0f;
+            }
+        fftF.execute(bufB);
+
+        // Normalized step for each bin.  The mean power is added, as in
+        // AudioLMSDenoiseNotch_F32, to limit the step of weak bins.  The
+        // factor of 4 makes the convergence about that of FBC_TIME for
+        // the same mu.
+        float32_t pMean;
+        arm_mean_f32(Pw, 2*P, &pMean);
+        for(i=0; i<2*P; i++)
+            {
+            float32_t muBin = 4.0f*mu/((float32_t)nPart*(Pw[i] + pMean) + 1.0E-10f*(float32_t)N2);
+            bufB[2*i] *= muBin;
+            bufB[2*i+1] *= muBin;
+            }
+
+        // W[k] += conj(Xf[k])*E
+        for(k=0; k<nPart; k++)
+            {
+            kx = (xNewest + k) % nPart;
+            pW = W + k*N2;
+            pXf = Xf + kx*N2;
+            for(i=0; i<2*P; i++)
+                {
+                float32_t xr = pXf[2*i];
+                float32_t xi = pXf[2*i+1];
+                float32_t er = bufB[2*i];
+                float32_t ei = bufB[2*i+1];
+                pW[2*i]   += xr*er + xi*ei;
+                pW[2*i+1] += xr*ei - xi*er;
+                }
+            }
+
+        // Gradient constraint, one partition each time
+        pW = W + nConstrain*N2;
+        ifftF.execute(pW);
+        for(i=P; i<2*P; i++)
+            {
+            pW[2*i] = 0.0f;
+            pW[2*i+1] = 0.0f;
+            }
+        for(i=0; i<P; i++)
+            pW[2*i+1] = 0.0f;       // Real FIR
+        fftF.execute(pW);
+        if(++nConstrain >= nPart)
+            nConstrain = 0;
+        }
+    }
+
+// Fits the predictor to the output just made, by Levinson-Durbin on a
+// smoothed autocorrelation, and puts the prediction error filter in aRev[].
+void AudioEffectFeedbackCancel_F32::updatePredictor(void)
+    {
+    float32_t r[FBC_MAX_ORDER + 1];
+    float32_t a[FBC_MAX_ORDER + 1];
+    float32_t aOld[FBC_MAX_ORDER + 1];
+    float32_t err, acc, kr, g;
+    uint16_t i, j;
+
+    if(order==0 || !adapt)
+        return;
+
+    for(i=0; i<=order; i++)
+        {
+        arm_dot_prod_f32(&eBuf[FBC_MAX_ORDER], &eBuf[FBC_MAX_ORDER-i], block_size, &r[i]);
+        rAvg[i] = 0.8f*rAvg[i] + 0.2f*r[i];
+        }
+    if(rAvg[0] < 1.0E-12f)
+        return;        // Silence, keep the old filter
+
+    // A little white noise keeps the solution well behaved
+    err = 1.0001f*rAvg[0];
+    a[0] = 1.0f;
+    for(i=1; i<=order; i++)
+        {
+        acc = rAvg[i];
+        for(j=1; j<i; j++)
+            acc += a[j]*rAvg[i-j];
+        kr = -acc/err;
+        for(j=0; j<i; j++)
+            aOld[j] = a[j];
+        for(j=1; j<i; j++)
+            a[j] = aOld[j] + kr*aOld[i-j];
+        a[i] = kr;
+        err *= (1.0f - kr*kr);
+        if(err <= 0.0f)
+            return;
+        }
+
+    // Bandwidth expansion, so that sharp peaks in a short block do not
+    // make a filter with deep notches.
+    g = 1.0f;
+    for(i=0; i<=order; i++)
+        {
+        aRev[order-i] = a[i]*g;
+        g *= 0.98f;
+        }
+    }
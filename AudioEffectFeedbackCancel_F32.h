@@ -0,0 +1,205 @@
+/*
+ * AudioEffectFeedbackCancel_F32.h
+ *
+ * Adaptive acoustic feedback canceller, for hearing aid type chains where
+ * the receiver (speaker) sound leaks back into the microphone.  An adaptive
+ * FIR models the path from the receiver signal to the microphone and its
+ * output is subtracted from the microphone.  This raises the gain that can
+ * be used before howling, typically by 10 to 15 dB.
+ *
+ * Inputs and output:
+ *   In 0   Microphone
+ *   In 1   Reference, the signal going to the receiver.  This is normally
+ *          a connection back from the last object before the output, such
+ *          as the WDRC compressor.  As that object updates after this one,
+ *          the block arrives one update late, which is also about when it
+ *          gets to the microphone.
+ *   Out 0  Microphone with the feedback estimate removed.  This goes on
+ *          to the rest of the processing.
+ *
+ *   i2sIn --> feedbackCancel(0) --> ... --> compWDRC --> i2sOut
+ *                 ^(1)                           |
+ *                 +------------------------------+
+ *
+ * The FIR has lengthFIR taps following a bulk delay, so that the taps are
+ * not spent on the DAC, ADC and block delays.  Find the bulk delay by
+ * sending a click or by looking at getCoefficients() after adapting with
+ * no bulk delay.  Stay a few samples short of the true delay.
+ *
+ * The trouble with a feedback canceller is that the reference is a delayed
+ * and amplified copy of the microphone, so the wanted sound is correlated
+ * with the reference and plain NLMS cancels part of it, as well as the
+ * feedback (biased estimate).  Here the prediction error method (PEM) is
+ * used.  A linear predictor is fitted, each block, to the canceller
+ * output, an estimate of the incoming sound.  The prediction error filter,
+ * A(z), then whitens both the reference and the error before they are used
+ * for the coefficient update.  The filtering of the microphone is always
+ * with the unfiltered reference.  setPredictorOrder(0) turns this off.
+ *
+ * There are two forms, set by initialize():
+ *   FBC_TIME     Sample by sample NLMS.  About 2*lengthFIR multiply-adds
+ *                per sample for the filter and update.
+ *   FBC_SUBBAND  Partitioned frequency domain NLMS, as LMS_FDAF in
+ *                AudioLMSDenoiseNotch_F32.  The FIR is split into
+ *                partitions of subBlock samples, and each of the 2*subBlock
+ *                frequency bins has its own normalized step, so whitening
+ *                is less important.  The work grows slowly with lengthFIR,
+ *                so this is the one for long filters.  There is no added
+ *                latency.  12*lengthFIR+10*subBlock floats are allocated.
+ *
+ * The CPU load is fixed for a given setting, and does not depend on the
+ * signal.  Measure it with processorUsage() at the longest FIR in use.
+ *
+ * Functions:
+ *   initialize(lengthFIR, bulkDelay, mode, subBlock) Returns FIR length.
+ *                     lengthFIR is a power of 2 up to FBC_MAX_FIR.
+ *                     bulkDelay is 0 to FBC_MAX_BULK samples.
+ *                     subBlock is 0 for the default.
+ *   setMu(mu)         Adaptation step, 0.0 to 1.0.  Default 0.005
+ *   getMu()
+ *   setPredictorOrder(n)  0 to FBC_MAX_ORDER, 0 is plain NLMS. Default 16
+ *   setAdapt(bool)    false freezes the coefficients
+ *   enable(bool)      false passes In 0 unchanged
+ *   reset()           Clears the coefficients
+ *   getCoefficients(pCoeff)  Time domain FIR, lengthFIR values, FBC_TIME only
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioEffectFeedbackCancel_F32_h_
+#define AudioEffectFeedbackCancel_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#include "FFT_OA_F32.h"
+
+#if defined(__IMXRT1062__)
+#define FBC_MAX_FIR   512
+#define FBC_MAX_BULK  512
+#else
+#define FBC_MAX_FIR   128
+#define FBC_MAX_BULK  256
+#endif
+#define FBC_MAX_ORDER  32
+
+#define FBC_TIME     0
+#define FBC_SUBBAND  1
+
+class AudioEffectFeedbackCancel_F32 : public AudioStream_F32
+{
+//GUI: inputs:2, outputs:1  //this line used for automatic generation of GUI nodes
+//GUI: shortName:feedbackCancel
+public:
+    AudioEffectFeedbackCancel_F32(void) : AudioStream_F32(2, inputQueueArray_f32) {
+        block_size = AUDIO_BLOCK_SAMPLES;
+        initialize(64, 0, FBC_TIME, 0);
+        }
+
+    AudioEffectFeedbackCancel_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(2, inputQueueArray_f32) {
+        block_size = settings.audio_block_samples;
+        initialize(64, 0, FBC_TIME, 0);
+        }
+
+    ~AudioEffectFeedbackCancel_F32(void) {
+        if(sbMem)  delete [] sbMem;
+        }
+
+    uint16_t initialize(uint16_t _lengthFIR, uint16_t _bulkDelay,
+                        uint16_t _mode=FBC_TIME, uint16_t _subBlock=0);
+
+    void setMu(float32_t _mu) {
+        if(_mu < 0.0f)  _mu = 0.0f;
+        if(_mu > 1.0f)  _mu = 1.0f;
+        mu = _mu;
+        }
+    float32_t getMu(void) { return mu; }
+
+    void setPredictorOrder(uint16_t _order) {
+        if(_order > FBC_MAX_ORDER)  _order = FBC_MAX_ORDER;
+        __disable_irq();
+        order = _order;
+        clearPredictor();
+        __enable_irq();
+        }
+    uint16_t getPredictorOrder(void) { return order; }
+
+    void setAdapt(bool _adapt) { adapt = _adapt; }
+
+    void enable(bool _enable) { doFBC = _enable; }
+
+    void reset(void) {
+        __disable_irq();
+        for(int i=0; i<FBC_MAX_FIR; i++)  coeff[i] = 0.0f;
+        if(W)
+            for(uint32_t i=0; i<4*(uint32_t)nPart*subBlock; i++)  W[i] = 0.0f;
+        __enable_irq();
+        }
+
+    // Copies lengthFIR coefficients, the first for the bulk delay.
+    // Returns the number copied, 0 for FBC_SUBBAND.
+    uint16_t getCoefficients(float32_t *pCoeff) {
+        if(mode != FBC_TIME)  return 0;
+        // coeff[] is in time reversed order, as for arm_fir_f32()
+        for(int i=0; i<lengthFIR; i++)
+            pCoeff[i] = coeff[lengthFIR - 1 - i];
+        return lengthFIR;
+        }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[2];
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    bool doFBC = true;
+    bool adapt = true;
+    uint16_t mode = FBC_TIME;
+    uint16_t lengthFIR = 64;
+    uint16_t bulkDelay = 0;
+    float32_t mu = 0.005f;
+
+    // Reference, and whitened reference, as linear buffers.  The newest
+    // block starts at bulkDelay+lengthFIR-1 and sample n of the block is
+    // filtered by hist[n] to hist[n+lengthFIR-1].
+    float32_t hist[FBC_MAX_BULK + FBC_MAX_FIR + 128];
+    float32_t histF[FBC_MAX_BULK + FBC_MAX_FIR + 128];
+    float32_t coeff[FBC_MAX_FIR];  // Time reversed, coeff[lengthFIR-1] is for bulkDelay
+
+    // Prediction error filter.  aRev[] is A(z) reversed, aRev[order]=1.
+    // uBuf and eBuf are FBC_MAX_ORDER old samples, followed by the block.
+    uint16_t order = 16;
+    float32_t aRev[FBC_MAX_ORDER + 1];
+    float32_t rAvg[FBC_MAX_ORDER + 1];
+    float32_t uBuf[FBC_MAX_ORDER + 128];
+    float32_t eBuf[FBC_MAX_ORDER + 128];
+
+    // FBC_SUBBAND, see initialize() for the layout of sbMem
+    float32_t *sbMem = NULL;
+    float32_t *W = NULL;           // nPart spectra of 2*subBlock complex
+    float32_t *X = NULL;           // Reference spectra, circular
+    float32_t *Xf = NULL;          // Whitened reference spectra, circular
+    float32_t *Pw = NULL;          // Smoothed power per bin, of Xf
+    float32_t *bufA = NULL;        // 2*subBlock complex work buffers
+    float32_t *bufB = NULL;
+    uint16_t subBlock = 32;
+    uint16_t nPart = 1;
+    uint16_t xNewest = 0;
+    uint16_t nConstrain = 0;
+    FFT_F32 fftF;
+    IFFT_F32 ifftF;
+    int nFFTsetup = 0;
+
+    void updateTime(float32_t *pMic);
+    void updateSubband(float32_t *pMic);
+    void prefilter(float32_t *pIn, float32_t *pOut, uint16_t n);
+    void updatePredictor(void);
+    void clearPredictor(void) {
+        for(int i=0; i<=FBC_MAX_ORDER; i++)  {
+            aRev[i] = 0.0f;
+            rAvg[i] = 0.0f;
+            }
+        aRev[order] = 1.0f;
+        }
+};
+#endif
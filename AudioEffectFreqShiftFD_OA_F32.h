@@ -114,6 +114,10 @@ class AudioEffectFreqShiftFD_OA_F32 : public AudioStream_F32
 	
     virtual void update(void);
 	bool enable(bool state = true) { enabled = state; return enabled;}
+	// The overlap buffering delay.  When not enabled, the audio passes directly.
+	uint32_t getLatencySamples(void) {
+		return enabled ? (uint32_t)myIFFT.getLatencySamples() : 0;
+	}
 
   private:
     int enabled = 0;
@@ -5,6 +5,11 @@
  * Purpose: This module mutes the Audio completly, when it's below a given threshold.
  *          
  * This processes a single stream fo audio data (ie, it is mono)       
+ *
+ * Oct 2026: Optional In 1, the speech probability from AudioCalcVAD_F32.
+ * When connected, a sample only opens the gate if it is above the threshold
+ * and the VAD is above setVADThreshold(), default 0.5.  Unconnected, the
+ * gate is as before.
  *          
  * MIT License.  use at your own risk.
 */
@@ -21,12 +26,12 @@ const float minLinear = pow10f(-60 / 20.0f);
 
 class AudioEffectNoiseGate_F32 : public AudioStream_F32
 {
-  //GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
+  //GUI: inputs:2, outputs:1  //this line used for automatic generation of GUI node
   //GUI: shortName:NoiseGate
 public:
   //constructor
-  AudioEffectNoiseGate_F32(void) : AudioStream_F32(1, inputQueueArray_f32){};
-  AudioEffectNoiseGate_F32(const AudioSettings_F32 &settings) : AudioStream_F32(1, inputQueueArray_f32){};
+  AudioEffectNoiseGate_F32(void) : AudioStream_F32(2, inputQueueArray_f32){};
+  AudioEffectNoiseGate_F32(const AudioSettings_F32 &settings) : AudioStream_F32(2, inputQueueArray_f32){};
 
   //here's the method that does all the work
   void update(void)
@@ -34,13 +39,21 @@ public:
 
     //Serial.println("AudioEffectNoiseGate_F32: updating.");  //for debugging.
     audio_block_f32_t *block;
+    // The VAD, if connected
+    audio_block_f32_t *vadBlock = AudioStream_F32::receiveReadOnly_f32(1);
     block = AudioStream_F32::receiveWritable_f32();
     if (!block)
+    {
+      if (vadBlock)
+        AudioStream_F32::release(vadBlock);
       return;
+    }
     // create a new audio block for the gain
     audio_block_f32_t *gainBlock = AudioStream_F32::allocate_f32();
     // calculate the desired gain
-    calcGain(block, gainBlock);
+    calcGain(block, gainBlock, vadBlock);
+    if (vadBlock)
+      AudioStream_F32::release(vadBlock);
     // smooth the "blocky" gain block
     calcSmoothedGain(gainBlock);
 #ifdef NOISEGATE_EXTENDEDINFO
@@ -84,6 +97,12 @@ public:
     holdTimeNumSamples = timeInSeconds * AUDIO_SAMPLE_RATE;
   }
 
+  // With AudioCalcVAD_F32 on In 1, the speech probability needed to open
+  void setVADThreshold(float probability)
+  {
+    vadThreshold = probability;
+  }
+
 #ifdef NOISEGATE_EXTENDEDINFO
   bool infoIsOpeningOrClosing()
   {
@@ -98,11 +117,12 @@ public:
 
 private:
   float32_t linearThreshold;
+  float32_t vadThreshold = 0.5f;
   float32_t prev_gain_dB = 0;
   float32_t openingTimeConst, closingTimeConst;
   float lastGainBlockValue = 0;
   int32_t counter, holdTimeNumSamples = 0;
-  audio_block_f32_t *inputQueueArray_f32[1]; //memory pointer for the input to this module
+  audio_block_f32_t *inputQueueArray_f32[2]; //memory pointer for the inputs to this module
   bool falling = false;
 
   bool _isOpen = false;
@@ -111,13 +131,16 @@ private:
 #ifdef NOISEGATE_EXTENDEDINFO
   bool _inBetween = false;
 #endif
-  void calcGain(audio_block_f32_t *input, audio_block_f32_t *gainBlock)
+  void calcGain(audio_block_f32_t *input, audio_block_f32_t *gainBlock, audio_block_f32_t *vad)
   {
     _isOpen = false;
     for (int i = 0; i < input->length; i++)
     {
-      // take absolute value and compare it to the set threshold
+      // take absolute value and compare it to the set threshold, and the VAD if connected
       bool isAboveThres = abs(input->data[i]) > linearThreshold;
+      if (vad)  // a shorter VAD block has its last value used past its end
+        isAboveThres = isAboveThres &&
+                       (vad->data[i < vad->length ? i : vad->length - 1] > vadThreshold);
       _isOpen |= isAboveThres;
       // if above the threshold set volume to 1 otherwise to 0, we did not account for holdtime
       gainBlock->data[i] = isAboveThres ? 1 : 0;
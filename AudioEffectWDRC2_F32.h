@@ -192,6 +192,8 @@ class AudioEffectWDRC2_F32 : public AudioStream_F32
        delayBufferMask = _delaySize - 1;
        in_index = 0;
        }
+    // The lookahead delay line
+    uint32_t getLatencySamples(void) { return delayBufferMask + 1; }
     void printOn(bool _printIO) { printIO = _printIO; } // Diagnostics ONLY. Not for general INO
 
     float getLowLevelGainDB(void) { return gain0DB; }
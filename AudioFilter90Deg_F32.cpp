@@ -15,21 +15,209 @@
  * frequencies and depends on N.
  *
  * The I-channel FIR is a Hilbert Transform and this has every other term 0.
- * These need not be multiplied-and-accumulated, but for now, we do.  By the
- * time the indexes are calculated, it may be quicker to process everything.
- * Additionally, to not require a half-sample delay, the number of terms in
- * the Hilbert FIR needs to be odd.
+ * FIRKernel_F32 skips these, and takes the difference of the two samples
+ * for each antisymmetric pair of terms before the multiply.  Additionally,
+ * to not require a half-sample delay, the number of terms in the Hilbert
+ * FIR needs to be odd.
  * 
  * MIT License,  Use at your own risk.
 */
 
 #include "AudioFilter90Deg_F32.h"
 
+// The half-band design, see de Soras' HIIR notes.  Transition parameters
+// k and the nome q, from the normalized transition t, 0 < t < 0.5.
+static void transitionParam(double t, double *pk, double *pq)  {
+  double k = tan((1.0 - 2.0*t)*M_PI/4.0);
+  k *= k;
+  double kk = pow(1.0 - k*k, 0.25);
+  double e = 0.5*(1.0 - kk)/(1.0 + kk);
+  double e4 = e*e*e*e;
+  *pk = k;
+  *pq = e*(1.0 + e4*(2.0 + e4*(15.0 + 150.0*e4)));
+}
+
+// Coefficient c (1 to n) of an elliptic half-band of the given order, from
+// the theta function series of Valenzuela and Constantinides.
+static double halfBandCoeff(int c, double k, double q, int order)  {
+  double num = 0.0, den = 0.0, t;
+  int i = 0;
+  double sgn = 1.0;
+  do  {
+    t = pow(q, (double)(i*(i + 1)))*sin((double)((2*i + 1)*c)*M_PI/(double)order)*sgn;
+    num += t;
+    sgn = -sgn;
+    i++;
+  } while(fabs(t) > 1e-30);
+  i = 1;
+  sgn = -1.0;
+  do  {
+    t = pow(q, (double)(i*i))*cos((double)(2*i*c)*M_PI/(double)order)*sgn;
+    den += t;
+    sgn = -sgn;
+    i++;
+  } while(fabs(t) > 1e-30);
+  double ww = num*pow(q, 0.25)/(den + 0.5);
+  double w2 = ww*ww;
+  double x = sqrt((1.0 - w2*k)*(1.0 - w2/k))/(1.0 + w2);
+  return (1.0 - x)/(1.0 + x);
+}
+
+uint16_t AudioFilter90Deg_F32::beginIIR(float32_t fLow_Hz, float32_t maxError_deg,
+                                        bool decimate)  {
+  float32_t c[HILBERT_IIR_MAX_COEFFS];
+  double k, q;
+  double t = 2.0*(double)fLow_Hz/(double)sample_rate_Hz;
+  if(t<=0.0 || t>=0.5 || maxError_deg<=0.0f || maxError_deg>=90.0f)
+    return 0;
+  // The phase error, e, is a stop band of sin(e/2) in the half-band
+  double a = sin(0.5*(double)maxError_deg*M_PI/180.0);
+  a = a*a/(1.0 - a*a);
+  transitionParam(t, &k, &q);
+  int order = (int)ceil(log(a*a/16.0)/log(q));
+  if((order & 1) == 0)  order++;
+  if(order < 3)  order = 3;
+  uint16_t n = (uint16_t)((order - 1)/2);
+  if(n > HILBERT_IIR_MAX_COEFFS)
+    return 0;
+  for(int i=0; i<n; i++)
+    c[i] = (float32_t)halfBandCoeff(i + 1, k, q, order);
+  return beginIIR(c, n, decimate);
+}
+
+uint16_t AudioFilter90Deg_F32::beginIIR(const float32_t *pCoeff, uint16_t nCoeff,
+                                        bool decimate)  {
+  double d[2] = {0.0, 1.0};     // Path 1 has the extra z^-1
+  if(pCoeff==NULL || nCoeff<2 || nCoeff>HILBERT_IIR_MAX_COEFFS)
+    return 0;
+  __disable_irq();
+  for(int p=0; p<2; p++)  {
+    nIIR[p] = 0;
+    for(int i=p; i<nCoeff; i+=2)  {
+      float32_t cc = pCoeff[i];
+      iirC[p][nIIR[p]] = cc;
+      for(int j=0; j<4; j++)
+        iirState[p][nIIR[p]][j] = 0.0f;
+      nIIR[p]++;
+      // Group delay of (c - z^-2)/(1 - c*z^-2) at fs/4
+      d[p] += 2.0*(1.0 - (double)cc)/(1.0 + (double)cc);
+      }
+    }
+  qLast = 0.0f;
+  mode = decimate ? HILBERT_IIR_DEC2 : HILBERT_IIR;
+  iirLatency = (uint32_t)(0.5*(d[0] + d[1]) + 0.5);
+  __enable_irq();
+  return nCoeff;
+}
+
+// Path p on n samples in place.  At the full rate each section is
+// (c - z^-2)/(1 - c*z^-2), and at half rate, on every other sample,
+// (c - z^-1)/(1 - c*z^-1).
+void AudioFilter90Deg_F32::allpass(int path, float32_t *pData, uint16_t n)  {
+  for(int s=0; s<nIIR[path]; s++)  {
+    float32_t c = iirC[path][s];
+    float32_t *st = iirState[path][s];
+    float32_t x1 = st[0], y1 = st[1];
+    if(mode == HILBERT_IIR)  {
+      float32_t x2 = st[2], y2 = st[3];
+      for(int i=0; i<n; i++)  {
+        float32_t x = pData[i];
+        float32_t y = c*(x + y2) - x2;
+        x2 = x1;  x1 = x;
+        y2 = y1;  y1 = y;
+        pData[i] = y;
+        }
+      st[2] = x2;  st[3] = y2;
+      }
+    else  {
+      for(int i=0; i<n; i++)  {
+        float32_t x = pData[i];
+        float32_t y = c*(x + y1) - x1;
+        x1 = x;  y1 = y;
+        pData[i] = y;
+        }
+      }
+    st[0] = x1;  st[1] = y1;
+    }
+}
+
+void AudioFilter90Deg_F32::updateIIR(void)  {
+  audio_block_f32_t *block_i, *block_q;
+
+  if(mode == HILBERT_IIR)  {
+    block_i = AudioStream_F32::receiveWritable_f32(0);
+    if (!block_i)
+      return;
+    block_q = AudioStream_F32::receiveWritable_f32(1);
+    if (!block_q)  {
+      AudioStream_F32::release(block_i);
+      return;
+      }
+    // Out 0 lags, by path 1 with the z^-1 ahead of its sections
+    float32_t last = block_i->data[block_i->length - 1];
+    for(int i=block_i->length-1; i>0; i--)
+      block_i->data[i] = block_i->data[i-1];
+    block_i->data[0] = qLast;
+    qLast = last;
+    allpass(1, block_i->data, block_i->length);
+    allpass(0, block_q->data, block_q->length);
+    AudioStream_F32::transmit(block_i, 0);
+    AudioStream_F32::release (block_i);
+    AudioStream_F32::transmit(block_q, 1);
+    AudioStream_F32::release (block_q);
+    return;
+    }
+
+  // Decimating.  Out 0, I, is the even samples through path 0, and Out 1,
+  // Q, the odd ones, a sample earlier, through path 1.
+  audio_block_f32_t *blockIn = AudioStream_F32::receiveReadOnly_f32(0);
+  if (!blockIn)
+    return;
+  audio_block_f32_t *block_q2 = AudioStream_F32::receiveReadOnly_f32(1);
+  if (block_q2)
+    AudioStream_F32::release(block_q2);     // In 1 not used
+  // Output blocks at half the rate, with half the samples
+  uint16_t nOut = blockIn->length/2;
+  float32_t fsOut = 0.5f*blockIn->fs_Hz;
+  block_i = AudioStream_F32::allocate_f32(nOut, fsOut);
+  block_q = AudioStream_F32::allocate_f32(nOut, fsOut);
+  if (!block_i || !block_q)  {
+    if(errorPrint)  Serial.println("FIL90-ERR: No out block");
+    if(block_i)  AudioStream_F32::release(block_i);
+    if(block_q)  AudioStream_F32::release(block_q);
+    AudioStream_F32::release(blockIn);
+    return;
+    }
+  block_q->data[0] = qLast;
+  for(int i=0; i<nOut; i++)  {
+    block_i->data[i] = blockIn->data[2*i];
+    if(i > 0)
+      block_q->data[i] = blockIn->data[2*i - 1];
+    }
+  qLast = blockIn->data[2*nOut - 1];
+  allpass(0, block_i->data, nOut);
+  allpass(1, block_q->data, nOut);
+  for(int ch=0; ch<2; ch++)  {
+    audio_block_f32_t *b = ch ? block_q : block_i;
+    b->id = blockIn->id;
+    if(blockIn->sampleIndex != AUDIO_F32_NO_SAMPLE_INDEX)
+      b->sampleIndex = blockIn->sampleIndex/2;
+    AudioStream_F32::transmit(b, ch);
+    AudioStream_F32::release(b);
+    }
+  AudioStream_F32::release(blockIn);
+}
+
 void AudioFilter90Deg_F32::update(void)
 {
   audio_block_f32_t *block_i, *block_q,  *blockOut_i=NULL;
   uint16_t i;
 
+  if(mode != HILBERT_FIR)  {
+    updateIIR();
+    return;
+  }
+
   // Get first input, i, that will be filtered
   block_i = AudioStream_F32::receiveWritable_f32(0);
   if (!block_i) {
@@ -53,8 +241,8 @@ void AudioFilter90Deg_F32::update(void)
     return;
   }
   
-  // Try to get a block for the FIR output
-  blockOut_i = AudioStream_F32::allocate_f32();
+  // Try to get a block for the FIR output, the size of the input
+  blockOut_i = AudioStream_F32::allocate_f32(block_i->length, block_i->fs_Hz);
   if (!blockOut_i){      // Didn't have any
     if(errorPrint)  Serial.println("FIL90-ERR: No out 0 block");
     AudioStream_F32::release(block_i);  
@@ -62,11 +250,8 @@ void AudioFilter90Deg_F32::update(void)
     return;
   }
 
-  // Apply the Hilbert transform FIR.  This includes multiplies by zero.
-  // Is there any way to play with the indexes and not multiply by zero
-  // without spending more time than is saved? How about something like
-  //           pick right nn,  then   for(j=0; j<fir_length; j+=2)   {sum += coef[j] * data[j+nn];}
-  arm_fir_f32(&Ph90Deg_inst, block_i->data, blockOut_i->data, block_i->length);
+  // Apply the Hilbert transform FIR, without the multiplies by zero
+  Ph90Deg_inst.process(block_i->data, blockOut_i->data, block_i->length);
   AudioStream_F32::release(block_i);     // Not needed further
   
   // Now enter block_size points to the delay loop and move earlier points to re-used block
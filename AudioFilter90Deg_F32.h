@@ -56,8 +56,39 @@
  *    251 tap Hilbert (including 0's) 646 microseconds
  *   Same 121 tap Hilbert on T4.0 is 57 microseconds per update()
  *   Same 251 tap Hilbert on T4.0 is 114 microseconds per update()
+ *   These times include the zero taps.  Since Oct 2026 the FIR is
+ *   FIRKernel_F32 that skips them and pairs the antisymmetric taps, so
+ *   about N/4 multiplies per sample, in place of N.
  *
  * Rev 7 Feb 23 - Corrected type cast and comments.  RSL
+ *
+ * Oct 2026 - IIR mode.  beginIIR() replaces the FIR and delay by a pair of
+ * all-pass cascades, the half-band polyphase IIR of Valenzuela and
+ * Constantinides moved up by fs/4.  Each section is one multiply, and the
+ * two paths stay 90 degrees apart to within maxError_deg from fLow_Hz to
+ * fs/2 - fLow_Hz.  The coefficients are designed here for these.  For
+ * example 0.5 degree from 200 Hz at 44.1 kHz is 6 multiplies per sample,
+ * where the 121 tap FIR is 121.  The phase of each path is not linear, only
+ * the difference is held, which is what a phasing SSB modulator or
+ * demodulator needs.  Out 0 lags Out 1, as with the hilbert19A-251A FIRs.
+ *
+ * With decimate true, In 0 is a real signal at fs and Out 0 and Out 1 are
+ * I and Q at fs/2, I + jQ holding the positive frequencies.  Each update
+ * sends block_size/2 samples, with block->length and fs_Hz set, as for
+ * AudioFilterDecimate_F32.  Each path runs at fs/2, on the even and odd
+ * input samples, so this is half the multiplies again.
+ * Input at f comes out at f up to fs/4, and at f - fs/2 above that.  In 1
+ * is not used.
+ *
+ * More functions:
+ *   beginIIR(fLow_Hz, maxError_deg, decimate)  Designs and starts the IIR.
+ *         Returns the number of all-pass sections, 0 if not possible in
+ *         HILBERT_IIR_MAX_COEFFS.
+ *   beginIIR(pCoeff, nCoeff, decimate)  The same with given coefficients,
+ *         in increasing order.  The even ones are for Out 1, or Out 0 when
+ *         decimating, and the odd ones for the other, with a z^-1.
+ *   getLatencySamples()  For IIR the mean group delay of the paths at fs/4,
+ *         at the input rate.
  */
 
 #ifndef _filter_90deg_f32_h
@@ -65,33 +96,42 @@
 
 #include "AudioStream_F32.h"
 #include "arm_math.h"
+#include "FIRKernel_F32.h"
 
 #define TEST_TIME_90D 1
 
 // Following supports a maximum FIR Hilbert Transform of 251
 #define HILBERT_MAX_COEFFS 251
+// All-pass sections for both paths of the IIR
+#define HILBERT_IIR_MAX_COEFFS 16
+
+#define HILBERT_FIR      0
+#define HILBERT_IIR      1
+#define HILBERT_IIR_DEC2 2
 
 class AudioFilter90Deg_F32 : public AudioStream_F32 {
 //GUI: inputs:2, outputs:2  //this line used for automatic generation of GUI node
 //GUI: shortName: 90DegPhase
 public:
-    // Option of AudioSettings_F32 change to block size (no sample rate dependent variables here):
+    // Option of AudioSettings_F32 change to block size (sample rate is only for beginIIR()):
     AudioFilter90Deg_F32(void) :  AudioStream_F32(2, inputQueueArray_f32) {
         block_size = AUDIO_BLOCK_SAMPLES;
     }
     AudioFilter90Deg_F32(const AudioSettings_F32 &settings) :  AudioStream_F32(2, inputQueueArray_f32) {
         block_size = settings.audio_block_samples;
+        sample_rate_Hz = settings.sample_rate_Hz;
     }
 
     // Initialize the 90Deg by giving it the filter coefficients and number of coefficients
     // Then the delay line for the q (Right) channel is initialized
     void begin(const float32_t *cp, const int _n_coeffs) {
+        mode = HILBERT_FIR;
         coeff_p = cp;
         n_coeffs = _n_coeffs;
 
-        // Initialize FIR instance (ARM DSP Math Library)  (for f32 the return is always void)
+        // Initialize the FIR, that skips the zero taps of the Hilbert
         if (coeff_p!=NULL  && n_coeffs<252) {
-            arm_fir_init_f32(&Ph90Deg_inst, n_coeffs, (float32_t *)coeff_p,  &StateF32[0], block_size);
+            Ph90Deg_inst.init(n_coeffs, coeff_p,  &StateF32[0], block_size);
         }
         else {
             coeff_p = NULL;     // Stops further FIR filtering for Hilbert
@@ -108,6 +148,17 @@ public:
         }
     }       // End of begin()
 
+    // Both the i and the q outputs are delayed by (n_coeffs-1)/2, the q
+    // path by the equalizing delay line, so the two paths are already aligned.
+    uint32_t getLatencySamples(void) {
+        if(mode != HILBERT_FIR)
+            return iirLatency;
+        return (coeff_p==NULL) ? 0 : (uint32_t)n_delay;
+    }
+
+    uint16_t beginIIR(float32_t fLow_Hz, float32_t maxError_deg=0.5f, bool decimate=false);
+    uint16_t beginIIR(const float32_t *pCoeff, uint16_t nCoeff, bool decimate=false);
+
     void showError(uint16_t e) {
         errorPrint = e;
     }
@@ -116,6 +167,7 @@ public:
 
 private:
     uint16_t block_size =  AUDIO_BLOCK_SAMPLES;
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE_EXACT;
     // Two input data pointers
     audio_block_f32_t *inputQueueArray_f32[2];
     // One output pointer
@@ -148,8 +200,20 @@ int32_t iitt = 999000;     // count up to a million during startup
     uint16_t delayBufferMask = 0X00FF;
     uint16_t n_delay;
 
-    // ARM DSP Math library filter instance
-    arm_fir_instance_f32 Ph90Deg_inst;
+    // The Hilbert FIR, antisymmetric with every other tap zero
+    FIRKernel_F32 Ph90Deg_inst;
     float32_t StateF32[AUDIO_BLOCK_SAMPLES + HILBERT_MAX_COEFFS];
+
+    // IIR, the sections of path p are iirC[p][] with, for each, the last
+    // input and output, and for the full rate the two before those.  Path 0
+    // is the even coefficients and path 1 the odd, with a z^-1.
+    uint16_t mode = HILBERT_FIR;
+    uint16_t nIIR[2] = {0, 0};
+    float32_t iirC[2][HILBERT_IIR_MAX_COEFFS/2];
+    float32_t iirState[2][HILBERT_IIR_MAX_COEFFS/2][4];
+    float32_t qLast = 0.0f;        // The z^-1 of path 1
+    uint32_t iirLatency = 0;
+    void allpass(int path, float32_t *pData, uint16_t n);
+    void updateIIR(void);
 };
 #endif
@@ -0,0 +1,73 @@
+/*
+ * AudioFilterBiquadMulti_F32.cpp
+ *
+ * See AudioFilterBiquadMulti_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioFilterBiquadMulti_F32.h"
+
+void AudioFilterBiquadMulti_F32::update(void)  {
+  audio_block_f32_t *block[BIQUAD_MULTI_CHANNELS];
+  const int nc = BIQUAD_MULTI_CHANNELS;     // Interleave stride
+  int nCh = numChannels;
+  int ch, jj, ii;
+  bool any = false;
+
+  // Channels above nCh pass through
+  for(ch=nCh; ch<BIQUAD_MULTI_CHANNELS; ch++)  {
+     audio_block_f32_t *b = AudioStream_F32::receiveReadOnly_f32(ch);
+     if(b)  {
+        AudioStream_F32::transmit(b, ch);
+        AudioStream_F32::release(b);
+        }
+     }
+
+  for(ch=0; ch<nCh; ch++)  {
+     block[ch] = AudioStream_F32::receiveWritable_f32(ch);
+     if(block[ch])  {
+        any = true;
+        for(jj=0; jj<block_size; jj++)
+           work[jj*nc + ch] = block[ch]->data[jj];
+        }
+     else  {
+        for(jj=0; jj<block_size; jj++)
+           work[jj*nc + ch] = 0.0f;
+        }
+     }
+  if(!any)
+     return;
+
+  if(doBiquad)  {
+     for(ii=0; ii<numStagesUsed; ii++)  {
+        float b0 = coeff32[5*ii];
+        float b1 = coeff32[5*ii + 1];
+        float b2 = coeff32[5*ii + 2];
+        float a1 = coeff32[5*ii + 3];
+        float a2 = coeff32[5*ii + 4];
+        float* s1 = &state[2*ii*nc];
+        float* s2 = s1 + nc;
+        float* px = work;
+        for(jj=0; jj<block_size; jj++, px+=nc)  {
+           // Independent across channels
+           for(ch=0; ch<nCh; ch++)  {
+              float x = px[ch];
+              float y = b0*x + s1[ch];
+              s1[ch] = b1*x + a1*y + s2[ch];
+              s2[ch] = b2*x + a2*y;
+              px[ch] = y;
+              }
+           }
+        }
+     }
+
+  for(ch=0; ch<nCh; ch++)  {
+     if(!block[ch])
+        continue;
+     for(jj=0; jj<block_size; jj++)
+        block[ch]->data[jj] = work[jj*nc + ch];
+     AudioStream_F32::transmit(block[ch], ch);
+     AudioStream_F32::release(block[ch]);
+     }
+}
@@ -0,0 +1,173 @@
+/*
+ * AudioFilterBiquadMulti_F32.h
+ *
+ * The same biquad cascade applied to 1 to 8 channels, such as both ears of
+ * a hearing aid or all channels of a speaker EQ.  Up to IIR_MAX_STAGES
+ * stages, as AudioFilterBiquad_F32, and the same design functions.  The
+ * structure is transposed direct form 2, in float.
+ *
+ * The channels are interleaved and the inner loop runs across channels.
+ * A single biquad is limited by the latency of each multiply-add, as every
+ * output needs the one before.  Across channels there is no dependence,
+ * so several channels take little more time than one on the T4 FPU, and
+ * the loop vectorizes on processors with SIMD float.
+ *
+ * setNumChannels(n) filters inputs 0 to n-1.  Inputs n and above are
+ * passed through.  Unconnected inputs below n are filtered as zero and
+ * have no output.
+ *
+ * Functions:
+ *   setNumChannels(n)        1 to BIQUAD_MULTI_CHANNELS, default 2
+ *   setCoefficients(stage, cf)  double cf[5], b0, b1, b2, a1, a2 (CMSIS signs)
+ *   setLowpass(), setHighpass(), setBandpass(), setNotch(), setLowShelf(),
+ *   setHighShelf(), setPeakingEQ()  As AudioFilterBiquad_F32
+ *   begin()                  Required after setting coefficients
+ *   end()                    Pass through
+ *   getCoeffs()              Pointer to the double coefficients
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioFilterBiquadMulti_F32_h_
+#define AudioFilterBiquadMulti_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#include "AudioFilterBiquad_F32.h"
+
+#define BIQUAD_MULTI_CHANNELS 8
+
+class AudioFilterBiquadMulti_F32 : public AudioStream_F32
+{
+//GUI: inputs:8, outputs:8  //this line used for automatic generation of GUI nodes
+//GUI: shortName:biquadMulti
+public:
+    AudioFilterBiquadMulti_F32(void): AudioStream_F32(BIQUAD_MULTI_CHANNELS, inputQueueArray) {
+        sampleRate_Hz = AUDIO_SAMPLE_RATE_EXACT;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        doClassInit();
+        }
+
+    AudioFilterBiquadMulti_F32(const AudioSettings_F32 &settings):
+                 AudioStream_F32(BIQUAD_MULTI_CHANNELS, inputQueueArray) {
+        sampleRate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        doClassInit();
+        }
+
+    void doClassInit(void)  {
+        for(int ii=0; ii<5*IIR_MAX_STAGES; ii++)  {
+           coeff32[ii] = 0.0f;
+           coeff64[ii] = 0.0;
+           }
+        for(int ii=0; ii<IIR_MAX_STAGES; ii++)  {
+           coeff32[5*ii] = 1.0f;  // b0 = 1 for pass through
+           coeff64[5*ii] = 1.0;
+           }
+        clearState();
+        numStagesUsed = 0;
+        doBiquad = false;
+        }
+
+    void setNumChannels(int n)  {
+        if(n < 1)  n = 1;
+        if(n > BIQUAD_MULTI_CHANNELS)  n = BIQUAD_MULTI_CHANNELS;
+        numChannels = n;
+        }
+    int getNumChannels(void) { return numChannels; }
+
+    void setCoefficients(int iStage, double *cf)  {
+        if (iStage < 0 || iStage >= IIR_MAX_STAGES)
+           return;
+        if((iStage + 1) > numStagesUsed)
+           numStagesUsed = iStage + 1;
+        for(int ii=0; ii<5; ii++)  {
+           coeff64[ii + 5*iStage] = cf[ii];
+           coeff32[ii + 5*iStage] = (float)cf[ii];
+           }
+        }
+
+    // Clears the filter state and starts filtering.  Required after
+    // the coefficients are set.
+    void begin(void) {
+        __disable_irq();
+        clearState();
+        doBiquad = true;
+        __enable_irq();
+        }
+
+    void end(void) {
+        doBiquad = false;
+        }
+
+    void setSampleRate_Hz(float _fs_Hz) { sampleRate_Hz = _fs_Hz; }
+
+    void setLowpass(int stage, float frequency, float q) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designLowpass(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setHighpass(int stage, float frequency, float q) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designHighpass(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setBandpass(int stage, float frequency, float q) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designBandpass(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setNotch(int stage, float frequency, float q) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designNotch(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setLowShelf(int stage, float frequency, float gain, float slope) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designLowShelf(coeff, sampleRate_Hz, frequency, gain, slope);
+        setCoefficients(stage, coeff);
+        }
+
+    void setHighShelf(int stage, float frequency, float gain, float slope) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designHighShelf(coeff, sampleRate_Hz, frequency, gain, slope);
+        setCoefficients(stage, coeff);
+        }
+
+    void setPeakingEQ(int stage, float frequency, float q, float gain) {
+        double coeff[5];
+        AudioFilterBiquad_F32::designPeakingEQ(coeff, sampleRate_Hz, frequency, q, gain);
+        setCoefficients(stage, coeff);
+        }
+
+    double* getCoeffs(void)  {
+        return coeff64;
+        }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray[BIQUAD_MULTI_CHANNELS];
+    float sampleRate_Hz = AUDIO_SAMPLE_RATE_EXACT;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    int numChannels = 2;
+    int numStagesUsed = 0;
+    bool doBiquad = false;
+    float  coeff32[5*IIR_MAX_STAGES];
+    double coeff64[5*IIR_MAX_STAGES];
+    // DF2T state, two rows of BIQUAD_MULTI_CHANNELS per stage
+    float  state[2*IIR_MAX_STAGES*BIQUAD_MULTI_CHANNELS];
+    // Interleaved data, sample n of channel c at work[n*BIQUAD_MULTI_CHANNELS+c]
+    float  work[AUDIO_BLOCK_SAMPLES*BIQUAD_MULTI_CHANNELS];
+
+    void clearState(void)  {
+        for(int ii=0; ii<2*IIR_MAX_STAGES*BIQUAD_MULTI_CHANNELS; ii++)
+           state[ii] = 0.0f;
+        }
+};
+#endif
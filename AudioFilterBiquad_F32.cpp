@@ -13,15 +13,296 @@
 */
 #include "AudioFilterBiquad_F32.h"
 
+// ARM DSP Math library filter instance.
+// Does the initialization of ARM CMSIS DSP BiQuad  structure.  This MUST follow the
+// setting of coefficients to catch the max number of stages and do the
+// double to float conversion for the CMSIS routine.
+void AudioFilterBiquad_F32::begin(void) {
+  __disable_irq();
+  // Already running as set up?  Keep the state and glide.
+  if(running && structure==runStructure && numStagesUsed>=runStages &&
+         runDouble==(useDoubleCoefs && (structure != BIQUAD_LATTICE)))  {
+     newCoeffs = true;
+     __enable_irq();
+     return;
+     }
+
+  // All stages, so that unused ones are pass throughs for a later glide
+  for(int ii=0; ii<5*IIR_MAX_STAGES; ii++)  {
+     coeff32[ii] = (float)coeff64[ii];
+#ifndef NEVER_DOUBLE
+     coeffRun64[ii] = coeff64[ii];
+#endif
+     }
+  for(int ii=0; ii<IIR_MAX_STAGES; ii++)
+     makeLattice(&coeff64[5*ii], &latticeC[5*ii]);
+  runStages = numStagesUsed;
+
+  // Initialize BiQuad instance (ARM DSP Math Library)
+  //https://www.keil.com/pack/doc/CMSIS/DSP/html/group__BiquadCascadeDF1.html
+  if(structure == BIQUAD_DF2T)
+     arm_biquad_cascade_df2T_init_f32(&iir_df2T_inst, runStages, &coeff32[0],  &StateF32[0]);
+  else
+     arm_biquad_cascade_df1_init_f32(&iir_inst, runStages, &coeff32[0],  &StateF32[0]);
+  for(int ii=0; ii<4*IIR_MAX_STAGES; ii++)  {
+     StateF32[ii] = 0.0f;
+#ifndef NEVER_DOUBLE
+     StateF64[ii] = 0.0;
+#endif
+     }
+  runStructure = structure;
+  runDouble = useDoubleCoefs && (structure != BIQUAD_LATTICE);
+  newCoeffs = false;
+  glideLeft = 0;
+  running = true;
+  __enable_irq();
+}
+
+// Lattice-ladder form of one stage.  With A(z) = 1 + d1/z + d2/z^2,
+// d1 = -a1 and d2 = -a2, the reflection coefficients are k2 = d2 and
+// k1 = d1/(1 + d2).  The ladder taps make the numerator from the
+// backward polynomials 1, k1 + 1/z and d2 + d1/z + 1/z^2.
+// Poles near z=1 put k1 near -1 and k2 near 1, where a float has
+// few bits left for the difference, so 1+k1 and 1-k2 are stored.
+void AudioFilterBiquad_F32::makeLattice(const double *c, float *pL)  {
+  double d1 = -c[3];
+  double d2 = -c[4];
+  double k1 = d1/(1.0 + d2);
+  double v2 = c[2];
+  double v1 = c[1] - v2*d1;
+  pL[0] = (float)((1.0 + d1 + d2)/(1.0 + d2));  // 1+k1
+  pL[1] = (float)(1.0 - d2);                    // 1-k2
+  pL[2] = (float)(c[0] - v1*k1 - v2*d2);
+  pL[3] = (float)v1;
+  pL[4] = (float)v2;
+}
+
+// New coefficients have been set while running.  Called from update(),
+// so nothing changes part way through a block.
+void AudioFilterBiquad_F32::startGlide(void)  {
+  newCoeffs = false;
+  if(numStagesUsed > runStages)  {
+     // The added stages are pass throughs with clear state
+     runStages = numStagesUsed;
+     iir_inst.numStages = runStages;
+     iir_df2T_inst.numStages = runStages;
+     }
+  if(runStructure == BIQUAD_LATTICE)  {
+     for(int ii=0; ii<runStages; ii++)
+        makeLattice(&coeff64[5*ii], &coeffTarget32[5*ii]);
+     }
+  else  {
+     for(int ii=0; ii<5*runStages; ii++)
+        coeffTarget32[ii] = (float)coeff64[ii];
+     }
+  glideLeft = glideSamples;
+  if(glideLeft == 0)  {  // Jump
+     float* pC = (runStructure == BIQUAD_LATTICE) ? latticeC : coeff32;
+     for(int ii=0; ii<5*runStages; ii++)  {
+        pC[ii] = coeffTarget32[ii];
+#ifndef NEVER_DOUBLE
+        coeffRun64[ii] = coeff64[ii];
+#endif
+        }
+     }
+}
+
 void AudioFilterBiquad_F32::update(void)  {
   audio_block_f32_t *block;
 
   block = AudioStream_F32::receiveWritable_f32();
   if (!block) return;  // Out of memory
-  if(doBiquad)   // Filter is defined, so go to it
-  arm_biquad_cascade_df1_f32(&iir_inst, block->data,
+  if(doBiquad)  {  // Filter is defined, so go to it
+     if(newCoeffs)
+        startGlide();
+#ifndef NEVER_DOUBLE
+     if(runDouble)
+        updateDouble(block->data, block->length);
+     else
+#endif
+     if(runStructure == BIQUAD_LATTICE)
+        updateLattice(block->data, block->length);
+     else if(glideLeft > 0)
+        updateGlide(block->data, block->length);
+     else if(runStructure == BIQUAD_DF2T)
+        arm_biquad_cascade_df2T_f32(&iir_df2T_inst, block->data,
+           block->data, block->length);
+     else
+        arm_biquad_cascade_df1_f32(&iir_inst, block->data,
            block->data, block->length);
+     }
   // Transmit the data, filtered or unfiltered
   AudioStream_F32::transmit(block);
   AudioStream_F32::release(block);
 }
+
+// DF1 and DF2T in float while gliding, with the CMSIS state layouts, so
+// the CMSIS routines carry on after the glide.  Each coefficient moves
+// by 1/glideLeft of the way to its target per sample, for m samples.
+void AudioFilterBiquad_F32::updateGlide(float32_t *pData, uint16_t n)  {
+  uint16_t m = (n < glideLeft) ? n : glideLeft;
+  float rLeft = 1.0f/(float)glideLeft;
+  float x, y;
+
+  for(int ii=0; ii<runStages; ii++)  {
+     float* c = &coeff32[5*ii];
+     float* t = &coeffTarget32[5*ii];
+     float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+     float db0 = (t[0]-b0)*rLeft, db1 = (t[1]-b1)*rLeft, db2 = (t[2]-b2)*rLeft;
+     float da1 = (t[3]-a1)*rLeft, da2 = (t[4]-a2)*rLeft;
+     if(runStructure == BIQUAD_DF2T)  {
+        float* st = &StateF32[2*ii];
+        float s1 = st[0];
+        float s2 = st[1];
+        for(int jj=0; jj<n; jj++)  {
+           if(jj < m)  {
+              b0 += db0;  b1 += db1;  b2 += db2;  a1 += da1;  a2 += da2;
+              }
+           x = pData[jj];
+           y = b0*x + s1;
+           s1 = b1*x + a1*y + s2;
+           s2 = b2*x + a2*y;
+           pData[jj] = y;
+           }
+        st[0] = s1;
+        st[1] = s2;
+        }
+     else  {
+        float* st = &StateF32[4*ii];
+        float x1 = st[0];
+        float x2 = st[1];
+        float y1 = st[2];
+        float y2 = st[3];
+        for(int jj=0; jj<n; jj++)  {
+           if(jj < m)  {
+              b0 += db0;  b1 += db1;  b2 += db2;  a1 += da1;  a2 += da2;
+              }
+           x = pData[jj];
+           y = b0*x + b1*x1 + b2*x2 + a1*y1 + a2*y2;
+           x2 = x1;   x1 = x;
+           y2 = y1;   y1 = y;
+           pData[jj] = y;
+           }
+        st[0] = x1;   st[1] = x2;
+        st[2] = y1;   st[3] = y2;
+        }
+     if(m == glideLeft)  {  // Done, end exactly on the target
+        for(int kk=0; kk<5; kk++)  c[kk] = t[kk];
+        }
+     else  {
+        c[0] = b0;  c[1] = b1;  c[2] = b2;  c[3] = a1;  c[4] = a2;
+        }
+     }
+  glideLeft -= m;
+}
+
+// Each stage is a two pole lattice with g0 and g1, the backward outputs
+// of the last sample, as the state.  The ladder sums the backward outputs.
+// With c1 = 1+k1 and c2 = 1-k2 the lattice is
+//    f1 = x - k2*g1 = x - g1 + c2*g1     g2' = k2*f1 + g1 = f1 + g1 - c2*f1
+//    f0 = f1 - k1*g0 = f1 + g0 - c1*g0   g1' = k1*f0 + g0 = g0 - f0 + c1*f0
+// While gliding, the five values move to coeffTarget32[] as in updateGlide().
+void AudioFilterBiquad_F32::updateLattice(float32_t *pData, uint16_t n)  {
+  uint16_t m = (n < glideLeft) ? n : glideLeft;
+  float rLeft = (glideLeft > 0) ? 1.0f/(float)glideLeft : 0.0f;
+
+  for(int ii=0; ii<runStages; ii++)  {
+     float* pL = &latticeC[5*ii];
+     float* t = &coeffTarget32[5*ii];
+     float c1 = pL[0];
+     float c2 = pL[1];
+     float v0 = pL[2];
+     float v1 = pL[3];
+     float v2 = pL[4];
+     float dc1 = (t[0]-c1)*rLeft, dc2 = (t[1]-c2)*rLeft;
+     float dv0 = (t[2]-v0)*rLeft, dv1 = (t[3]-v1)*rLeft, dv2 = (t[4]-v2)*rLeft;
+     float g0 = StateF32[2*ii];
+     float g1 = StateF32[2*ii + 1];
+     for(int jj=0; jj<n; jj++)  {
+        if(jj < m)  {
+           c1 += dc1;  c2 += dc2;  v0 += dv0;  v1 += dv1;  v2 += dv2;
+           }
+        float f1 = (pData[jj] - g1) + c2*g1;
+        float f0 = (f1 + g0) - c1*g0;
+        float g2New = (f1 + g1) - c2*f1;
+        float g1New = (g0 - f0) + c1*f0;
+        pData[jj] = v0*f0 + v1*g1New + v2*g2New;
+        g0 = f0;
+        g1 = g1New;
+        }
+     StateF32[2*ii] = g0;
+     StateF32[2*ii + 1] = g1;
+     if(m > 0)  {
+        if(m == glideLeft)
+           for(int kk=0; kk<5; kk++)  pL[kk] = t[kk];
+        else  {
+           pL[0] = c1;  pL[1] = c2;  pL[2] = v0;  pL[3] = v1;  pL[4] = v2;
+           }
+        }
+     }
+  glideLeft -= m;
+}
+
+#ifndef NEVER_DOUBLE
+// The cascade in double, one stage at a time through a double buffer.
+// DF1 state is x[n-1], x[n-2], y[n-1], y[n-2] and DF2T is two sums.
+// While gliding, coeffRun64[] moves to coeff64[] as in updateGlide().
+void AudioFilterBiquad_F32::updateDouble(float32_t *pData, uint16_t n)  {
+  double work[AUDIO_BLOCK_SAMPLES];
+  double x, y;
+  double c[5], dc[5];
+
+  if(n > AUDIO_BLOCK_SAMPLES)  n = AUDIO_BLOCK_SAMPLES;
+  uint16_t m = (n < glideLeft) ? n : glideLeft;
+  double rLeft = (glideLeft > 0) ? 1.0/(double)glideLeft : 0.0;
+  for(int jj=0; jj<n; jj++)
+     work[jj] = (double)pData[jj];
+  for(int ii=0; ii<runStages; ii++)  {
+     double* pC = &coeffRun64[5*ii];
+     double* t = &coeff64[5*ii];
+     for(int kk=0; kk<5; kk++)  {
+        c[kk] = pC[kk];
+        dc[kk] = (t[kk] - c[kk])*rLeft;
+        }
+     double* st = &StateF64[4*ii];
+     if(runStructure == BIQUAD_DF2T)  {
+        double s1 = st[0];
+        double s2 = st[1];
+        for(int jj=0; jj<n; jj++)  {
+           if(jj < m)
+              for(int kk=0; kk<5; kk++)  c[kk] += dc[kk];
+           x = work[jj];
+           y = c[0]*x + s1;
+           s1 = c[1]*x + c[3]*y + s2;
+           s2 = c[2]*x + c[4]*y;
+           work[jj] = y;
+           }
+        st[0] = s1;
+        st[1] = s2;
+        }
+     else  {
+        double x1 = st[0];
+        double x2 = st[1];
+        double y1 = st[2];
+        double y2 = st[3];
+        for(int jj=0; jj<n; jj++)  {
+           if(jj < m)
+              for(int kk=0; kk<5; kk++)  c[kk] += dc[kk];
+           x = work[jj];
+           y = c[0]*x + c[1]*x1 + c[2]*x2 + c[3]*y1 + c[4]*y2;
+           x2 = x1;   x1 = x;
+           y2 = y1;   y1 = y;
+           work[jj] = y;
+           }
+        st[0] = x1;   st[1] = x2;
+        st[2] = y1;   st[3] = y2;
+        }
+     if(m > 0)
+        for(int kk=0; kk<5; kk++)
+           pC[kk] = (m == glideLeft) ? t[kk] : c[kk];
+     }
+  glideLeft -= m;
+  for(int jj=0; jj<n; jj++)
+     pData[jj] = (float32_t)work[jj];
+}
+#endif
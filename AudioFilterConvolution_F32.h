@@ -34,7 +34,7 @@
    *   AudioConnection_F32         patchCord2(FilterConv,0,Output_i2s,1);
    *
    * There are three class functions:
-   *    void initFilter(float32_t fc, float32_t Astop,
+   *    bool initFilter(float32_t fc, float32_t Astop,
    *                     int type, float32_t dfc);
    *    void passThrough(int stat);
    *    float32_t* getCoeffPtr(void);
@@ -71,8 +71,8 @@
    *
    * getCoeffPtr() returns a pointer to the coefficient array. To use this, compute
    * the coefficients of a 512 tap FIR filter with the desired response.  Then
-   * load the 512 float32_t buffer with the coefficients.  Disabling the audio
-   * path may be needed to prevent "pop" noises.
+   * load the 512 float32_t buffer with the coefficients, and call initFilter()
+   * to make the mask from them.
    *
    * An alternate way to specify
    *
@@ -100,6 +100,24 @@
    * Removed #defines that were not needed. Thanks K7MDL. Bob 6 Mar 2022
    * Separated Teensy 3 and 4 parts. Thanks Paul  Bob  16 Jan 2023
    *
+   * Oct 2026 - initFilter() while running no longer stops the audio or
+   * clicks.  The new mask is made, in the calling function, in a second mask
+   * buffer and update() changes over at the start of the next 512 sample
+   * frame.  For that frame both masks are used, the new one to build up its
+   * overlap, and the old one for the output.  The next frame is crossfaded
+   * from the old to the new filter.  This is two frames, about 23 ms at
+   * 44.1 kHz, with twice the FFT work.  A second initFilter() during this
+   * does not wait.  It returns false, busy, and the mask is not changed, so
+   * call it again later, as from loop().  The coefficients are still
+   * designed, and cached, so the retry is quick.  Otherwise initFilter()
+   * returns true.  The first initFilter() starts the audio, as before.
+   * Only update() ends a crossfade, so if update() has stopped, as with
+   * the audio stopped, call endCrossfade() before initFilter().
+   * The same applies to initFilter(void) after loading new coefficients
+   * through getCoeffPtr().  8 kB more memory is used.
+   * The Kaiser window is from FIRDesign_F32, and kept for the next design,
+   * and designs from initFilter() are cached there.
+   *
    * ************************************************************ */
 // Only exists for T3.5 through T4.1:
 #if defined(__MK64FX512__) || defined(__MK66FX1M0__) || defined(__IMXRT1062__)
@@ -110,6 +128,7 @@
 #include <AudioStream_F32.h>
 #include "arm_math.h"
 #include "arm_common_tables.h"
+#include "FIRDesign_F32.h"
 
 #if defined(__IMXRT1062__)
 #include "arm_const_structs.h"
@@ -157,10 +176,19 @@ public:
 
   virtual void update(void);
   void passThrough(int stat);
-  void initFilter (void) {impulse(FIR_Coef);}
-  void initFilter (float32_t fc, float32_t Astop,
+  // Both return false if busy with the last change, see notes above
+  bool initFilter (void) {return impulse(FIR_Coef);}
+  bool initFilter (float32_t fc, float32_t Astop,
                    int type, float32_t dfc);
   float32_t* getCoeffPtr(void) {return &FIR_Coef[0];}
+  // Only update() finishes a crossfade.  If it is no longer being called,
+  // as when the audio is stopped, this ends one so initFilter() can work.
+  void endCrossfade(void) {fadeStage = 0;}
+  // The 512 samples of block buffering plus the group delay of the
+  // linear phase filter from initFilter().  Not counted in passThrough().
+  uint32_t getLatencySamples(void) {
+     return passThru ? 512 : 512 + (MAX_NUMCOEF - 1)/2;
+     }
 
 private:
   float32_t fs;
@@ -174,15 +202,19 @@ private:
   int enabled=0;
   float32_t FIR_Coef[MAX_NUMCOEF];
   const uint32_t FFT_length = 1024;
-  float32_t FIR_filter_mask[2048] __attribute__((aligned(4)));
+  // [maskNow] is in use, the other is the new, or the fading out, mask
+  float32_t FIR_filter_mask[2][2048] __attribute__((aligned(4)));
+  int maskNow = 0;
+  volatile bool maskPending = false;  // New mask waiting for update()
+  volatile int fadeStage = 0;         // 1 builds up the new overlap, 2 crossfades
+  float32_t last_sample_buffer_old[512];
   float32_t buffer[2048] __attribute__((aligned(4)));
   float32_t tbuffer[2048]__attribute__((aligned(4)));
   float32_t FFT_buffer[2048] __attribute__((aligned(4)));
   float32_t iFFT_buffer[2048] __attribute__((aligned(4)));
   float32_t last_sample_buffer_L[512];
-  void impulse(float32_t *coefs);
+  bool impulse(float32_t *coefs);
                                                            int aaa = 0;
-  float32_t Izero (float32_t x);
   float32_t m_sinc(int m, float32_t fc);
   void      calc_FIR_coeffs (float32_t * coeffs, int numCoeffs,
                              float32_t fc, float32_t Astop,
@@ -0,0 +1,234 @@
+/*
+ * AudioFilterDecimate_F32.cpp
+ *
+ * See AudioFilterDecimate_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioFilterDecimate_F32.h"
+
+uint16_t AudioFilterDecimate_F32::begin(uint16_t _ratio, float32_t passband_Hz,
+                                        float32_t atten_dB)  {
+    FIRDesign_F32::stage newStages[MULTIRATE_MAX_STAGES];
+    FIRDesign_F32::stage oldStages[MULTIRATE_MAX_STAGES];
+    uint16_t nNew = 0;
+    uint16_t nOld;
+    float32_t *newBuffer = NULL;
+    float32_t *oldBuffer;
+    uint16_t r = _ratio;
+
+    if(_ratio<1 || _ratio>DECIMATE_MAX_RATIO)
+        return ERR_DECIMATE_RATIO;
+    while((r & 1) == 0)  r /= 2;
+    while(r%3 == 0)      r /= 3;
+    while(r%5 == 0)      r /= 5;
+    while(r%7 == 0)      r /= 7;
+    if(r != 1)
+        return ERR_DECIMATE_RATIO;
+    if(passband_Hz <= 0.0f)
+        passband_Hz = 0.4f*sample_rate_Hz/(float32_t)_ratio;
+    if(passband_Hz >= 0.5f*sample_rate_Hz/(float32_t)_ratio)
+        return ERR_DECIMATE_BAND;
+
+    if(_ratio > 1)  {
+        nNew = FIRDesign_F32::multirateStages(_ratio, passband_Hz/sample_rate_Hz,
+                        atten_dB, newStages, MULTIRATE_MAX_STAGES);
+        if(nNew == 0)
+            return ERR_DECIMATE_MEMORY;
+        uint32_t size = 0;
+        uint16_t nIn = block_size;
+        for(int s=0; s<nNew; s++)  {
+            size += newStages[s].nTaps - 1 + nIn;
+            nIn = nIn/newStages[s].factor + 1;
+            }
+        newBuffer = new float32_t[2*size];
+        if(newBuffer == NULL)  {
+            FIRDesign_F32::freeStages(newStages, nNew);
+            return ERR_DECIMATE_MEMORY;
+            }
+        for(uint32_t i=0; i<2*size; i++)
+            newBuffer[i] = 0.0f;
+        }
+
+    // Change over, with update() held off
+    __disable_irq();
+    nOld = nStages;
+    oldBuffer = buffer;
+    for(int s=0; s<MULTIRATE_MAX_STAGES; s++)  {
+        oldStages[s] = stages[s];
+        stages[s] = newStages[s];
+        }
+    nStages = nNew;
+    buffer = newBuffer;
+    ratio = _ratio;
+    outBlock = islandBlock();
+    float32_t *p = buffer;
+    uint16_t nIn = block_size;
+    for(int ch=0; ch<2; ch++)  {
+        nIn = block_size;
+        for(int s=0; s<nStages; s++)  {
+            pBuf[ch][s] = p;
+            p += stages[s].nTaps - 1 + nIn;
+            nIn = nIn/stages[s].factor + 1;
+            phase[ch][s] = 0;
+            }
+        outCount[ch] = 0;
+        }
+    __enable_irq();
+
+    FIRDesign_F32::freeStages(oldStages, nOld);
+    if(oldBuffer)  delete [] oldBuffer;
+    releasePending();
+    return 0;
+    }
+
+void AudioFilterDecimate_F32::setOutputBlock(uint16_t n)  {
+    if(n > AUDIO_BLOCK_SAMPLES)  n = AUDIO_BLOCK_SAMPLES;
+    __disable_irq();
+    outBlockSet = n;
+    outBlock = islandBlock();
+    __enable_irq();
+    releasePending();
+    }
+
+// Drop any partly filled blocks.  release() turns interrupts back on, so
+// they are taken first and released after.
+void AudioFilterDecimate_F32::releasePending(void)  {
+    audio_block_f32_t *p[2];
+    __disable_irq();
+    for(int ch=0; ch<2; ch++)  {
+        p[ch] = pending[ch];
+        pending[ch] = NULL;
+        nPending[ch] = 0;
+        }
+    __enable_irq();
+    for(int ch=0; ch<2; ch++)
+        if(p[ch])  AudioStream_F32::release(p[ch]);
+    }
+
+// Samples at the input rate.  For an island, the updates until the first
+// block is full, which is when the interpolator starts its output.
+uint32_t AudioFilterDecimate_F32::getLatencySamples(void)  {
+    uint32_t rate = 1;
+    uint32_t wait = 0;
+    float32_t d = 0.0f;
+    for(int s=0; s<nStages; s++)  {
+        d += 0.5f*(float32_t)(stages[s].nTaps - 1)*(float32_t)rate;
+        rate *= stages[s].factor;
+        }
+    if(outBlock && nStages)
+        wait = block_size*(((uint32_t)outBlock - 1)*ratio/block_size);
+    return (uint32_t)(d + 0.5f) + wait;
+    }
+
+// Each stage puts its outputs after the old samples in the buffer of the
+// next, and the last into pOut.  Output k of a stage is for input phase +
+// k*factor, and phase carries the remainder to the next update.  Returns
+// the number of outputs.
+uint16_t AudioFilterDecimate_F32::runStages(const FIRDesign_F32::stage *pStages,
+             uint16_t nStages, float32_t * const *pBuf, uint16_t *pPhase,
+             const float32_t *pIn, uint16_t nIn, float32_t *pOut)  {
+    const float32_t *src = pIn;
+    uint16_t n = nIn;
+
+    for(int s=0; s<nStages; s++)  {
+        const FIRDesign_F32::stage *pS = &pStages[s];
+        float32_t *b = pBuf[s];
+        uint16_t nHist = pS->nTaps - 1;
+        const float32_t *h = pS->pCoeff;
+        float32_t *dst = (s == nStages-1) ? pOut : pBuf[s+1] + pStages[s+1].nTaps - 1;
+        uint16_t nOut = 0;
+        int i;
+
+        if(src != b + nHist)
+            for(i=0; i<n; i++)
+                b[nHist + i] = src[i];
+        for(i=pPhase[s]; i<n; i+=pS->factor)  {
+            const float32_t *x = b + i;      // Oldest of nTaps
+            float32_t y;
+            if(pS->K)  {
+                // Half-band, the center and the odd distances from it
+                const float32_t *c = x + 2*pS->K - 1;
+                y = 0.5f*c[0];
+                for(int j=0; j<pS->K; j++)
+                    y += h[j]*(c[-(2*j+1)] + c[2*j+1]);
+                }
+            else  {
+                uint16_t L = pS->nTaps;
+                y = h[L/2]*x[L/2];
+                for(int k=0; k<L/2; k++)
+                    y += h[k]*(x[k] + x[L - 1 - k]);
+                }
+            dst[nOut++] = y;
+            }
+        pPhase[s] = i - n;
+        for(i=0; i<nHist; i++)           // Keep the newest for next time
+            b[i] = b[n + i];
+        src = dst;
+        n = nOut;
+        }
+    return n;
+    }
+
+void AudioFilterDecimate_F32::update(void)  {
+    audio_block_f32_t *blockIn, *blockOut;
+
+    for(int ch=0; ch<2; ch++)  {
+        blockIn = AudioStream_F32::receiveReadOnly_f32(ch);
+        if(!blockIn)
+            continue;
+        if(nStages == 0)  {            // Ratio 1
+            AudioStream_F32::transmit(blockIn, ch);
+            AudioStream_F32::release(blockIn);
+            continue;
+            }
+        uint16_t nIn = blockIn->length;
+        if(nIn > block_size)  nIn = block_size;
+        if(outBlock)  {
+            // Re-pack into blocks of outBlock, see the .h
+            float32_t work[AUDIO_BLOCK_SAMPLES];
+            uint16_t n = runStages(stages, nStages, pBuf[ch], phase[ch],
+                                   blockIn->data, nIn, work);
+            for(uint16_t i=0; i<n; i++)  {
+                if(!pending[ch])  {
+                    pending[ch] = AudioStream_F32::allocate_f32();
+                    nPending[ch] = 0;
+                    if(!pending[ch])  {
+                        outCount[ch] += n - i;   // Lost, but keep the count
+                        break;
+                        }
+                    pending[ch]->sampleIndex = outCount[ch];
+                    }
+                pending[ch]->data[nPending[ch]++] = work[i];
+                outCount[ch]++;
+                if(nPending[ch] >= outBlock)  {
+                    pending[ch]->length = outBlock;
+                    pending[ch]->fs_Hz = blockIn->fs_Hz/(float32_t)ratio;
+                    pending[ch]->id = blockIn->id;
+                    AudioStream_F32::transmit(pending[ch], ch);
+                    AudioStream_F32::release(pending[ch]);
+                    pending[ch] = NULL;
+                    }
+                }
+            AudioStream_F32::release(blockIn);
+            continue;
+            }
+        blockOut = AudioStream_F32::allocate_f32();
+        if(!blockOut)  {
+            AudioStream_F32::release(blockIn);
+            continue;
+            }
+        uint16_t n = runStages(stages, nStages, pBuf[ch], phase[ch],
+                               blockIn->data, nIn, blockOut->data);
+        blockOut->length = n;
+        blockOut->fs_Hz = blockIn->fs_Hz/(float32_t)ratio;
+        blockOut->id = blockIn->id;
+        blockOut->sampleIndex = outCount[ch];
+        outCount[ch] += n;
+        if(n > 0)
+            AudioStream_F32::transmit(blockOut, ch);
+        AudioStream_F32::release(blockOut);
+        AudioStream_F32::release(blockIn);
+        }
+    }
@@ -0,0 +1,145 @@
+/*
+ * AudioFilterDecimate_F32.h
+ *
+ * Lowers the sample rate by an integer ratio, so that narrowband processing
+ * can run at a lower rate, where it takes a fraction of the time.  One
+ * real signal, or I and Q.  AudioFilterInterpolate_F32 goes back up.
+ *
+ * Inputs and outputs:
+ *   In 0, In 1    Real, or I and Q.  In 1 need not be connected.
+ *   Out 0, Out 1  At fs/ratio.  Each update() sends what is ready, about
+ *                 block_size/ratio samples, with block->length set to that
+ *                 and fs_Hz to the lower rate.  So the objects that follow
+ *                 must go by block->length, as AudioFilterFIRGeneral_F32,
+ *                 AudioFilterBiquad_F32 and AudioFilterInterpolate_F32 do.
+ *                 sampleIndex counts samples at the lower rate.
+ *
+ *   i2sIn --> decimate --> narrowband objects --> interpolate --> i2sOut
+ *
+ * Multi-rate islands - With setOutputBlock(n) the low rate samples are
+ * re-packed into blocks of n, and a block is sent only when it is full.
+ * The objects between here and the interpolator then run on n samples every
+ * n*ratio/block_size updates, and skip the updates between, as any object
+ * does with no input.  Give them their own AudioSettings_F32 for the island,
+ * sample rate fs/ratio and block size n, so that they design their filters
+ * for the low rate.  For instance by 4 at 44.1 kHz with n = 128 runs the
+ * island at 11.025 kHz once in 4 updates, and
+ * AudioFilterInterpolate_F32::setInputBlock(128) at the other end.  The
+ * island objects must be ones that only run when they have input, and that
+ * keep block->length and fs_Hz, either working in place or setting them on
+ * the blocks they allocate, see AudioStream_F32.h.  A
+ * partly filled block is held for each channel, so allow 2 more in
+ * AudioMemory_F32().  The latency then includes the wait for the first
+ * block, so that with that of the interpolator it is the delay end to end.
+ *
+ * The filters are designed by begin(), by FIRDesign_F32::multirateStages().
+ * The ratio is factored into 2's, and 3, 5 or 7.  Each 2 is a half-band
+ * stage, run first, at the high rates.  These only need to stop what would
+ * alias into the pass band, so they are short, and every other tap is zero.
+ * The odd factors follow as lowpass stages, with the sharp transition, from
+ * passband_Hz to fs/ratio - passband_Hz, at the lowest rate.  Only the
+ * outputs that are kept are computed, and the symmetry of the taps halves
+ * the multiplies.  For example, by 4 at 44.1 kHz with a pass band to 4 kHz
+ * and 80 dB is half-bands of 15 and 35 taps, about 5 multiplies per input
+ * sample, where a single 4 to 7 kHz lowpass would take about 9.
+ *
+ * Functions:
+ *   begin(ratio, passband_Hz, atten_dB)  ratio is 2's times 3, 5 and 7, to
+ *                  DECIMATE_MAX_RATIO.  passband_Hz is below fs/(2*ratio),
+ *                  0.0 for 0.4*fs/ratio.  atten_dB is the stop band, and
+ *                  also sets the pass band ripple, default 80.0.  Returns 0
+ *                  or an ERR_DECIMATE_ code.  1 is pass through.
+ *   setOutputBlock(n)  0, the default, sends what is ready each update.  1 to
+ *                  AUDIO_BLOCK_SAMPLES sends full blocks of n, but not less
+ *                  than block_size/ratio, rounded up.  At any time.
+ *   getRatio()
+ *   getNumStages()
+ *   getStageTaps(i)   Taps of stage i, from the high rate.
+ *   getLatencySamples()  At the input rate, see above for islands.
+ *   runStages(pStages, nStages, pBuf, pPhase, pIn, nIn, pOut)  Static, the
+ *                  filtering of one channel, for other classes that
+ *                  decimate.  pBuf[s] is nTaps-1 plus the input of stage s,
+ *                  and pPhase[s] starts at 0.  Returns the outputs.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioFilterDecimate_F32_h_
+#define AudioFilterDecimate_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#include "FIRDesign_F32.h"
+
+#define DECIMATE_MAX_RATIO   64
+#define MULTIRATE_MAX_STAGES  8
+
+#define ERR_DECIMATE_RATIO   1
+#define ERR_DECIMATE_BAND    2
+#define ERR_DECIMATE_MEMORY  3
+
+class AudioFilterDecimate_F32 : public AudioStream_F32
+{
+//GUI: inputs:2, outputs:2  //this line used for automatic generation of GUI nodes
+//GUI: shortName:decimate
+public:
+    AudioFilterDecimate_F32(void) : AudioStream_F32(2, inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE_EXACT;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        }
+
+    AudioFilterDecimate_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(2, inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        }
+
+    ~AudioFilterDecimate_F32(void) {
+        FIRDesign_F32::freeStages(stages, nStages);
+        if(buffer)  delete [] buffer;
+        for(int ch=0; ch<2; ch++)
+            if(pending[ch])  AudioStream_F32::release(pending[ch]);
+        }
+
+    uint16_t begin(uint16_t _ratio, float32_t passband_Hz=0.0f, float32_t atten_dB=80.0f);
+    void setOutputBlock(uint16_t n);
+    uint16_t getRatio(void) { return ratio; }
+    uint16_t getNumStages(void) { return nStages; }
+    uint16_t getStageTaps(uint16_t i) { return i<nStages ? stages[i].nTaps : 0; }
+    uint32_t getLatencySamples(void);
+    // The filtering, for others that decimate, as AudioAnalyzeSpectrum_F32
+    static uint16_t runStages(const FIRDesign_F32::stage *pStages, uint16_t nStages,
+             float32_t * const *pBuf, uint16_t *pPhase,
+             const float32_t *pIn, uint16_t nIn, float32_t *pOut);
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[2];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE_EXACT;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    uint16_t ratio = 1;
+
+    FIRDesign_F32::stage stages[MULTIRATE_MAX_STAGES];
+    uint16_t nStages = 0;
+    // For each channel and stage, nTaps-1 old samples and room for the
+    // input of one update.  All from one new[].
+    float32_t *buffer = NULL;
+    float32_t *pBuf[2][MULTIRATE_MAX_STAGES];
+    uint16_t phase[2][MULTIRATE_MAX_STAGES];
+    uint64_t outCount[2] = {0, 0};
+    // Re-packing for an island, 0 for off
+    uint16_t outBlockSet = 0;
+    uint16_t outBlock = 0;
+    audio_block_f32_t *pending[2] = {NULL, NULL};
+    uint16_t nPending[2] = {0, 0};
+
+    void releasePending(void);
+    // At least what one update makes, so only one block is sent per update
+    uint16_t islandBlock(void)  {
+        uint16_t nMin = (block_size + ratio - 1)/ratio;
+        if(outBlockSet == 0)  return 0;
+        return outBlockSet<nMin ? nMin : outBlockSet;
+        }
+};
+#endif
@@ -41,10 +41,27 @@ void AudioFilterEqualizer_F32::update(void)  {
       return;
     }
 
+    // New coefficients change over only here, at a block boundary
+    if (pending)
+        changeFIR();
+    running = true;
+
 	block_new = AudioStream_F32::allocate_f32(); 	// get a block for the FIR output
 	if (block_new) {
 		//apply the FIR
-		arm_fir_f32(&fir_inst, block->data, block_new->data, block->length);
+		fir_inst[active].process(block->data, block_new->data, block->length);
+		if (fadeLeft > 0) {
+		    // Old FIR as well, and fade from it to the new
+		    float32_t oldOut[AUDIO_BLOCK_SAMPLES];
+		    fir_inst[1-active].process(block->data, oldOut, block->length);
+		    float32_t gStep = 1.0f/(float32_t)fadeLen;
+		    for (int i=0; i<block->length; i++) {
+		        if (fadeLeft > 0)
+		            fadeLeft--;
+		        float32_t g = 1.0f - gStep*(float32_t)fadeLeft;
+		        block_new->data[i] = oldOut[i] + g*(block_new->data[i] - oldOut[i]);
+		    }
+		}
 		AudioStream_F32::transmit(block_new); // send the FIR output
 		AudioStream_F32::release(block_new);
 	}
@@ -70,11 +87,17 @@ void AudioFilterEqualizer_F32::update(void)  {
  *            kdb=60 slow cutoff, low sidelobes
  * 
  * The arrays, feq[], aeq[] and cf32f[] are supplied by the calling .INO
+ * The FIR has its own copy of cf32f[], so it can be reused for the next call.
+ * cf32f[] is written only when the new design is loaded.
  *
  * Returns: 0 if successful, or an error code if not.
  * Errors:  1 = Too many bands, 50 max
  *          2 = sidelobe level out of range, must be > 0
  *          3 = nFIR out of range
+ *          6 = busy, the last change is still crossfading.  The design
+ *              is done, and cached, but not in use, and cf32f[], nFIR and
+ *              getResponse() are still for the equalizer in use.  Call
+ *              again later.
  *
  * Note - This function runs at setup time, and there is no need to fret about
  * processor speed.  Likewise, local arrays are created on the stack and are
@@ -84,31 +107,43 @@ uint16_t AudioFilterEqualizer_F32::equalizerNew(uint16_t _nBands, float32_t *feq
                       uint16_t _nFIR, float32_t *_cf32f, float32_t kdb)  {
     uint16_t i, j;
     uint16_t nHalfFIR;
-    float32_t beta, kbes;
-    float32_t q, xj2, scaleXj2, WindowWt;
+    float32_t beta;
+    float32_t q, sinLast, sinNext;
     float32_t fNorm[50];   // Normalized to the sampling frequency
     float32_t aVolts[50];  // Convert from dB to "quasi-Volts"
-    mathDSP_F32 mathEqualizer;  // For Bessel function
+    const float32_t *pWindow;
+    FIRDesign_F32::cacheKey key;
+    // The design is here until it is loaded, then copied to _cf32f[]
+    float32_t cNew[EQUALIZER_MAX_COEFFS];
+    uint16_t nNew = _nFIR;
 
-    // Make private copies
-    cf32f = _cf32f;
-    nFIR = _nFIR;
     nBands = _nBands;
 
     // Check range of nFIR
-    if (nFIR<5 || nFIR>EQUALIZER_MAX_COEFFS)
+    if (nNew<5 || nNew>EQUALIZER_MAX_COEFFS)
         return ERR_EQ_NFIR;
 
     // The number of FIR coefficients needs to be odd
-    if (2*(nFIR/2) == nFIR)
-        nFIR -= 1;  // We just won't use the last element of the array
-    nHalfFIR = (nFIR - 1)/2;  // If nFIR=199, nHalfFIR=99
+    if (2*(nNew/2) == nNew)
+        nNew -= 1;  // We just won't use the last element of the array
+    nHalfFIR = (nNew - 1)/2;  // If nFIR=199, nHalfFIR=99
  
-    for (int kk = 0; kk<nFIR; kk++)  // To be sure, zero the coefficients
-      cf32f[kk] = 0.0f;
+    for (int kk = 0; kk<nNew; kk++)  // To be sure, zero the coefficients
+      cNew[kk] = 0.0f;
       
-    // Convert dB to Voltage ratios, frequencies to fractions of sampling freq
     if(nBands <2 || nBands>50)  return ERR_EQ_BANDS;
+    if (kdb<0) return ERR_EQ_SIDELOBES;
+
+    // A design done before may be in the cache.  The key is all it depends on.
+    key = FIRDesign_F32::hash(feq, nBands*sizeof(float32_t));
+    key = FIRDesign_F32::hash(adb, nBands*sizeof(float32_t), key);
+    key = FIRDesign_F32::hash(&nNew, sizeof(nNew), key);
+    key = FIRDesign_F32::hash(&kdb, sizeof(kdb), key);
+    key = FIRDesign_F32::hash(&sample_rate_Hz, sizeof(sample_rate_Hz), key);
+    if (FIRDesign_F32::cacheGet(key, nNew, cNew))
+        return loadNewFIR(cNew, nNew, _cf32f) ? 0 : ERR_EQ_BUSY;
+
+    // Convert dB to Voltage ratios, frequencies to fractions of sampling freq
     for (i=0; i<nBands; i++)  {
        aVolts[i]=powf(10.0, (0.05*adb[i]));
        fNorm[i]=feq[i]/sample_rate_Hz;
@@ -126,20 +161,25 @@ uint16_t AudioFilterEqualizer_F32::equalizerNew(uint16_t _nBands, float32_t *feq
      * The center coef ( for nFIR=199 taps, nHalfFIR=99 ) is a 
      * special case that comes from sin(0)/0 and treated first:
      */
-    cf32f[nHalfFIR] = 2.0f*(aVolts[0]*fNorm[0]);  // Coefficient "99"
+    cNew[nHalfFIR] = 2.0f*(aVolts[0]*fNorm[0]);  // Coefficient "99"
     for(i=1; i<nBands; i++) {
-       cf32f[nHalfFIR] += 2.0f*aVolts[i]*(fNorm[i]-fNorm[i-1]);
+       cNew[nHalfFIR] += 2.0f*aVolts[i]*(fNorm[i]-fNorm[i-1]);
     }
     for (j=1; j<=nHalfFIR; j++) {          // Coefficients "100 to 198"
         q = MF_PI*(float32_t)j;
         // First, deal with the zero frequency end band that is "low-pass."
-        cf32f[j+nHalfFIR] = aVolts[0]*sinf(fNorm[0]*2.0*q)/q;
-        //  and then the rest of the bands that have low and high frequencies
-        for(i=1; i<nBands; i++)
-           cf32f[j+nHalfFIR] += aVolts[i]*( (sinf(fNorm[i]*2.0*q)/q) - (sinf(fNorm[i-1]*2.0*q)/q) );
+        sinLast = sinf(fNorm[0]*2.0f*q)/q;
+        cNew[j+nHalfFIR] = aVolts[0]*sinLast;
+        //  and then the rest of the bands that have low and high frequencies.
+        //  The top of one band is the bottom of the next.
+        for(i=1; i<nBands; i++) {
+           sinNext = sinf(fNorm[i]*2.0f*q)/q;
+           cNew[j+nHalfFIR] += aVolts[i]*(sinNext - sinLast);
+           sinLast = sinNext;
+        }
     }
 
-    /* At this point, the cf32f[] coefficients are simply truncated sin(x)/x shapes, creating
+    /* At this point, the cNew[] coefficients are simply truncated sin(x)/x shapes, creating
      * very high sidelobe responses. To reduce the sidelobes, a windowing function is applied.
      * This has the side affect of increasing the rate of cutoff for sharp frequency changes.
      * The only windowing function available here is that of James Kaiser.  This has a number
@@ -147,46 +187,136 @@ uint16_t AudioFilterEqualizer_F32::equalizerNew(uint16_t _nBands, float32_t *feq
      * We specify it in terms of kdb, the highest sidelobe, in dB, next to a sharp cutoff. For
      * calculating the windowing vector, we need a parameter beta, found as follows:
      */
-    if (kdb<0) return ERR_EQ_SIDELOBES;
     if (kdb>50)
         beta = 0.1102*(kdb-8.7);
     else if  (kdb>20.96 && kdb<=50.0)
         beta = 0.58417*powf((kdb-20.96), 0.4) + 0.07886*(kdb-20.96);
     else
         beta=0.0;
-    // Note: i0f is the floating point in & out zero'th order Bessel function (see mathDSP_F32.h)
-    kbes = 1.0f / mathEqualizer.i0f(beta);      // An additional derived parameter used in loop
-  
-    // Apply the Kaiser window
-    scaleXj2 = 2.0f/(float32_t)nFIR;
-    scaleXj2 *= scaleXj2;
+
+    // Apply the Kaiser window, at x = 2j/nFIR from the center.  This is
+    // kept for the next design, see FIRDesign_F32.h
+    pWindow = FIRDesign_F32::kaiserWindow(nNew, (float32_t)nNew, beta);
     for (j=0; j<=nHalfFIR; j++) {  // For 199 Taps, this is 0 to 99
-         xj2 = (int16_t)(0.5f+(float32_t)j);
-         xj2 = scaleXj2*xj2*xj2;
-         WindowWt=kbes*(mathEqualizer.i0f(beta*sqrt(1.0-xj2)));
-         cf32f[nHalfFIR + j] *= WindowWt;          // Apply the Kaiser window to upper half
-         cf32f[nHalfFIR - j] = cf32f[nHalfFIR +j]; // and create the lower half
+         if (pWindow)
+             cNew[nHalfFIR + j] *= pWindow[nHalfFIR + j];  // Apply the Kaiser window to upper half
+         cNew[nHalfFIR - j] = cNew[nHalfFIR +j]; // and create the lower half
     }
-    // And fill in the members of fir_inst
-    arm_fir_init_f32(&fir_inst, nFIR, (float32_t *)cf32f,  &StateF32[0], (uint32_t)block_size);
-    return 0;
+    FIRDesign_F32::cachePut(key, nNew, cNew);
+    // And pass them to the idle FIR, for update() to change over to
+    return loadNewFIR(cNew, nNew, _cf32f) ? 0 : ERR_EQ_BUSY;
+}
+
+/* equalizerNewOptimal() is equalizerNew() designed by an optimal method,
+ * from the same feq[] and adb[].  In place of kdb:
+ *   transition_Hz  Left free at each change of band, when both bands are
+ *                  at least this wide.  A fraction of the narrowest band.
+ *   method         FIRD_REMEZ or FIRD_LEAST_SQUARES
+ *
+ * Returns: 0 if successful, or an error code if not.
+ * Errors:  1 = Too many bands, 50 max, or least squares was singular
+ *          3 = nFIR out of range
+ *          4 = out of memory
+ *          5 = Remez did not converge, but the best found is in use
+ *          6 = busy, as for equalizerNew()
+ */
+uint16_t AudioFilterEqualizer_F32::equalizerNewOptimal(uint16_t _nBands,
+                      float32_t *feq, float32_t *adb, uint16_t _nFIR,
+                      float32_t *_cf32f, float32_t transition_Hz, uint16_t method)  {
+    float32_t fNorm[50];
+    float32_t edges[100];
+    float32_t amp[50];
+    float32_t weight[50];
+    uint16_t i, nb, status;
+    FIRDesign_F32::cacheKey key;
+    float32_t cNew[EQUALIZER_MAX_COEFFS];   // As for equalizerNew()
+    uint16_t nNew = _nFIR;
+
+    nBands = _nBands;
+    if (nNew<5 || nNew>EQUALIZER_MAX_COEFFS)
+        return ERR_EQ_NFIR;
+    if (2*(nNew/2) == nNew)
+        nNew -= 1;          // Odd, as for equalizerNew()
+    if(nBands <2 || nBands>50)  return ERR_EQ_BANDS;
+
+    key = FIRDesign_F32::hash(feq, nBands*sizeof(float32_t));
+    key = FIRDesign_F32::hash(adb, nBands*sizeof(float32_t), key);
+    key = FIRDesign_F32::hash(&nNew, sizeof(nNew), key);
+    key = FIRDesign_F32::hash(&transition_Hz, sizeof(transition_Hz), key);
+    key = FIRDesign_F32::hash(&sample_rate_Hz, sizeof(sample_rate_Hz), key);
+    key = FIRDesign_F32::hash(&method, sizeof(method), key);
+    if (FIRDesign_F32::cacheGet(key, nNew, cNew))
+        return loadNewFIR(cNew, nNew, _cf32f) ? 0 : ERR_EQ_BUSY;
+
+    for (i=0; i<nBands; i++)
+       fNorm[i] = feq[i]/sample_rate_Hz;
+    nb = FIRDesign_F32::levelBands(nBands, fNorm, adb,
+               transition_Hz/sample_rate_Hz, edges, amp, weight);
+    if (method == FIRD_LEAST_SQUARES)
+        status = FIRDesign_F32::leastSquares(cNew, nNew, nb, edges, amp, weight);
+    else
+        status = FIRDesign_F32::remez(cNew, nNew, nb, edges, amp, weight);
+    if (status == FIRD_ERR_MEMORY)    return ERR_EQ_MEMORY;
+    if (status == FIRD_ERR_NFIR)      return ERR_EQ_NFIR;
+    if (status == FIRD_ERR_SINGULAR)  return ERR_EQ_BANDS;
+    if (status == 0)
+        FIRDesign_F32::cachePut(key, nNew, cNew);
+    if (!loadNewFIR(cNew, nNew, _cf32f))
+        return ERR_EQ_BUSY;
+    return (status==FIRD_ERR_CONVERGE) ? ERR_EQ_CONVERGE : 0;
+}
+
+/* Copy the new design, pNew[nNew], to the FIR not in use.  If a crossfade
+ * is going on, that FIR is still being faded out, so return false without
+ * waiting, and nothing is changed.  Only update(), or endCrossfade(), ends
+ * a fade.  Once loaded, the design is copied to the .INO array pCoeff[],
+ * that is then cf32f[] for getResponse().
+ */
+bool AudioFilterEqualizer_F32::loadNewFIR(const float32_t *pNew, uint16_t nNew,
+                                          float32_t *pCoeff)  {
+    __disable_irq();
+    if (fadeLeft > 0) {
+        __enable_irq();
+        return false;
+    }
+    int idle = 1 - active;   // Replaces any design still pending
+    for (int kk=0; kk<nNew; kk++)
+        coeffRun[idle][kk] = pNew[kk];
+    nFIRrun[idle] = nNew;
+    fir_inst[idle].init(nNew, &coeffRun[idle][0],  &StateF32[idle][0], (uint32_t)block_size);
+    pending = true;
+    __enable_irq();
+
+    for (int kk=0; kk<nNew; kk++)
+        pCoeff[kk] = pNew[kk];
+    cf32f = pCoeff;
+    nFIR = nNew;
+    return true;
+}
+
+/* Called from update().  The state of the new FIR is filled with the most
+ * recent inputs, oldest first, as the FIR leaves them, so it starts
+ * with no transient.  Then the outputs are crossfaded.
+ */
+void AudioFilterEqualizer_F32::changeFIR(void)  {
+    int idle = 1 - active;
+    int nOld = nFIRrun[active] - 1;
+    int nNew = nFIRrun[idle] - 1;
+    for (int kk=0; kk<nNew; kk++) {
+        int j = kk - nNew + nOld;
+        StateF32[idle][kk] = (j >= 0) ? StateF32[active][j] : 0.0f;
+    }
+    active = idle;
+    pending = false;
+    // No fade for the first equalizer, before the audio has started
+    fadeLen = running ? (uint32_t)fadeBlocks*block_size : 0;
+    fadeLeft = fadeLen;
 }
 
 /* Calculate response in dB.  Leave nFreq point result in array rdb[] supplied
  * by the calling .INO  See Parks and Burris, "Digital Filter Design," p27 (Type 1).
+ * This is an FFT if 2*nFreq is a power of 2, see FIRDesign_F32.h.
  */
 void AudioFilterEqualizer_F32::getResponse(uint16_t nFreq, float32_t *rdb)  {
-	uint16_t i, j;
-	float32_t bt;
-	float32_t piOnNfreq;
-	uint16_t nHalfFIR;
-
-    nHalfFIR = (nFIR - 1)/2;
-    piOnNfreq = MF_PI / (float32_t)nFreq;
-    for (i=0; i<nFreq; i++) {
-        bt = cf32f[nHalfFIR];//bt = 0.5f*cf32f[nHalfFIR];  // Center coefficient
-        for (j=0; j<nHalfFIR; j++)  // Add in the others twice, as they are symmetric
-            bt += 2.0f*cf32f[j]*cosf(piOnNfreq*(float32_t)((nHalfFIR-j)*i));
-        rdb[i] = 20.0f*log10f(fabsf(bt));     // Convert to dB
-    }
+    FIRDesign_F32::responseDB(cf32f, nFIR, nFreq, rdb);
 }
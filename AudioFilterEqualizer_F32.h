@@ -82,6 +82,29 @@
  * float32_t dbBand[] = {0.0f, 0.0f};
  * equalize1.equalizerNew(2, &fBand[0], &dbBand[0], 4, &equalizeCoeffs[0], 30.0f, 32767.0f);
  *  
+ * Oct 2026 - Changing the equalizer while running no longer clicks.  The FIR
+ * in use has its own copy of the coefficients, so equalizerNew() can be
+ * called at any time.  The new coefficients go to a second FIR, that is
+ * started with the recent input samples of the first, and then to the .INO
+ * array.  At the next block update() changes over and crossfades the two
+ * outputs over setCrossfadeBlocks(n) blocks, default 4.  Both FIR run
+ * during the fade.  A second equalizerNew() during a fade does not wait.
+ * It returns ERR_EQ_BUSY and the equalizer is not changed, nor is the .INO
+ * array, so getResponse() and getLatencySamples() are still for the one in
+ * use.  Call it again later, as from loop().  The design is cached, so the
+ * retry is quick.  Only update() ends a crossfade, so if update() has
+ * stopped, as with the audio stopped, call endCrossfade() first.
+ * The Kaiser window and the response use FIRDesign_F32, and designs are
+ * cached there, so changes while running are quick.
+ * equalizerNewOptimal() takes the same bands, but designs by Parks-McClellan
+ * (FIRD_REMEZ) or least squares (FIRD_LEAST_SQUARES), see FIRDesign_F32.h.
+ * In place of kdb, transition_Hz is left free at each band edge, where the
+ * bands are wide enough.  The error is spread evenly, in dB, over the bands,
+ * so the same match needs fewer taps than the Kaiser window.
+ * The FIR is FIRKernel_F32, that adds the pairs of samples for the symmetric
+ * coefficients before the multiply.  This about halves the time per coefficient
+ * given below.
+ *
  * Measured timing of update() for a 128 sample block, Teensy 3.6:
  *     Fixed time 13 microseconds
  *     Per FIR Coefficient time 2.5 microseconds
@@ -121,6 +144,8 @@
 #include "AudioStream_F32.h"
 #include "arm_math.h"
 #include "mathDSP_F32.h"
+#include "FIRDesign_F32.h"
+#include "FIRKernel_F32.h"
 
 #ifndef MF_PI
 #define MF_PI 3.1415926f
@@ -134,6 +159,9 @@
 #define ERR_EQ_BANDS 1
 #define ERR_EQ_SIDELOBES 2
 #define ERR_EQ_NFIR 3
+#define ERR_EQ_MEMORY 4
+#define ERR_EQ_CONVERGE 5
+#define ERR_EQ_BUSY 6
 
 class AudioFilterEqualizer_F32 : public AudioStream_F32
 {
@@ -142,17 +170,28 @@ class AudioFilterEqualizer_F32 : public AudioStream_F32
     public:
         AudioFilterEqualizer_F32(void): AudioStream_F32(1,inputQueueArray) {
 	        // Initialize FIR instance (ARM DSP Math Library) with default simple passthrough FIR
-            arm_fir_init_f32(&fir_inst, nFIR, (float32_t *)cf32f,  &StateF32[0], (uint32_t)block_size);
+            initFIR();
 		}
         AudioFilterEqualizer_F32(const AudioSettings_F32 &settings): AudioStream_F32(1,inputQueueArray) {
 	        block_size = settings.audio_block_samples;
 	        sample_rate_Hz = settings.sample_rate_Hz;
-            arm_fir_init_f32(&fir_inst, nFIR, (float32_t *)cf32f,  &StateF32[0], (uint32_t)block_size);
+            initFIR();
 		}
 
     uint16_t equalizerNew(uint16_t _nBands, float32_t *feq, float32_t *adb,
                       uint16_t _nFIR, float32_t *_cf32f, float32_t kdb);
+    uint16_t equalizerNewOptimal(uint16_t _nBands, float32_t *feq, float32_t *adb,
+                      uint16_t _nFIR, float32_t *_cf32f, float32_t transition_Hz,
+                      uint16_t method);
     void getResponse(uint16_t nFreq, float32_t *rdb);
+    // Blocks for the crossfade to a new equalizer.  0 changes at the next
+    // block, which may click.  Default 4.
+    void setCrossfadeBlocks(uint16_t _nBlocks) { fadeBlocks = _nBlocks; }
+    // Only update() finishes a crossfade.  If it is no longer being called,
+    // as when the audio is stopped, this ends one so equalizerNew() can work.
+    void endCrossfade(void) { fadeLeft = 0; }
+    // Group delay, the designs here are linear phase
+    uint32_t getLatencySamples(void) { return (uint32_t)((nFIR - 1)/2); }
     void update(void);
 
 private:
@@ -169,9 +208,28 @@ private:
     elapsedMicros tElapse;
     int32_t iitt = 999000;     // count up to a million during startup
 #endif
-        // ARM DSP Math library filter instance
-        arm_fir_instance_f32 fir_inst;
-        float32_t StateF32[AUDIO_BLOCK_SAMPLES + EQUALIZER_MAX_COEFFS];  // max, max
+        // The FIRs, [active] is in use and the other is the previous, or
+        // next, equalizer.  The state is as for arm_fir_f32().
+        FIRKernel_F32 fir_inst[2];
+        float32_t coeffRun[2][EQUALIZER_MAX_COEFFS];
+        float32_t StateF32[2][AUDIO_BLOCK_SAMPLES + EQUALIZER_MAX_COEFFS];  // max, max
+        uint16_t nFIRrun[2];
+        int active = 0;
+        volatile bool pending = false;  // New FIR waiting for update()
+        bool running = false;           // update() has been called
+        uint16_t fadeBlocks = 4;
+        uint32_t fadeLen = 0;
+        volatile uint32_t fadeLeft = 0; // Samples to go in the crossfade
+
+        void initFIR(void)  {
+            for(int i=0; i<4; i++)
+                coeffRun[0][i] = firStart[i];
+            nFIRrun[0] = 4;
+            nFIRrun[1] = 4;
+            fir_inst[0].init(4, &coeffRun[0][0],  &StateF32[0][0], (uint32_t)block_size);
+            }
+        bool loadNewFIR(const float32_t *pNew, uint16_t nNew, float32_t *pCoeff);
+        void changeFIR(void);
 };
 #endif
 
@@ -50,10 +50,11 @@ void AudioFilterFIRGeneral_F32::update(void)  {
       return;
     }
 
-    blockOut = AudioStream_F32::allocate_f32();  // get a block for the FIR output
+    // get a block for the FIR output, the size of the input, as in an island
+    blockOut = AudioStream_F32::allocate_f32(blockIn->length, blockIn->fs_Hz);
     if (blockOut) {
         // The FIR update
-        arm_fir_f32(&fir_inst, blockIn->data, blockOut->data, blockIn->length);
+        fir_inst.process(blockIn->data, blockOut->data, blockIn->length);
         AudioStream_F32::transmit(blockOut); // send the FIR output
         AudioStream_F32::release(blockOut);
     }
@@ -62,7 +63,8 @@ void AudioFilterFIRGeneral_F32::update(void)  {
 #if TEST_TIME_FIRG
   t2 = tElapse;
   if(iitt++ < 0) {Serial.print("At FIRGeneral end, microseconds = "); Serial.println (t2 - t1); //           }
-	Serial.print("numtaps = "); Serial.println (fir_inst.numTaps); 
+	Serial.print("numtaps = "); Serial.print(fir_inst.getNumTaps());
+	Serial.print("  multiplies = "); Serial.println(fir_inst.getMultiplies()); 
 	}
   t1 = tElapse;
 #endif
@@ -84,20 +86,20 @@ void AudioFilterFIRGeneral_F32::update(void)  {
  * Errors:  1 = NU
  *          2 = sidelobe level out of range, must be > 0
  *          3 = nFIR out of range
+ *          4 = out of memory for the FFT
  *
- * Note - This function runs at setup time, so slowness is not an issue
+ * Note - This function runs at setup time, but see FIRDesign_F32.h for making
+ * it fast enough for changes while running.
  */
 uint16_t AudioFilterFIRGeneral_F32::FIRGeneralNew(
          float32_t *adb, uint16_t _nFIR, float32_t *_cf32f, float32_t kdb,
          float32_t *pStateArray) {
 
-    uint16_t i, k, n;
+    uint16_t i, n;
     uint16_t nHalfFIR;
-    float32_t beta, kbes;
-    float32_t num, xn2, scaleXn2, WindowWt;
-    float32_t M;                // Burris and Parks, (2.16)
-    mathDSP_F32 mathEqualizer;  // For Bessel function
-    bool even;
+    float32_t beta;
+    const float32_t *pWindow;
+    FIRDesign_F32::cacheKey key;
 
     cf32f = _cf32f;  // Make pivate copies
     nFIR = _nFIR;
@@ -105,106 +107,136 @@ uint16_t AudioFilterFIRGeneral_F32::FIRGeneralNew(
     // Check range of nFIR
     if (nFIR<4)
         return ERR_FIRGEN_NFIR;
-        
-    M = 0.5f*(float32_t)(nFIR - 1);
+    if (kdb<0.0f) return ERR_FIRGEN_SIDELOBES;
+
     // The number of FIR coefficients is even or odd
-    if (2*(nFIR/2) == nFIR) {
-        even = true; 
+    if (2*(nFIR/2) == nFIR)
         nHalfFIR = nFIR/2;
-     }
-     else {
-        even = false; 
+     else
         nHalfFIR = (nFIR - 1)/2;
-      }
 
-    for (i=0; i<nFIR; i++)  // To be sure, zero the coefficients
-       cf32f[i] = 0.0f;
-    for(i=0; i<(nFIR+AUDIO_BLOCK_SAMPLES); i++)  // And the storage
+    for(i=0; i<(nFIR+AUDIO_BLOCK_SAMPLES); i++)  // Zero the storage
        pStateArray[i] = 0.0f;
 
-    // Convert dB to "Voltage" ratios, frequencies to fractions of sampling freq
-    // Borrow pStateArray, as it has not yet gone to ARM math
-    for(i=0; i<=nHalfFIR; i++)
-        pStateArray[i] = powf(10.0, 0.05f*adb[i]);
+    // A design done before may be in the cache.  The key is all it depends on.
+    key = FIRDesign_F32::hash(adb, (nHalfFIR + 1)*sizeof(float32_t));
+    key = FIRDesign_F32::hash(&nFIR, sizeof(nFIR), key);
+    key = FIRDesign_F32::hash(&kdb, sizeof(kdb), key);
+    if (!FIRDesign_F32::cacheGet(key, nFIR, cf32f)) {
+      // Convert dB to "Voltage" ratios.
+      // Borrow pStateArray, as it has not yet gone to ARM math
+      for(i=0; i<=nHalfFIR; i++)
+          pStateArray[i] = powf(10.0, 0.05f*adb[i]);
 
-    /* Find FIR coefficients, the Fourier transform of the frequency
-     * response. This general frequency description has half as many
-     * frequency dB points as FIR coefficients.  If nFIR is odd,
-     * the number of frequency points is nHalfFIR = (nFIR - 1)/2.
-     *
-     * Numbering example for nFIR==21:
-     * Odd nFIR:  Subscript 0 to 9 is 10 taps;  11 to 20 is 10 taps; 10+1+10=21 taps
-     *
-     * Numbering example for nFIR==20: 
-     * Even nFIR: Subscript 0 to 9 is 10 taps;  10 to 19 is 10 taps; 10+10=20 taps
-     */
-    float32_t oneOnNFIR = 1.0f / (float32_t)nFIR;
-    if(even) {
-       for(n=0; n<nHalfFIR; n++) {    // Over half of even nFIR FIR coeffs	  
-           cf32f[n] = pStateArray[0];   // DC term
-           for(k=1; k<nHalfFIR;  k++) {  // Over all frequencies, half of nFIR
-               num = (M - (float32_t)n) * (float32_t)k; 
-               cf32f[n] +=  2.0f*pStateArray[k]*cosf(MF_TWOPI*num*oneOnNFIR);
-            }
-            cf32f[n] *= oneOnNFIR;  // Divide by nFIR
-       }				 
-    }
-    else {    // nFIR is odd		 
-       for(n=0; n<=nHalfFIR; n++) {    // Over half of FIR coeffs, nFIR odd
-           cf32f[n] = pStateArray[0];
-           for(k=1; k<=nHalfFIR;  k++) {
-               num = (float32_t)((nHalfFIR - n)*k);
-               cf32f[n] +=  2.0f*pStateArray[k]*cosf(MF_TWOPI*num*oneOnNFIR);
-            }
-            cf32f[n] *= oneOnNFIR;
-       }     
-	}
-    /* At this point, the cf32f[] coefficients are simply truncated, creating
-     * high sidelobe responses. To reduce the sidelobes, a windowing function is applied.
-     * This has the side affect of increasing the rate of cutoff for sharp frequency transition.
-     * The only windowing function available here is that of James Kaiser.  This has a number
-     * of desirable features. The sidelobes drop off as the frequency away from a transition.
-     * Also, the tradeoff of sidelobe level versus cutoff rate is variable.
-     * Here we specify it in terms of kdb, the highest sidelobe, in dB, next to a sharp cutoff. For
-     * calculating the windowing vector, we need a parameter beta, found as follows:
-     */
-    if (kdb<0.0f) return ERR_FIRGEN_SIDELOBES;
-    if (kdb < 20.0f)
-        beta = 0.0;
-    else
-        beta = -2.17+0.17153*kdb-0.0002841*kdb*kdb; // Within a dB or so
-    // Note: i0f is the fp zero'th order modified Bessel function (see mathDSP_F32.h)
-    kbes = 1.0f / mathEqualizer.i0f(beta);      // An additional derived parameter used in loop
-	scaleXn2 = 4.0f / ( ((float32_t)nFIR - 1.0f)*((float32_t)nFIR - 1.0f) ); // Needed for even & odd
-    if (even) {
-		// nHalfFIR = nFIR/2;   for nFIR even
-        for (n=0; n<nHalfFIR; n++) {  // For 20 Taps, this is 0 to 9
-            xn2 = 0.5f+(float32_t)n;
-            xn2 = scaleXn2*xn2*xn2;
-            WindowWt=kbes*(mathEqualizer.i0f(beta*sqrt(1.0-xn2)));
-            if(kdb > 0.1f)                                 // kdb==0.0 means no window
-                cf32f[nHalfFIR - n - 1] *= WindowWt;       // Apply window, reverse subscripts
-            cf32f[nHalfFIR + n] = cf32f[nHalfFIR - n - 1]; // and create the upper half
-        }
-	}
-	else {   // nFIR is odd,   nHalfFIR = (nFIR - 1)/2
-        for (n=0; n<=nHalfFIR; n++) {  // For 21 Taps, this is 0 to 10, including center
-            xn2 = (int16_t)(0.5f+(float32_t)n);
-            xn2 = scaleXn2*xn2*xn2;
-            WindowWt=kbes*(mathEqualizer.i0f(beta*sqrt(1.0-xn2)));
-            if(kdb > 0.1f)
-                cf32f[nHalfFIR - n] *= WindowWt;
-            // 21 taps, for n=0, nHalfFIR-n = 10,  for n=1 nHalfFIR-n=9,  for n=nHalfFIR, nHalfFIR-n=0
-            cf32f[nHalfFIR + n] = cf32f[nHalfFIR - n]; // and create upper half (rewrite center is OK)
-        }
+      /* Find FIR coefficients, the Fourier transform of the frequency
+       * response. This general frequency description has half as many
+       * frequency dB points as FIR coefficients, at multiples of
+       * fs/nFIR.  The transform is done by an FFT over a finer grid,
+       * see FIRDesign_F32.h.  It is even or odd about the center.
+       */
+      if (FIRDesign_F32::frequencySample(cf32f, nFIR, pStateArray, nHalfFIR + 1))
+          return ERR_FIRGEN_MEMORY;
+      for(i=0; i<nHalfFIR+1; i++)
+          pStateArray[i] = 0.0f;
+
+      /* At this point, the cf32f[] coefficients are simply truncated, creating
+       * high sidelobe responses. To reduce the sidelobes, a windowing function is applied.
+       * This has the side affect of increasing the rate of cutoff for sharp frequency transition.
+       * The only windowing function available here is that of James Kaiser.  This has a number
+       * of desirable features. The sidelobes drop off as the frequency away from a transition.
+       * Also, the tradeoff of sidelobe level versus cutoff rate is variable.
+       * Here we specify it in terms of kdb, the highest sidelobe, in dB, next to a sharp cutoff. For
+       * calculating the windowing vector, we need a parameter beta, found as follows:
+       */
+      if (kdb < 20.0f)
+          beta = 0.0;
+      else
+          beta = -2.17+0.17153*kdb-0.0002841*kdb*kdb; // Within a dB or so
+      // kdb==0.0 means no window.  The window is kept, see FIRDesign_F32.h
+      if (kdb > 0.1f) {
+          pWindow = FIRDesign_F32::kaiserWindow(nFIR, (float32_t)(nFIR - 1), beta);
+          if (pWindow)
+              for (n=0; n<nFIR; n++)
+                  cf32f[n] *= pWindow[n];
+      }
+      FIRDesign_F32::cachePut(key, nFIR, cf32f);
     }
-    // And finally, fill in the members of fir_inst given in update() to the ARM FIR routine.
+    // And finally, set up fir_inst for update().  The designs are symmetric,
+    // so it pre-adds pairs of samples, half the multiplies.
     AudioNoInterrupts();
-    arm_fir_init_f32(&fir_inst, nFIR, (float32_t *)cf32f, &pStateArray[0], (uint32_t)block_size);
+    fir_inst.init(nFIR, cf32f, &pStateArray[0], (uint32_t)block_size);
     AudioInterrupts(); 
     return 0;
 }
 
+/* FIRGeneralOptimal() designs from the same adb[] as FIRGeneralNew(), but by
+ * the Parks-McClellan equiripple method or by weighted least squares, see
+ * FIRDesign_F32.h.  In place of kdb:
+ *   transition_Hz  The band left free where adb[] changes level.  About
+ *                  the width that the Kaiser design gave is a fair start.
+ *   method         FIRD_REMEZ or FIRD_LEAST_SQUARES
+ *
+ * Returns: 0 if successful, or an error code if not.
+ * Errors:  1 = The least squares equations are singular, check adb[]
+ *          3 = nFIR out of range, or too many for least squares
+ *          4 = out of memory
+ *          5 = Remez did not converge.  The coefficients are the best
+ *              found and are in use.
+ */
+uint16_t AudioFilterFIRGeneral_F32::FIRGeneralOptimal(float32_t *adb,
+         uint16_t _nFIR, float32_t *_cf32f, float32_t transition_Hz,
+         uint16_t method, float32_t *pStateArray) {
+    uint16_t i, nHalfFIR, nLevels, nBands, status;
+    FIRDesign_F32::cacheKey key;
+
+    cf32f = _cf32f;
+    nFIR = _nFIR;
+    if (nFIR<4)
+        return ERR_FIRGEN_NFIR;
+    nHalfFIR = nFIR/2;
+    nLevels = nHalfFIR + 1;
+
+    for(i=0; i<(nFIR+AUDIO_BLOCK_SAMPLES); i++)
+       pStateArray[i] = 0.0f;
+
+    // The method goes in the key as well, so no Kaiser design matches
+    key = FIRDesign_F32::hash(adb, nLevels*sizeof(float32_t));
+    key = FIRDesign_F32::hash(&nFIR, sizeof(nFIR), key);
+    key = FIRDesign_F32::hash(&transition_Hz, sizeof(transition_Hz), key);
+    key = FIRDesign_F32::hash(&method, sizeof(method), key);
+    key = FIRDesign_F32::hash(&sample_rate_Hz, sizeof(sample_rate_Hz), key);
+    status = 0;
+    if (!FIRDesign_F32::cacheGet(key, nFIR, cf32f)) {
+      // adb[i] is at i*fs/nFIR, so it runs to half way to the next
+      float32_t *pMem = new float32_t[5*nLevels];
+      if (pMem == NULL)
+          return ERR_FIRGEN_MEMORY;
+      float32_t *pUpper = pMem;
+      float32_t *pEdges = pUpper + nLevels;
+      float32_t *pAmp = pEdges + 2*nLevels;
+      float32_t *pWeight = pAmp + nLevels;
+      for(i=0; i<nLevels; i++)
+          pUpper[i] = ((float32_t)i + 0.5f)/(float32_t)nFIR;
+      nBands = FIRDesign_F32::levelBands(nLevels, pUpper, adb,
+                 transition_Hz/sample_rate_Hz, pEdges, pAmp, pWeight);
+      if (method == FIRD_LEAST_SQUARES)
+          status = FIRDesign_F32::leastSquares(cf32f, nFIR, nBands, pEdges, pAmp, pWeight);
+      else
+          status = FIRDesign_F32::remez(cf32f, nFIR, nBands, pEdges, pAmp, pWeight);
+      delete [] pMem;
+
+      if (status == FIRD_ERR_MEMORY)    return ERR_FIRGEN_MEMORY;
+      if (status == FIRD_ERR_NFIR)      return ERR_FIRGEN_NFIR;
+      if (status == FIRD_ERR_SINGULAR)  return ERR_FIRGEN_BANDS;
+      if (status == 0)
+          FIRDesign_F32::cachePut(key, nFIR, cf32f);
+    }
+    AudioNoInterrupts();
+    fir_inst.init(nFIR, cf32f, &pStateArray[0], (uint32_t)block_size);
+    AudioInterrupts();
+    return (status==FIRD_ERR_CONVERGE) ? ERR_FIRGEN_CONVERGE : 0;
+}
+
 // FIRGeneralLoad() allows an array of nFIR FIR coefficients to be loaded.  They come from an .INO
 // supplied array.  Also, pStateArray[] is .INO supplied and must be (block_size + nFIR) in size.
 uint16_t AudioFilterFIRGeneral_F32::LoadCoeffs(uint16_t _nFIR, float32_t *_cf32f, float32_t *pStateArray) {
@@ -215,45 +247,18 @@ uint16_t AudioFilterFIRGeneral_F32::LoadCoeffs(uint16_t _nFIR, float32_t *_cf32f
     for(int i=0; i<(nFIR+AUDIO_BLOCK_SAMPLES); i++)  // Zero, to be sure
         pStateArray[i] = 0.0f;
     AudioNoInterrupts(); 
-    arm_fir_init_f32(&fir_inst, nFIR, &cf32f[0], &pStateArray[0], (uint32_t)block_size);
+    fir_inst.init(nFIR, &cf32f[0], &pStateArray[0], (uint32_t)block_size);
     AudioInterrupts(); 
     return 0;
 }
 
 /* Calculate frequency response in dB.  Leave nFreq point result in array rdb[] supplied
- * by the calling .INO  See B&P p27 (Type 1 and 2). Be aware that if nFIR*nFreq is big,
- * like 100,000 or more, this will take a while to calcuulate all the cosf().  Normally,
- * this is not an issue as this is an infrequent calculation.
+ * by the calling .INO  See B&P p27 (Type 1 and 2).  This is an FFT if 2*nFreq is a
+ * power of 2, and otherwise a direct sum, see FIRDesign_F32.h.
  * This function assumes that the phase of the FIR is linear with frequency, i.e.,
  * the coefficients are symmetrical about the middle.  Otherwise, doubling of values,
  * as  is done here, is not valid.
  */
 void AudioFilterFIRGeneral_F32::getResponse(uint16_t nFreq, float32_t *rdb)  {
-    uint16_t i, n;
-    float32_t bt;
-    float32_t piOnNfreq;
-    uint16_t nHalfFIR;
-    float32_t M;
-
-    piOnNfreq = MF_PI / (float32_t)nFreq;
-    // The number of FIR coefficients, even or odd?
-    if (2*(nFIR/2) == nFIR) {     // it is even
-		nHalfFIR = nFIR/2;
-        M = 0.5f*(float32_t)(nFIR - 1);
-        for (i=0; i<nFreq; i++) {
-            bt = 0.0;
-            for (n=0; n<nHalfFIR; n++)  // Add in terms twice, as they are symmetric
-                 bt += 2.0f*cf32f[n]*cosf(piOnNfreq*((M-(float32_t)n)*(float32_t)i));
-            rdb[i] = 20.0f*log10f(fabsf(bt));     // Convert to dB
-        }
-    }
-    else {                         // it is odd
-        nHalfFIR = (nFIR - 1)/2;
-        for (i=0; i<nFreq; i++) {
-            bt = cf32f[nHalfFIR];       // Center coefficient
-            for (n=0; n<nHalfFIR; n++)  // Add in the others twice, as they are symmetric
-                bt += 2.0f*cf32f[n]*cosf(piOnNfreq*(float32_t)((nHalfFIR-n)*i));
-            rdb[i] = 20.0f*log10f(fabsf(bt));
-        }
-    }      
+    FIRDesign_F32::responseDB(cf32f, nFIR, nFreq, rdb);
 }
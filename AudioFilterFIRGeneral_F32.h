@@ -93,10 +93,29 @@
  * Measured for FIRGeneralNew(), T4.0, to design a 4000 tap FIR is 14 sec. This goes
  *     with the square of the number of taps.
  * Measured for getResponse() for nFIR=4000 and nFreq=5000, T4.0, is about a minute.
+ * Oct 2026 - The design and getResponse() use FIRDesign_F32.  The FIR is found
+ *     by an FFT, the Kaiser window is kept for the next design of the same
+ *     length and designs are cached, so a changing response is practical
+ *     while running.  getResponse() is an FFT for nFreq a power of 2, and
+ *     much faster than before for other nFreq.
+ * Oct 2026 - FIRGeneralOptimal() designs from the same adb[] with the
+ *     Parks-McClellan (FIRD_REMEZ) or least squares (FIRD_LEAST_SQUARES)
+ *     methods of FIRDesign_F32, in place of the Kaiser window.  Where adb[]
+ *     changes level, transition_Hz is left free for the change.  For the
+ *     same stop band this needs about a third fewer taps, so less time in
+ *     update().  The error is equal in dB over the bands, so put the stop
+ *     band at the level needed, as -80.0, not -140.0.  Least squares is
+ *     limited to FIRD_LS_MAX_TAPS.
+ * Oct 2026 - The FIR is FIRKernel_F32 in place of arm_fir_f32().  The
+ *     coefficients here are symmetric, so each pair of samples is added
+ *     before the multiply, half the multiplies for the same nFIR.
+ *     LoadCoeffs() of unsymmetric coefficients is as before.
  *
  * Functions for the AudioFilterFIRGeneral_F32 object are
  *   FIRGeneralNew(*adb, nFIR, cf32f, kdb, *pStateArray); // to design and use an adb[]
  *      frequency response.
+ *   FIRGeneralOptimal(*adb, nFIR, cf32f, transition_Hz, method, *pStateArray);
+ *      // The same, by an optimal design.  method is FIRD_REMEZ or FIRD_LEAST_SQUARES
  *   LoadCoeffs(nFIR, cf32f, *pStateArray);    // To directly load FIR coefficients cf32f[]
  *   getResponse(nFreq, *rdb);   // To obtain the amplitude response in dB, rdb[]
  *
@@ -136,6 +155,8 @@
 #include "AudioStream_F32.h"
 #include "arm_math.h"
 #include "mathDSP_F32.h"
+#include "FIRDesign_F32.h"
+#include "FIRKernel_F32.h"
 
 #ifndef MF_PI
 #define MF_PI 3.1415926f
@@ -147,6 +168,8 @@
 #define ERR_FIRGEN_BANDS 1
 #define ERR_FIRGEN_SIDELOBES 2
 #define ERR_FIRGEN_NFIR 3
+#define ERR_FIRGEN_MEMORY 4
+#define ERR_FIRGEN_CONVERGE 5
 
 class AudioFilterFIRGeneral_F32 : public AudioStream_F32
 {
@@ -154,18 +177,22 @@ class AudioFilterFIRGeneral_F32 : public AudioStream_F32
 //GUI: shortName:filter_Equalizer
 public:
     AudioFilterFIRGeneral_F32(void): AudioStream_F32(1,inputQueueArray) {
-        // Initialize FIR instance (ARM DSP Math Library) with default simple passthrough FIR
-        arm_fir_init_f32(&fir_inst, nFIR, (float32_t *)cf32f, &StateF32[0], (uint32_t)block_size);
+        // Initialize FIR with default simple passthrough FIR
+        fir_inst.init(nFIR, cf32f, &StateF32[0], (uint32_t)block_size);
     }
     AudioFilterFIRGeneral_F32(const AudioSettings_F32 &settings): AudioStream_F32(1,inputQueueArray) {
         block_size = settings.audio_block_samples;
         sample_rate_Hz = settings.sample_rate_Hz;
-        arm_fir_init_f32(&fir_inst, nFIR, (float32_t *)cf32f, &StateF32[0], (uint32_t)block_size);
+        fir_inst.init(nFIR, cf32f, &StateF32[0], (uint32_t)block_size);
     }
 
     uint16_t FIRGeneralNew(float32_t *adb, uint16_t _nFIR, float32_t *_cf32f, float32_t kdb, float32_t *pStateArray);
+    uint16_t FIRGeneralOptimal(float32_t *adb, uint16_t _nFIR, float32_t *_cf32f,
+             float32_t transition_Hz, uint16_t method, float32_t *pStateArray);
     uint16_t LoadCoeffs(uint16_t _nFIR, float32_t *_cf32f, float32_t *pStateArray);
     void getResponse(uint16_t nFreq, float32_t *rdb);
+    // Group delay, the designs here are linear phase
+    uint32_t getLatencySamples(void) { return (uint32_t)((nFIR - 1)/2); }
     void update(void);
 
 private:
@@ -181,8 +208,8 @@ private:
     elapsedMicros tElapse;
     int32_t iitt = 999000;     // count up to a million during startup
 #endif
-    // ARM DSP Math library filter instance
-    arm_fir_instance_f32 fir_inst;
+    // The FIR, symmetric coefficients take half the multiplies
+    FIRKernel_F32 fir_inst;
     float32_t StateF32[AUDIO_BLOCK_SAMPLES + 4];     // FIR_GENERAL_MAX_COEFFS];  // max, max
 };
 #endif
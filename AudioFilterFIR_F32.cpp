@@ -44,7 +44,7 @@ void AudioFilterFIR_F32::update(void)
 		}
 		
 		//apply the FIR
-		arm_fir_f32(&fir_inst, block->data, block_new->data, block->length);
+		fir_inst.process(block->data, block_new->data, block->length);
 		block_new->length = block->length;
 
 		//transmit the data
@@ -4,6 +4,9 @@
  * Created: Chip Audette (OpenAudio) Feb 2017
  *    - Building from AudioFilterFIR from Teensy Audio Library (AudioFilterFIR credited to Pete (El Supremo))
  * 
+ * Oct 2026 - The FIR is FIRKernel_F32.  Symmetric and antisymmetric
+ *    coefficients, as nearly all designs, take half the multiplies, and
+ *    half-band and Hilbert zero taps are skipped.  Others as before.
  */
 
 #ifndef _filter_fir_f32_h
@@ -12,6 +15,7 @@
 #include "Arduino.h"
 #include "AudioStream_F32.h"
 #include "arm_math.h"
+#include "FIRKernel_F32.h"
 
 // Indicates that the code should just pass through the audio
 // without any filtering (as opposed to doing nothing at all)
@@ -35,7 +39,7 @@ class AudioFilterFIR_F32 : public AudioStream_F32
 			
 			// Initialize FIR instance (ARM DSP Math Library)
 			if (coeff_p && (coeff_p != FIR_F32_PASSTHRU) && n_coeffs <= FIR_MAX_COEFFS) {
-				arm_fir_init_f32(&fir_inst, n_coeffs, (float32_t *)coeff_p,  &StateF32[0], block_size);
+				fir_inst.init(n_coeffs, coeff_p,  &StateF32[0], block_size);
 				configured_block_size = block_size;
 				//Serial.print("AudioFilterFIR_F32: FIR is initialized. N_FIR = "); Serial.print(n_coeffs);
 				//Serial.print(", Block Size = "); Serial.println(block_size);
@@ -46,6 +50,11 @@ class AudioFilterFIR_F32 : public AudioStream_F32
 			}
 		}
 		void end(void) {  coeff_p = NULL; }
+		// Group delay, assuming linear phase (symmetric) coefficients
+		uint32_t getLatencySamples(void) {
+			if (coeff_p==NULL || coeff_p==FIR_F32_PASSTHRU) return 0;
+			return (uint32_t)((n_coeffs - 1)/2);
+		}
 		void update(void);
 
 		//void setBlockDC(void) {}	//helper function that sets this up for a first-order HP filter at 20Hz
@@ -58,8 +67,8 @@ class AudioFilterFIR_F32 : public AudioStream_F32
 		int n_coeffs;
 		int configured_block_size;
 
-		// ARM DSP Math library filter instance
-		arm_fir_instance_f32 fir_inst;
+		// The FIR, see FIRKernel_F32.h
+		FIRKernel_F32 fir_inst;
 		float32_t StateF32[AUDIO_BLOCK_SAMPLES + FIR_MAX_COEFFS];
 };
 
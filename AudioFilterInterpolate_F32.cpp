@@ -0,0 +1,224 @@
+/*
+ * AudioFilterInterpolate_F32.cpp
+ *
+ * See AudioFilterInterpolate_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "AudioFilterInterpolate_F32.h"
+
+uint16_t AudioFilterInterpolate_F32::begin(uint16_t _ratio, float32_t passband_Hz,
+                                           float32_t atten_dB)  {
+    FIRDesign_F32::stage newStages[MULTIRATE_MAX_STAGES];
+    FIRDesign_F32::stage oldStages[MULTIRATE_MAX_STAGES];
+    uint16_t nNew = 0;
+    uint16_t nOld;
+    uint16_t newChunk = 0;
+    uint16_t newFifoSize = 0;
+    uint16_t newPrefill = 0;
+    uint32_t size = 0;        // Per channel
+    float32_t *newBuffer = NULL;
+    float32_t *oldBuffer;
+    uint16_t r = _ratio;
+
+    if(_ratio<1 || _ratio>DECIMATE_MAX_RATIO)
+        return ERR_DECIMATE_RATIO;
+    while((r & 1) == 0)  r /= 2;
+    while(r%3 == 0)      r /= 3;
+    while(r%5 == 0)      r /= 5;
+    while(r%7 == 0)      r /= 7;
+    if(r != 1)
+        return ERR_DECIMATE_RATIO;
+    if(passband_Hz <= 0.0f)
+        passband_Hz = 0.4f*sample_rate_Hz/(float32_t)_ratio;
+    if(passband_Hz >= 0.5f*sample_rate_Hz/(float32_t)_ratio)
+        return ERR_DECIMATE_BAND;
+
+    if(_ratio > 1)  {
+        nNew = FIRDesign_F32::multirateStages(_ratio, passband_Hz/sample_rate_Hz,
+                        atten_dB, newStages, MULTIRATE_MAX_STAGES);
+        if(nNew == 0)
+            return ERR_DECIMATE_MEMORY;
+        // Gain of ratio, to make up for the zeros between input samples.
+        // The half-band center is implied, so only the weights change.
+        for(int s=0; s<nNew; s++)  {
+            FIRDesign_F32::stage *pS = &newStages[s];
+            uint16_t n = pS->K ? pS->K : pS->nTaps;
+            for(int k=0; k<n; k++)
+                pS->pCoeff[k] *= (float32_t)pS->factor;
+            }
+        newChunk = block_size/_ratio + 1;
+        // The FIFO only starts when the first block comes, so even for an
+        // island it never needs more than a block to ride out the uneven
+        // arrivals.  Room for the ratio*inBlock outputs of each.
+        newPrefill = inBlock ? block_size : _ratio;
+        newFifoSize = 2*block_size + 2*_ratio*(inBlock ? inBlock : 1);
+        uint32_t nIn = newChunk;
+        for(int s=nNew-1; s>=0; s--)  {
+            size += history(&newStages[s]) + nIn;
+            nIn *= newStages[s].factor;
+            }
+        size += nIn + newFifoSize;
+        newBuffer = new float32_t[2*size];
+        if(newBuffer == NULL)  {
+            FIRDesign_F32::freeStages(newStages, nNew);
+            return ERR_DECIMATE_MEMORY;
+            }
+        for(uint32_t i=0; i<2*size; i++)
+            newBuffer[i] = 0.0f;
+        }
+
+    // Change over, with update() held off
+    __disable_irq();
+    nOld = nStages;
+    oldBuffer = buffer;
+    for(int s=0; s<MULTIRATE_MAX_STAGES; s++)  {
+        oldStages[s] = stages[s];
+        stages[s] = newStages[s];
+        }
+    nStages = nNew;
+    buffer = newBuffer;
+    ratio = _ratio;
+    chunk = newChunk;
+    fifoSize = newFifoSize;
+    prefill = newPrefill;
+    for(int ch=0; ch<2; ch++)  {
+        float32_t *p = buffer + ch*size;
+        uint32_t nIn = chunk;
+        for(int s=nStages-1; s>=0; s--)  {
+            pBuf[ch][s] = p;
+            p += history(&stages[s]) + nIn;
+            nIn *= stages[s].factor;
+            }
+        pOut[ch] = p;
+        pFifo[ch] = p + nIn;
+        fifoRead[ch] = 0;
+        fifoCount[ch] = prefill;    // Zeros, see the .h
+        outCount[ch] = 0;
+        running[ch] = false;
+        }
+    __enable_irq();
+
+    FIRDesign_F32::freeStages(oldStages, nOld);
+    if(oldBuffer)  delete [] oldBuffer;
+    return 0;
+    }
+
+// Samples at the output rate
+uint32_t AudioFilterInterpolate_F32::getLatencySamples(void)  {
+    uint32_t rate = 1;
+    float32_t d = 0.0f;
+    if(nStages == 0)
+        return 0;
+    for(int s=0; s<nStages; s++)  {
+        d += 0.5f*(float32_t)(stages[s].nTaps - 1)*(float32_t)rate;
+        rate *= stages[s].factor;
+        }
+    return (uint32_t)(d + 0.5f) + prefill;
+    }
+
+// From the low rate up.  Each stage puts factor outputs for each input
+// after the old samples in the buffer of the next, and the last into
+// pOut[ch].  Returns the number in pOut[ch], nIn*ratio.
+uint16_t AudioFilterInterpolate_F32::runChannel(int ch, const float32_t *pIn,
+                                                uint16_t nIn)  {
+    const float32_t *src = pIn;
+    uint16_t n = nIn;
+
+    for(int s=nStages-1; s>=0; s--)  {
+        FIRDesign_F32::stage *pS = &stages[s];
+        float32_t *b = pBuf[ch][s];
+        uint16_t nHist = history(pS);
+        const float32_t *h = pS->pCoeff;
+        float32_t *dst = (s == 0) ? pOut[ch] : pBuf[ch][s-1] + history(&stages[s-1]);
+        uint16_t nOut = 0;
+        int i;
+
+        if(src != b + nHist)
+            for(i=0; i<n; i++)
+                b[nHist + i] = src[i];
+        for(i=nHist; i<nHist+n; i++)  {
+            if(pS->K)  {
+                // The even outputs are 2K taps around c, the odd a copy
+                const float32_t *c = b + i - pS->K + 1;
+                float32_t y = 0.0f;
+                for(int j=0; j<pS->K; j++)
+                    y += h[j]*(c[j] + c[-1 - j]);
+                dst[nOut++] = y;
+                dst[nOut++] = c[0];
+                }
+            else  {
+                // Phase p uses taps p, p+factor, ...
+                for(int p=0; p<pS->factor; p++)  {
+                    float32_t y = 0.0f;
+                    const float32_t *x = b + i;
+                    for(int k=p; k<pS->nTaps; k+=pS->factor)
+                        y += h[k]*(*x--);
+                    dst[nOut++] = y;
+                    }
+                }
+            }
+        for(i=0; i<nHist; i++)           // Keep the newest for next time
+            b[i] = b[n + i];
+        src = dst;
+        n = nOut;
+        }
+    return n;
+    }
+
+void AudioFilterInterpolate_F32::update(void)  {
+    audio_block_f32_t *blockIn, *blockOut;
+
+    for(int ch=0; ch<2; ch++)  {
+        blockIn = AudioStream_F32::receiveReadOnly_f32(ch);
+        if(nStages == 0)  {            // Ratio 1
+            if(blockIn)  {
+                AudioStream_F32::transmit(blockIn, ch);
+                AudioStream_F32::release(blockIn);
+                }
+            continue;
+            }
+        if(blockIn)  {
+            running[ch] = true;
+            lastId[ch] = blockIn->id;
+            uint16_t nIn = blockIn->length;
+            if(nIn > block_size)  nIn = block_size;
+            for(uint16_t k=0; k<nIn; k+=chunk)  {
+                uint16_t m = (nIn - k < chunk) ? nIn - k : chunk;
+                uint16_t n = runChannel(ch, blockIn->data + k, m);
+                for(uint16_t i=0; i<n && fifoCount[ch]<fifoSize; i++)  {
+                    uint16_t w = fifoRead[ch] + fifoCount[ch];
+                    if(w >= fifoSize)  w -= fifoSize;
+                    pFifo[ch][w] = pOut[ch][i];
+                    fifoCount[ch]++;
+                    }
+                }
+            AudioStream_F32::release(blockIn);
+            }
+        else if(!running[ch] || fifoCount[ch] == 0)  {
+            running[ch] = false;
+            continue;
+            }
+
+        blockOut = AudioStream_F32::allocate_f32();
+        if(!blockOut)
+            continue;
+        for(uint16_t i=0; i<block_size; i++)  {
+            if(fifoCount[ch] > 0)  {
+                blockOut->data[i] = pFifo[ch][fifoRead[ch]];
+                if(++fifoRead[ch] >= fifoSize)  fifoRead[ch] = 0;
+                fifoCount[ch]--;
+                }
+            else
+                blockOut->data[i] = 0.0f;
+            }
+        blockOut->length = block_size;
+        blockOut->fs_Hz = sample_rate_Hz;
+        blockOut->id = lastId[ch];
+        blockOut->sampleIndex = outCount[ch];
+        outCount[ch] += block_size;
+        AudioStream_F32::transmit(blockOut, ch);
+        AudioStream_F32::release(blockOut);
+        }
+    }
@@ -0,0 +1,115 @@
+/*
+ * AudioFilterInterpolate_F32.h
+ *
+ * Raises the sample rate by an integer ratio, the other end of a lower rate
+ * section started by AudioFilterDecimate_F32.  One real signal, or I and Q.
+ *
+ * Inputs and outputs:
+ *   In 0, In 1    At fs/ratio, block->length samples per update, about
+ *                 block_size/ratio as sent by AudioFilterDecimate_F32 with
+ *                 the same ratio.  In 1 need not be connected.
+ *   Out 0, Out 1  Full blocks at fs.  The interpolated samples go through a
+ *                 FIFO that starts with ratio zeros, so that the uneven
+ *                 counts from the decimator always fill a block.  More than
+ *                 the FIFO holds are dropped, and if it runs short the block
+ *                 is filled with zeros.  sampleIndex counts output samples.
+ *
+ * At the end of a multi-rate island, see AudioFilterDecimate_F32, the input
+ * is full blocks of n at the low rate, that only come every few updates.
+ * setInputBlock(n) makes room in the FIFO for the n*ratio samples from
+ * each, about 8*n*ratio bytes for the two channels, and starts it with a
+ * block of zeros, so that there is a full block out every update.  Once a
+ * channel has had input, blocks are sent until the FIFO runs dry.
+ *
+ * The filters are the same as for AudioFilterDecimate_F32, from
+ * FIRDesign_F32::multirateStages(), run in the reverse order, the odd
+ * factors at the low rate and then the half-bands.  Each stage is split
+ * into its polyphase parts, so the zeros between input samples are never
+ * multiplied.  For a half-band, every other output is just a copy of an
+ * input sample.  The gain is 1.
+ *
+ * Functions:
+ *   begin(ratio, passband_Hz, atten_dB)  As AudioFilterDecimate_F32, with
+ *                  fs the output rate.  Returns 0 or an ERR_DECIMATE_ code.
+ *   setInputBlock(n)  0, the default, for about block_size/ratio samples
+ *                  each update, or the island block size.  Call before
+ *                  begin().
+ *   getRatio()
+ *   getNumStages()
+ *   getStageTaps(i)   Taps of stage i, from the high rate.
+ *   getLatencySamples()  At the output rate, the filters and the zeros the
+ *                  FIFO starts with.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef AudioFilterInterpolate_F32_h_
+#define AudioFilterInterpolate_F32_h_
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "arm_math.h"
+#include "FIRDesign_F32.h"
+#include "AudioFilterDecimate_F32.h"
+
+class AudioFilterInterpolate_F32 : public AudioStream_F32
+{
+//GUI: inputs:2, outputs:2  //this line used for automatic generation of GUI nodes
+//GUI: shortName:interpolate
+public:
+    AudioFilterInterpolate_F32(void) : AudioStream_F32(2, inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE_EXACT;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        }
+
+    AudioFilterInterpolate_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(2, inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        }
+
+    ~AudioFilterInterpolate_F32(void) {
+        FIRDesign_F32::freeStages(stages, nStages);
+        if(buffer)  delete [] buffer;
+        }
+
+    uint16_t begin(uint16_t _ratio, float32_t passband_Hz=0.0f, float32_t atten_dB=80.0f);
+    void setInputBlock(uint16_t n) {
+        inBlock = n>AUDIO_BLOCK_SAMPLES ? AUDIO_BLOCK_SAMPLES : n;
+        }
+    uint16_t getRatio(void) { return ratio; }
+    uint16_t getNumStages(void) { return nStages; }
+    uint16_t getStageTaps(uint16_t i) { return i<nStages ? stages[i].nTaps : 0; }
+    uint32_t getLatencySamples(void);
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[2];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE_EXACT;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    uint16_t ratio = 1;
+
+    FIRDesign_F32::stage stages[MULTIRATE_MAX_STAGES];
+    uint16_t nStages = 0;
+    uint16_t chunk = 0;       // Most input samples per runChannel()
+    uint16_t fifoSize = 0;
+    uint16_t inBlock = 0;     // Island block, 0 for none
+    uint16_t prefill = 0;     // Zeros in the FIFO at the start
+    // For each channel, the old samples and input room for each stage, the
+    // output of the last and the FIFO.  All from one new[].
+    float32_t *buffer = NULL;
+    float32_t *pBuf[2][MULTIRATE_MAX_STAGES];
+    float32_t *pOut[2];
+    float32_t *pFifo[2];
+    uint16_t fifoRead[2];
+    uint16_t fifoCount[2];
+    uint64_t outCount[2] = {0, 0};
+    bool running[2] = {false, false};
+    unsigned long lastId[2] = {0, 0};
+
+    static uint16_t history(const FIRDesign_F32::stage *pS)  {
+        return pS->K ? 2*pS->K - 1 : (pS->nTaps - 1)/pS->factor;
+        }
+    uint16_t runChannel(int ch, const float32_t *pIn, uint16_t nIn);
+};
+#endif
@@ -25,10 +25,95 @@
 #include "AudioStream_F32.h"
 #include "AudioLMSDenoiseNotch_F32.h"
 
+uint16_t AudioLMSDenoiseNotch_F32::initializeLMS(uint16_t _what,
+                  uint16_t _lengthDataF, uint16_t _lengthDataD)
+    {
+    bool wasOn;
+    float32_t *pOld, *pNew;
+
+    // update() is an interrupt, so stop it while things change.
+    __disable_irq();
+    wasOn = doLMS;
+    doLMS = false;
+    __enable_irq();
+
+    what = _what;
+    if(what != DENOISE && what != NOTCH)  what = DENOISE;
+    lengthDataF = powf(2.0f, log2f(_lengthDataF)+0.000001f);  //Make sure a power of 2
+    lengthDataF = (lengthDataF>MAX_FIR ? MAX_FIR : lengthDataF);  // Limit length
+    kMask = lengthDataF - 1;
+    lengthDataD = _lengthDataD;
+    lengthDataD = (lengthDataD>MAX_DELAY ? MAX_DELAY : lengthDataD);  // Limit length
+#ifdef LMS_NORMALIZE
+    for(int i=0; i<128; i++) powerNorm[i] = 0.01f;
+    pNorm = 0.01f * 128.0f;
+#endif
+    for(int i=0; i<MAX_FIR; i++)    coeff[i] = 0.0f;
+    for(int i=0; i<2*MAX_FIR; i++)  dataF[i] = 0.0f;
+    for(int i=0; i<MAX_DELAY; i++)  dataD[i] = 0.0f;
+    kOffsetF = 0;
+    kNextD = 0;
+    numLeak = 0;
+
+    // Sub-block, a power of 2 from 8 to 128, no bigger than the FIR
+    if(subBlockReq == 0)
+        subBlock = (algorithm==LMS_FDAF) ? 128 : 32;
+    else
+        subBlock = powf(2.0f, log2f(subBlockReq)+0.000001f);
+    if(subBlock > 128)  subBlock = 128;
+    if(subBlock < 8)    subBlock = 8;
+    if(algorithm==LMS_FDAF && subBlock > lengthDataF)
+        subBlock = lengthDataF;
+    if(lengthDataF < 8)   // Too short for FDAF, use the original
+        algorithm = LMS_SAMPLE;
+
+    pOld = fdafMem;
+    pNew = NULL;
+    if(algorithm == LMS_FDAF)
+        {
+        uint32_t P = subBlock;
+        nPart = lengthDataF/P;
+        // W[nPart*4P], X[nPart*4P], Pw[2P], bufA[4P], bufB[4P], xPrev[P]
+        uint32_t nFloat = 8*nPart*P + 11*P;
+        pNew = new float32_t[nFloat];
+        if(pNew == NULL)
+            {
+            algorithm = LMS_SAMPLE;     // Not enough memory
+            }
+        else
+            {
+            for(uint32_t i=0; i<nFloat; i++)  pNew[i] = 0.0f;
+            W = pNew;
+            X = W + nPart*4*P;
+            Pw = X + nPart*4*P;
+            bufA = Pw + 2*P;
+            bufB = bufA + 4*P;
+            xPrev = bufB + 4*P;
+            for(uint32_t i=0; i<2*P; i++)  Pw[i] = 1.0E-6f;
+            xNewest = 0;
+            nConstrain = 0;
+            if(nFFTsetup != (int)(2*P))
+                {
+                fftF.setup(2*P);
+                fftF.useRectangularWindow();
+                ifftF.setup(2*P);
+                ifftF.useRectangularWindow();
+                nFFTsetup = 2*P;
+                }
+            }
+        }
+    fdafMem = pNew;
+    if(pOld)  delete [] pOld;
+    setFdafLeak();
+
+    __disable_irq();
+    doLMS = wasOn;
+    __enable_irq();
+    return lengthDataF;
+    }
+
 void AudioLMSDenoiseNotch_F32::update(void)
     {
-    uint16_t j, k;
-    float32_t blockDataIn, error, firOut;
     audio_block_f32_t *block;
 
     block = AudioStream_F32::receiveWritable_f32();
@@ -50,9 +135,29 @@ void AudioLMSDenoiseNotch_F32::update(void)
         return;
         }
 
+    if(algorithm == LMS_FDAF && fdafMem != NULL)
+        updateFDAF(block->data, blockOut->data);
+    else if(algorithm == LMS_BLOCK)
+        updateBlock(block->data, blockOut->data);
+    else
+        updateSample(block->data, blockOut->data);
+
+    //transmit the block and be done
+    AudioStream_F32::transmit(blockOut);
+    AudioStream_F32::release(block);
+    AudioStream_F32::release(blockOut);
+    }
+
+// The original sample by sample LMS
+void AudioLMSDenoiseNotch_F32::updateSample(float32_t *pIn, float32_t *pOut)
+    {
+    uint16_t j;
+    float32_t blockDataIn, error, firOut;
+    float32_t *pF;
+
     for(int i=0; i<128; i++)
         {
-        blockDataIn = block->data[i];
+        blockDataIn = pIn[i];
 
         // Leakage on one coefficient
         coeff[numLeak] *= decay;         // Decay one coefficient
@@ -74,14 +179,12 @@ void AudioLMSDenoiseNotch_F32::update(void)
         if(++kNextD >= lengthDataD)     // Next spot in delay line
            kNextD = 0;
 
-        // Update the FIR.
-        dataF[kOffsetF] = dataD[kNextD];   // Input FIR is output Delay
-        firOut = 0.0f;
-        for(j=0; j<lengthDataF; j++)       // Over all coefficients
-            {
-            k = (j + kOffsetF) & kMask;    // Data circular buffer
-            firOut +=coeff[j]*dataF[k];
-            }
+        // Update the FIR.  Input FIR is output Delay.  Written twice so
+        // that pF[0] to pF[lengthDataF-1] is the whole circular buffer.
+        dataF[kOffsetF] = dataD[kNextD];
+        dataF[kOffsetF + lengthDataF] = dataD[kNextD];
+        pF = &dataF[kOffsetF];
+        arm_dot_prod_f32(coeff, pF, lengthDataF, &firOut);
 
         // Compute the error, the difference between the data point
         // just received and the FIR output.
@@ -94,10 +197,7 @@ void AudioLMSDenoiseNotch_F32::update(void)
         float32_t kcf = error*beta;
 #endif
         for(j=0; j<lengthDataF; j++)
-            {
-            k = (j + kOffsetF) & kMask;
-            coeff[j] = coeff[j] + kcf*dataF[k];
-            }
+            coeff[j] += kcf*pF[j];
 
         // Move to next positions in circular data buffer via kOffsetF
         if(++kOffsetF >= lengthDataF)
@@ -105,12 +205,187 @@ void AudioLMSDenoiseNotch_F32::update(void)
 
         // fir out to output block
         if(what == DENOISE)
-          blockOut->data[i] = firOut;
+          pOut[i] = firOut;
         else
-          blockOut->data[i] = error;           // Auto-Notch
+          pOut[i] = error;           // Auto-Notch
+        }
+    }
+
+// Fill refData[] with the input delayed by lengthDataD, the same
+// delay line as updateSample().  Also sets pNorm for the block.
+void AudioLMSDenoiseNotch_F32::makeReference(float32_t *pIn)
+    {
+    for(int i=0; i<128; i++)
+        {
+        dataD[kNextD] = pIn[i];
+        if(++kNextD >= lengthDataD)
+           kNextD = 0;
+        refData[i] = dataD[kNextD];
+        }
+#ifdef LMS_NORMALIZE
+    arm_dot_prod_f32(pIn, pIn, 128, &pNorm);
+    if(pNorm < 1.0E-12f)  pNorm = 1.0E-12f;
+#endif
+    }
+
+// Block LMS.  The FIR is y[n] = sum coeff[j]*dataF[n+j] where
+// dataF[n+lengthDataF-1] is the newest reference sample.  The coefficients
+// change only at the end of each sub-block.
+void AudioLMSDenoiseNotch_F32::updateBlock(float32_t *pIn, float32_t *pOut)
+    {
+    uint16_t L = lengthDataF;
+    float32_t *pF;
+    float32_t firOut;
+
+    makeReference(pIn);
+    arm_copy_f32(refData, &dataF[L-1], 128);
+    // The coefficients are held for the sub-block, so the step is limited
+    // by the power over the whole FIR, not the last 128 samples.
+#ifdef LMS_NORMALIZE
+    float32_t mu = beta/(pNorm*(L>128 ? (float32_t)L/128.0f : 1.0f));
+#else
+    float32_t mu = beta;
+#endif
+
+    for(int n0=0; n0<128; n0+=subBlock)
+        {
+        // Filter the sub-block with fixed coefficients
+        for(int n=n0; n<n0+subBlock; n++)
+            {
+            arm_dot_prod_f32(coeff, &dataF[n], L, &firOut);
+            errData[n] = pIn[n] - firOut;
+            pOut[n] = (what==DENOISE) ? firOut : errData[n];
+            }
+        // Sum the gradient into the coefficients.  Contiguous, no wrap.
+        for(int n=n0; n<n0+subBlock; n++)
+            {
+            float32_t kcf = mu*errData[n];
+            pF = &dataF[n];
+            for(int j=0; j<L; j++)
+                coeff[j] += kcf*pF[j];
+            }
+        }
+
+    // Leakage, the same number of coefficients as updateSample()
+    for(int i=0; i<128; i++)
+        {
+        coeff[numLeak] *= decay;
+        if(++numLeak >= L)
+            numLeak = 0;
+        }
+    // Keep the last L-1 reference samples for the next block
+    arm_copy_f32(&dataF[128], dataF, L-1);
+    }
+
+// Partitioned block frequency domain NLMS, with P=subBlock samples per
+// partition and 2P point complex FFTs.  Partition k of the FIR is W[k],
+// and uses the input spectrum from k sub-blocks ago.
+void AudioLMSDenoiseNotch_F32::updateFDAF(float32_t *pIn, float32_t *pOut)
+    {
+    uint32_t P = subBlock;
+    uint32_t N2 = 4*P;        // Floats in a 2P complex spectrum
+    uint32_t i, k, kx;
+    float32_t *pW, *pX;
+
+    makeReference(pIn);
+    for(uint32_t n0=0; n0<128; n0+=P)
+        {
+        // Spectrum of the last 2P reference samples goes in X as newest
+        if(xNewest == 0)  xNewest = nPart;
+        xNewest--;
+        pX = X + xNewest*N2;
+        for(i=0; i<P; i++)
+            {
+            pX[2*i] = xPrev[i];              pX[2*i+1] = 0.0f;
+            pX[2*(i+P)] = refData[n0+i];     pX[2*(i+P)+1] = 0.0f;
+            xPrev[i] = refData[n0+i];
+            }
+        fftF.execute(pX);
+
+        // Smoothed power per bin, for the normalization.  Fast rise, so
+        // that a sudden increase can not make the step too large.
+        for(i=0; i<2*P; i++)
+            {
+            float32_t p2 = pX[2*i]*pX[2*i] + pX[2*i+1]*pX[2*i+1];
+            Pw[i] = 0.9f*Pw[i] + 0.1f*p2;
+            if(p2 > Pw[i])  Pw[i] = p2;
+            }
+
+        // Y = sum over partitions of W[k]X[k], then y is the last half of the IFFT
+        arm_fill_f32(0.0f, bufA, N2);
+        for(k=0; k<nPart; k++)
+            {
+            kx = (xNewest + k) % nPart;
+            pW = W + k*N2;
+            pX = X + kx*N2;
+            for(i=0; i<2*P; i++)
+                {
+                bufA[2*i]   += pW[2*i]*pX[2*i]   - pW[2*i+1]*pX[2*i+1];
+                bufA[2*i+1] += pW[2*i]*pX[2*i+1] + pW[2*i+1]*pX[2*i];
+                }
+            }
+        ifftF.execute(bufA);
+
+        // Error, with zeros in the first half for the FFT
+        for(i=0; i<P; i++)
+            {
+            float32_t y = bufA[2*(i+P)];
+            float32_t e = pIn[n0+i] - y;
+            pOut[n0+i] = (what==DENOISE) ? y : e;
+            bufB[2*i] = 0.0f;         bufB[2*i+1] = 0.0f;
+            bufB[2*(i+P)] = e;        bufB[2*(i+P)+1] = 0.0f;
+            }
+        fftF.execute(bufB);
+
+        // Normalized step for each bin.  Divided by nPart as all partitions
+        // move at once.  The mean power is added to each bin, as a tone
+        // between bins otherwise gives too large a step in the weak bins
+        // next to it.
+#ifdef LMS_NORMALIZE
+        float32_t pMean;
+        arm_mean_f32(Pw, 2*P, &pMean);
+#endif
+        for(i=0; i<2*P; i++)
+            {
+#ifdef LMS_NORMALIZE
+            float32_t mu = beta/((float32_t)nPart*(Pw[i] + pMean) + 1.0E-10f*(float32_t)N2);
+#else
+            float32_t mu = beta/(float32_t)nPart;
+#endif
+            bufB[2*i] *= mu;
+            bufB[2*i+1] *= mu;
+            }
+
+        // W[k] += conj(X[k])*E, and the leak
+        for(k=0; k<nPart; k++)
+            {
+            kx = (xNewest + k) % nPart;
+            pW = W + k*N2;
+            pX = X + kx*N2;
+            for(i=0; i<2*P; i++)
+                {
+                float32_t xr = pX[2*i];
+                float32_t xi = pX[2*i+1];
+                float32_t er = bufB[2*i];
+                float32_t ei = bufB[2*i+1];
+                pW[2*i]   = leakF*(pW[2*i]   + xr*er + xi*ei);
+                pW[2*i+1] = leakF*(pW[2*i+1] + xr*ei - xi*er);
+                }
+            }
+
+        // Gradient constraint, one partition each time.  The time domain
+        // partition is P long, so the last half of its IFFT is zeroed.
+        pW = W + nConstrain*N2;
+        ifftF.execute(pW);
+        for(i=P; i<2*P; i++)
+            {
+            pW[2*i] = 0.0f;
+            pW[2*i+1] = 0.0f;
+            }
+        for(i=0; i<P; i++)
+            pW[2*i+1] = 0.0f;       // Real FIR
+        fftF.execute(pW);
+        if(++nConstrain >= nPart)
+            nConstrain = 0;
         }
-        //transmit the block and be done
-        AudioStream_F32::transmit(blockOut);
-        AudioStream_F32::release(block);
-        AudioStream_F32::release(blockOut);
     }
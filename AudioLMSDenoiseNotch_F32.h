@@ -89,6 +89,30 @@
   * All timing was done with a delay buffer of 4, but this size has
   * very little effect, anyway. Normalization was off, also, but
   * again, this has a minor effect.
+  *
+  * Oct 2026 - Added block and frequency domain algorithms, selected by
+  * setAlgorithm() before initializeLMS().  All three have the same DENOISE
+  * and NOTCH outputs and use the same beta and decay.  The FIR can be up to
+  * MAX_FIR, 1024 for T4.x.
+  *   LMS_SAMPLE  The original sample by sample LMS.  The circular FIR buffer
+  *      is now double length (each sample written twice) so that the
+  *      dot product and the coefficient update are over contiguous data.
+  *   LMS_BLOCK   Block LMS.  The coefficients are held for a sub-block
+  *      (default 32 samples) while the gradient is summed, and the
+  *      reference data is a linear buffer.  No masking or wrap in the
+  *      inner loops, so arm_dot_prod_f32() does the FIR.
+  *   LMS_FDAF    Partitioned block frequency domain NLMS, (multi-delay
+  *      filter).  The FIR is split into partitions of P samples (default
+  *      128, or lengthDataF if smaller) and the filtering and gradient are
+  *      done with 2P point FFTs.  Each frequency bin is normalized by its
+  *      own power, so this converges faster for colored signals.  The
+  *      gradient constraint is applied to one partition per sub-block, in
+  *      turn.  This is the one to use for long FIR, such as feedback
+  *      cancellation, as the work grows as log(P) per tap, not as the
+  *      number of taps.  Memory, 8*lengthDataF+11*P floats, is allocated
+  *      by initializeLMS().
+  * The original MAX_FIR of 256 overran the 128 word arrays.  The arrays are
+  * now sized from MAX_FIR.
   */
 
 #ifndef _AudioLMSDenoiseNotch_F32_h
@@ -96,15 +120,25 @@
 
 #include <AudioStream_F32.h>
 #include "arm_math.h"
+#include "FFT_OA_F32.h"
 
 // Default is to use the normalized form of coefficient update
 #define LMS_NORMALIZE
 
+#if defined(__IMXRT1062__)
+#define MAX_FIR 1024
+#else
 #define MAX_FIR  256
+#endif
 #define MAX_DELAY 16
 #define DENOISE  1
 #define NOTCH    2
 
+// Algorithms for setAlgorithm()
+#define LMS_SAMPLE 0
+#define LMS_BLOCK  1
+#define LMS_FDAF   2
+
 class AudioLMSDenoiseNotch_F32 : public AudioStream_F32
 {
   //GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
@@ -113,22 +147,23 @@ class AudioLMSDenoiseNotch_F32 : public AudioStream_F32
     AudioLMSDenoiseNotch_F32(void) : AudioStream_F32(1, inputQueueArray_f32) {};
     AudioLMSDenoiseNotch_F32(const AudioSettings_F32 &settings) :
                                      AudioStream_F32(1, inputQueueArray_f32) {};
+    ~AudioLMSDenoiseNotch_F32(void) {
+        if(fdafMem)  delete [] fdafMem;
+        }
+
+    // Returns the FIR length achieved.  Clears the coefficients and data.
+    uint16_t initializeLMS(uint16_t _what, uint16_t _lengthDataF, uint16_t _lengthDataD);
 
-    uint16_t initializeLMS(uint16_t _what, uint16_t _lengthDataF, uint16_t _lengthDataD)
+    // LMS_SAMPLE (default), LMS_BLOCK or LMS_FDAF.  subBlock is the update
+    // interval for LMS_BLOCK, or the partition size for LMS_FDAF, a power
+    // of 2 from 8 to 128.  0 gives the default.  Call initializeLMS() after.
+    void setAlgorithm(uint16_t _algorithm, uint16_t _subBlock = 0)
         {
-        what = _what;
-        if(what != DENOISE && what != NOTCH)  what = DENOISE;
-        lengthDataF = powf(2.0f, log2f(_lengthDataF)+0.000001f);  //Make sure a power of 2
-        lengthDataF = (lengthDataF>MAX_FIR ? MAX_FIR : lengthDataF);  // Limit length
-        kMask = lengthDataF - 1;
-        lengthDataD = _lengthDataD;
-        lengthDataD = (lengthDataD>MAX_DELAY ? MAX_DELAY : lengthDataD);  // Limit length
-#ifdef LMS_NORMALIZE
-        for(int i=0; i<128; i++) powerNorm[i] = 0.01f;
-        pNorm = 0.01f * 128.0f;
-#endif
-        return lengthDataF;
+        algorithm = _algorithm;
+        if(algorithm > LMS_FDAF)  algorithm = LMS_SAMPLE;
+        subBlockReq = _subBlock;
         }
+    uint16_t getAlgorithm(void) { return algorithm; }
 
     // If setEnable is false the LMS object update() becomes pass-though.
     void enable(bool setEnable) {
@@ -144,6 +179,7 @@ class AudioLMSDenoiseNotch_F32 : public AudioStream_F32
         decay = _decay;
         if(decay>=1.0f) decay = 0.999999f;
         if(decay<0.000001) decay = 0.000001f;
+        setFdafLeak();
         }
 
     virtual void update(void);
@@ -158,15 +194,17 @@ class AudioLMSDenoiseNotch_F32 : public AudioStream_F32
     uint16_t kOffsetD = 0;
     uint16_t lengthDataD = 4;      // Any value, 2 to MAX_DELAY
 
-    float32_t coeff[128];
+    float32_t coeff[MAX_FIR];
 #ifdef LMS_NORMALIZE
     float32_t powerNorm[128];
     float32_t pNorm = 0.0f;
 #endif
 
-    // dataF[] is arranged, by added variables kOffset and
-    // lengthDataF, to be circular. A power-of-2 mask makes it circular.
-    float32_t dataF[128];           // Can be made less than 128 by lengthDataF
+    // For LMS_SAMPLE dataF[] is circular, with every sample written at k and
+    // k+lengthDataF, so that dataF[kOffsetF] to dataF[kOffsetF+lengthDataF-1]
+    // is always the whole FIR, contiguous.  For LMS_BLOCK it is a linear
+    // buffer of lengthDataF-1 old reference samples followed by 128 new ones.
+    float32_t dataF[2*MAX_FIR];
     float32_t dataOutF = 0.0f;
     uint16_t kOffsetF = 0;
     uint16_t lengthDataF = 64;
@@ -175,5 +213,37 @@ class AudioLMSDenoiseNotch_F32 : public AudioStream_F32
     float32_t beta = 0.03f;
     float32_t decay = 0.995f;
     uint16_t numLeak = 0;
+
+    uint16_t algorithm = LMS_SAMPLE;
+    uint16_t subBlockReq = 0;
+    uint16_t subBlock = 32;        // Block LMS update, or FDAF partition, size
+    float32_t refData[128];        // Delayed input for one block
+    float32_t errData[128];
+
+    // LMS_FDAF, see initializeLMS() for the layout of fdafMem
+    float32_t *fdafMem = NULL;
+    float32_t *W = NULL;           // nPart spectra of 2*subBlock complex
+    float32_t *X = NULL;           // nPart input spectra, circular
+    float32_t *Pw = NULL;          // Smoothed power per bin
+    float32_t *bufA = NULL;        // 2*subBlock complex work buffers
+    float32_t *bufB = NULL;
+    float32_t *xPrev = NULL;       // Previous subBlock of reference
+    uint16_t nPart = 1;
+    uint16_t xNewest = 0;          // Index of newest spectrum in X
+    uint16_t nConstrain = 0;       // Next partition to constrain
+    float32_t leakF = 1.0f;        // decay, per subBlock, for all of W
+    FFT_F32 fftF;
+    IFFT_F32 ifftF;
+    int nFFTsetup = 0;
+
+    void updateSample(float32_t *pIn, float32_t *pOut);
+    void updateBlock(float32_t *pIn, float32_t *pOut);
+    void updateFDAF(float32_t *pIn, float32_t *pOut);
+    void makeReference(float32_t *pIn);
+    void setFdafLeak(void)
+        {
+        // Same average leak as one coefficient per sample
+        leakF = powf(decay, (float32_t)subBlock/(float32_t)lengthDataF);
+        }
 };
 #endif
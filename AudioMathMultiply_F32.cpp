@@ -6,6 +6,34 @@ void AudioMathMultiply_F32::update(void) {
   block = AudioStream_F32::receiveWritable_f32(0);
   if (!block) return;
 
+  // A control connection to input 1, if any, in place of the audio
+  if (AudioStream_F32::controlInputConnected(1)) {
+    float32_t v[AUDIO_F32_CONTROL_POINTS];
+    int n = AudioStream_F32::receiveControl(v, 1);
+    in = AudioStream_F32::receiveReadOnly_f32(1);
+    if (in) AudioStream_F32::release(in);
+    if (n > 0 && !havePrev) {
+      // Nothing to ramp from, so start flat at the first value
+      control_prev = v[0];
+      havePrev = true;
+    }
+    if (!havePrev) {
+      // No gain yet, as with no audio In 1
+      AudioStream_F32::release(block);
+      return;
+    }
+    if (n > 0) {
+      AudioStream_F32::multiplyControl(block->data, block->data, block->length,
+                                       control_prev, v, n);
+      control_prev = v[n - 1];
+    } else {
+      arm_scale_f32(block->data, control_prev, block->data, block->length);
+    }
+    AudioStream_F32::transmit(block);
+    AudioStream_F32::release(block);
+    return;
+  }
+
   in = AudioStream_F32::receiveReadOnly_f32(1);
   if (!in) {
     AudioStream_F32::release(block);
@@ -6,6 +6,12 @@
  * Assumes floating-point data.
  *          
  * This processes a single stream fo audio data (ie, it is mono)       
+ *
+ * Oct 2026: Control input 1.  An AudioControlConnection_F32 to input 1, such
+ * as the gain from AudioCalcGainWDRC_F32, is used in place of the audio
+ * In 1, interpolated from the last values to the new.  That needs no pool
+ * block for the gain.  See AudioStream_F32.h.  There is no output until the
+ * first control value, and the first block starts at that value, not zero.
  *          
  * MIT License.  use at your own risk.
 */
@@ -26,6 +32,8 @@ class AudioMathMultiply_F32 : public AudioStream_F32
     
   private:
     audio_block_f32_t *inputQueueArray_f32[2];
+    float32_t control_prev = 0.0f;   // Last value on control input 1
+    bool havePrev = false;           // control_prev has been received
 };
 
 #endif
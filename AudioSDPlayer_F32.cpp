@@ -91,6 +91,7 @@ bool AudioSDPlayer_F32::play(const char *filename)
     }
     buffer_length = 0;
     buffer_offset = 0;
+    sample_counter = 0;
     state_play = STATE_STOP;
     data_length = 20;
     header_offset = 0;
@@ -202,6 +203,7 @@ cleanup:
             for (uint32_t i=block_offset; i < audio_block_samples; i++) {
                 block_left_f32->data[i] = 0.0f;
             }
+            stampBlocks();
             transmit(block_left_f32, 0);
             if (state < 8 && (state & 1) == 0) {
                 transmit(block_left_f32, 1);
@@ -223,6 +225,20 @@ cleanup:
 }
 
 
+// Give the output blocks the sample index of their first sample, counting
+// from the start of the file.  Called just before they are transmitted.
+void AudioSDPlayer_F32::stampBlocks(void)  {
+    if (block_left_f32) {
+        block_left_f32->sampleIndex = sample_counter;
+        block_left_f32->id = (unsigned long)(sample_counter/audio_block_samples);
+    }
+    if (block_right_f32) {
+        block_right_f32->sampleIndex = sample_counter;
+        block_right_f32->id = (unsigned long)(sample_counter/audio_block_samples);
+    }
+    sample_counter += audio_block_samples;
+}
+
 // Consume already buffered WAV file data.  Returns true if audio transmitted.
 bool AudioSDPlayer_F32::consume(uint32_t size)  {
     uint32_t len;
@@ -412,6 +428,7 @@ start:
                         arm_fir_f32(&fir_instL, block_left_f32->data,
                            block_left_f32->data, block_left_f32->length);
                         }
+                    stampBlocks();
                     transmit(block_left_f32, 0);  // Mono sends same to L&R
                     transmit(block_left_f32, 1);
 
@@ -448,6 +465,7 @@ start:
                         arm_fir_f32(&fir_instL, block_left_f32->data,
                            block_left_f32->data, block_left_f32->length);
                         }
+                    stampBlocks();
                     transmit(block_left_f32, 0);  // Mono sends same to L&R
                     transmit(block_left_f32, 1);
                     AudioStream_F32::release(block_left_f32);
@@ -504,6 +522,7 @@ start:
                         arm_fir_f32(&fir_instR, block_right_f32->data,
                            block_right_f32->data, block_right_f32->length);
                         }
+                    stampBlocks();
                     transmit(block_left_f32,  0);
                     transmit(block_right_f32, 1);
                     AudioStream_F32::release(block_left_f32);
@@ -556,6 +575,7 @@ start:
                         arm_fir_f32(&fir_instR, block_right_f32->data,
                            block_right_f32->data, block_right_f32->length);
                         }
+                    stampBlocks();
                     transmit(block_left_f32, 0);
                     AudioStream_F32::release(block_left_f32);
                     block_left_f32 = NULL;
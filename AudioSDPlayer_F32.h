@@ -221,6 +221,8 @@ class AudioSDPlayer_F32 : public AudioStream_F32
     uint16_t audio_block_samples = AUDIO_BLOCK_SAMPLES;
 
     uint32_t updateBytes2Millis(void);
+    uint64_t sample_counter = 0;   // For block sampleIndex
+    void stampBlocks(void);
     //int32_t pctr = 0;
 };
 
@@ -0,0 +1,249 @@
+/*
+ * AudioSDRecorder_F32.cpp
+ *
+ * See AudioSDRecorder_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include <Arduino.h>
+#include "AudioSDRecorder_F32.h"
+
+// Little-endian writes for the WAV header
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;  p[1] = (uint8_t)(v >> 8);
+    }
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;          p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);  p[3] = (uint8_t)(v >> 24);
+    }
+static void put64(uint8_t *p, uint64_t v) {
+    put32(p, (uint32_t)v);  put32(p+4, (uint32_t)(v >> 32));
+    }
+
+bool AudioSDRecorder_F32::record(const char *filename, uint64_t preAllocateBytes) {
+    uint8_t header[SDREC_HEADER_BYTES];
+
+    if(recording || fileOpen) stop();
+    if(ringBuf==NULL || ringSize < 2*writeChunk)
+        return false;
+
+    wavfile = SD.sdfs.open(filename, O_RDWR | O_CREAT | O_TRUNC);
+    if(!wavfile)
+        return false;
+    // Contiguous space keeps the SD card write times short.  A failure
+    // here is not fatal, the file just grows as it is written.
+    if(preAllocateBytes > 0)
+        wavfile.preAllocate(preAllocateBytes + SDREC_HEADER_BYTES);
+
+    // Header with zero sizes, in case of power loss.  Patched by stop().
+    buildHeader(header, 0ULL);
+    if(wavfile.write(header, SDREC_HEADER_BYTES) != SDREC_HEADER_BYTES) {
+        wavfile.close();
+        return false;
+        }
+    fileOpen = true;
+    bytesWritten = 0;
+
+    __disable_irq();
+    ringHead = 0;
+    ringTail = 0;
+    overrunCount = 0;
+    missingBlockCount = 0;
+    bufferMaxUsed = 0;
+    framesRecorded = 0;
+    recording = true;
+    __enable_irq();
+    return true;
+    }
+
+// Call from loop().  Writes full chunks from the ring buffer to the SD card.
+// Returns the number of bytes written.
+uint32_t AudioSDRecorder_F32::service(void) {
+    uint32_t nTotal = 0;
+    uint32_t n;
+
+    if(!fileOpen) return 0;
+    while(getBufferUsed() >= writeChunk) {
+        n = writeRing(writeChunk);
+        if(n == 0) break;
+        nTotal += n;
+        }
+    return nTotal;
+    }
+
+// Write up to maxBytes from the ring buffer to the file, as a single SD
+// write.  Since ringSize is a multiple of 512 and writes are all done in
+// multiples of 512 (except the last one at stop()) the ring end never splits
+// a sector.
+uint32_t AudioSDRecorder_F32::writeRing(uint32_t maxBytes) {
+    uint32_t used = getBufferUsed();
+    uint32_t t = ringTail;
+    uint32_t n = ringSize - t;         // Contiguous bytes to end of ring
+    if(n > used)      n = used;
+    if(n > maxBytes)  n = maxBytes;
+    if(n == 0) return 0;
+    if(wavfile.write(ringBuf + t, n) != n)
+        return 0;          // SD card error, try again next time
+    t += n;
+    if(t >= ringSize) t = 0;
+    ringTail = t;
+    bytesWritten += n;
+    return n;
+    }
+
+void AudioSDRecorder_F32::stop(void) {
+    uint8_t header[SDREC_HEADER_BYTES];
+
+    recording = false;      // update() stops filling the ring buffer
+    if(!fileOpen) return;
+
+    // Empty out the ring buffer, including any partial sector
+    while(getBufferUsed() > 0)  {
+        if(writeRing(writeChunk) == 0)
+            break;
+        }
+    // Drop any of the pre-allocation not used
+    wavfile.truncate(SDREC_HEADER_BYTES + bytesWritten);
+    buildHeader(header, bytesWritten);
+    wavfile.seekSet(0);
+    wavfile.write(header, SDREC_HEADER_BYTES);
+    wavfile.close();
+    fileOpen = false;
+    }
+
+void AudioSDRecorder_F32::update(void) {
+    audio_block_f32_t *blockIn[SDREC_MAX_CHANNELS];
+    uint16_t ch, i, nGot;
+    uint32_t nBytes, space, h, n, used;
+    uint16_t frameBytes = numChannels*bytesPerSample;
+
+    nGot = 0;
+    for(ch=0; ch<SDREC_MAX_CHANNELS; ch++)  {
+        blockIn[ch] = receiveReadOnly_f32(ch);
+        if(blockIn[ch] && ch<numChannels)
+            nGot++;
+        }
+    if(!recording || nGot==0)  {
+        for(ch=0; ch<SDREC_MAX_CHANNELS; ch++)
+            if(blockIn[ch])  AudioStream_F32::release(blockIn[ch]);
+        return;
+        }
+
+    nBytes = (uint32_t)block_size*frameBytes;
+    used = getBufferUsed();
+    space = ringSize - 1 - used;
+    if(nBytes > space)  {
+        overrunCount++;        // No room, this block is lost
+        for(ch=0; ch<SDREC_MAX_CHANNELS; ch++)
+            if(blockIn[ch])  AudioStream_F32::release(blockIn[ch]);
+        return;
+        }
+    if(used + nBytes > bufferMaxUsed)
+        bufferMaxUsed = used + nBytes;
+
+    // Interleave and convert to the file format
+    for(ch=0; ch<numChannels; ch++)  {
+        uint8_t *pOut = stage + ch*bytesPerSample;
+        if(blockIn[ch] == NULL)  {
+            missingBlockCount++;
+            for(i=0; i<block_size; i++)  {
+                memset(pOut, 0, bytesPerSample);
+                pOut += frameBytes;
+                }
+            }
+        else if(format == SDREC_INT24)  {
+            float32_t *pIn = blockIn[ch]->data;
+            for(i=0; i<block_size; i++)  {
+                float32_t x = pIn[i];
+                if(x > 1.0f) x = 1.0f;
+                else if(x < -1.0f) x = -1.0f;
+                int32_t v = (int32_t)(x*8388607.0f);
+                pOut[0] = (uint8_t)v;
+                pOut[1] = (uint8_t)(v >> 8);
+                pOut[2] = (uint8_t)(v >> 16);
+                pOut += frameBytes;
+                }
+            }
+        else  {     // float32, native little-endian
+            float32_t *pIn = blockIn[ch]->data;
+            for(i=0; i<block_size; i++)  {
+                memcpy(pOut, &pIn[i], 4);
+                pOut += frameBytes;
+                }
+            }
+        }
+    for(ch=0; ch<SDREC_MAX_CHANNELS; ch++)
+        if(blockIn[ch])  AudioStream_F32::release(blockIn[ch]);
+
+    // Copy to ring buffer, in two parts if it wraps
+    h = ringHead;
+    n = ringSize - h;
+    if(n > nBytes) n = nBytes;
+    memcpy(ringBuf + h, stage, n);
+    if(n < nBytes)
+        memcpy(ringBuf, stage + n, nBytes - n);
+    h += nBytes;
+    if(h >= ringSize) h -= ringSize;
+    ringHead = h;        // Only now can service() see the new data
+    framesRecorded += block_size;
+    }
+
+/* 512 byte WAVE_FORMAT_EXTENSIBLE header:
+ *   0 "RIFF" or "RF64", size, "WAVE"
+ *  12 "JUNK" 28 bytes, or "ds64" for RF64 files
+ *  48 "fmt " 40 bytes
+ *  96 "fact" 4 bytes
+ * 108 "JUNK" 388 bytes, pads header to 512
+ * 504 "data" size
+ */
+void AudioSDRecorder_F32::buildHeader(uint8_t *h, uint64_t dataBytes) {
+    // KSDATAFORMAT_SUBTYPE GUID, less the first two bytes
+    static const uint8_t guidTail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                       0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    uint16_t blockAlign = numChannels*bytesPerSample;
+    uint64_t frames = dataBytes/blockAlign;
+    uint64_t riffSize = SDREC_HEADER_BYTES - 8 + dataBytes;
+    bool rf64 = (riffSize > 0XFFFFFFFFULL);
+    uint32_t channelMask = 0;  // No speaker positions for >2 channels
+    if(numChannels==1)      channelMask = 0X4;   // Front center
+    else if(numChannels==2) channelMask = 0X3;   // Front left, right
+
+    memset(h, 0, SDREC_HEADER_BYTES);
+    memcpy(h, rf64 ? "RF64" : "RIFF", 4);
+    put32(h+4, rf64 ? 0XFFFFFFFFUL : (uint32_t)riffSize);
+    memcpy(h+8, "WAVE", 4);
+
+    memcpy(h+12, rf64 ? "ds64" : "JUNK", 4);
+    put32(h+16, 28);
+    if(rf64)  {
+        put64(h+20, riffSize);
+        put64(h+28, dataBytes);
+        put64(h+36, frames);
+        put32(h+44, 0);        // No table entries
+        }
+
+    memcpy(h+48, "fmt ", 4);
+    put32(h+52, 40);
+    put16(h+56, 0XFFFE);       // WAVE_FORMAT_EXTENSIBLE
+    put16(h+58, numChannels);
+    put32(h+60, (uint32_t)(sample_rate_Hz + 0.5f));
+    put32(h+64, (uint32_t)(sample_rate_Hz + 0.5f)*blockAlign);
+    put16(h+68, blockAlign);
+    put16(h+70, 8*bytesPerSample);
+    put16(h+72, 22);           // Extension size
+    put16(h+74, 8*bytesPerSample);
+    put32(h+76, channelMask);
+    put16(h+80, (format==SDREC_INT24) ? 1 : 3);   // PCM or IEEE float
+    memcpy(h+82, guidTail, 14);
+
+    memcpy(h+96, "fact", 4);
+    put32(h+100, 4);
+    put32(h+104, rf64 ? 0XFFFFFFFFUL : (uint32_t)frames);
+
+    memcpy(h+108, "JUNK", 4);
+    put32(h+112, SDREC_HEADER_BYTES - 108 - 8 - 8);
+
+    memcpy(h+504, "data", 4);
+    put32(h+508, rf64 ? 0XFFFFFFFFUL : (uint32_t)dataBytes);
+    }
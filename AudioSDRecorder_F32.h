@@ -0,0 +1,176 @@
+/*
+ * AudioSDRecorder_F32.h
+ *
+ * Streaming recorder for the OpenAudio_ArduinoLibrary.  Up to four channels
+ * of F32 audio are written to a WAV file on the SD card, as either 32-bit
+ * float or 24-bit integer samples.
+ *
+ * MIT License,  Use at your own risk.
+ *
+ * The problem with AudioRecordQueue_F32 for long recordings is that it holds
+ * audio blocks from the F32 pool.  If the SD card takes a long time for a write,
+ * as they all do now and then, the pool empties and audio is lost.  This class
+ * copies the audio, interleaved and converted to the file format, into a
+ * large byte ring buffer supplied by the INO.  That buffer can be in PSRAM
+ * (EXTMEM) and can hold several seconds of audio.  The update() only fills the
+ * ring buffer.  The writing to the SD card is done by service(), that is
+ * called from the INO loop().  Thus the SD card never is accessed in the
+ * audio interrupt.
+ *
+ * The file can be pre-allocated with a size in bytes.  For exFAT cards this
+ * gives a contiguous file and the SD card write times stay short.  At stop()
+ * the file is truncated to the recorded length and the header is patched with
+ * the final sizes.  Files larger than 4 GB use the RF64 format (EBU Tech 3306)
+ * that most audio programs can read.  For this, the header has a JUNK chunk
+ * right after "WAVE" that gets turned into the "ds64" chunk.  The header is
+ * padded to 512 bytes so that all audio data writes are sector aligned.
+ *
+ * Sizes: Four channels at 48 kHz is 768 kB/sec as float and 576 kB/sec as
+ * 24-bit.  A ring buffer of 2 MB (EXTMEM) gives over 2.5 seconds of slack
+ * for the SD card.  The write chunk size, default 16 kB, should be a few
+ * times smaller than the ring buffer.
+ *
+ * If the ring buffer is full when update() is called, that block of data is
+ * not recorded and the overrun counter is incremented.  If an input has no
+ * block (not connected, or the pool was empty) zeros are recorded for that
+ * channel and missing block counter is incremented.
+ *
+ * Functions:
+ *   setBuffer(uint8_t* pBuffer, uint32_t nBytes)  Ring buffer from the INO
+ *   setNumChannels(uint16_t n)  1 to 4 channels, inputs 0 to n-1
+ *   setFormat(uint16_t f)       SDREC_FLOAT32 or SDREC_INT24
+ *   setWriteChunk(uint32_t n)   Bytes per SD write, multiple of 512
+ *   record(filename, preAllocateBytes)  Opens file and starts recording
+ *   service()                   Call from loop() often.  Writes to SD.
+ *   stop()                      Write remaining data, patch header, close
+ *   isRecording()
+ *   getOverrunCount(), getMissingBlockCount(), getBufferMaxUsed()
+ *   getFramesRecorded(), getBytesWritten()
+ *
+ * Only one of this class and AudioSDPlayer_F32 should use an SPI connected
+ * SD card at a time, as the player reads the card in the audio interrupt.
+ * The Teensy 3.6/4.1 built-in SDIO card has no such limitation.
+ */
+
+#ifndef AudioSDRecorder_F32_h_
+#define AudioSDRecorder_F32_h_
+
+#include "Arduino.h"
+#include "AudioSettings_F32.h"
+#include "AudioStream_F32.h"
+#include <SD.h>
+
+#define SDREC_FLOAT32 0
+#define SDREC_INT24   1
+
+#define SDREC_MAX_CHANNELS 4
+#define SDREC_HEADER_BYTES 512
+
+class AudioSDRecorder_F32 : public AudioStream_F32
+{
+//GUI: inputs:4, outputs:0  //this line used for automatic generation of GUI nodes
+//GUI: shortName:recordSdWav
+public:
+    AudioSDRecorder_F32(void) : AudioStream_F32(SDREC_MAX_CHANNELS, inputQueueArray_f32) {
+        sample_rate_Hz = AUDIO_SAMPLE_RATE;
+        block_size = AUDIO_BLOCK_SAMPLES;
+        }
+
+    AudioSDRecorder_F32(const AudioSettings_F32 &settings) :
+                AudioStream_F32(SDREC_MAX_CHANNELS, inputQueueArray_f32) {
+        sample_rate_Hz = settings.sample_rate_Hz;
+        block_size = settings.audio_block_samples;
+        }
+
+    // The ring buffer is supplied by the INO, and can be EXTMEM.  The size
+    // is rounded down to a multiple of 512 bytes.  Do not change while recording.
+    void setBuffer(uint8_t* pBuffer, uint32_t nBytes) {
+        if(recording) return;
+        ringBuf = pBuffer;
+        ringSize = nBytes & ~(uint32_t)511;
+        }
+
+    void setNumChannels(uint16_t _nCh) {
+        if(recording) return;
+        if(_nCh < 1) _nCh = 1;
+        if(_nCh > SDREC_MAX_CHANNELS) _nCh = SDREC_MAX_CHANNELS;
+        numChannels = _nCh;
+        }
+
+    // SDREC_FLOAT32 (default) or SDREC_INT24
+    void setFormat(uint16_t _format) {
+        if(recording) return;
+        format = _format;
+        bytesPerSample = (format==SDREC_INT24) ? 3 : 4;
+        }
+
+    // Bytes per SD card write.  Larger chunks are more efficient for the card.
+    void setWriteChunk(uint32_t _nBytes) {
+        _nBytes &= ~(uint32_t)511;
+        if(_nBytes < 512) _nBytes = 512;
+        writeChunk = _nBytes;
+        }
+
+    void setSampleRate_Hz(float32_t _fs_Hz) {
+        if(recording) return;
+        sample_rate_Hz = _fs_Hz;
+        }
+
+    bool record(const char *filename, uint64_t preAllocateBytes = 0);
+    uint32_t service(void);
+    void stop(void);
+    bool isRecording(void)  { return recording; }
+
+    uint32_t getOverrunCount(void)       { return overrunCount; }
+    uint32_t getMissingBlockCount(void)  { return missingBlockCount; }
+    uint32_t getBufferMaxUsed(void)      { return bufferMaxUsed; }
+    uint64_t getBytesWritten(void)       { return bytesWritten; }
+    // Sample frames (one sample for every channel) put into the ring buffer
+    uint64_t getFramesRecorded(void) {
+        __disable_irq();
+        uint64_t f = framesRecorded;
+        __enable_irq();
+        return f;
+        }
+    uint32_t getBufferUsed(void)  {
+        uint32_t h = ringHead;
+        uint32_t t = ringTail;
+        return (h >= t) ? h - t : ringSize + h - t;
+        }
+
+    virtual void update(void);
+
+private:
+    audio_block_f32_t *inputQueueArray_f32[SDREC_MAX_CHANNELS];
+    float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
+    uint16_t block_size = AUDIO_BLOCK_SAMPLES;
+    uint16_t numChannels = 2;
+    uint16_t format = SDREC_FLOAT32;
+    uint16_t bytesPerSample = 4;
+
+    FsFile wavfile;
+    volatile bool recording = false;
+    bool fileOpen = false;
+
+    // Ring buffer.  Written only by update() at ringHead, read only by
+    // service() at ringTail.  One byte is always left empty, so that
+    // ringHead==ringTail means an empty buffer.
+    uint8_t* ringBuf = NULL;
+    uint32_t ringSize = 0;
+    volatile uint32_t ringHead = 0;
+    volatile uint32_t ringTail = 0;
+    uint32_t writeChunk = 16384;
+
+    // Interleaved, converted audio for one update(), before going to ringBuf
+    uint8_t stage[AUDIO_BLOCK_SAMPLES*SDREC_MAX_CHANNELS*4];
+
+    volatile uint32_t overrunCount = 0;
+    volatile uint32_t missingBlockCount = 0;
+    volatile uint32_t bufferMaxUsed = 0;
+    uint64_t framesRecorded = 0;
+    uint64_t bytesWritten = 0;     // Audio data bytes, not including header
+
+    uint32_t writeRing(uint32_t maxBytes);
+    void buildHeader(uint8_t *h, uint64_t dataBytes);
+};
+#endif
@@ -124,6 +124,14 @@ int AudioSpectralDenoise_F32::setup(const AudioSettings_F32 & settings,
 
 void AudioSpectralDenoise_F32::update(void)
 {
+  //the speech probability from a VAD on In 1, if connected, or -1.0
+  float32_t vad_prob = -1.0;
+  audio_block_f32_t *vad_block = AudioStream_F32::receiveReadOnly_f32(1);
+  if (vad_block) {
+    vad_prob = vad_block->data[vad_block->length - 1];
+    AudioStream_F32::release(vad_block);
+  }
+
   //get a pointer to the latest data
   audio_block_f32_t *in_audio_block = AudioStream_F32::receiveReadOnly_f32();
   if (!in_audio_block)
@@ -223,6 +231,9 @@ void AudioSpectralDenoise_F32::update(void)
     } else {
       ph1y[bindx] = fmin(ph1y[bindx], 1.0);
     }
+    // the VAD, limited as above, so the noise estimate still moves
+    if (vad_prob > ph1y[bindx])
+      ph1y[bindx] = fmin(vad_prob, 1.0 - pnsaf);
     // estimated raw noise spectrum
     xtr = (1.0 - ph1y[bindx]) * NR_X[bindx] + ph1y[bindx] * xt[bindx];
     // smooth the noise estimate
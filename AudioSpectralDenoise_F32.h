@@ -5,6 +5,11 @@
  * Purpose: Spectral noise reduction
  *          
  * This processes a single stream of audio data (i.e., it is mono)     
+ *
+ * Oct 2026: Optional In 1, the speech probability from AudioCalcVAD_F32.
+ * When connected, it is a floor on the speech presence probability of
+ * every bin, so the noise estimate is not taken from speech.  Unconnected,
+ * as before.
  *          
  * License: GNU GPLv3 License
  *  As the code it is derived from is GPLv3
@@ -25,16 +30,16 @@
 #include <Arduino.h>
 
 class AudioSpectralDenoise_F32:public AudioStream_F32 {
-//GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
+//GUI: inputs:2, outputs:1  //this line used for automatic generation of GUI node
 //GUI: shortName:spectral
 public:
-  AudioSpectralDenoise_F32(void):AudioStream_F32(1, inputQueueArray_f32) {
+  AudioSpectralDenoise_F32(void):AudioStream_F32(2, inputQueueArray_f32) {
   };
   AudioSpectralDenoise_F32(const AudioSettings_F32 &
-                           settings):AudioStream_F32(1, inputQueueArray_f32) {
+                           settings):AudioStream_F32(2, inputQueueArray_f32) {
   }
   AudioSpectralDenoise_F32(const AudioSettings_F32 & settings,
-                           const int _N_FFT):AudioStream_F32(1,
+                           const int _N_FFT):AudioStream_F32(2,
                                                              inputQueueArray_f32)
   {
     setup(settings, _N_FFT);
@@ -68,6 +73,10 @@ public:
   bool enabled(void) {
     return is_enabled;
   }
+  // The overlap buffering delay.  When not enabled, the audio passes directly.
+  uint32_t getLatencySamples(void) {
+    return is_enabled ? (uint32_t)myIFFT.getLatencySamples() : 0;
+  }
 
   //Getters and Setters
   float32_t getAsnr(void) {
@@ -136,7 +145,7 @@ private:
   uint8_t init_phase = 1;       //Track our phases of initialisation
   int is_enabled = 0;
   float32_t *complex_2N_buffer; //Store our FFT real/imag data
-  audio_block_f32_t *inputQueueArray_f32[1];  //memory pointer for the input to this module
+  audio_block_f32_t *inputQueueArray_f32[2];  //memory pointer for the inputs to this module
   FFT_Overlapped_OA_F32 myFFT;
   IFFT_Overlapped_OA_F32 myIFFT;
   int N_FFT = -1;               //How big an FFT are we using?
@@ -6,6 +6,8 @@ uint32_t AudioStream_F32::f32_memory_pool_available_mask[6];
 
 uint8_t AudioStream_F32::f32_memory_used = 0;
 uint8_t AudioStream_F32::f32_memory_used_max = 0;
+int AudioStream_F32::f32_default_length = AUDIO_BLOCK_SAMPLES;
+float AudioStream_F32::f32_default_fs_Hz = AUDIO_SAMPLE_RATE;
 
 audio_block_f32_t* allocate_f32_memory(const int num) {
     static bool firstTime=true;
@@ -46,6 +48,8 @@ void AudioStream_F32::initialize_f32_memory(audio_block_f32_t *data, unsigned in
   for (i=0; i < num; i++) {
     data[i].memory_pool_index = i;
   }
+  f32_default_length = AUDIO_BLOCK_SAMPLES;
+  f32_default_fs_Hz = AUDIO_SAMPLE_RATE;
   __enable_irq();
 
 } // end initialize_memory
@@ -56,10 +60,14 @@ void AudioStream_F32::initialize_f32_memory(audio_block_f32_t *data, unsigned in
      data[i].fs_Hz = settings.sample_rate_Hz;
      data[i].length = settings.audio_block_samples;
  }
+ f32_default_length = settings.audio_block_samples;
+ f32_default_fs_Hz = settings.sample_rate_Hz;
 } // end initialize_memory
 
 // Allocate 1 audio data block.  If successful
-// the caller is the only owner of this new block
+// the caller is the only owner of this new block.
+// length and fs_Hz are those of the pool, as set by AudioMemory_F32(),
+// whatever the last owner left.
 audio_block_f32_t * AudioStream_F32::allocate_f32(void)
 {
   uint32_t n, index, avail;
@@ -100,6 +108,10 @@ audio_block_f32_t * AudioStream_F32::allocate_f32(void)
   index = p - f32_memory_pool_available_mask;
   block = f32_memory_pool + ((index << 5) + (31 - n));
   block->ref_count = 1;
+  block->sampleIndex = AUDIO_F32_NO_SAMPLE_INDEX;  // Not yet stamped
+  block->id = 0;
+  block->length = f32_default_length;
+  block->fs_Hz = f32_default_fs_Hz;
   if (used > f32_memory_used_max) f32_memory_used_max = used;
   // Serial.print("alloc_f32:");  Serial.println((uint32_t)block, HEX);
   return block;
@@ -134,6 +146,12 @@ void AudioStream_F32::release(audio_block_f32_t *block)
 // and then release it once after all transmit calls.
 void AudioStream_F32::transmit(audio_block_f32_t *block, unsigned char index)
 {
+  // Un-stamped outputs inherit from the primary input, see AudioStream_F32.h
+  if (block->sampleIndex == AUDIO_F32_NO_SAMPLE_INDEX) {
+    block->sampleIndex = inSampleIndex;
+    block->id = inId;
+  }
+  inStale = true;  // The next receive is for the next update
   //Serial.print("AudioStream_F32: transmit().  start...index = ");Serial.println(index);
   for (AudioConnection_F32 *c = destination_list_f32; c != NULL; c = c->next_dest) {
       //Serial.print("  : loop1, c->src_index = ");Serial.println(c->src_index);
@@ -150,6 +168,117 @@ void AudioStream_F32::transmit(audio_block_f32_t *block, unsigned char index)
   //Serial.println("AudioStream_F32: transmit(). finished.");
 }
 
+// True if anything is connected to the audio output
+bool AudioStream_F32::outputConnected(unsigned char index)
+{
+  for (AudioConnection_F32 *c = destination_list_f32; c != NULL; c = c->next_dest) {
+    if (c->src_index == index) return true;
+  }
+  return false;
+}
+
+// Send values to all control connections from a control output.  Values
+// not yet received are replaced, as only the newest matter.
+void AudioStream_F32::transmitControl(const float32_t *v, int n, unsigned char index)
+{
+  if (n > AUDIO_F32_CONTROL_POINTS) n = AUDIO_F32_CONTROL_POINTS;
+  if (n < 1) return;
+  for (AudioControlConnection_F32 *c = control_dest_list_f32; c != NULL; c = c->next_dest) {
+    if (c->src_index == index) {
+      for (int k = 0; k < n; k++) c->value[k] = v[k];
+      c->n = n;
+    }
+  }
+}
+
+// Receive values from a control input, into v[], with room for
+// AUDIO_F32_CONTROL_POINTS.  Returns the number, or 0 if none are waiting.
+int AudioStream_F32::receiveControl(float32_t *v, unsigned int index)
+{
+  for (AudioControlConnection_F32 *c = control_src_list_f32; c != NULL; c = c->next_src) {
+    if (c->dest_index == index && c->n > 0) {
+      int n = c->n;
+      for (int k = 0; k < n; k++) v[k] = c->value[k];
+      c->n = 0;
+      return n;
+    }
+  }
+  return 0;
+}
+
+bool AudioStream_F32::controlOutputConnected(unsigned char index)
+{
+  for (AudioControlConnection_F32 *c = control_dest_list_f32; c != NULL; c = c->next_dest) {
+    if (c->src_index == index) return true;
+  }
+  return false;
+}
+
+bool AudioStream_F32::controlInputConnected(unsigned int index)
+{
+  for (AudioControlConnection_F32 *c = control_src_list_f32; c != NULL; c = c->next_src) {
+    if (c->dest_index == index) return true;
+  }
+  return false;
+}
+
+// Linear from prev to v[0] over the first n-th of the block, and so on,
+// so that out[length-1] is v[n-1]
+void AudioStream_F32::controlToBlock(float32_t prev, const float32_t *v, int n,
+                                     float32_t *out, int length)
+{
+  int i0 = 0;
+  for (int k = 0; k < n; k++) {
+    int i1 = ((k + 1) * length) / n;
+    if (i1 > i0) {
+      float32_t step = (v[k] - prev) / (float32_t)(i1 - i0);
+      for (int i = i0; i < i1; i++) out[i] = prev + step * (float32_t)(i - i0 + 1);
+    }
+    prev = v[k];
+    i0 = i1;
+  }
+}
+
+// As controlToBlock(), times in[]
+void AudioStream_F32::multiplyControl(const float32_t *in, float32_t *out, int length,
+                                      float32_t prev, const float32_t *v, int n)
+{
+  int i0 = 0;
+  for (int k = 0; k < n; k++) {
+    int i1 = ((k + 1) * length) / n;
+    if (i1 > i0) {
+      float32_t step = (v[k] - prev) / (float32_t)(i1 - i0);
+      for (int i = i0; i < i1; i++)
+        out[i] = in[i] * (prev + step * (float32_t)(i - i0 + 1));
+    }
+    prev = v[k];
+    i0 = i1;
+  }
+}
+
+// Keep the sampleIndex and id of the primary input, input 0, or failing
+// that the newest input, for transmit() to stamp outputs with.  Called for
+// every receive, including those that return NULL, so that a missing input
+// 0 does not leave the previous update's values.
+void AudioStream_F32::noteInputInfo(unsigned int index, const audio_block_f32_t *in)
+{
+  uint32_t bit = (index < 32) ? (1UL << index) : 0;
+  if (inStale || (inReceived & bit)) {
+    // A new update
+    inSampleIndex = AUDIO_F32_NO_SAMPLE_INDEX;
+    inId = 0;
+    inReceived = 0;
+    inStale = false;
+  }
+  inReceived |= bit;
+  if (in == NULL || in->sampleIndex == AUDIO_F32_NO_SAMPLE_INDEX) return;
+  if (index == 0 || inSampleIndex == AUDIO_F32_NO_SAMPLE_INDEX
+                 || in->sampleIndex > inSampleIndex) {
+    inSampleIndex = in->sampleIndex;
+    inId = in->id;
+  }
+}
+
 // Receive block from an input.  The block's data
 // may be shared with other streams, so it must not be written
 audio_block_f32_t * AudioStream_F32::receiveReadOnly_f32(unsigned int index)
@@ -159,6 +288,7 @@ audio_block_f32_t * AudioStream_F32::receiveReadOnly_f32(unsigned int index)
   if (index >= num_inputs_f32) return NULL;
   in = inputQueue_f32[index];
   inputQueue_f32[index] = NULL;
+  noteInputInfo(index, in);
   return in;
 }
 
@@ -171,15 +301,56 @@ audio_block_f32_t * AudioStream_F32::receiveWritable_f32(unsigned int index)
   if (index >= num_inputs_f32) return NULL;
   in = inputQueue_f32[index];
   inputQueue_f32[index] = NULL;
+  noteInputInfo(index, in);
   if (in && in->ref_count > 1) {
     p = allocate_f32();
-    if (p) memcpy(p->data, in->data, sizeof(p->data));
+    if (p) {
+      memcpy(p->data, in->data, sizeof(p->data));
+      copyBlockInfo(p, in);
+      p->length = in->length;
+    }
     in->ref_count--;
     in = p;
   }
   return in;
 }
 
+// Latency from the output of "from" to "to" along every path.  See .h
+int32_t AudioStream_F32::getPathLatencySamples(AudioStream_F32 &from,
+                 AudioStream_F32 &to, int toInput, int32_t *pMin)
+{
+  int32_t lMax = -1;
+  int32_t lMin = -1;
+
+  pathLatency(&from, &to, toInput, 0, 0, &lMax, &lMin);
+  if (pMin) *pMin = lMin;
+  return lMax;
+}
+
+// Depth first search of the connections.  A path that reaches "to" stops
+// there, so feedback loops through "to" are not followed.  Other loops are
+// stopped by the depth limit.
+void AudioStream_F32::pathLatency(AudioStream_F32 *node, AudioStream_F32 *to,
+     int toInput, uint32_t sum, int depth, int32_t *pMax, int32_t *pMin)
+{
+  uint32_t s;
+
+  if (depth >= AUDIO_F32_MAX_PATH_DEPTH) return;
+  for (AudioConnection_F32 *c = node->destination_list_f32; c != NULL; c = c->next_dest) {
+    if (&c->dst == to) {
+      if (toInput >= 0 && c->dest_index != toInput) continue;
+      s = sum;
+      if (toInput < 0) s += to->getInputLatencySamples(c->dest_index);
+      if (*pMax < 0 || (int32_t)s > *pMax) *pMax = (int32_t)s;
+      if (*pMin < 0 || (int32_t)s < *pMin) *pMin = (int32_t)s;
+    }
+    else {
+      s = sum + c->dst.getInputLatencySamples(c->dest_index);
+      pathLatency(&c->dst, to, toInput, s, depth + 1, pMax, pMin);
+    }
+  }
+}
+
 void AudioConnection_F32::connect(void) {
   AudioConnection_F32 *p;
 
@@ -196,3 +367,26 @@ void AudioConnection_F32::connect(void) {
   dst.active = true;
   __enable_irq();
 }
+
+void AudioControlConnection_F32::connect(void) {
+  AudioControlConnection_F32 *p;
+
+  __disable_irq();
+  p = src.control_dest_list_f32;
+  if (p == NULL) {
+    src.control_dest_list_f32 = this;
+  } else {
+    while (p->next_dest) p = p->next_dest;
+    p->next_dest = this;
+  }
+  p = dst.control_src_list_f32;
+  if (p == NULL) {
+    dst.control_src_list_f32 = this;
+  } else {
+    while (p->next_src) p = p->next_src;
+    p->next_src = this;
+  }
+  src.active = true;
+  dst.active = true;
+  __enable_irq();
+}
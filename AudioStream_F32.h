@@ -9,6 +9,51 @@
  *
  * Added id to audio_block_f32_t class, per Tympan.  Bob Larkin June 2020
  *
+ * Added sampleIndex to audio_block_f32_t, Oct 2026.  Input classes stamp
+ * each block with the 64-bit count of samples before its first sample, and
+ * id with a block sequence number.  A block from allocate_f32() has
+ * sampleIndex = AUDIO_F32_NO_SAMPLE_INDEX.  The propagation rule is that
+ * an output block inherits the sampleIndex and id of the primary input,
+ * input 0 (or the newest input block, if input 0 had none), from the same
+ * update.  This is done in transmit() for any block not already stamped,
+ * so classes that allocate new output blocks need do nothing.  A class may
+ * stamp its own outputs, for instance to account for internal delay, and
+ * transmit() leaves those alone.
+ *
+ * Added latency reporting, Oct 2026.  getLatencySamples() returns the delay,
+ * in samples, that a class adds from its input to its output.  The default
+ * is 0, and classes with internal buffering, lookahead or linear-phase FIR
+ * filters override it.  getPathLatencySamples() walks the connections from
+ * one object to another and sums the latencies along the way.  Where there
+ * are several paths the largest is returned and the smallest can also be
+ * had.  This does not include the I2S/DMA buffering of the input and output
+ * classes, normally two blocks, nor the codec.  See
+ * AudioEffectAlignLatency_F32 for equalizing parallel paths.
+ *
+ * Multi-rate islands, Oct 2026.  Every object runs each update, but most
+ * return at once when they have no input.  AudioFilterDecimate_F32 can
+ * re-pack its low rate output into full blocks that are sent every few
+ * updates, and AudioFilterInterpolate_F32 turns these back into a block
+ * every update.  The objects between run at the low rate, with their own
+ * AudioSettings_F32 for that rate and block size.  block->length and
+ * block->fs_Hz are set for the island.  allocate_f32() always gives a
+ * block with the length and rate of the pool, from AudioMemory_F32(), so
+ * a class that sends a block it allocated must set length and fs_Hz, or
+ * use allocate_f32(length, fs_Hz).  Normally these are those of its input.
+ * Classes that work in place, with receiveWritable_f32(), keep them.
+ *
+ * Control-rate connections, Oct 2026.  An envelope or a gain changes slowly
+ * compared with the audio, but a full block of it uses a pool block on each
+ * connection, and per sample work, like log and exp, at the consumer.  An
+ * AudioControlConnection_F32 carries 1 to AUDIO_F32_CONTROL_POINTS values
+ * per update instead, with no pool block.  Value k of n is at the end of the
+ * k-th of n equal parts of the block, so one value is at the last sample.
+ * The consumer interpolates from its last value, see controlToBlock() and
+ * multiplyControl().  A class sends with transmitControl() and receives with
+ * receiveControl(), with its own numbering of control outputs and inputs,
+ * separate from the audio ones.  Values not received are replaced by the
+ * next.  Objects that do not use them ignore control connections.  The
+ * latency functions do not follow them.
  *
  * Thse classes are derived from their equivalents in Teensyduino. Thus:
  * Teensyduino Core Library
@@ -54,6 +99,13 @@
 // /////////////// class prototypes
 class AudioStream_F32;
 class AudioConnection_F32;
+class AudioControlConnection_F32;
+
+// Longest chain of connections searched by getPathLatencySamples()
+#define AUDIO_F32_MAX_PATH_DEPTH 40
+
+// Most values per update on an AudioControlConnection_F32
+#define AUDIO_F32_CONTROL_POINTS 8
 
 
 // ///////////// class definitions
@@ -62,6 +114,7 @@ class AudioConnection_F32;
 //modeled on the existing teensy audio block struct, which uses Int16
 //https://github.com/PaulStoffregen/cores/blob/268848cdb0121f26b7ef6b82b4fb54abbe465427/teensy3/AudioStream.h
 // Added id, per Tympan.  Should not disturb existing programs.  Bob Larkin June 2020
+#define AUDIO_F32_NO_SAMPLE_INDEX 0XFFFFFFFFFFFFFFFFULL
 class audio_block_f32_t {
     public:
         audio_block_f32_t(void) {};
@@ -80,6 +133,8 @@ class audio_block_f32_t {
                                           // For Teensy 4.x, AUDIO_SAMPLE_RATE is 44100
         float fs_Hz = AUDIO_SAMPLE_RATE;  // T3.x AUDIO_SAMPLE_RATE is 44117.64706
         unsigned long id;
+        // Samples before data[0], counted at the input class.  See notes at top.
+        uint64_t sampleIndex = AUDIO_F32_NO_SAMPLE_INDEX;
 };
 
 class AudioConnection_F32
@@ -106,6 +161,35 @@ class AudioConnection_F32
 };
 
 
+// A control-rate connection, from a control output to a control input.
+// See notes at top.
+class AudioControlConnection_F32
+{
+  public:
+    AudioControlConnection_F32(AudioStream_F32 &source, AudioStream_F32 &destination) :
+      src(source), dst(destination), src_index(0), dest_index(0),
+      next_dest(NULL), next_src(NULL), n(0)
+      { connect(); }
+    AudioControlConnection_F32(AudioStream_F32 &source, unsigned char sourceOutput,
+      AudioStream_F32 &destination, unsigned char destinationInput) :
+      src(source), dst(destination),
+      src_index(sourceOutput), dest_index(destinationInput),
+      next_dest(NULL), next_src(NULL), n(0)
+      { connect(); }
+    friend class AudioStream_F32;
+  protected:
+    void connect(void);
+    AudioStream_F32 &src;
+    AudioStream_F32 &dst;
+    unsigned char src_index;
+    unsigned char dest_index;
+    AudioControlConnection_F32 *next_dest;  // From the same source
+    AudioControlConnection_F32 *next_src;   // To the same destination
+    float32_t value[AUDIO_F32_CONTROL_POINTS];
+    uint8_t n;                              // Values waiting, 0 for none
+};
+
+
 class AudioStream_F32 : public AudioStream {
   public:
     AudioStream_F32(unsigned char n_input_f32, audio_block_f32_t **iqueue, 
@@ -115,6 +199,8 @@ class AudioStream_F32 : public AudioStream {
     {
       //active_f32 = false;
       destination_list_f32 = NULL;
+      control_dest_list_f32 = NULL;
+      control_src_list_f32 = NULL;
       for (int i=0; i < n_input_f32; i++) {
         inputQueue_f32[i] = NULL;
       }
@@ -129,18 +215,78 @@ class AudioStream_F32 : public AudioStream {
     static uint8_t f32_memory_used;
     static uint8_t f32_memory_used_max;
     static audio_block_f32_t * allocate_f32(void);
+    // The same, with length and fs_Hz set, as for an island, see notes at top
+    static audio_block_f32_t * allocate_f32(int length, float fs_Hz) {
+      audio_block_f32_t *block = allocate_f32();
+      if (block) {
+        block->length = length;
+        block->fs_Hz = fs_Hz;
+      }
+      return block;
+    }
+    // length and fs_Hz of a block from allocate_f32(), from AudioMemory_F32()
+    static int f32_default_length;
+    static float f32_default_fs_Hz;
     static void release(audio_block_f32_t * block);
 
+    // Copy sampleIndex and id (and fs_Hz) from one block to another
+    static void copyBlockInfo(audio_block_f32_t *dst, const audio_block_f32_t *src) {
+      dst->sampleIndex = src->sampleIndex;
+      dst->id = src->id;
+      dst->fs_Hz = src->fs_Hz;
+    }
+
+    // Delay, in samples, from input to output.  Override if not zero.
+    virtual uint32_t getLatencySamples(void) { return 0; }
+    // Delay from a particular input to the outputs, if inputs differ
+    virtual uint32_t getInputLatencySamples(unsigned int /*inputIndex*/) {
+      return getLatencySamples();
+    }
+    // Sum of latencies from the output of "from" to the output of "to",
+    // largest if there are several paths.  If toInput >= 0, the sum is instead
+    // to that input of "to", not including "to" itself.  The smallest is
+    // returned at *pMin if not NULL.  Returns -1 if there is no path.
+    static int32_t getPathLatencySamples(AudioStream_F32 &from, AudioStream_F32 &to,
+                                         int toInput = -1, int32_t *pMin = NULL);
+
   protected:
     //bool active_f32;
     unsigned char num_inputs_f32;
+    // sampleIndex and id of the primary input, for stamping outputs.  These
+    // are for the current update only.  The first receive after a transmit,
+    // or of an input already received, starts a new update and clears them.
+    uint64_t inSampleIndex = AUDIO_F32_NO_SAMPLE_INDEX;
+    unsigned long inId = 0;
+    uint32_t inReceived = 0;   // Bit per input received this update
+    bool inStale = false;      // Set by transmit()
+    void noteInputInfo(unsigned int index, const audio_block_f32_t *in);
     void transmit(audio_block_f32_t *block, unsigned char index = 0);
     audio_block_f32_t * receiveReadOnly_f32(unsigned int index = 0);
     audio_block_f32_t * receiveWritable_f32(unsigned int index = 0);
+    // True if an audio output goes anywhere, so its block is needed
+    bool outputConnected(unsigned char index = 0);
+
+    // Control-rate connections, see notes at top.  receiveControl() returns
+    // the number of values put in v[], 0 if none came this update.
+    void transmitControl(const float32_t *v, int n, unsigned char index = 0);
+    int receiveControl(float32_t *v, unsigned int index = 0);
+    bool controlOutputConnected(unsigned char index = 0);
+    bool controlInputConnected(unsigned int index = 0);
+    // Ramp from prev through the n values, to out[0] to out[length-1]
+    static void controlToBlock(float32_t prev, const float32_t *v, int n,
+                               float32_t *out, int length);
+    // The same, times in[], to out[].  in and out may be the same.
+    static void multiplyControl(const float32_t *in, float32_t *out, int length,
+                                float32_t prev, const float32_t *v, int n);
     friend class AudioConnection_F32;
+    friend class AudioControlConnection_F32;
 
   private:
+    static void pathLatency(AudioStream_F32 *node, AudioStream_F32 *to, int toInput,
+                 uint32_t sum, int depth, int32_t *pMax, int32_t *pMin);
     AudioConnection_F32 *destination_list_f32;
+    AudioControlConnection_F32 *control_dest_list_f32;
+    AudioControlConnection_F32 *control_src_list_f32;
     audio_block_f32_t **inputQueue_f32;
     virtual void update(void) = 0;
     audio_block_t *inputQueueArray_i16[1];  //two for stereo
@@ -30,7 +30,7 @@ class FFT_F32
     FFT_F32(const int _N_FFT, const int _is_IFFT) {
       setup(_N_FFT, _is_IFFT);
     }
-    ~FFT_F32(void) { delete window; };  //destructor
+    ~FFT_F32(void) { if (window != NULL) delete [] window; };  //destructor
 
     virtual int setup(const int _N_FFT) {
       int _is_IFFT = 0;
@@ -54,6 +54,7 @@ class FFT_F32
       }
 
       //allocate window
+      if (window != NULL) delete [] window;
       window = new float[N_FFT];
       if (is_IFFT) {
         useRectangularWindow(); //default to no windowing for IFFT
@@ -148,7 +149,7 @@ class FFT_F32
     int N_FFT=0;
     int is_IFFT=0;
     int is_rad4=0;
-    float *window;
+    float *window = NULL;
     int flag__useWindow=0;
     arm_cfft_radix4_instance_f32 fft_inst_r4;
     arm_cfft_radix2_instance_f32 fft_inst_r2;
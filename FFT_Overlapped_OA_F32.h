@@ -117,6 +117,8 @@ class FFT_Overlapped_Base_OA_F32 {  //handles all the data structures for the ov
     }
     virtual int getNFFT(void) = 0;
     virtual int getNBuffBlocks(void) { return N_BUFF_BLOCKS; }
+    // Delay of the overlap buffering, input to output of an FFT/IFFT pair
+    virtual int getLatencySamples(void) { return (N_BUFF_BLOCKS - 1)*audio_block_samples; }
 
   protected:
     int N_BUFF_BLOCKS = 0;
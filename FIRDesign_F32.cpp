@@ -0,0 +1,879 @@
+/*
+ * FIRDesign_F32.cpp
+ *
+ * See FIRDesign_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "FIRDesign_F32.h"
+#include "utility/BTNRH_rfft.h"
+
+FIRDesign_F32::windowSlot FIRDesign_F32::windows[FIRD_WINDOW_SLOTS];
+FIRDesign_F32::cacheSlot FIRDesign_F32::cache[FIRD_CACHE_MAX];
+uint16_t FIRDesign_F32::nCacheSlots = FIRD_CACHE_SLOTS;
+uint32_t FIRDesign_F32::useCount = 0;
+
+// Modified Bessel function of order 0, by its series.  Fine to x = 30 or so.
+double FIRDesign_F32::i0(double x)  {
+    double x2 = 0.25*x*x;
+    double sum = 1.0;
+    double term = 1.0;
+    double k = 1.0;
+    do  {
+        term *= x2/(k*k);
+        sum += term;
+        k += 1.0;
+        }  while(term > 1.0e-12*sum);
+    return sum;
+    }
+
+const float32_t* FIRDesign_F32::kaiserWindow(uint16_t L, float32_t D, float32_t beta)  {
+    int iUse = 0;
+
+    useCount++;
+    for(int s=0; s<FIRD_WINDOW_SLOTS; s++)  {
+        if(windows[s].w && windows[s].L==L && windows[s].D==D && windows[s].beta==beta)  {
+            windows[s].lastUse = useCount;
+            return windows[s].w;     // Seen it before
+            }
+        if(windows[s].lastUse < windows[iUse].lastUse)
+            iUse = s;                // Least recently used
+        }
+
+    windowSlot *pS = &windows[iUse];
+    if(pS->size < L)  {
+        if(pS->w)  delete [] pS->w;
+        pS->w = new float32_t[L];
+        pS->size = pS->w ? L : 0;
+        }
+    pS->L = 0;
+    if(pS->w == NULL)
+        return NULL;
+
+    // Symmetrical, so compute half
+    double rI0Beta = 1.0/i0((double)beta);
+    for(int i=0; i<(L+1)/2; i++)  {
+        double x = (2.0*(double)i - (double)(L - 1))/(double)D;
+        double r = 1.0 - x*x;
+        if(r < 0.0)  r = 0.0;
+        float32_t w = (float32_t)(rI0Beta*i0((double)beta*sqrt(r)));
+        pS->w[i] = w;
+        pS->w[L - 1 - i] = w;
+        }
+    pS->L = L;
+    pS->D = D;
+    pS->beta = beta;
+    pS->lastUse = useCount;
+    return pS->w;
+    }
+
+// The real inverse FFT is of P points at twice the sample rate, so that
+// alternate outputs are the half sample lags of an even nFIR.  Bin b is at
+// b*2*fs/P, which is k = b*2*nFIR/P on the nFIR point grid, and fs/2 is at
+// b = P/4.  Above that is zero.  The sum over bins is then half of the
+// integral over -fs/2 to fs/2 that the DFT approximates, and the lag t
+// coefficient is 2*x[2*t].
+uint16_t FIRDesign_F32::frequencySample(float32_t *pCoeff, uint16_t nFIR,
+                                         const float32_t *pAmp, uint16_t nAmp)  {
+    uint32_t P = 64;
+    while(P < 2*(uint32_t)nFIR)
+        P *= 2;
+    float32_t *x = new float32_t[P + 2];  // P/2+1 complex bins
+    if(x == NULL)
+        return 1;
+
+    float32_t kStep = 2.0f*(float32_t)nFIR/(float32_t)P;
+    for(uint32_t b=0; b<=P/2; b++)  {
+        float32_t a = 0.0f;
+        if(b <= P/4)  {
+            float32_t k = kStep*(float32_t)b;
+            uint32_t k0 = (uint32_t)k;
+            if(k0 >= (uint32_t)(nAmp - 1))
+                a = pAmp[nAmp - 1];
+            else
+                a = pAmp[k0] + (k - (float32_t)k0)*(pAmp[k0 + 1] - pAmp[k0]);
+            if(b == P/4)
+                a *= 0.5f;   // End of the integral
+            }
+        x[2*b] = a;
+        x[2*b + 1] = 0.0f;
+        }
+    BTNRH_FFT::cha_fft_cr(x, (int)P);
+
+    for(int n=0; n<nFIR; n++)  {
+        int m = 2*n - (nFIR - 1);
+        if(m < 0)  m += P;
+        pCoeff[n] = 2.0f*x[m];
+        }
+    delete [] x;
+    return 0;
+    }
+
+void FIRDesign_F32::responseDB(const float32_t *pCoeff, uint16_t nFIR,
+                               uint16_t nFreq, float32_t *pdB)  {
+    uint32_t P = 2*(uint32_t)nFreq;
+
+    if(P>=4 && (P & (P - 1))==0)  {
+        float32_t *x = new float32_t[P + 2];
+        if(x)  {
+            // Folding the FIR to P points leaves these DFT points unchanged
+            for(uint32_t i=0; i<P+2; i++)
+                x[i] = 0.0f;
+            for(uint32_t n=0; n<nFIR; n++)
+                x[n & (P - 1)] += pCoeff[n];
+            BTNRH_FFT::cha_fft_rc(x, (int)P);
+            for(uint16_t i=0; i<nFreq; i++)
+                pdB[i] = 10.0f*log10f(x[2*i]*x[2*i] + x[2*i+1]*x[2*i+1]);
+            delete [] x;
+            return;
+            }
+        }
+
+    // The zero phase amplitude, as the coefficients are symmetrical.  Odd
+    // nFIR has a center tap, and the others are 1, 2, 3 ... from it.  For
+    // even the distances are 0.5, 1.5, 2.5 ...
+    uint16_t nH = nFIR/2;
+    bool odd = (nFIR & 1);
+    for(uint16_t i=0; i<nFreq; i++)  {
+        double w = M_PI*(double)i/(double)nFreq;
+        double cw = cos(w);
+        double sw = sin(w);
+        double w0 = odd ? w : 0.5*w;
+        double re = cos(w0);
+        double im = sin(w0);
+        double a = odd ? (double)pCoeff[nH] : 0.0;
+        for(int d=0; d<nH; d++)  {
+            a += 2.0*(double)pCoeff[nH - 1 - d]*re;
+            double t = re*cw - im*sw;   // Rotate by w
+            im = re*sw + im*cw;
+            re = t;
+            }
+        pdB[i] = 20.0f*log10f(fabsf((float32_t)a));
+        }
+    }
+
+// Remez exchange, as Parks and McClellan.  With the linear phase taken out
+// the amplitude is a polynomial P(x) in x = cos(w) of r terms, times
+// cos(w/2) for even nFIR, which is moved into the desired and weight.  The
+// error is looked at on a grid of about 16 points per term over the bands,
+// made as needed from the band edges.  Each pass fits P through r+1
+// extremal frequencies with the weighted error alternating +/-delta, by
+// barycentric Lagrange interpolation, and moves the set to the peaks of the
+// error.  Done when the largest error is within 1e-4 of delta.
+#define FIRD_REMEZ_GRID  16
+#define FIRD_REMEZ_ITER  40
+#define FIRD_REMEZ_SCALE 100     // Terms, above which the start is scaled
+
+// Barycentric interpolation through r points
+static double remezP(double x, int r, const double *xe, const double *bw, const double *ye)  {
+    double num = 0.0;
+    double den = 0.0;
+    for(int i=0; i<r; i++)  {
+        double d = x - xe[i];
+        if(d == 0.0)
+            return ye[i];
+        double t = bw[i]/d;
+        num += t*ye[i];
+        den += t;
+        }
+    return num/den;
+    }
+
+// Barycentric weights for n points, 1/product of 2*(xi - xj).  For
+// hundreds of points the products leave the range of double, so the
+// exponent is kept apart, and all are scaled alike as only ratios matter.
+static void remezWeights(int n, const double *xe, double *pw, int *pExp)  {
+    int eMax = -100000;
+    for(int i=0; i<n; i++)  {
+        double p = 1.0;
+        int e = 0;
+        for(int j=0; j<n; j++)  {
+            if(j == i)  continue;
+            p *= 2.0*(xe[i] - xe[j]);
+            if(fabs(p)>1.0e100 || fabs(p)<1.0e-100)  {
+                int e1;
+                p = frexp(p, &e1);
+                e += e1;
+                }
+            }
+        int e1;
+        p = frexp(p, &e1);
+        pw[i] = 1.0/p;
+        pExp[i] = -(e + e1);
+        if(pExp[i] > eMax)  eMax = pExp[i];
+        }
+    for(int i=0; i<n; i++)
+        pw[i] = ldexp(pw[i], pExp[i] - eMax);
+    }
+
+// Grid point g, as a frequency, and the band it is in
+static double remezFreq(int g, int nBands, const int *gStart,
+          const double *gF0, const double *gStep, int *pBand)  {
+    int lo = 0;
+    int hi = nBands - 1;
+    while(lo < hi)  {         // Last band with gStart <= g
+        int m = (lo + hi + 1)/2;
+        if(gStart[m] <= g)  lo = m;
+        else                hi = m - 1;
+        }
+    *pBand = lo;
+    return gF0[lo] + (double)(g - gStart[lo])*gStep[lo];
+    }
+
+// Grid point g as x, desired and weight
+static void remezGrid(int g, bool odd, int nBands, const int *gStart,
+          const double *gF0, const double *gStep, const float32_t *pAmp,
+          const float32_t *pWeight, double *px, double *pd, double *pw)  {
+    int b;
+    double f = remezFreq(g, nBands, gStart, gF0, gStep, &b);
+    *px = cos(2.0*M_PI*f);
+    *pd = (double)pAmp[b];
+    *pw = (double)pWeight[b];
+    if(!odd)  {
+        double c = cos(M_PI*f);
+        *pd /= c;
+        *pw *= c;
+        }
+    }
+
+uint16_t FIRDesign_F32::remez(float32_t *pCoeff, uint16_t nFIR, uint16_t nBands,
+         const float32_t *pEdges, const float32_t *pAmp, const float32_t *pWeight)  {
+    if(nFIR < 3 || nBands == 0)
+        return FIRD_ERR_NFIR;
+    return remezExchange(nFIR, nBands, pEdges, pAmp, pWeight, NULL, pCoeff);
+    }
+
+// The exchange.  If pF is not NULL the final r+1 extremal frequencies are
+// left there, and if pCoeff is not NULL the coefficients.  Starting evenly
+// spread over the grid is fine for a hundred or so terms, but beyond that
+// the first levelled error can be below the rounding of double and the
+// exchange wanders.  So a design of about half the taps is done first and
+// its extremals, scaled band by band, are the start.
+uint16_t FIRDesign_F32::remezExchange(uint16_t nFIR, uint16_t nBands,
+         const float32_t *pEdges, const float32_t *pAmp, const float32_t *pWeight,
+         double *pF, float32_t *pCoeff)  {
+    bool odd = (nFIR & 1);
+    int r = (nFIR + 1)/2;           // Terms in P(x)
+    int nCandMax = r + 2*nBands + 4;
+    uint16_t status = FIRD_ERR_CONVERGE;
+
+    double *dMem = new double[2*nBands + 7*(r + 1) + nCandMax + nFIR/2 + 1];
+    int *iMem = new int[nBands + 1 + (r + 1) + nCandMax];
+    if(dMem==NULL || iMem==NULL)  {
+        if(dMem)  delete [] dMem;
+        if(iMem)  delete [] iMem;
+        return FIRD_ERR_MEMORY;
+        }
+    double *gF0 = dMem;             // Band grid start and step, cycles per sample
+    double *gStep = gF0 + nBands;
+    double *xe = gStep + nBands;    // Extremal x, desired and weight
+    double *de = xe + r + 1;
+    double *we = de + r + 1;
+    double *ad = we + r + 1;        // Weights for r+1 points, for delta
+    double *bw = ad + r + 1;        // Weights for r points, for P(x)
+    double *ye = bw + r + 1;        // P at the r points
+    double *candE = ye + r + 1;
+    double *pA = candE + nCandMax;  // Amplitude at k*fs/nFIR
+    int *gStart = iMem;
+    int *ext = gStart + nBands + 1;
+    int *cand = ext + r + 1;
+
+    // The grid.  For even nFIR the response is 0 at fs/2, so stop short.
+    double fMax = odd ? 0.5 : 0.5 - 0.25/(double)(FIRD_REMEZ_GRID*r);
+    double totalW = 0.0;
+    for(int b=0; b<nBands; b++)
+        totalW += (double)(pEdges[2*b + 1] - pEdges[2*b]);
+    int nGrid = 0;
+    for(int b=0; b<nBands; b++)  {
+        double f0 = (double)pEdges[2*b];
+        double f1 = (double)pEdges[2*b + 1];
+        if(f1 > fMax)  f1 = fMax;
+        if(f0 > f1)    f0 = f1;
+        int n = 1;
+        if(f1>f0 && totalW>0.0)
+            n += (int)((double)(FIRD_REMEZ_GRID*r)*(f1 - f0)/totalW + 0.5);
+        gStart[b] = nGrid;
+        gF0[b] = f0;
+        gStep[b] = n>1 ? (f1 - f0)/(double)(n - 1) : 0.0;
+        nGrid += n;
+        }
+    gStart[nBands] = nGrid;
+    if(nGrid < r + 1)  {
+        delete [] dMem;
+        delete [] iMem;
+        return FIRD_ERR_NFIR;        // Not enough band for the taps
+        }
+
+    bool started = false;
+    if(r > FIRD_REMEZ_SCALE)  {
+        uint16_t n2 = nFIR/2;
+        if((n2 & 1) != (nFIR & 1))  n2++;
+        int r2 = (n2 + 1)/2;
+        double *pF2 = new double[r2 + 1];
+        if(pF2)  {
+            uint16_t s2 = remezExchange(n2, nBands, pEdges, pAmp, pWeight, pF2, NULL);
+            if(s2==0 || s2==FIRD_ERR_CONVERGE)  {
+                // Old extremals in each band, kept in cand[] and scaled
+                // in number, then placed by interpolating the old ones
+                int i2 = 0;
+                int nNew = 0;
+                for(int b=0; b<nBands; b++)  {
+                    double fEnd = gF0[b] + (double)(gStart[b+1] - gStart[b] - 1)*gStep[b];
+                    int k0 = i2;
+                    while(i2<=r2 && (b==nBands-1 || pF2[i2] <= fEnd + 1.0e-9))
+                        i2++;
+                    cand[b] = i2 - k0;
+                    }
+                for(int b=0; b<nBands; b++)  {
+                    cand[nBands + b] = (cand[b]*(r + 1) + (r2 + 1)/2)/(r2 + 1);
+                    nNew += cand[nBands + b];
+                    }
+                int bBig = 0;                // Put any rounding in the biggest
+                for(int b=1; b<nBands; b++)
+                    if(cand[nBands + b] > cand[nBands + bBig])  bBig = b;
+                cand[nBands + bBig] += r + 1 - nNew;
+                if(cand[nBands + bBig] >= 0)  {
+                    int k0 = 0;
+                    int i = 0;
+                    for(int b=0; b<nBands; b++)  {
+                        int kb = cand[b];
+                        int nb = cand[nBands + b];
+                        for(int j=0; j<nb; j++)  {
+                            double f;
+                            if(kb == 0)
+                                f = gF0[b];
+                            else if(kb==1 || nb==1)
+                                f = pF2[k0];
+                            else  {
+                                double t = (double)j*(double)(kb - 1)/(double)(nb - 1);
+                                int t0 = (int)t;
+                                if(t0 >= kb - 1)  t0 = kb - 2;
+                                f = pF2[k0 + t0] + (t - (double)t0)*(pF2[k0 + t0 + 1] - pF2[k0 + t0]);
+                                }
+                            int g = gStart[b];
+                            if(gStep[b] > 0.0)
+                                g += (int)((f - gF0[b])/gStep[b] + 0.5);
+                            if(g < gStart[b])          g = gStart[b];
+                            if(g >= gStart[b + 1])     g = gStart[b + 1] - 1;
+                            ext[i++] = g;
+                            }
+                        k0 += kb;
+                        }
+                    // Make them strictly increasing, within the grid
+                    for(i=1; i<=r; i++)
+                        if(ext[i] <= ext[i - 1])  ext[i] = ext[i - 1] + 1;
+                    if(ext[r] > nGrid - 1)  ext[r] = nGrid - 1;
+                    for(i=r-1; i>=0; i--)
+                        if(ext[i] >= ext[i + 1])  ext[i] = ext[i + 1] - 1;
+                    started = (ext[0] >= 0);
+                    }
+                }
+            delete [] pF2;
+            }
+        }
+    if(!started)
+        for(int i=0; i<=r; i++)      // Evenly spread
+            ext[i] = (int)((int64_t)i*(nGrid - 1)/r);
+
+    for(int iter=0; iter<FIRD_REMEZ_ITER; iter++)  {
+        for(int i=0; i<=r; i++)
+            remezGrid(ext[i], odd, nBands, gStart, gF0, gStep, pAmp, pWeight,
+                      &xe[i], &de[i], &we[i]);
+        double num = 0.0;
+        double den = 0.0;
+        double sgn = 1.0;
+        remezWeights(r + 1, xe, ad, cand);
+        for(int i=0; i<=r; i++)  {
+            num += ad[i]*de[i];
+            den += sgn*ad[i]/we[i];
+            sgn = -sgn;
+            }
+        double delta = num/den;
+        remezWeights(r, xe, bw, cand);
+        sgn = 1.0;
+        for(int i=0; i<r; i++)  {
+            ye[i] = de[i] - sgn*delta/we[i];
+            sgn = -sgn;
+            }
+
+        // Error peaks, band by band.  Neighbors of the same sign keep the
+        // larger, so the list alternates.
+        int nCand = 0;
+        double eMax = 0.0;
+        for(int b=0; b<nBands; b++)  {
+            int g0 = gStart[b];
+            int g1 = gStart[b + 1];
+            double x, d, w;
+            double ePrev = 0.0;
+            remezGrid(g0, odd, nBands, gStart, gF0, gStep, pAmp, pWeight, &x, &d, &w);
+            double eCur = w*(d - remezP(x, r, xe, bw, ye));
+            for(int g=g0; g<g1; g++)  {
+                double eNext = 0.0;
+                if(g + 1 < g1)  {
+                    remezGrid(g + 1, odd, nBands, gStart, gF0, gStep, pAmp, pWeight, &x, &d, &w);
+                    eNext = w*(d - remezP(x, r, xe, bw, ye));
+                    }
+                bool peak;
+                if(eCur > 0.0)
+                    peak = (g==g0 || eCur>=ePrev) && (g+1==g1 || eCur>eNext);
+                else
+                    peak = eCur<0.0 && (g==g0 || eCur<=ePrev) && (g+1==g1 || eCur<eNext);
+                if(peak)  {
+                    if(nCand>0 && (eCur>0.0)==(candE[nCand - 1]>0.0))  {
+                        if(fabs(eCur) > fabs(candE[nCand - 1]))  {
+                            cand[nCand - 1] = g;
+                            candE[nCand - 1] = eCur;
+                            }
+                        }
+                    else if(nCand < nCandMax)  {
+                        cand[nCand] = g;
+                        candE[nCand++] = eCur;
+                        }
+                    }
+                if(fabs(eCur) > eMax)  eMax = fabs(eCur);
+                ePrev = eCur;
+                eCur = eNext;
+                }
+            }
+
+        if(eMax - fabs(delta) <= 1.0e-4*eMax)  {
+            status = 0;
+            break;
+            }
+        if(nCand < r + 1)
+            break;                   // Keep this fit, not the best
+
+        // Down to r+1, removing the smallest, and a neighbor with it when
+        // that leaves two of the same sign together
+        while(nCand > r + 1)  {
+            int k;
+            if(nCand == r + 2)  {
+                k = fabs(candE[0])<fabs(candE[nCand - 1]) ? 0 : nCand - 1;
+                }
+            else  {
+                k = 0;
+                for(int i=1; i<nCand; i++)
+                    if(fabs(candE[i]) < fabs(candE[k]))  k = i;
+                if(k>0 && k<nCand-1)  {
+                    // Remove k and the smaller of its neighbors
+                    if(fabs(candE[k - 1]) < fabs(candE[k + 1]))  k--;
+                    for(int i=k; i<nCand-2; i++)  {
+                        cand[i] = cand[i + 2];
+                        candE[i] = candE[i + 2];
+                        }
+                    nCand -= 2;
+                    continue;
+                    }
+                }
+            for(int i=k; i<nCand-1; i++)  {
+                cand[i] = cand[i + 1];
+                candE[i] = candE[i + 1];
+                }
+            nCand--;
+            }
+        for(int i=0; i<=r; i++)
+            ext[i] = cand[i];
+        }
+
+    if(pF)  {
+        int b;
+        for(int i=0; i<=r; i++)
+            pF[i] = remezFreq(ext[i], nBands, gStart, gF0, gStep, &b);
+        }
+    // The amplitude on the nFIR point grid, then the coefficients
+    if(pCoeff)  {
+        for(int k=0; k<=nFIR/2; k++)  {
+            double w = 2.0*M_PI*(double)k/(double)nFIR;
+            double a = remezP(cos(w), r, xe, bw, ye);
+            pA[k] = odd ? a : a*cos(0.5*w);
+            }
+        coeffsFromAmplitude(pCoeff, nFIR, pA);
+        }
+    delete [] dMem;
+    delete [] iMem;
+    return status;
+    }
+
+// Weighted least squares.  The amplitude is a sum of cos(mu*w), with mu =
+// 0, 1, 2 ... for odd nFIR and 0.5, 1.5 ... for even.  The squared error
+// integrated over the bands is a quadratic in the r amplitudes, and as the
+// desired and weight are constant over a band the normal equations are
+// sums of integrals of cosines, found directly.  They are solved by
+// Cholesky, packed, in double.  A band of no width is given a little.
+uint16_t FIRDesign_F32::leastSquares(float32_t *pCoeff, uint16_t nFIR, uint16_t nBands,
+         const float32_t *pEdges, const float32_t *pAmp, const float32_t *pWeight)  {
+    bool odd = (nFIR & 1);
+    int r = (nFIR + 1)/2;
+    double h = odd ? 0.0 : 0.5;     // mu = m + h
+
+    if(nFIR < 3 || nFIR > FIRD_LS_MAX_TAPS || nBands == 0)
+        return FIRD_ERR_NFIR;
+    uint32_t nQ = (uint32_t)r*(r + 1)/2;
+    double *q = new double[nQ + 2*r + 2*r + 1];
+    if(q == NULL)
+        return FIRD_ERR_MEMORY;
+    double *b = q + nQ;
+    double *a = b + r;              // Also the amplitudes for coeffsFromAmplitude()
+    double *S = a + r;              // Integral of cos(k*w) over the band
+    for(uint32_t i=0; i<nQ+2*r; i++)
+        q[i] = 0.0;
+
+    for(int j=0; j<nBands; j++)  {
+        double w1 = 2.0*M_PI*(double)pEdges[2*j];
+        double w2 = 2.0*M_PI*(double)pEdges[2*j + 1];
+        double wMin = 0.5*M_PI/(double)nFIR;
+        if(w2 - w1 < wMin)  {
+            double c = 0.5*(w1 + w2);
+            w1 = c - 0.5*wMin;
+            w2 = c + 0.5*wMin;
+            if(w1 < 0.0)   { w2 -= w1;  w1 = 0.0; }
+            if(w2 > M_PI)  { w1 -= w2 - M_PI;  w2 = M_PI; }
+            }
+        double wt2 = (double)pWeight[j]*(double)pWeight[j];
+        double wd = wt2*(double)pAmp[j];
+        S[0] = w2 - w1;
+        for(int k=1; k<=2*r; k++)
+            S[k] = (sin((double)k*w2) - sin((double)k*w1))/(double)k;
+        uint32_t idx = 0;
+        for(int m=0; m<r; m++)  {
+            double mu = (double)m + h;
+            if(m==0 && odd)
+                b[m] += wd*S[0];
+            else
+                b[m] += wd*(sin(mu*w2) - sin(mu*w1))/mu;
+            // mu_m + mu_n is m + n + 2h, an integer
+            for(int n=0; n<=m; n++)
+                q[idx++] += 0.5*wt2*(S[m - n] + S[m + n + (odd ? 0 : 1)]);
+            }
+        }
+    // A little on the diagonal, for gaps that leave it near singular
+    double tr = 0.0;
+    for(int m=0; m<r; m++)
+        tr += q[(uint32_t)m*(m + 3)/2];
+    for(int m=0; m<r; m++)
+        q[(uint32_t)m*(m + 3)/2] += 1.0e-12*tr/(double)r;
+
+    // Cholesky, in place.  Row i starts at i*(i+1)/2.
+    for(int j=0; j<r; j++)  {
+        double *rj = q + (uint32_t)j*(j + 1)/2;
+        double s = rj[j];
+        for(int k=0; k<j; k++)
+            s -= rj[k]*rj[k];
+        if(s <= 0.0)  {
+            delete [] q;
+            return FIRD_ERR_SINGULAR;
+            }
+        rj[j] = sqrt(s);
+        for(int i=j+1; i<r; i++)  {
+            double *ri = q + (uint32_t)i*(i + 1)/2;
+            double t = ri[j];
+            for(int k=0; k<j; k++)
+                t -= ri[k]*rj[k];
+            ri[j] = t/rj[j];
+            }
+        }
+    for(int i=0; i<r; i++)  {       // L y = b
+        double *ri = q + (uint32_t)i*(i + 1)/2;
+        double t = b[i];
+        for(int k=0; k<i; k++)
+            t -= ri[k]*a[k];
+        a[i] = t/ri[i];
+        }
+    for(int i=r-1; i>=0; i--)  {    // L' a = y
+        double t = a[i];
+        for(int k=i+1; k<r; k++)
+            t -= q[(uint32_t)k*(k + 1)/2 + i]*a[k];
+        a[i] = t/q[(uint32_t)i*(i + 3)/2];
+        }
+
+    // Amplitude of cos(mu*w) is twice the coefficient, or once for the center
+    int c = nFIR/2;
+    for(int m=0; m<r; m++)  {
+        if(odd)  {
+            if(m == 0)
+                pCoeff[c] = (float32_t)a[0];
+            else
+                pCoeff[c - m] = pCoeff[c + m] = (float32_t)(0.5*a[m]);
+            }
+        else
+            pCoeff[c - 1 - m] = pCoeff[c + m] = (float32_t)(0.5*a[m]);
+        }
+    delete [] q;
+    return 0;
+    }
+
+// pA[k] is the amplitude at k*fs/nFIR, k = 0 to nFIR/2.  The inverse DFT
+// of these is exact when the amplitude is that of nFIR taps, as from
+// remez().  The cosine of the lag is by rotation.
+void FIRDesign_F32::coeffsFromAmplitude(float32_t *pCoeff, uint16_t nFIR, const double *pA)  {
+    int kMax = (nFIR - 1)/2;         // pA[nFIR/2] is 0 for even nFIR
+    double rN = 1.0/(double)nFIR;
+    for(int n=0; n<(nFIR+1)/2; n++)  {
+        double t = 2.0*M_PI*((double)n - 0.5*(double)(nFIR - 1))*rN;
+        double ct = cos(t);
+        double st = sin(t);
+        double re = ct;
+        double im = st;
+        double sum = pA[0];
+        for(int k=1; k<=kMax; k++)  {
+            sum += 2.0*pA[k]*re;
+            double u = re*ct - im*st;
+            im = re*st + im*ct;
+            re = u;
+            }
+        pCoeff[n] = pCoeff[nFIR - 1 - n] = (float32_t)(sum*rN);
+        }
+    }
+
+// Adjacent levels that are the same are one band.  The transition is only
+// put between two bands at least that wide.  Narrower ones, as for a
+// sloping response given point by point, meet their neighbors, apart by a
+// little so that no frequency is in two bands.  The weight is the inverse
+// of the error allowed, FIRD_RIPPLE_DB of the level, or the level itself,
+// to -120 dB, for a stop band.
+uint16_t FIRDesign_F32::levelBands(uint16_t nLevels, const float32_t *pUpper,
+         const float32_t *pdB, float32_t tw,
+         float32_t *pEdges, float32_t *pAmp, float32_t *pWeight)  {
+    uint16_t nb = 0;
+    float32_t fLow = 0.0f;           // Lower end of this level
+    float32_t ripple = powf(10.0f, 0.05f*FIRD_RIPPLE_DB) - 1.0f;
+
+    for(int i=0; i<nLevels && fLow<0.5f; i++)  {
+        float32_t fHigh = (i==nLevels-1 || pUpper[i]>0.5f) ? 0.5f : pUpper[i];
+        if(nb>0 && pdB[i]==pdB[i - 1])
+            pEdges[2*nb - 1] = fHigh;
+        else  {
+            pEdges[2*nb] = fLow;
+            pEdges[2*nb + 1] = fHigh;
+            float32_t a = powf(10.0f, 0.05f*pdB[i]);
+            if(pdB[i] <= FIRD_STOP_DB)  {
+                pAmp[nb] = 0.0f;
+                pWeight[nb] = 1.0f/(a>1.0e-6f ? a : 1.0e-6f);
+                }
+            else  {
+                pAmp[nb] = a;
+                pWeight[nb] = 1.0f/(ripple*a);
+                }
+            nb++;
+            }
+        fLow = fHigh;
+        }
+    pEdges[2*nb - 1] = 0.5f;
+
+    for(int b=0; b<nb-1; b++)  {
+        float32_t h = 1.0e-5f;
+        if(pEdges[2*b + 1] - pEdges[2*b] >= tw  &&
+           pEdges[2*b + 3] - pEdges[2*b + 2] >= tw)
+            h = 0.5f*tw;
+        pEdges[2*b + 1] -= h;
+        pEdges[2*b + 2] += h;
+        }
+    return nb;
+    }
+
+// Largest |A - target| for the zero phase amplitude A over f0 to f1, on
+// a grid of 8 points per tap.
+float32_t FIRDesign_F32::bandError(const float32_t *pCoeff, uint16_t nFIR,
+                                   float32_t f0, float32_t f1, float32_t target)  {
+    int nGrid = 8*nFIR;
+    double eMax = 0.0;
+    for(int g=0; g<=nGrid; g++)  {
+        double w = 2.0*M_PI*((double)f0 + (double)(f1 - f0)*(double)g/(double)nGrid);
+        double a = 0.0;
+        for(int n=0; n<nFIR/2; n++)
+            a += 2.0*(double)pCoeff[n]*cos(w*(0.5*(double)(nFIR - 1) - (double)n));
+        if(nFIR & 1)
+            a += (double)pCoeff[nFIR/2];
+        double e = fabs(a - (double)target);
+        if(e > eMax)  eMax = e;
+        }
+    return (float32_t)eMax;
+    }
+
+// The half-band is H(z) = (z^-(2K-1) + G(z^2))/2, where G is an even length
+// 2K filter with the single band 0 to 2*fPass, that is antisymmetric about
+// fs/2, see Vaidyanathan.  The error of H is half that of G in both bands.
+// The length starts from the Kaiser estimate and grows until it is met.
+float32_t* FIRDesign_F32::halfBand(float32_t fPass, float32_t atten_dB, uint16_t *pK)  {
+    *pK = 0;
+    if(fPass<=0.0f || fPass>=0.25f || atten_dB<10.0f)
+        return NULL;
+    float32_t tol = 2.0f*powf(10.0f, -0.05f*atten_dB);   // For G
+    float32_t nEst = (atten_dB - 7.95f)/(14.36f*(0.5f - 2.0f*fPass)) + 1.0f;
+    int K = (int)((nEst + 1.0f)/4.0f);
+    if(K < 1)  K = 1;
+    float32_t *g = new float32_t[2*FIRD_MULTIRATE_MAX_K];
+    float32_t edges[2] = {0.0f, 2.0f*fPass};
+    float32_t one = 1.0f;
+    if(g == NULL)
+        return NULL;
+    for(; K<=FIRD_MULTIRATE_MAX_K; K++)  {
+        if(remez(g, 2*K, 1, edges, &one, &one) == FIRD_ERR_MEMORY)
+            break;
+        if(bandError(g, 2*K, 0.0f, 2.0f*fPass, 1.0f) <= tol)  {
+            float32_t *pH = new float32_t[K];
+            if(pH)  {
+                for(int j=0; j<K; j++)
+                    pH[j] = 0.5f*g[K - 1 - j];
+                *pK = K;
+                }
+            delete [] g;
+            return pH;
+            }
+        }
+    delete [] g;
+    return NULL;
+    }
+
+float32_t* FIRDesign_F32::lowpass(float32_t fPass, float32_t fStop,
+                                  float32_t atten_dB, uint16_t *pN)  {
+    *pN = 0;
+    if(fPass<=0.0f || fStop<=fPass || fStop>=0.5f || atten_dB<10.0f)
+        return NULL;
+    float32_t tol = powf(10.0f, -0.05f*atten_dB);
+    int N = (int)((atten_dB - 7.95f)/(14.36f*(fStop - fPass))) + 1;
+    N |= 1;
+    if(N < 3)  N = 3;
+    float32_t *h = new float32_t[FIRD_MULTIRATE_MAX_N];
+    float32_t edges[4] = {0.0f, fPass, fStop, 0.5f};
+    float32_t amp[2] = {1.0f, 0.0f};
+    float32_t weight[2] = {1.0f, 1.0f};
+    if(h == NULL)
+        return NULL;
+    for(; N<=FIRD_MULTIRATE_MAX_N; N+=2)  {
+        if(remez(h, N, 2, edges, amp, weight) == FIRD_ERR_MEMORY)
+            break;
+        if(bandError(h, N, 0.0f, fPass, 1.0f) <= tol &&
+           bandError(h, N, fStop, 0.5f, 0.0f) <= tol)  {
+            float32_t *pH = new float32_t[N];
+            if(pH)  {
+                for(int n=0; n<N; n++)
+                    pH[n] = h[n];
+                *pN = N;
+                }
+            delete [] h;
+            return pH;
+            }
+        }
+    delete [] h;
+    return NULL;
+    }
+
+uint16_t FIRDesign_F32::multirateStages(uint16_t ratio, float32_t fPass,
+         float32_t atten_dB, stage *pStage, uint16_t maxStages)  {
+    uint16_t nStages = 0;
+    uint16_t r = ratio;
+    float32_t fs = 1.0f;              // Rate into the stage, of the high rate
+
+    if(ratio<2 || fPass<=0.0f || fPass>=0.5f/(float32_t)ratio)
+        return 0;
+    for(int i=0; i<maxStages; i++)  {
+        pStage[i].pCoeff = NULL;
+        pStage[i].nTaps = 0;
+        }
+    while((r & 1) == 0)  {
+        r /= 2;
+        if(nStages >= maxStages)
+            return 0;
+        stage *pS = &pStage[nStages++];
+        pS->factor = 2;
+        pS->pCoeff = halfBand(fPass/fs, atten_dB, &pS->K);
+        if(pS->pCoeff == NULL)  {
+            freeStages(pStage, nStages);
+            return 0;
+            }
+        pS->nTaps = 4*pS->K - 1;
+        fs *= 0.5f;
+        }
+    const uint16_t odd[3] = {7, 5, 3};
+    for(int j=0; j<3; j++)  {
+        while(r % odd[j] == 0)  {
+            r /= odd[j];
+            if(nStages >= maxStages)  {
+                freeStages(pStage, nStages);
+                return 0;
+                }
+            stage *pS = &pStage[nStages++];
+            float32_t fp = fPass/fs;
+            pS->factor = odd[j];
+            pS->K = 0;
+            pS->pCoeff = lowpass(fp, 1.0f/(float32_t)odd[j] - fp, atten_dB, &pS->nTaps);
+            if(pS->pCoeff == NULL)  {
+                freeStages(pStage, nStages);
+                return 0;
+                }
+            fs /= (float32_t)odd[j];
+            }
+        }
+    if(r != 1)  {
+        freeStages(pStage, nStages);
+        return 0;
+        }
+    return nStages;
+    }
+
+void FIRDesign_F32::freeStages(stage *pStage, uint16_t nStages)  {
+    for(int i=0; i<nStages; i++)  {
+        if(pStage[i].pCoeff)  delete [] pStage[i].pCoeff;
+        pStage[i].pCoeff = NULL;
+        pStage[i].nTaps = 0;
+        }
+    }
+
+bool FIRDesign_F32::cacheGet(cacheKey key, uint16_t nFIR, float32_t *pCoeff)  {
+    for(int s=0; s<nCacheSlots; s++)  {
+        if(cache[s].nFIR==nFIR && cache[s].key.fnv==key.fnv
+           && cache[s].key.oat==key.oat)  {
+            for(int i=0; i<nFIR; i++)
+                pCoeff[i] = cache[s].c[i];
+            cache[s].lastUse = ++useCount;
+            return true;
+            }
+        }
+    return false;
+    }
+
+void FIRDesign_F32::cachePut(cacheKey key, uint16_t nFIR, const float32_t *pCoeff)  {
+    int iUse = 0;
+
+    if(nCacheSlots == 0)
+        return;
+    for(int s=0; s<nCacheSlots; s++)  {
+        if(cache[s].nFIR==nFIR && cache[s].key.fnv==key.fnv
+           && cache[s].key.oat==key.oat)  {
+            iUse = s;      // Already there
+            break;
+            }
+        if(cache[s].lastUse < cache[iUse].lastUse)
+            iUse = s;
+        }
+
+    cacheSlot *pS = &cache[iUse];
+    if(pS->size < nFIR)  {
+        if(pS->c)  delete [] pS->c;
+        pS->c = new float32_t[nFIR];
+        pS->size = pS->c ? nFIR : 0;
+        }
+    pS->nFIR = 0;
+    if(pS->c == NULL)
+        return;
+    for(int i=0; i<nFIR; i++)
+        pS->c[i] = pCoeff[i];
+    pS->nFIR = nFIR;
+    pS->key = key;
+    pS->lastUse = ++useCount;
+    }
+
+void FIRDesign_F32::setCacheSlots(uint16_t n)  {
+    if(n > FIRD_CACHE_MAX)
+        n = FIRD_CACHE_MAX;
+    for(int s=n; s<FIRD_CACHE_MAX; s++)  {
+        if(cache[s].c)  delete [] cache[s].c;
+        cache[s].c = NULL;
+        cache[s].size = 0;
+        cache[s].nFIR = 0;
+        cache[s].lastUse = 0;
+        }
+    nCacheSlots = n;
+    }
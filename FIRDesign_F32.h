@@ -0,0 +1,212 @@
+/*
+ * FIRDesign_F32.h
+ *
+ * Shared support for the design of linear phase FIR filters, used by
+ * AudioFilterFIRGeneral_F32, AudioFilterEqualizer_F32 and
+ * AudioFilterConvolution_F32.  This is not an audio object and all
+ * functions are static.  Oct 2026
+ *
+ * Kaiser windows - The Bessel I0 function is a series, and a window
+ * needs one for every tap.  A slider that changes the response of a filter
+ * does not change the window, so the last FIRD_WINDOW_SLOTS windows are
+ * kept and a repeat costs nothing.
+ *
+ * Frequency sampling - The FIR for an amplitude response given at nFIR/2
+ * frequencies was an inverse DFT with a cosf() for every term, growing
+ * as the square of nFIR.  Here the response is interpolated onto the grid
+ * of a power of 2 real inverse FFT, at least as fine as the nFIR point
+ * grid and with the half sample steps needed for an even nFIR.  This
+ * takes a few ms for 2000 taps, where the DFT took seconds.  The
+ * coefficients differ from the DFT ones by the interpolation, which is
+ * well below the effect of the window.
+ *
+ * Response - The amplitude response, in dB, at nFreq points from 0 to
+ * half the sample rate.  If 2*nFreq is a power of 2 this is an FFT.
+ * Otherwise it is the direct sum, but with the cosine found by rotation,
+ * in double, so no cosf() is called.
+ *
+ * Coefficient cache - The last FIRD_CACHE_SLOTS designs are kept with a
+ * key made by hash() from everything the design depends on.  Going back
+ * to a previous setting is then a copy.  4 on T4.x and none on T3.x, or
+ * set by setCacheSlots().  Memory for both is from the heap, as needed.
+ *
+ * Optimal designs - remez() is the Parks-McClellan equiripple design and
+ * leastSquares() minimizes the weighted squared error.  For the same stop
+ * band these need fewer taps than a Kaiser window design, often 30% fewer,
+ * and every tap is time in update().  Both take bands, pairs of edges as
+ * fractions of fs from 0.0 to 0.5, each with an amplitude and a weight.
+ * The gaps between bands are transitions, where the response is free.
+ * levelBands() makes the bands from the level-in-dB form used by the
+ * equalizer and FIRGeneral objects, with a transition width centered on
+ * each change of level.  A level at or below FIRD_STOP_DB is a stop band,
+ * where the response is to be at most that level.  Above it the level is
+ * to be matched within FIRD_RIPPLE_DB.  The weights are set so that both
+ * are met together, or missed by the same factor if there are too few
+ * taps.  So ask for the stop band that is needed, not -140 dB.  Both are in
+ * double.  remez() uses memory in proportion to nFIR and takes a fraction
+ * of a second for a few hundred taps on T4.x, longer for T3.x.
+ * leastSquares() needs (nFIR/2)^2/2 doubles, so it is limited to
+ * FIRD_LS_MAX_TAPS.
+ *
+ * Functions:
+ *   kaiserWindow(L, D, beta)   Returns a pointer to L points of the Kaiser
+ *        window at x = (2i - (L-1))/D, i = 0 to L-1.  D = L-1 is the usual
+ *        window.  The pointer is good until the next call.  NULL if out
+ *        of memory.
+ *   i0(x)   Bessel function I0, in double.
+ *   frequencySample(pCoeff, nFIR, pAmp, nAmp)  nFIR coefficients, not
+ *        windowed, for the amplitudes pAmp[k] at k*fs/nFIR, k = 0 to
+ *        nAmp-1.  Amplitudes above the last repeat it.  Returns 0, or 1
+ *        if out of memory.
+ *   responseDB(pCoeff, nFIR, nFreq, pdB)  pdB[i] at i*fs/(2*nFreq).  The
+ *        FIR must be symmetrical.
+ *   remez(pCoeff, nFIR, nBands, pEdges, pAmp, pWeight)   Returns 0, or an
+ *        FIRD_ERR_ code.  With FIRD_ERR_CONVERGE the coefficients are
+ *        the best found.
+ *   leastSquares(pCoeff, nFIR, nBands, pEdges, pAmp, pWeight)  Returns 0,
+ *        or an FIRD_ERR_ code, with no coefficients.
+ *   levelBands(nLevels, pUpper, pdB, tw, pEdges, pAmp, pWeight)  Level
+ *        pdB[i] is up to frequency pUpper[i], tw is the transition width,
+ *        all frequencies fractions of fs.  pEdges is 2*nLevels.
+ *   halfBand(fPass, atten_dB, pK)   Half-band lowpass, for a change of rate
+ *        by 2.  Pass to fPass, a fraction of fs below 0.25, stop from
+ *        0.5-fPass, both to within atten_dB.  Returns a new[] array of the
+ *        K weights for the samples 1, 3, 5 ... each side of the center,
+ *        which is 0.5.  The others are 0.  K is put in *pK.  NULL on error.
+ *   lowpass(fPass, fStop, atten_dB, pN)   Returns a new[] array of *pN
+ *        coefficients, odd, for pass to fPass and stop from fStop, both to
+ *        within atten_dB.  NULL on error.
+ *   multirateStages(ratio, fPass, atten_dB, pStage, maxStages)  Plans and
+ *        designs a change of rate by ratio, as stages from the high rate
+ *        down.  ratio must be 2's times 3, 5 and 7.  Each 2 is a halfBand()
+ *        stage and these come first, then the odd factors as lowpass()
+ *        stages, largest first.  Each stage stops only what would alias
+ *        into 0 to fPass, a fraction of the high rate, so only the last
+ *        has a sharp transition, and it is at the lowest rate.  Returns
+ *        the number of stages, 0 on error.  Free with freeStages().
+ *   hash(pData, nBytes, h)   A cacheKey, the 32 bit FNV-1a and Jenkins
+ *        one-at-a-time hashes together.  Start with no h, and chain by
+ *        passing the last result as h.
+ *   cacheGet(key, nFIR, pCoeff)   Returns true and copies if found.
+ *   cachePut(key, nFIR, pCoeff)
+ *   setCacheSlots(n)   0 to FIRD_CACHE_MAX.  0 frees and turns off.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef FIRDesign_F32_h_
+#define FIRDesign_F32_h_
+
+#include "Arduino.h"
+#include "arm_math.h"
+
+// Design methods, for FIRGeneralOptimal() and equalizerNewOptimal()
+#define FIRD_REMEZ          0
+#define FIRD_LEAST_SQUARES  1
+
+// Returns from remez() and leastSquares()
+#define FIRD_ERR_MEMORY     1
+#define FIRD_ERR_CONVERGE   2
+#define FIRD_ERR_NFIR       3
+#define FIRD_ERR_SINGULAR   4
+
+// Largest designs from halfBand() and lowpass()
+#define FIRD_MULTIRATE_MAX_K  64
+#define FIRD_MULTIRATE_MAX_N  255
+
+// For levelBands()
+#define FIRD_STOP_DB       -40.0f
+#define FIRD_RIPPLE_DB       0.1f
+
+#define FIRD_WINDOW_SLOTS 2
+#define FIRD_CACHE_MAX    8
+#if defined(__IMXRT1062__)
+#define FIRD_CACHE_SLOTS  4
+#define FIRD_LS_MAX_TAPS  257
+#else
+#define FIRD_CACHE_SLOTS  0
+#define FIRD_LS_MAX_TAPS  129
+#endif
+
+class FIRDesign_F32
+{
+public:
+    static const float32_t* kaiserWindow(uint16_t L, float32_t D, float32_t beta);
+    static double i0(double x);
+    static uint16_t frequencySample(float32_t *pCoeff, uint16_t nFIR,
+                                    const float32_t *pAmp, uint16_t nAmp);
+    static void responseDB(const float32_t *pCoeff, uint16_t nFIR,
+                           uint16_t nFreq, float32_t *pdB);
+    static uint16_t remez(float32_t *pCoeff, uint16_t nFIR, uint16_t nBands,
+             const float32_t *pEdges, const float32_t *pAmp, const float32_t *pWeight);
+    static uint16_t leastSquares(float32_t *pCoeff, uint16_t nFIR, uint16_t nBands,
+             const float32_t *pEdges, const float32_t *pAmp, const float32_t *pWeight);
+    // One stage of a change of rate, see multirateStages()
+    struct stage {
+        uint16_t factor;     // 2 for a half-band
+        uint16_t nTaps;      // All taps, 4K-1 for a half-band
+        uint16_t K;          // Half-band weights in pCoeff, 0 for a lowpass
+        float32_t *pCoeff;   // From new[]
+        };
+    static uint16_t multirateStages(uint16_t ratio, float32_t fPass,
+             float32_t atten_dB, stage *pStage, uint16_t maxStages);
+    static void freeStages(stage *pStage, uint16_t nStages);
+    static float32_t* halfBand(float32_t fPass, float32_t atten_dB, uint16_t *pK);
+    static float32_t* lowpass(float32_t fPass, float32_t fStop,
+                              float32_t atten_dB, uint16_t *pN);
+    static uint16_t levelBands(uint16_t nLevels, const float32_t *pUpper,
+             const float32_t *pdB, float32_t tw,
+             float32_t *pEdges, float32_t *pAmp, float32_t *pWeight);
+
+    // Two independent 32 bit hashes of the same bytes, FNV-1a and Jenkins
+    // one-at-a-time.  A cache hit needs both to match.
+    struct cacheKey {
+        uint32_t fnv;
+        uint32_t oat;
+        cacheKey(void) : fnv(2166136261UL), oat(0) {}
+        };
+    static cacheKey hash(const void *pData, uint32_t nBytes,
+                         cacheKey h = cacheKey())  {
+        const uint8_t *p = (const uint8_t *)pData;
+        for(uint32_t i=0; i<nBytes; i++)  {
+            h.fnv ^= p[i];
+            h.fnv *= 16777619UL;
+            h.oat += p[i];
+            h.oat += h.oat << 10;
+            h.oat ^= h.oat >> 6;
+            }
+        return h;
+        }
+    static bool cacheGet(cacheKey key, uint16_t nFIR, float32_t *pCoeff);
+    static void cachePut(cacheKey key, uint16_t nFIR, const float32_t *pCoeff);
+    static void setCacheSlots(uint16_t n);
+
+private:
+    struct windowSlot {
+        float32_t *w;
+        uint16_t size;      // Allocated
+        uint16_t L;
+        float32_t D;
+        float32_t beta;
+        uint32_t lastUse;
+        };
+    struct cacheSlot {
+        float32_t *c;
+        uint16_t size;      // Allocated
+        uint16_t nFIR;      // 0 is empty
+        cacheKey key;
+        uint32_t lastUse;
+        };
+    static uint16_t remezExchange(uint16_t nFIR, uint16_t nBands,
+             const float32_t *pEdges, const float32_t *pAmp, const float32_t *pWeight,
+             double *pF, float32_t *pCoeff);
+    static float32_t bandError(const float32_t *pCoeff, uint16_t nFIR,
+                               float32_t f0, float32_t f1, float32_t target);
+    static void coeffsFromAmplitude(float32_t *pCoeff, uint16_t nFIR, const double *pA);
+
+    static windowSlot windows[FIRD_WINDOW_SLOTS];
+    static cacheSlot cache[FIRD_CACHE_MAX];
+    static uint16_t nCacheSlots;
+    static uint32_t useCount;
+};
+#endif
@@ -0,0 +1,153 @@
+/*
+ * FIRKernel_F32.cpp
+ *
+ * See FIRKernel_F32.h for notes.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "FIRKernel_F32.h"
+
+uint16_t FIRKernel_F32::initDecimate(uint16_t _numTaps, uint16_t _M,
+             const float32_t *_pCoeffs, float32_t *_pState, uint32_t _blockSize)  {
+    float32_t hMax = 0.0f;
+    bool sym = true;
+    bool anti = true;
+    uint16_t nz[2] = {0, 0};     // Non-zero pairs with k even, k odd
+    uint16_t half, last, k;
+
+    numTaps = _numTaps;
+    M = (_M < 1) ? 1 : _M;
+    pCoeffs = _pCoeffs;
+    pState = _pState;
+    type = FIRK_GENERAL;
+    first = 0;
+    step = 1;
+    center = 0.0f;
+    nMult = numTaps;
+    if(numTaps==0 || pCoeffs==NULL || pState==NULL)  {
+        numTaps = 0;
+        nMult = 0;
+        return type;
+        }
+    for(uint32_t i=0; i<numTaps+_blockSize-1; i++)
+        pState[i] = 0.0f;
+
+    half = numTaps/2;
+    last = numTaps - 1;
+    for(k=0; k<numTaps; k++)
+        if(fabsf(pCoeffs[k]) > hMax)  hMax = fabsf(pCoeffs[k]);
+    float32_t zero = FIRK_ZERO_TOL*hMax;
+    for(k=0; k<half; k++)  {
+        float32_t a = pCoeffs[k];
+        float32_t b = pCoeffs[last - k];
+        float32_t tol = FIRK_SYM_TOL*(fabsf(a) + fabsf(b)) + zero;
+        if(fabsf(a - b) > tol)  sym = false;
+        if(fabsf(a + b) > tol)  anti = false;
+        if(fabsf(a) > zero)  nz[k & 1]++;
+        }
+    if((numTaps & 1) && fabsf(pCoeffs[half]) > zero)
+        anti = false;             // An odd antisymmetric has 0 there
+
+    if(sym || anti)  {
+        type = sym ? FIRK_SYMMETRIC : FIRK_ANTISYMMETRIC;
+        // Half-band and Hilbert, every other pair zero
+        if(nz[0]==0 && nz[1]>0)        { first = 1;  step = 2; }
+        else if(nz[1]==0 && nz[0]>0)   { first = 0;  step = 2; }
+        while(first<half && fabsf(pCoeffs[first])<=zero)
+            first += step;
+        if(sym && (numTaps & 1) && fabsf(pCoeffs[half])>zero)
+            center = pCoeffs[half];
+        nMult = (first<half) ? (half - first + step - 1)/step : 0;
+        if(center != 0.0f)  nMult++;
+        }
+    else if(M == 1)
+        arm_fir_init_f32(&armInst, numTaps, (float32_t *)pCoeffs, pState, _blockSize);
+    return type;
+    }
+
+// Output j is the sum over the window w = x + j*M, w[numTaps-1] the
+// newest.  The pairs for ANTI false or true.
+template <bool ANTI>
+static inline void pairSums(const float32_t *h, uint16_t first, uint16_t step,
+                uint16_t half, uint16_t last, const float32_t *x, uint16_t M,
+                float32_t *pDst, uint32_t nOut)  {
+    uint32_t j = 0;
+    for(; j+4<=nOut; j+=4)  {
+        const float32_t *x0 = x + j*M;
+        const float32_t *x1 = x0 + M;
+        const float32_t *x2 = x1 + M;
+        const float32_t *x3 = x2 + M;
+        float32_t a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+        for(uint16_t k=first; k<half; k+=step)  {
+            float32_t c = h[k];
+            uint16_t m = last - k;
+            a0 += c*(ANTI ? x0[k] - x0[m] : x0[k] + x0[m]);
+            a1 += c*(ANTI ? x1[k] - x1[m] : x1[k] + x1[m]);
+            a2 += c*(ANTI ? x2[k] - x2[m] : x2[k] + x2[m]);
+            a3 += c*(ANTI ? x3[k] - x3[m] : x3[k] + x3[m]);
+            }
+        pDst[j] = a0;  pDst[j+1] = a1;  pDst[j+2] = a2;  pDst[j+3] = a3;
+        }
+    for(; j<nOut; j++)  {
+        const float32_t *x0 = x + j*M;
+        float32_t a0 = 0.0f;
+        for(uint16_t k=first; k<half; k+=step)
+            a0 += h[k]*(ANTI ? x0[k] - x0[last - k] : x0[k] + x0[last - k]);
+        pDst[j] = a0;
+        }
+    }
+
+void FIRKernel_F32::outputs(const float32_t *x, float32_t *pDst, uint32_t nOut)  {
+    const float32_t *h = pCoeffs;
+    uint16_t half = numTaps/2;
+    uint32_t j = 0;
+
+    if(type == FIRK_GENERAL)  {       // Only when decimating
+        for(; j+4<=nOut; j+=4)  {
+            const float32_t *x0 = x + j*M;
+            const float32_t *x1 = x0 + M;
+            const float32_t *x2 = x1 + M;
+            const float32_t *x3 = x2 + M;
+            float32_t a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+            for(uint16_t k=0; k<numTaps; k++)  {
+                float32_t c = h[k];
+                a0 += c*x0[k];  a1 += c*x1[k];  a2 += c*x2[k];  a3 += c*x3[k];
+                }
+            pDst[j] = a0;  pDst[j+1] = a1;  pDst[j+2] = a2;  pDst[j+3] = a3;
+            }
+        for(; j<nOut; j++)  {
+            const float32_t *x0 = x + j*M;
+            float32_t a0 = 0.0f;
+            for(uint16_t k=0; k<numTaps; k++)
+                a0 += h[k]*x0[k];
+            pDst[j] = a0;
+            }
+        return;
+        }
+
+    if(type == FIRK_ANTISYMMETRIC)
+        pairSums<true>(h, first, step, half, numTaps-1, x, M, pDst, nOut);
+    else
+        pairSums<false>(h, first, step, half, numTaps-1, x, M, pDst, nOut);
+    if(center != 0.0f)
+        for(j=0; j<nOut; j++)
+            pDst[j] += center*x[j*M + half];
+    }
+
+void FIRKernel_F32::process(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)  {
+    if(numTaps == 0)
+        return;
+    if(type==FIRK_GENERAL && M==1)  {
+        arm_fir_f32(&armInst, (float32_t *)pSrc, pDst, blockSize);
+        return;
+        }
+    // The input after the old samples, so pSrc may be pDst
+    float32_t *pNew = pState + numTaps - 1;
+    if(pSrc != pNew)
+        for(uint32_t i=0; i<blockSize; i++)
+            pNew[i] = pSrc[i];
+    outputs(pState, pDst, blockSize/M);
+    for(uint16_t i=0; i<numTaps-1; i++)     // Newest to the front for next time
+        pState[i] = pState[blockSize + i];
+    }
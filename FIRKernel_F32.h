@@ -0,0 +1,86 @@
+/*
+ * FIRKernel_F32.h
+ *
+ * An FIR filter, in place of arm_fir_f32() and arm_fir_decimate_f32(),
+ * that takes advantage of linear phase.  Almost every FIR designed in this
+ * library is symmetric, h[k] = h[N-1-k], and Hilbert transformers are
+ * antisymmetric, h[k] = -h[N-1-k].  Then the two samples that share a
+ * coefficient are added (or subtracted) first, and there are half the
+ * multiplies and half the coefficient loads.  Half-band filters, and
+ * Hilbert transformers, also have every other tap zero, and these are
+ * skipped, so half as many again.  init() finds all this from the
+ * coefficients.  Anything else goes to the ARM library as before.  Not an
+ * audio object.  Oct 2026
+ *
+ * The state is the same as for the ARM FIR, numTaps + blockSize - 1
+ * floats, holding the last numTaps - 1 inputs, oldest first, between
+ * calls.  The coefficients are in the same order, the one for the oldest
+ * sample first, and are not copied, so they must stay in place.  pSrc and
+ * pDst may be the same.  Four outputs are found together, so each
+ * coefficient is loaded once for the four, and the four sums are
+ * independent for the FPU pipeline.  The Cortex-M4 and M7 have no SIMD
+ * for float, so this is as near as they come.
+ *
+ * Taps are taken as symmetric if they match to FIRK_SYM_TOL, relative, and
+ * as zero if they are below FIRK_ZERO_TOL of the largest.
+ *
+ * Functions:
+ *   init(numTaps, pCoeffs, pState, blockSize)  As arm_fir_init_f32().  The
+ *         state is zeroed.  Returns the type, FIRK_GENERAL, FIRK_SYMMETRIC
+ *         or FIRK_ANTISYMMETRIC.
+ *   initDecimate(numTaps, M, pCoeffs, pState, blockSize)  The same, for
+ *         one output in M, as arm_fir_decimate_init_f32().  blockSize must
+ *         be a multiple of M.
+ *   process(pSrc, pDst, blockSize)  blockSize inputs, and blockSize/M
+ *         outputs.  blockSize up to the one given to init().
+ *   getType()
+ *   getMultiplies()  Per output.
+ *   getNumTaps()
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef FIRKernel_F32_h_
+#define FIRKernel_F32_h_
+
+#include "Arduino.h"
+#include "arm_math.h"
+
+#define FIRK_GENERAL        0
+#define FIRK_SYMMETRIC      1
+#define FIRK_ANTISYMMETRIC  2
+
+#define FIRK_SYM_TOL   1.0e-6f
+#define FIRK_ZERO_TOL  1.0e-7f
+
+class FIRKernel_F32
+{
+public:
+    uint16_t init(uint16_t _numTaps, const float32_t *_pCoeffs,
+                  float32_t *_pState, uint32_t _blockSize)  {
+        return initDecimate(_numTaps, 1, _pCoeffs, _pState, _blockSize);
+        }
+    uint16_t initDecimate(uint16_t _numTaps, uint16_t _M, const float32_t *_pCoeffs,
+                          float32_t *_pState, uint32_t _blockSize);
+    void process(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+    uint16_t getType(void)       { return type; }
+    uint16_t getMultiplies(void) { return nMult; }
+    uint16_t getNumTaps(void)    { return numTaps; }
+
+private:
+    uint16_t numTaps = 0;
+    uint16_t M = 1;
+    const float32_t *pCoeffs = NULL;
+    float32_t *pState = NULL;
+    uint16_t type = FIRK_GENERAL;
+    // Pairs are taps k = first, first+step, ... below numTaps/2, with the
+    // mirror tap numTaps-1-k.
+    uint16_t first = 0;
+    uint16_t step = 1;
+    float32_t center = 0.0f;    // Middle tap of odd numTaps, if symmetric
+    uint16_t nMult = 0;
+    arm_fir_instance_f32 armInst;
+
+    void outputs(const float32_t *x, float32_t *pDst, uint32_t nOut);
+};
+#endif
@@ -5,15 +5,19 @@
 #include <control_tlv320aic3206.h>
 #include "AudioCalcEnvelope_F32.h"
 #include "AudioCalcGainWDRC_F32.h"
+#include "AudioCalcVAD_F32.h"
 #include "AudioConfigFIRFilterBank_F32.h"
 #include "AudioControlTester.h"
 #include "AudioConvert_F32.h"
+#include "AudioEffectAlignLatency_F32.h"
 #include "AudioEffectCompressor_F32.h"
 #include "AudioEffectCompressor2_F32.h"
 //#include "AudioEffectCompWDRC_F32.h"
 #include "AudioEffectEmpty_F32.h"
+#include "AudioEffectFeedbackCancel_F32.h"
 #include "AudioEffectGain_F32.h"
 #include "AudioFilterBiquad_F32.h"
+#include "AudioFilterBiquadMulti_F32.h"
 #include "AudioFilterConvolution_F32.h"
 #include <AudioFilterFIR_F32.h>
 #include <AudioFilterIIR_F32.h>
@@ -26,6 +30,7 @@
 #include "AudioMixer_F32.h"
 #include "AudioMultiply_F32.h"
 #include "AudioSDPlayer_F32.h"
+#include "AudioSDRecorder_F32.h"
 #include "AudioSettings_F32.h"
 #include "AudioSpectralDenoise_F32.h"
 #include "input_i2s_f32.h"
@@ -50,9 +55,14 @@
 #include "analyze_fft2048_iq_F32.h"
 #include "analyze_fft4096_iq_F32.h"
 #include "analyze_fft4096_iqem_F32.h"
+#include "AudioAnalyzeSpectrum_F32.h"
+#include "AudioAnalyzeSpectrogram_F32.h"
+#include "AudioAnalyzeSpectralPeaks_F32.h"
 #include "analyze_peak_f32.h"
 #include "analyze_rms_f32.h"
+#include "AudioAnalyzeStats_F32.h"
 #include "analyze_tonedetect_F32.h"
+#include "AudioAnalyzeToneBank_F32.h"
 // #include "control_tlv320aic3206.h"  collides much with Teensy Audio
 #include "AudioSwitch_OA_F32.h"
 #include "FFT_Overlapped_OA_F32.h"
@@ -62,8 +72,11 @@
 #include "RadioIQMixer_F32.h"
 #include "AudioFilter90Deg_F32.h"
 #include "AudioAnalyzePhase_F32.h"
+#include "AudioAnalyzeCrossCorr_F32.h"
 #include "AudioFilterEqualizer_F32.h"
 #include "AudioFilterFIRGeneral_F32.h"
+#include "AudioFilterDecimate_F32.h"
+#include "AudioFilterInterpolate_F32.h"
 #include "radioCWModulator_F32.h"
 #include "radioCESSBtransmit_F32.h"
 #include "radioCESSB_Z_transmit_F32.h"
@@ -37,6 +37,29 @@
 
 #include <Arduino.h>
 #include "analyze_CTCSS_F32.h"
+#include "AudioAnalyzeToneBank_F32.h"
+
+// The 50 standard CTCSS tones, Hz
+const float32_t analyze_CTCSS_F32::ctcssTones[CTCSS_NUM_TONES] = {
+   67.0f,  69.3f,  71.9f,  74.4f,  77.0f,  79.7f,  82.5f,  85.4f,  88.5f,  91.5f,
+   94.8f,  97.4f, 100.0f, 103.5f, 107.2f, 110.9f, 114.8f, 118.8f, 123.0f, 127.3f,
+  131.8f, 136.5f, 141.3f, 146.2f, 151.4f, 156.7f, 159.8f, 162.2f, 165.5f, 167.9f,
+  171.3f, 173.8f, 177.3f, 179.9f, 183.5f, 186.2f, 189.9f, 192.8f, 196.6f, 199.5f,
+  203.5f, 206.5f, 210.7f, 218.1f, 225.7f, 229.1f, 233.6f, 241.8f, 250.3f, 254.1f};
+
+// The 104 standard DCS codes, octal
+const uint16_t analyze_CTCSS_F32::dcsCodes[DCS_NUM_CODES] = {
+  0023, 0025, 0026, 0031, 0032, 0036, 0043, 0047, 0051, 0053, 0054, 0065, 0071,
+  0072, 0073, 0074, 0114, 0115, 0116, 0122, 0125, 0131, 0132, 0134, 0143, 0145,
+  0152, 0155, 0156, 0162, 0165, 0172, 0174, 0205, 0212, 0223, 0225, 0226, 0243,
+  0244, 0245, 0246, 0251, 0252, 0255, 0261, 0263, 0265, 0266, 0271, 0274, 0306,
+  0311, 0315, 0325, 0331, 0332, 0343, 0346, 0351, 0356, 0364, 0365, 0371, 0411,
+  0412, 0413, 0423, 0431, 0432, 0445, 0446, 0452, 0454, 0455, 0462, 0464, 0465,
+  0466, 0503, 0506, 0516, 0523, 0526, 0532, 0546, 0565, 0606, 0612, 0624, 0627,
+  0631, 0632, 0654, 0662, 0664, 0703, 0712, 0723, 0731, 0732, 0734, 0743, 0754};
+
+#define DCS_BAUD  134.4f
+#define DCS_INV   0x1000     // With the code in dcsFound, inverted
 
 void analyze_CTCSS_F32::update(void)  {
     audio_block_f32_t *block;
@@ -63,9 +86,16 @@ void analyze_CTCSS_F32::update(void)  {
     for(int i=0; i<nPerBlock2; i++)
        d16a[i] = *(block->data + nDecimate*i);   // Decimated sample, only every nDecimate
 
+    // DCS is mostly below 67 Hz, so it is decoded ahead of the BPF
+    if(scan)
+       runDCS(d16a, nPerBlock2);
+
     // Filter down to 67-254Hz band, leaving result in d16a[];
     arm_biquad_cascade_df1_f32(&iir_bpf_inst, d16a, d16a, nPerBlock2);
 
+    if(scan)
+       runScan(d16a, nPerBlock2);
+
     // For reference measurement, only, null out the tone, creating d16b[].
     // This d16b signal  path is not used for the Goertzel.
     arm_biquad_cascade_df1_f32(&iir_nulls_inst, d16a, d16b, nPerBlock2);
@@ -121,3 +151,153 @@ analyze_CTCSS_F32::operator bool()  {
     pThresh *= pThresh;
     return (powerTone >= pThresh);
     }
+
+
+// Called from initCTCSS() and setScan(), with sampleRate2 and gLength set
+void analyze_CTCSS_F32::initScan(void)  {
+    for(int k=0; k<CTCSS_NUM_TONES; k++)
+       {
+       scanCoef[k] = 2.0f*cosf(6.28318530718f*ctcssTones[k]/sampleRate2);
+       scanS1[k] = 0.0f;
+       scanS2[k] = 0.0f;
+       }
+    scanCount = 0;
+    scanBandSum = 0.0f;
+    scanIndex = -1;
+    scanPower = 0.0f;
+    scanSNR_dB = 0.0f;
+
+    dcsDCk = 1.0f/sampleRate2;      // About a second
+    dcsStep = DCS_BAUD/sampleRate2;
+    dcsPhase = 0.0f;
+    dcsWord = 0;
+    dcsBitCount = 0;
+    dcsFound = 0;
+    dcsPrevFound = 0;
+    dcsMisses = 0;
+    dcsCode = 0;
+    dcsInverted = false;
+    }
+
+// The 50 Goertzel filters, four at a time over the samples, as in
+// AudioAnalyzeToneBank_F32.  All have the length gLength, so a
+// measurement ends for all at the same sample.
+void analyze_CTCSS_F32::runScan(const float32_t *x, uint16_t n)  {
+    while(n > 0)
+       {
+       uint16_t nRun = gLength - scanCount;
+       if(nRun > n)  nRun = n;
+       AudioAnalyzeToneBank_F32::goertzel(x, nRun, scanCoef, scanS1, scanS2,
+                                          CTCSS_NUM_TONES);
+       for(uint16_t i=0; i<nRun; i++)
+          scanBandSum += x[i]*x[i];
+       scanCount += nRun;
+       x += nRun;
+       n -= nRun;
+
+       if(scanCount >= gLength)   // The end of a measurement, find the strongest
+          {
+          int16_t iMax = 0;
+          float32_t pMax = 0.0f;
+          for(int k=0; k<CTCSS_NUM_TONES; k++)
+             {
+             // |X|^2 for the Goertzel, scaled as powerTone, A^2 for a sine wave
+             float32_t p = scanS1[k]*scanS1[k] + scanS2[k]*scanS2[k]
+                         - scanCoef[k]*scanS1[k]*scanS2[k];
+             if(p > pMax)
+                {
+                pMax = p;
+                iMax = k;
+                }
+             scanS1[k] = 0.0f;
+             scanS2[k] = 0.0f;
+             }
+          float32_t L = (float32_t)gLength;
+          scanPower = 4.0f*pMax/(L*L);
+          // The band power, also A^2 for a sine wave
+          float32_t pBand = 2.0f*scanBandSum/L;
+          float32_t pRest = pBand - scanPower;
+          if(pRest < 1.0E-4f*pBand)  pRest = 1.0E-4f*pBand;   // 40 dB limit
+          if(pRest < 1.0E-12f)       pRest = 1.0E-12f;
+          scanSNR_dB = 10.0f*log10f(scanPower/pRest);
+          if(scanPower>=scanThreshAbs && scanSNR_dB>=scanThreshSNR_dB)
+             scanIndex = iMax;
+          else
+             scanIndex = -1;
+          scanCount = 0;
+          scanBandSum = 0.0f;
+          scanNew = true;
+          }
+       }
+    }
+
+// Slicer, bit PLL and a check of the last 23 bits, at each bit
+void analyze_CTCSS_F32::runDCS(const float32_t *x, uint16_t n)  {
+    for(uint16_t i=0; i<n; i++)
+       {
+       dcsDC += dcsDCk*(x[i] - dcsDC);
+       bool bit = (x[i] > dcsDC);
+       // Transitions belong at phase 0.5, so pull toward that
+       if(bit != dcsLast)
+          dcsPhase -= 0.25f*(dcsPhase - 0.5f);
+       dcsLast = bit;
+       dcsPhase += dcsStep;
+       if(dcsPhase < 1.0f)
+          continue;
+       dcsPhase -= 1.0f;
+
+       // Mid bit.  The first bit sent, the LSB, ends up at bit 0.
+       dcsWord = (dcsWord >> 1) | ((uint32_t)bit << 22);
+       uint16_t c = dcsCheck(dcsWord);
+       uint16_t cInv = dcsCheck(~dcsWord & 0x7FFFFF);
+       if(cInv)  cInv |= DCS_INV;
+       // The lowest code, of the aliases, normal ahead of inverted
+       if(c && (dcsFound==0 || c < (dcsFound & 0x1FF)))
+          dcsFound = c;
+       if(cInv && (dcsFound==0 || (cInv & 0x1FF) < (dcsFound & 0x1FF)))
+          dcsFound = cInv;
+
+       if(++dcsBitCount < 23)
+          continue;
+       dcsBitCount = 0;
+       if(dcsFound)
+          {
+          if(dcsFound == dcsPrevFound)
+             {
+             dcsCode = dcsFound & 0x1FF;
+             dcsInverted = (dcsFound & DCS_INV) != 0;
+             }
+          dcsMisses = 0;
+          }
+       else if(++dcsMisses >= 2)
+          {
+          dcsCode = 0;
+          dcsInverted = false;
+          }
+       dcsPrevFound = dcsFound;
+       dcsFound = 0;
+       }
+    }
+
+/* Returns the code, if w is the 23 bit Golay word of a standard code,
+ * or 0.  The 12 data bits are the 9 bit code and 100 in bits 9 to 11.
+ */
+uint16_t analyze_CTCSS_F32::dcsCheck(uint32_t w)  {
+    if(((w >> 9) & 7) != 4)
+       return 0;
+    uint16_t code = w & 0x1FF;
+    // Golay (23,12), the 11 parity bits above the 12 data bits
+    uint32_t g = w & 0xFFF;
+    for(int i=0; i<12; i++)
+       {
+       g <<= 1;
+       if(g & 0x1000)
+          g ^= 0x08EA;
+       }
+    if(((w & 0xFFF) | ((g & 0x0FFE) << 11)) != w)
+       return 0;
+    for(int i=0; i<DCS_NUM_CODES; i++)
+       if(dcsCodes[i] == code)
+          return code;
+    return 0;
+    }
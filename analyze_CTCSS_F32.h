@@ -6,6 +6,8 @@
  *   Rev 21 Jan 2022 Major redo and ready to publish.  Bob L
  *   Rev 15 March 2023 - Added dynamic sample rate control; added 12 ksps; corrected
  *      receiveWritable_f32() for block with output.  Bob L
+ *   Rev Oct 2026 - Added scan mode, the strongest of the 50 standard tones,
+ *      and DCS decoding, from the same decimated data.
  *
  * This is specific for the CTCSS tone system
  * with tones in the 67.0 to 254.1 Hz range.
@@ -138,6 +140,40 @@
  *
  * Each update of an 128-input block takes about 42 uSec on a Teensy 3.6.
  *
+ * Scan mode - setScan(true) adds a search of all 50 standard CTCSS tones and
+ * a DCS decoder, sharing the LPF, decimation and BPF of the single tone
+ * detector.  The 50 tones are Goertzel filters on the BPF output, run four
+ * at a time, and all measuring over the same tMeas, 300 msec by default.  At
+ * the end of each measurement the strongest is reported, with its power and
+ * its SNR, the tone power over the rest of the 67 to 254 Hz band.  A
+ * frequency meter is not needed, and the tones are spaced by 2.3 Hz or more,
+ * so with 300 msec the nearest neighbor is down about 8 dB.  This is about
+ * 400 multiplies per 128 block at 44.1 kHz, far less than 50 of these
+ * objects.
+ *
+ * DCS is 134.4 bit/sec NRZ, so it uses the decimated data ahead of the BPF.
+ * The slicer removes the DC and a simple PLL samples in the middle of each
+ * bit.  The last 23 bits are checked, and inverted, each bit, for a Golay
+ * (23,12) code word with the 100 flag bits and one of the 104 standard
+ * codes.  The code repeats every 23 bits, and some codes are rotations of
+ * others, or of the inverse of others, such as 023 normal and 047 inverted.
+ * These can not be told apart, so the lowest code found in 23 bits is
+ * reported.  It needs two matching 23-bit periods to report a code,
+ * about 0.35 sec, and two without any to clear it.
+ *
+ * Scan functions:
+ *   setScan(bool)  Starts, or stops, the scan and DCS.
+ *   bool availableScan()  true at the end of each scan measurement.
+ *   int16_t readScanIndex()  0 to 49 for the strongest tone, or -1 if it is
+ *         under the scan thresholds.
+ *   float32_t readScanFrequency()  In Hz, or 0.0 if none.
+ *   float32_t readScanPower()  Of the strongest, in the units of readTonePower().
+ *   float32_t readScanSNR_dB()
+ *   scanThresholds(levelAbs, snr_dB)  Defaults 0.0001 and 6 dB.
+ *   uint16_t readDCS()  The code, or 0 for none.  Print it with OCT.
+ *   bool readDCSInverted()
+ *   float32_t getCTCSSFrequency(i)  The 50 standard tones, 0 to 49.
+ *
  * Note - Pieces of this support block sizes other than 128, but not all.
  * Work needs to be done to implement and test variable block size.  The same is
  * true for sample rates outside the 12 and 44.1 to 100 kHz range.
@@ -149,6 +185,9 @@
 #include "Arduino.h"
 #include "AudioStream_F32.h"
 
+#define CTCSS_NUM_TONES  50
+#define DCS_NUM_CODES   104
+
 class analyze_CTCSS_F32 : public AudioStream_F32
 {
 //GUI: inputs:1, outputs:1  //this line used for automatic generation of GUI node
@@ -228,6 +267,7 @@ public:
         ccIm = -sin(6.28318530718f*nDecimatef*freq/sample_rate_Hz);
 
         thresholds(0.1f, 1.0f);
+        initScan();
     }
 
     // Set frequency and length of Goertzel detect tone in Hz and milliseconds.
@@ -284,6 +324,42 @@ public:
 
     operator bool();  // true if at or above threshold, false if below
 
+    // Scan of the 50 standard tones, and DCS.  See notes above.
+    void setScan(bool _scan)  {
+        __disable_irq();
+        scan = _scan;
+        initScan();
+        __enable_irq();
+        }
+
+    bool availableScan(void) {
+        __disable_irq();
+        bool flag = scanNew;
+        scanNew = false;
+        __enable_irq();
+        return flag;
+        }
+
+    int16_t readScanIndex(void)         { return scanIndex; }
+    float32_t readScanFrequency(void)   {
+        int16_t i = scanIndex;
+        return i<0 ? 0.0f : ctcssTones[i];
+        }
+    float32_t readScanPower(void)       { return scanPower; }
+    float32_t readScanSNR_dB(void)      { return scanSNR_dB; }
+
+    void scanThresholds(float32_t levelAbs, float32_t snr_dB) {
+        scanThreshAbs = levelAbs;
+        scanThreshSNR_dB = snr_dB;
+        }
+
+    uint16_t readDCS(void)              { return dcsCode; }
+    bool readDCSInverted(void)          { return dcsInverted; }
+
+    static float32_t getCTCSSFrequency(uint16_t i)  {
+        return i<CTCSS_NUM_TONES ? ctcssTones[i] : 0.0f;
+        }
+
     virtual void update(void);
 
     /* The bandpass filter covers 67 to 254 Hz to allow a comparison
@@ -338,6 +414,41 @@ private:
     float32_t threshRel = 1.0f;     // noise relative threshold
     bool gEnabled = false;
     volatile bool new_output = false;
+
+    // Scan, the 50 Goertzel filters as arrays, and a common count
+    static const float32_t ctcssTones[CTCSS_NUM_TONES];
+    bool scan = false;
+    float32_t scanCoef[CTCSS_NUM_TONES];
+    float32_t scanS1[CTCSS_NUM_TONES];
+    float32_t scanS2[CTCSS_NUM_TONES];
+    uint16_t scanCount = 0;
+    float32_t scanBandSum = 0.0f;     // Of the BPF output, squared
+    volatile bool scanNew = false;
+    volatile int16_t scanIndex = -1;
+    float32_t scanPower = 0.0f;
+    float32_t scanSNR_dB = 0.0f;
+    float32_t scanThreshAbs = 0.0001f;
+    float32_t scanThreshSNR_dB = 6.0f;
+
+    // DCS, slicer, bit PLL and the last 23 bits
+    static const uint16_t dcsCodes[DCS_NUM_CODES];
+    float32_t dcsDC = 0.0f;
+    float32_t dcsDCk = 0.001f;        // DC average, per sample
+    bool dcsLast = false;
+    float32_t dcsPhase = 0.0f;        // Bits, 0 to 1
+    float32_t dcsStep = 0.05f;        // Bits per sample
+    uint32_t dcsWord = 0;
+    uint16_t dcsBitCount = 0;         // In the 23 bit period
+    uint16_t dcsFound = 0;            // This period, code | DCS_INV, or 0
+    uint16_t dcsPrevFound = 0;        // Last period
+    uint16_t dcsMisses = 0;
+    volatile uint16_t dcsCode = 0;
+    volatile bool dcsInverted = false;
+
+    void initScan(void);
+    void runScan(const float32_t *x, uint16_t n);
+    void runDCS(const float32_t *x, uint16_t n);
+    uint16_t dcsCheck(uint32_t w);
     audio_block_f32_t *inputQueueArray_f32[1];
     float32_t sample_rate_Hz = AUDIO_SAMPLE_RATE;
     uint16_t block_size = 128;
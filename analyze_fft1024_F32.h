@@ -67,6 +67,8 @@
 // Converted to using half-size FFT for real input, with no zero inputs.
 // See E. Oran Brigham and many other FFT references.  16 March 2021 RSL
 // Moved post-FFT calculations to state 4 to load share.  RSL 18 Mar 2021
+// See AudioAnalyzeSpectrum_F32 for other sizes and the work spread over
+// every update.  This class is kept for existing INOs.  Oct 2026
 
 #ifndef analyze_fft1024_F32_h_
 #define analyze_fft1024_F32_h_
@@ -3,6 +3,8 @@
 *
  * Rev 6 Mar 2021 - Added setXAxis()
  * Rev 11 Mar 2021 - Fixed xAxis correction for dBFS output
+ * Rev Oct 2026 - AudioAnalyzeSpectrum_F32 does any size, with the work
+ * spread over the updates.  This class is kept for existing INOs.
  * 
  * Does Fast Fourier Transform of a 1024 point complex (I-Q) input.
  * Output is one of three measures of the power in each of the 1024
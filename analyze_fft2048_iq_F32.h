@@ -1,6 +1,8 @@
 /*
  *   Analyze_fft2048_iq_F32.h    Assembled by Bob Larkin   8 Mar 2021
  * Rev 12 March 2021 Corrected avaeraging. Bob
+ * Rev Oct 2026 - AudioAnalyzeSpectrum_F32 does any size, with the work
+ * spread over the updates.  This class is kept for existing INOs.
  *
  *  Note: Teensy 4.x Only, 3.x not supported
  *
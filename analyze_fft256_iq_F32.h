@@ -3,6 +3,8 @@
  * Rev 6 Mar 2021 - Added setXAxis()
  * Rev 7 Mar 2021 - Corrected bug in applying windowing
  * Rev 10 Mar 2021 - Corrrected: dBFS offset (up 12 dB) & xAxis for dBFS
+ * Rev Oct 2026 - AudioAnalyzeSpectrum_F32 does any size, with the work
+ * spread over the updates.  This class is kept for existing INOs.
  * 
  * Does Fast Fourier Transform of a 256 point complex (I-Q) input.
  * Output is one of three measures of the power in each of the 256
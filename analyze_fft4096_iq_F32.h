@@ -1,5 +1,7 @@
 /*
  *   Analyze_fft4096_iq_F32.h    Assembled by Bob Larkin   9 Mar 2021
+ * Rev Oct 2026 - AudioAnalyzeSpectrum_F32 does any size, with the work
+ * spread over the updates.  This class is kept for existing INOs.
  *
  *  Note: Teensy 4.x Only, 3.x not supported
  *
@@ -1,5 +1,7 @@
 /*
  *   analyze_fft4096_iqem_F32.h    Assembled by Bob Larkin   18 Feb 2022
+ * Rev Oct 2026 - AudioAnalyzeSpectrum_F32 does any size, with the work
+ * spread over the updates.  This class is kept for existing INOs.
  *
  * External Memory - INO supplied memory arrays.  Windows are half width.
  *
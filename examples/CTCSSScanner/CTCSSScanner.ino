@@ -0,0 +1,141 @@
+/*
+ *  CTCSSScanner.ino  The scan mode of analyze_CTCSS_F32, that finds
+ *  which of the 50 CTCSS tones, or which DCS code, is present.
+ *
+ * The sub-audible signal is made here, a CTCSS sine wave or a DCS
+ * 134.4 bit/sec code word, and sent through an AudioPlayQueue_F32, as
+ * PlayQueue2.ino.  A 1 kHz "voice" is added and the scanner should not
+ * see it.  Every few seconds the signal changes, stepping through some
+ * tones, then some DCS codes, normal and inverted.  DCS 047 inverted is
+ * the same signal as 023 normal, and is reported as 023 N.
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+#include "Arduino.h"
+
+AudioPlayQueue_F32          queue1;
+AudioSynthWaveformSine_F32  voice;
+AudioMixer4_F32             mixer1;
+analyze_CTCSS_F32           scanner;
+AudioOutputI2S_F32          i2sOut;
+AudioConnection_F32         patchCord1(queue1, 0, mixer1, 0);
+AudioConnection_F32         patchCord2(voice,  0, mixer1, 1);
+AudioConnection_F32         patchCord3(mixer1, 0, scanner, 0);
+AudioConnection_F32         patchCord4(mixer1, 0, i2sOut, 0);
+
+// What is sent, tone number 0 to 49, or a DCS code, octal
+struct sent { int16_t tone; uint16_t dcs; bool inverted; };
+const sent sends[] = {
+  {0, 0, false}, {20, 0, false}, {26, 0, false}, {49, 0, false},
+  {-1, 023, false}, {-1, 0754, false}, {-1, 0131, true}, {-1, 047, true},
+  {-1, 0, false} };
+const int nSends = sizeof(sends)/sizeof(sent);
+int iSend = 0;
+
+float32_t samples[128];
+uint32_t dcsWord = 0;
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - CTCSS and DCS Scanner");
+  AudioMemory_F32(20);
+  queue1.setBehaviour(AudioPlayQueue_F32::NON_STALLING);
+  queue1.setMaxBuffers(4);
+  voice.frequency(1000.0f);
+  voice.amplitude(0.3f);
+  mixer1.gain(0, 1.0f);
+  mixer1.gain(1, 1.0f);
+  scanner.setScan(true);
+  newSend();
+  }
+
+void loop() {
+  static uint32_t tSend = millis();
+
+  // Keep the queue full
+  if(queue1.availableForWrite() > 0)
+    queue1.play(makeBlock(), 128);
+
+  if(scanner.availableScan())  {
+    Serial.print("Scan ");
+    if(scanner.readScanIndex() >= 0)  {
+      Serial.print(scanner.readScanFrequency(), 1);
+      Serial.print(" Hz, SNR ");
+      Serial.print(scanner.readScanSNR_dB(), 1);
+      Serial.print(" dB");
+      }
+    else
+      Serial.print("no tone");
+    Serial.print("   DCS ");
+    if(scanner.readDCS())  {
+      Serial.print(scanner.readDCS(), OCT);
+      Serial.println(scanner.readDCSInverted() ? " I" : " N");
+      }
+    else
+      Serial.println("none");
+    }
+
+  if(millis() - tSend > 3000)  {
+    tSend = millis();
+    if(++iSend >= nSends)  iSend = 0;
+    newSend();
+    }
+  }
+
+void newSend(void)  {
+  Serial.print("Sending ");
+  if(sends[iSend].tone >= 0)  {
+    Serial.print(scanner.getCTCSSFrequency(sends[iSend].tone), 1);
+    Serial.println(" Hz");
+    }
+  else if(sends[iSend].dcs)  {
+    Serial.print("DCS ");
+    Serial.print(sends[iSend].dcs, OCT);
+    Serial.println(sends[iSend].inverted ? " I" : " N");
+    dcsWord = golay(sends[iSend].dcs | 0x800);
+    if(sends[iSend].inverted)
+      dcsWord = ~dcsWord & 0x7FFFFF;
+    }
+  else
+    Serial.println("nothing");
+  }
+
+// 128 samples of the tone, or of the DCS, at a level of 0.15
+float32_t* makeBlock(void)  {
+  static float32_t phase = 0.0f;
+  static float32_t bitPhase = 0.0f;
+  static uint16_t nBit = 0;
+  for(int i=0; i<128; i++)  {
+    if(sends[iSend].tone >= 0)  {
+      samples[i] = 0.15f*sinf(phase);
+      phase += TWO_PI*scanner.getCTCSSFrequency(sends[iSend].tone)/AUDIO_SAMPLE_RATE_EXACT;
+      if(phase > TWO_PI)  phase -= TWO_PI;
+      }
+    else if(sends[iSend].dcs)  {
+      // Sent LSB first, repeating every 23 bits
+      samples[i] = ((dcsWord >> nBit) & 1) ? 0.15f : -0.15f;
+      bitPhase += 134.4f/AUDIO_SAMPLE_RATE_EXACT;
+      if(bitPhase >= 1.0f)  {
+        bitPhase -= 1.0f;
+        if(++nBit >= 23)  nBit = 0;
+        }
+      }
+    else
+      samples[i] = 0.0f;
+    }
+  return samples;
+  }
+
+// The 23 bit DCS word, the 12 bits of cw and 11 parity bits of the Golay code
+uint32_t golay(uint32_t cw)  {
+  uint32_t w = cw;
+  for(int i=0; i<12; i++)  {
+    w <<= 1;
+    if(w & 0x1000)
+      w ^= 0x08EA;
+    }
+  return cw | ((w & 0x0FFE) << 11);
+  }
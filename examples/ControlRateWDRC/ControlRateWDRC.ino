@@ -0,0 +1,72 @@
+/*
+ *  ControlRateWDRC.ino  A wide dynamic range compressor built from
+ *  AudioCalcEnvelope_F32, AudioCalcGainWDRC_F32 and AudioMathMultiply_F32,
+ *  with the envelope and the gain on control-rate connections.
+ *
+ * An AudioConnection_F32 carries a full block of 128 values, and uses a
+ * pool block for each.  The envelope and gain change slowly, so here they
+ * go on AudioControlConnection_F32 objects, 8 values per block, with no
+ * pool block.  The gain is found only at those 8 points, so there are 8
+ * log and exp per block in place of 128, and the multiply ramps the gain
+ * between them.  The audio path is the only use of the pool.
+ *
+ * The input is a 1 kHz tone that steps between -6 and -46 dBFS every
+ * second.  The gain and memory use are printed.  Set CONTROL_RATE to 0
+ * for the same graph with audio connections, to compare.
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+#define CONTROL_RATE 1
+
+AudioSynthWaveformSine_F32     sine1;
+AudioCalcEnvelope_F32          envelope1;
+AudioCalcGainWDRC_F32          gain1;
+AudioMathMultiply_F32          multiply1;
+AudioOutputI2S_F32             i2sOut;
+AudioConnection_F32            patchCord1(sine1, 0, envelope1, 0);
+AudioConnection_F32            patchCord2(sine1, 0, multiply1, 0);
+AudioConnection_F32            patchCord3(multiply1, 0, i2sOut, 0);
+AudioConnection_F32            patchCord4(sine1, 0, i2sOut, 1);
+#if CONTROL_RATE
+AudioControlConnection_F32     controlCord1(envelope1, 0, gain1, 0);
+AudioControlConnection_F32     controlCord2(gain1, 0, multiply1, 1);
+#else
+AudioConnection_F32            patchCord5(envelope1, 0, gain1, 0);
+AudioConnection_F32            patchCord6(gain1, 0, multiply1, 1);
+#endif
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - Control rate WDRC");
+  AudioMemory_F32(10);
+
+  sine1.frequency(1000.0f);
+  sine1.amplitude(0.5f);
+
+  // 5 msec attack, 50 msec release, 8 envelope values per block
+  envelope1.setAttackRelease_msec(5.0f, 50.0f);
+  envelope1.setControlPoints(8);
+
+  // maxdB, tkgain, cr, tk, bolt:  3:1 over 55 dB SPL, limit at 100 dB SPL
+  gain1.setParams(115.0f, 0.0f, 3.0f, 55.0f, 100.0f);
+  }
+
+void loop() {
+  static bool loud = true;
+  sine1.amplitude(loud ? 0.5f : 0.005f);
+  for(int i=0; i<4; i++)  {
+    delay(250);
+    Serial.print(loud ? "-6 dBFS   " : "-46 dBFS  ");
+    Serial.print("Gain ");
+    Serial.print(gain1.getCurrentGain_dB(), 1);
+    Serial.print(" dB   Blocks max ");
+    Serial.print(AudioMemoryUsageMax_F32());
+    Serial.print("   CPU max ");
+    Serial.println(AudioProcessorUsageMax(), 2);
+    }
+  loud = !loud;
+  }
@@ -0,0 +1,69 @@
+/*
+ *  CrossCorrDelay.ino  Time delay between two inputs with
+ *  AudioAnalyzeCrossCorr_F32, GCC-PHAT.
+ *
+ * White noise goes to input 0 directly, and to input 1 through a delay
+ * that steps between 0 and 1 msec.  At 44.1 kHz, 1 msec is 44.1 samples,
+ * and the delay object rounds to whole samples.  Every half second the
+ * measured delay, in samples and microseconds, and the correlation peak.
+ * With a noise added to input 1 the peak falls, but the delay holds.
+ *
+ * To follow the skew of two ADC channels, or the delay across two
+ * microphones, connect the two inputs of an AudioInputI2S_F32 in place
+ * of the noise.
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+AudioSynthNoiseWhite_F32    noise1;
+AudioSynthNoiseWhite_F32    noise2;
+AudioEffectDelay_OA_F32     delay1;
+AudioMixer4_F32             mixer1;
+AudioAnalyzeCrossCorr_F32   xcorr1;
+AudioOutputI2S_F32          i2sOut;
+AudioConnection_F32         patchCord1(noise1, 0, xcorr1, 0);
+AudioConnection_F32         patchCord2(noise1, 0, delay1, 0);
+AudioConnection_F32         patchCord3(delay1, 0, mixer1, 0);
+AudioConnection_F32         patchCord4(noise2, 0, mixer1, 1);
+AudioConnection_F32         patchCord5(mixer1, 0, xcorr1, 1);
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - Cross-correlation delay");
+  AudioMemory_F32(30);
+
+  noise1.amplitude(0.2f);
+  noise2.amplitude(0.2f);
+  mixer1.gain(0, 1.0f);
+  mixer1.gain(1, 0.0f);    // No added noise to start
+
+  // 1024 point FFT, averaged over about 8 frames, 93 msec at 44.1 kHz
+  if(xcorr1.begin(1024, 8.0f))
+    Serial.println("begin() error");
+  xcorr1.addPair(0, 1);
+  xcorr1.setMaxLag(100);
+  }
+
+void loop() {
+  static int n = 0;
+  float32_t dly_ms = 0.25f*(float32_t)(n % 5);
+
+  if((n % 5) == 0)  {
+    mixer1.gain(1, (n % 10) ? 1.0f : 0.0f);
+    Serial.println((n % 10) ? "With added noise" : "No added noise");
+    }
+  delay1.delay(0, dly_ms);
+  delay(500);
+  while(!xcorr1.available(0))  ;
+  Serial.print("Delay set ");  Serial.print(dly_ms, 2);
+  Serial.print(" msec.  Measured ");
+  Serial.print(xcorr1.readDelay(0), 2);
+  Serial.print(" samples, ");
+  Serial.print(xcorr1.readDelay_us(0), 1);
+  Serial.print(" usec, peak ");
+  Serial.println(xcorr1.readPeak(0), 3);
+  n++;
+  }
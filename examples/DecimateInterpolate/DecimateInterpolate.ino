@@ -0,0 +1,69 @@
+/*
+  DecimateInterpolate.ino  A narrow CW filter run at a quarter of the
+  sample rate, between AudioFilterDecimate_F32 and
+  AudioFilterInterpolate_F32.  A 700 Hz bandpass of 8 biquad stages at
+  11 kHz, where it takes a quarter of the time and the coefficients are
+  better conditioned than at 44 kHz.  The biquad is a multi-rate island,
+  with blocks of 128 at 11.025 kHz, so it runs once every 4 updates.
+  Oct 2026
+  Public Domain
+*/
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+#include <Audio.h>
+
+const float sample_rate_Hz = 44100.0f;
+const int   audio_block_samples = 128;
+AudioSettings_F32 audio_settings(sample_rate_Hz, audio_block_samples);
+// For the objects between decimate1 and interpolate1
+AudioSettings_F32 island_settings(sample_rate_Hz/4.0f, 128);
+
+AudioInputI2S_F32          audioInI2S1(audio_settings);
+AudioFilterDecimate_F32    decimate1(audio_settings);
+AudioFilterBiquad_F32      biquad1(island_settings);
+AudioFilterInterpolate_F32 interpolate1(audio_settings);
+AudioOutputI2S_F32         audioOutI2S1(audio_settings);
+AudioConnection_F32        patchCord1(audioInI2S1, 0, decimate1, 0);
+AudioConnection_F32        patchCord2(decimate1, 0, biquad1, 0);
+AudioConnection_F32        patchCord3(biquad1, 0, interpolate1, 0);
+AudioConnection_F32        patchCord4(interpolate1, 0, audioOutI2S1, 0);
+AudioConnection_F32        patchCord5(interpolate1, 0, audioOutI2S1, 1);
+AudioControlSGTL5000       sgtl5000_1;
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - DecimateInterpolate");
+
+  AudioMemory(10);
+  AudioMemory_F32(30, audio_settings);
+
+  sgtl5000_1.enable();
+  sgtl5000_1.inputSelect(AUDIO_INPUT_LINEIN);
+  sgtl5000_1.volume(0.5);
+
+  // Pass band to 3 kHz, 80 dB.  Both ends the same.  Leave out the
+  // two set's for blocks of 32 every update.
+  decimate1.setOutputBlock(128);
+  interpolate1.setInputBlock(128);
+  uint16_t err = decimate1.begin(4, 3000.0f, 80.0f);
+  err |= interpolate1.begin(4, 3000.0f, 80.0f);
+  Serial.print("begin: ");  Serial.println(err);
+  for(int i=0; i<decimate1.getNumStages(); i++)  {
+    Serial.print("Stage ");  Serial.print(i);
+    Serial.print(" taps ");  Serial.println(decimate1.getStageTaps(i));
+    }
+  Serial.print("Latency, samples at 44.1 kHz: ");
+  Serial.println(decimate1.getLatencySamples() + interpolate1.getLatencySamples());
+
+  for(int i=0; i<8; i++)
+    biquad1.setBandpass(i, 700.0f, 8.0f);
+  biquad1.begin();
+  }
+
+void loop() {
+  Serial.print("CPU: ");
+  Serial.print(AudioProcessorUsage());
+  Serial.println("%");
+  delay(2000);
+  }
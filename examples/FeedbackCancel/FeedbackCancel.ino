@@ -0,0 +1,68 @@
+/*
+ * FeedbackCancel.ino
+ *
+ * Microphone on the left line input, receiver on the left output, with
+ * gain between, as a bare hearing aid.  AudioEffectFeedbackCancel_F32
+ * removes the receiver sound picked up by the microphone.  The gain
+ * starts low and is raised with '+' on the serial monitor, 3 dB at a
+ * time, so that the canceller converges as the gain goes up.  '-' lowers
+ * the gain, 'f' turns the canceller off and 'n' back on.  Keep the volume
+ * low when trying this!
+ *
+ * The bulk delay, 128 samples here, should be a little less than the
+ * receiver to microphone delay, as seen by the canceller.  That is the
+ * I2S output and input buffering, the one block of the connection back to
+ * In 1, and the codec delays.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+const float sample_rate_Hz = 44100.0f;
+const int   audio_block_samples = 128;
+AudioSettings_F32 audio_settings(sample_rate_Hz, audio_block_samples);
+
+AudioInputI2S_F32              audioInI2S(audio_settings);
+AudioEffectFeedbackCancel_F32  feedbackCancel(audio_settings);
+AudioEffectGain_F32            gain1(audio_settings);
+AudioOutputI2S_F32             audioOutI2S(audio_settings);
+AudioConnection_F32            patchCord1(audioInI2S, 0, feedbackCancel, 0);
+AudioConnection_F32            patchCord2(feedbackCancel, 0, gain1, 0);
+AudioConnection_F32            patchCord3(gain1, 0, audioOutI2S, 0);
+AudioConnection_F32            patchCord4(gain1, 0, feedbackCancel, 1);  // Reference
+AudioControlSGTL5000           sgtl5000_1;
+
+float gainDB = 0.0f;
+
+void setup() {
+  Serial.begin(300); delay(1000);
+  Serial.println("###  FeedbackCancel  ###");
+  AudioMemory_F32(20, audio_settings);
+  sgtl5000_1.enable();
+  sgtl5000_1.inputSelect(AUDIO_INPUT_LINEIN);
+
+  feedbackCancel.initialize(128, 128, FBC_TIME, 0);
+  feedbackCancel.setMu(0.005f);
+  feedbackCancel.setPredictorOrder(16);
+  feedbackCancel.enable(true);
+  gain1.setGain_dB(gainDB);
+  Serial.println("'+' and '-' change the gain, 'f' canceller off, 'n' on");
+}
+
+void loop() {
+  if (Serial.available()) {
+    char c = Serial.read();
+    if (c=='+')       gainDB += 3.0f;
+    else if (c=='-')  gainDB -= 3.0f;
+    else if (c=='f')  feedbackCancel.enable(false);
+    else if (c=='n')  feedbackCancel.enable(true);
+    else return;
+    gain1.setGain_dB(gainDB);
+    Serial.print("Gain, dB = ");
+    Serial.print(gainDB);
+    Serial.print("   CPU % = ");
+    Serial.println(AudioProcessorUsageMax());
+  }
+}
@@ -47,6 +47,8 @@ void setup(void) {
   // hilbert1.begin(hilbert19A, 19);
   hilbert1.begin(hilbert121A, 121);
   // hilbert1.begin(hilbert251A, 251);
+  // Or the IIR, 0.5 degree from 200 Hz, in 6 multiplies per sample
+  // hilbert1.beginIIR(200.0f, 0.5f);
   sum1.gain(0, 1.0);   // Leave at 1.0
   sum1.gain(1, -1.0);  // -1 for LSB out
   iqmixer1.showError(1);   // Prints update() errors
@@ -0,0 +1,81 @@
+/*
+ * SDRecorder.ino
+ *
+ * Record the two I2S inputs to a float WAV file on the built-in SD card
+ * of a T4.1.  The ring buffer is in PSRAM.  Send 'r' on the serial
+ * monitor to start recording, and 's' to stop.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+#include <SD.h>
+
+const float sample_rate_Hz = 48000.0f;
+const int   audio_block_samples = 128;
+AudioSettings_F32 audio_settings(sample_rate_Hz, audio_block_samples);
+
+AudioInputI2S_F32        audioInI2S(audio_settings);
+AudioSDRecorder_F32      recordSdWav(audio_settings);
+AudioOutputI2S_F32       audioOutI2S(audio_settings);
+AudioConnection_F32      patchCord1(audioInI2S, 0, recordSdWav, 0);
+AudioConnection_F32      patchCord2(audioInI2S, 1, recordSdWav, 1);
+AudioConnection_F32      patchCord3(audioInI2S, 0, audioOutI2S, 0);
+AudioConnection_F32      patchCord4(audioInI2S, 1, audioOutI2S, 1);
+AudioControlSGTL5000     sgtl5000_1;
+
+// 2 MB ring buffer in PSRAM is over 5 seconds for stereo float at 48 kHz
+EXTMEM uint8_t ringBuffer[2*1024*1024];
+
+uint32_t tPrint = 0;
+
+void setup() {
+  Serial.begin(300); delay(1000);
+  Serial.println("###  SDRecorder  ###");
+  AudioMemory_F32(20, audio_settings);
+  sgtl5000_1.enable();
+  sgtl5000_1.inputSelect(AUDIO_INPUT_LINEIN);
+
+  if (!(SD.begin(BUILTIN_SDCARD))) {
+    while (1) {
+      Serial.println("*** Unable to access the SD card  ***");
+      delay(1000);
+    }
+  }
+  recordSdWav.setBuffer(ringBuffer, sizeof(ringBuffer));
+  recordSdWav.setNumChannels(2);
+  recordSdWav.setFormat(SDREC_FLOAT32);
+  Serial.println("Send 'r' to record, 's' to stop.");
+}
+
+void loop() {
+  // Move data from the ring buffer to the SD card
+  recordSdWav.service();
+
+  if (Serial.available()) {
+    char c = Serial.read();
+    if (c=='r' && !recordSdWav.isRecording()) {
+      // Pre-allocate 10 minutes of stereo float
+      if (recordSdWav.record("REC1.WAV", 10ULL*60ULL*48000ULL*2ULL*4ULL))
+        Serial.println("Recording REC1.WAV");
+      else
+        Serial.println("Could not open REC1.WAV");
+    }
+    else if (c=='s' && recordSdWav.isRecording()) {
+      recordSdWav.stop();
+      Serial.print("Stopped.  Bytes = ");
+      Serial.println((uint32_t)recordSdWav.getBytesWritten());
+    }
+  }
+
+  if (recordSdWav.isRecording() && millis()-tPrint > 2000) {
+    tPrint = millis();
+    Serial.print("Frames = ");
+    Serial.print((uint32_t)recordSdWav.getFramesRecorded());
+    Serial.print("  Max buffer used = ");
+    Serial.print(recordSdWav.getBufferMaxUsed());
+    Serial.print("  Overruns = ");
+    Serial.println(recordSdWav.getOverrunCount());
+  }
+}
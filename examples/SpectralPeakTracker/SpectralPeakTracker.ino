@@ -0,0 +1,85 @@
+/*
+ *  SpectralPeakTracker.ino  Frequency, amplitude and SNR of the peaks
+ *  of a spectrum, from AudioAnalyzeSpectralPeaks_F32.
+ *
+ * Two sine waves and a little noise.  One is fixed at a random frequency
+ * from 300 to 3000 Hz, as FFTFrequencyMeter, and the other sweeps slowly
+ * from 4 to 6 kHz and back.  A 1024 point spectrum with the Hann window
+ * gives 43 Hz bins, and the peaks are interpolated to a small fraction of
+ * that.  Each track keeps its id as the swept tone moves.  All the search
+ * and interpolation is done in update(), so loop() only reads.
+ *
+ * Compare with FFTFrequencyMeter, that does the search in loop().
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+AudioSynthWaveformSine_F32     sine1;
+AudioSynthWaveformSine_F32     sine2;
+AudioSynthNoiseWhite_F32       noise1;
+AudioMixer4_F32                mixer1;
+AudioAnalyzeSpectralPeaks_F32  peaks1;
+AudioOutputI2S_F32             i2sOut;
+AudioConnection_F32            patchCord1(sine1,  0, mixer1, 0);
+AudioConnection_F32            patchCord2(sine2,  0, mixer1, 1);
+AudioConnection_F32            patchCord3(noise1, 0, mixer1, 2);
+AudioConnection_F32            patchCord4(mixer1, 0, peaks1, 0);
+
+float32_t f1 = 1000.0f;
+float32_t f2 = 4000.0f;
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - Spectral peak tracker");
+  AudioMemory_F32(20);
+
+  sine1.amplitude(0.5f);
+  sine2.amplitude(0.05f);
+  noise1.amplitude(0.001f);
+  sine1.frequency(f1);
+  sine2.frequency(f2);
+
+  if(peaks1.begin(1024))
+    Serial.println("begin() error");
+  peaks1.windowFunction(SPECTRUM_WINDOW_HANN);
+  peaks1.setNAverage(4);
+  peaks1.beginPeaks(4);
+  peaks1.setThresholds(15.0f, 10.0f);
+  peaks1.setTracking(100.0f, 2, 3);   // Up to 100 Hz move per spectrum
+  }
+
+void loop() {
+  static int n = 0;
+  static float32_t df2 = 5.0f;
+  AudioAnalyzeSpectralPeaks_F32::peak pk[4];
+
+  delay(100);
+  f2 += df2;
+  if(f2 > 6000.0f || f2 < 4000.0f)
+    df2 = -df2;
+  sine2.frequency(f2);
+
+  if(++n < 10)
+    return;
+  n = 0;
+  uint16_t nPk = peaks1.readPeaks(pk, 4);
+  Serial.print("Set ");  Serial.print(f1, 3);
+  Serial.print(" and ");  Serial.print(f2, 3);
+  Serial.print(" Hz, noise ");  Serial.println(peaks1.readNoise(), 6);
+  for(int i=0; i<nPk; i++)  {
+    Serial.print("  id ");  Serial.print(pk[i].id);
+    Serial.print("  ");  Serial.print(pk[i].frequency, 3);
+    Serial.print(" Hz  amp ");  Serial.print(pk[i].amplitude, 4);
+    Serial.print("  SNR ");  Serial.print(pk[i].snr_dB, 1);
+    Serial.println(" dB");
+    }
+
+  // A new fixed frequency, now and then
+  if(random(5) == 0)  {
+    f1 = 300.0f + 0.01f*(float32_t)random(270000);
+    sine1.frequency(f1);
+    }
+  }
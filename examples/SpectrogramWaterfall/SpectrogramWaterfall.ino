@@ -0,0 +1,99 @@
+/*
+ *  SpectrogramWaterfall.ino  Waterfall frames from
+ *  AudioAnalyzeSpectrogram_F32, sent over USB serial.
+ *
+ * A sine wave sweeps from 300 Hz to 8 kHz and back, with a little white
+ * noise.  Each 1024 point spectrum, 512 bins, is reduced to 128 columns of
+ * one byte, -100 to 0 dBFS, and the frames go to a ring of 16.  As set,
+ * SEND_TEXT 1, a coarse text waterfall goes to the Serial Monitor.  With
+ * SEND_TEXT 0 the loop sends each frame as a header byte 0xFF, the 4 byte
+ * sequence number and the 128 bytes, with 0xFF in the data changed to
+ * 0xFE, for a program on the PC to draw.  A frame is 133 bytes, where the
+ * 512 floats would be 2048.  peekFrame() is read in place, and the slot
+ * is not reused until releaseFrame().
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+#define SEND_TEXT 1
+#define WIDTH 128
+
+AudioSynthWaveformSine_F32   sine1;
+AudioSynthNoiseWhite_F32     noise1;
+AudioMixer4_F32              mixer1;
+AudioAnalyzeSpectrogram_F32  spectro1;
+AudioOutputI2S_F32           i2sOut;
+AudioConnection_F32          patchCord1(sine1,  0, mixer1, 0);
+AudioConnection_F32          patchCord2(noise1, 0, mixer1, 1);
+AudioConnection_F32          patchCord3(mixer1, 0, spectro1, 0);
+
+uint32_t lastSeq = 0;
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  if(SEND_TEXT)
+    Serial.println("OpenAudio_ArduinoLibrary - Spectrogram waterfall");
+  AudioMemory_F32(20);
+
+  sine1.amplitude(0.3f);
+  noise1.amplitude(0.001f);
+  mixer1.gain(0, 1.0f);
+  mixer1.gain(1, 1.0f);
+
+  if(spectro1.begin(1024))
+    Serial.println("begin() error");
+  spectro1.windowFunction(SPECTRUM_WINDOW_BLACKMAN_HARRIS);
+  spectro1.setNAverage(4);        // About 20 frames per second at 44.1 kHz
+  if(spectro1.beginFrames(WIDTH, 16))
+    Serial.println("beginFrames() error");
+  spectro1.setRange(-100.0f, 0.0f);
+  spectro1.setPooling(SPECTROGRAM_POOL_MAX);
+  }
+
+void loop() {
+  static float32_t f = 300.0f;
+  static float32_t df = 1.02f;
+  static uint32_t tSweep = 0;
+  const char shades[] = " .:-=+*#%@";
+  uint32_t seq;
+
+  if(millis() - tSweep > 20)  {
+    tSweep = millis();
+    f *= df;
+    if(f > 8000.0f || f < 300.0f)
+      df = 1.0f/df;
+    sine1.frequency(f);
+    }
+
+  const uint8_t *pFrame = spectro1.peekFrame(&seq);
+  if(pFrame == NULL)
+    return;
+  if(seq != lastSeq + 1 && seq != 0 && SEND_TEXT)  {
+    Serial.print("Dropped ");
+    Serial.println(seq - lastSeq - 1);
+    }
+  lastSeq = seq;
+
+  if(SEND_TEXT)  {
+    // Every fourth frame, two columns per character
+    if((seq & 3) == 0)  {
+      for(int c=0; c<WIDTH; c+=2)  {
+        uint8_t q = pFrame[c] > pFrame[c+1] ? pFrame[c] : pFrame[c+1];
+        Serial.print(shades[q/26]);
+        }
+      Serial.println();
+      }
+    }
+  else  {
+    uint8_t buf[WIDTH + 5];
+    buf[0] = 0xFF;
+    memcpy(buf + 1, &seq, 4);
+    for(int c=0; c<WIDTH; c++)
+      buf[c + 5] = pFrame[c]==0xFF ? 0xFE : pFrame[c];
+    Serial.write(buf, WIDTH + 5);
+    }
+  spectro1.releaseFrame();
+  }
@@ -0,0 +1,66 @@
+// TestSpectrum.ino  for Teensy 3.x, 4.x
+// Oct 2026
+
+// Generate a Sin and Cosine pair and input to AudioAnalyzeSpectrum_F32, as
+// a 2048 point I-Q FFT with 75% overlap.  Serial print out the powers of
+// all 2048 bins in dB relative to Sine Wave Full Scale.  Then the most
+// time taken by an update(), that stays low as the FFT work is spread
+// over the updates.
+
+// Public Domain
+
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+// GUItool: begin automatically generated code
+AudioSynthSineCosine_F32   sine_cos1;       //xy=76,532
+AudioAnalyzeSpectrum_F32   spectrum1;       //xy=243,532
+AudioOutputI2S_F32         audioOutI2S1;    //xy=246,591
+AudioConnection_F32        patchCord1(sine_cos1, 0, spectrum1, 0);
+AudioConnection_F32        patchCord2(sine_cos1, 1, spectrum1, 1);
+// GUItool: end automatically generated code
+
+void setup(void) {
+  float* pPwr;
+
+  Serial.begin(9600);
+  delay(1000);
+  AudioMemory_F32(20);
+  Serial.println("Spectrum Test");
+
+  // N=2048, I-Q, 0.75 overlap.  For real input use begin(2048) with
+  // just In 0, for 1024 bins.
+  if(spectrum1.begin(2048, true, 0.75f))
+    Serial.println("Spectrum begin() failed");
+
+  sine_cos1.amplitude(1.0f); // Initialize Waveform Generator
+  sine_cos1.frequency(30.0f*spectrum1.getBinHz());  // A bin center
+
+  spectrum1.setOutputType(FFT_DBFS);
+  spectrum1.windowFunction(SPECTRUM_WINDOW_BLACKMAN_HARRIS);
+  //spectrum1.windowFunction(SPECTRUM_WINDOW_KAISER, 70.0f);
+
+  // Exponential average, 1/4 of each new FFT
+  spectrum1.setAverageMode(SPECTRUM_AVE_EXP);
+  spectrum1.setNAverage(4);
+
+  // xAxis, bit 0 left/right;  bit 1 low to high;  default 0X03
+  spectrum1.setXAxis(0X02);
+
+  delay(1000);
+  // Print output, once
+  if( spectrum1.available() )  {
+      pPwr = spectrum1.getData();
+      for(int i=0; i<spectrum1.getNBins(); i++)
+        Serial.println(*(pPwr + i), 8 );
+      }
+  Serial.println("");
+  }
+
+void loop(void)  {
+  // Percent of the time for one block.  Try setSpread(false) to compare.
+  Serial.print("Spectrum update() max, percent = ");
+  Serial.println(spectrum1.processorUsageMax(), 2);
+  spectrum1.processorUsageMaxReset();
+  delay(1000);
+  }
@@ -0,0 +1,65 @@
+/* TestStats.ino  AudioAnalyzeStats_F32 on three inputs
+ *
+ * A sine wave, a square wave with DC added, and a pink noise, all into
+ * one AudioAnalyzeStats_F32.  Every second, for each input, the peak, RMS,
+ * DC and crest factor over the short (400 msec) window, and the loudness,
+ * Momentary and Short-term, over all three.  The sine wave has crest
+ * 1.414 and the square wave 1.0 about its DC.  A full scale 1 kHz sine
+ * wave alone would read -3.01 LUFS.
+ *
+ * Oct 2026    Public Domain
+ */
+
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+AudioSynthWaveformSine_F32  sine1;
+AudioSynthWaveform_F32      square1;
+AudioSynthNoisePink_F32     pink1;
+AudioMathOffset_F32         offset1;
+AudioAnalyzeStats_F32       stats1(3);
+AudioOutputI2S_F32          i2sOut;
+AudioConnection_F32         patchCord1(sine1,   0, stats1, 0);
+AudioConnection_F32         patchCord2(square1, 0, offset1, 0);
+AudioConnection_F32         patchCord3(offset1, 0, stats1, 1);
+AudioConnection_F32         patchCord4(pink1,   0, stats1, 2);
+
+void setup(void) {
+  Serial.begin(300);  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - AudioAnalyzeStats_F32");
+  AudioMemory_F32(10);
+
+  sine1.frequency(1000.0f);
+  sine1.amplitude(0.5f);
+  square1.begin(AudioSynthWaveform_F32::OSCILLATOR_MODE_SQUARE);
+  square1.frequency(200.0f);
+  square1.amplitude(0.25f);
+  offset1.setOffset(0.1f);
+  pink1.amplitude(0.2f);
+
+  if(!stats1.begin(400.0f, 3000.0f))
+    Serial.println("Stats begin() out of memory");
+  Serial.print("Windows, msec: ");
+  Serial.print(stats1.getWindow_ms(false), 1);
+  Serial.print(", ");
+  Serial.println(stats1.getWindow_ms(true), 1);
+  }
+
+void loop(void) {
+  AudioAnalyzeStats_F32::stats s;
+
+  delay(1000);
+  for(int ch=0; ch<3; ch++)  {
+    stats1.readStats(ch, false, &s);
+    Serial.print("In ");      Serial.print(ch);
+    Serial.print("  Peak ");  Serial.print(s.peak, 4);
+    Serial.print("  RMS ");   Serial.print(s.rms, 4);
+    Serial.print("  DC ");    Serial.print(s.dc, 4);
+    Serial.print("  Crest "); Serial.println(s.crest, 3);
+    }
+  Serial.print("Loudness, LUFS, Momentary ");
+  Serial.print(stats1.readLoudness(false), 2);
+  Serial.print("  Short-term ");
+  Serial.println(stats1.readLoudness(true), 2);
+  Serial.println();
+  }
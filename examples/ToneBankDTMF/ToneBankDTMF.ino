@@ -0,0 +1,109 @@
+/*
+ *  ToneBankDTMF.ino  DTMF decoding with one AudioAnalyzeToneBank_F32
+ *  in place of eight AudioAnalyzeToneDetect_F32.
+ *
+ * Two sine waves make each DTMF digit in turn, one from the low group of
+ * 697 to 941 Hz, and one from the high group of 1209 to 1633 Hz.  The
+ * bank measures all 8 tones over 40 msec, and the digit is the strongest
+ * of each group, if both are over the threshold.
+ *
+ * The second part scans the 50 CTCSS tones with the same class,
+ * decimated by 64 first, 300 msec measurements.  See also analyze_CTCSS_F32
+ * for a single tone with a reference band.
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+AudioSynthWaveformSine_F32  sineLow;
+AudioSynthWaveformSine_F32  sineHigh;
+AudioMixer4_F32             mixer1;
+AudioAnalyzeToneBank_F32    dtmfBank;
+AudioAnalyzeToneBank_F32    ctcssBank;
+AudioOutputI2S_F32          audioOutI2S1;
+AudioConnection_F32         patchCord1(sineLow,  0, mixer1, 0);
+AudioConnection_F32         patchCord2(sineHigh, 0, mixer1, 1);
+AudioConnection_F32         patchCord3(mixer1,   0, dtmfBank, 0);
+AudioConnection_F32         patchCord4(mixer1,   0, ctcssBank, 0);
+
+const float dtmfLow[4]  = { 697.0f,  770.0f,  852.0f,  941.0f};
+const float dtmfHigh[4] = {1209.0f, 1336.0f, 1477.0f, 1633.0f};
+const char  dtmfKeys[4][5] = {"123A", "456B", "789C", "*0#D"};
+
+const float ctcss[50] = {
+  67.0f,  69.3f,  71.9f,  74.4f,  77.0f,  79.7f,  82.5f,  85.4f,  88.5f,  91.5f,
+  94.8f,  97.4f, 100.0f, 103.5f, 107.2f, 110.9f, 114.8f, 118.8f, 123.0f, 127.3f,
+ 131.8f, 136.5f, 141.3f, 146.2f, 151.4f, 156.7f, 159.8f, 162.2f, 165.5f, 167.9f,
+ 171.3f, 173.8f, 177.3f, 179.9f, 183.5f, 186.2f, 189.9f, 192.8f, 196.6f, 199.5f,
+ 203.5f, 206.5f, 210.7f, 218.1f, 225.7f, 229.1f, 233.6f, 241.8f, 250.3f, 254.1f};
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - ToneBank DTMF and CTCSS");
+  AudioMemory_F32(20);
+
+  // Tones 0 to 3 are the low group, 4 to 7 the high
+  dtmfBank.begin();
+  for(int i=0; i<4; i++)
+    dtmfBank.addTone(dtmfLow[i], 40.0f, 0.1f);
+  for(int i=0; i<4; i++)
+    dtmfBank.addTone(dtmfHigh[i], 40.0f, 0.1f);
+
+  ctcssBank.begin(64);
+  for(int i=0; i<50; i++)
+    ctcssBank.addTone(ctcss[i], 300.0f, 0.02f);
+
+  mixer1.gain(0, 0.4f);
+  mixer1.gain(1, 0.4f);
+  sineLow.amplitude(1.0f);
+  sineHigh.amplitude(1.0f);
+  }
+
+void loop() {
+  static int row = 0, col = 0;
+
+  sineLow.frequency(dtmfLow[row]);
+  sineHigh.frequency(dtmfHigh[col]);
+  delay(100);      // Two 40 msec measurements, to flush the last digit
+  Serial.print("Sent ");  Serial.print(dtmfKeys[row][col]);
+  Serial.print("  Decoded ");  Serial.println(decodeDTMF());
+  if(++col >= 4)  {
+    col = 0;
+    if(++row >= 4)  {
+      row = 0;
+      scanCTCSS();
+      }
+    }
+  }
+
+// The strongest tone of each group, or '-' if not both present
+char decodeDTMF(void)  {
+  int iLow = 0, iHigh = 4;
+  for(int i=1; i<4; i++)  {
+    if(dtmfBank.read(i) > dtmfBank.read(iLow))       iLow = i;
+    if(dtmfBank.read(i+4) > dtmfBank.read(iHigh))    iHigh = i + 4;
+    }
+  if(dtmfBank.present(iLow) && dtmfBank.present(iHigh))
+    return dtmfKeys[iLow][iHigh - 4];
+  return '-';
+  }
+
+// A low level sub-audible tone, 131.8 Hz, and the strongest of the 50
+void scanCTCSS(void)  {
+  sineLow.frequency(131.8f);
+  sineHigh.amplitude(0.0f);
+  mixer1.gain(0, 0.1f);
+  delay(700);
+  int iBest = 0;
+  for(int i=1; i<50; i++)
+    if(ctcssBank.read(i) > ctcssBank.read(iBest))
+      iBest = i;
+  Serial.print("CTCSS sent 131.8 Hz, found ");
+  Serial.print(ctcssBank.getFrequency(iBest), 1);
+  Serial.print(" Hz at level ");
+  Serial.println(ctcssBank.read(iBest), 4);
+  mixer1.gain(0, 0.4f);
+  sineHigh.amplitude(1.0f);
+  }
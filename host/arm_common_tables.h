@@ -0,0 +1,14 @@
+/*
+ * arm_common_tables.h  -  Host version.  See arm_math.h in this directory.
+ *
+ * The library includes this but uses none of the CMSIS tables directly.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef _ARM_COMMON_TABLES_H
+#define _ARM_COMMON_TABLES_H
+
+#include "arm_math.h"
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * arm_math.h  -  Portable (host) version of the CMSIS-DSP subset used by
+ * OpenAudio_ArduinoLibrary.
+ *
+ * This is NOT used for Teensy builds.  The Teensy core supplies the real
+ * CMSIS-DSP arm_math.h and the Arduino IDE never looks in this host
+ * directory.  For a Linux x86 or Raspberry Pi (Cortex-A) build, put this
+ * directory first on the include path (-Ihost) and compile
+ * arm_math_host.cpp.  See readme.md in this directory.
+ *
+ * The names, instance structures and argument order are those of CMSIS-DSP,
+ * so library sources compile unchanged.  Only the functions the library
+ * calls are here.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARM_MATH_HOST 1
+
+typedef float   float32_t;
+typedef double  float64_t;
+typedef int8_t  q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+#ifndef PI
+#define PI 3.14159265358979f
+#endif
+
+typedef enum
+{
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+    ARM_MATH_LENGTH_ERROR = -2,
+    ARM_MATH_SIZE_MISMATCH = -3,
+    ARM_MATH_NANINF = -4,
+    ARM_MATH_SINGULAR = -5,
+    ARM_MATH_TEST_FAILURE = -6
+} arm_status;
+
+// ---------------------------------------------------------- Instances
+typedef struct
+{
+    uint16_t numTaps;
+    float32_t *pState;         // numTaps+blockSize-1
+    const float32_t *pCoeffs;  // Time reversed
+} arm_fir_instance_f32;
+
+typedef struct
+{
+    uint8_t M;                 // Decimation factor
+    uint16_t numTaps;
+    const float32_t *pCoeffs;
+    float32_t *pState;         // numTaps+blockSize-1
+} arm_fir_decimate_instance_f32;
+
+typedef struct
+{
+    uint8_t L;                 // Interpolation factor
+    uint16_t phaseLength;      // numTaps/L
+    const float32_t *pCoeffs;
+    float32_t *pState;         // phaseLength+blockSize-1
+} arm_fir_interpolate_instance_f32;
+
+typedef struct
+{
+    uint32_t numStages;
+    float32_t *pState;         // 4 per stage, x[n-1], x[n-2], y[n-1], y[n-2]
+    const float32_t *pCoeffs;  // 5 per stage, b0, b1, b2, a1, a2
+} arm_biquad_casd_df1_inst_f32;
+
+typedef struct
+{
+    uint8_t numStages;
+    float32_t *pState;         // 2 per stage
+    const float32_t *pCoeffs;  // 5 per stage, b0, b1, b2, a1, a2
+} arm_biquad_cascade_df2T_instance_f32;
+
+typedef struct
+{
+    uint16_t fftLen;
+    const float32_t *pTwiddle;       // Not used by the host version
+    const uint16_t *pBitRevTable;    // Not used by the host version
+    uint16_t bitRevLength;
+} arm_cfft_instance_f32;
+
+typedef struct
+{
+    uint16_t fftLen;
+    uint8_t ifftFlag;
+    uint8_t bitReverseFlag;
+    float32_t *pTwiddle;
+    uint16_t *pBitRevTable;
+    uint16_t twidCoefModifier;
+    uint16_t bitRevFactor;
+    float32_t onebyfftLen;
+} arm_cfft_radix2_instance_f32;
+
+typedef arm_cfft_radix2_instance_f32 arm_cfft_radix4_instance_f32;
+
+// ---------------------------------------------------------- Vectors
+void arm_add_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize);
+void arm_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize);
+void arm_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize);
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *result);
+void arm_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+void arm_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+void arm_min_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+void arm_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize);
+float32_t arm_sin_f32(float32_t x);
+float32_t arm_cos_f32(float32_t x);
+
+static inline arm_status arm_sqrt_f32(float32_t in, float32_t *pOut) {
+    if (in >= 0.0f) {
+        *pOut = sqrtf(in);
+        return ARM_MATH_SUCCESS;
+    }
+    *pOut = 0.0f;
+    return ARM_MATH_ARGUMENT_ERROR;
+}
+
+// ---------------------------------------------------------- Complex
+void arm_cmplx_mult_cmplx_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t numSamples);
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+
+// ---------------------------------------------------------- Filters
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs,
+                      float32_t *pState, uint32_t blockSize);
+void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+arm_status arm_fir_decimate_init_f32(arm_fir_decimate_instance_f32 *S, uint16_t numTaps, uint8_t M,
+                      const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize);
+void arm_fir_decimate_f32(const arm_fir_decimate_instance_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize);
+
+arm_status arm_fir_interpolate_init_f32(arm_fir_interpolate_instance_f32 *S, uint8_t L, uint16_t numTaps,
+                      const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize);
+void arm_fir_interpolate_f32(const arm_fir_interpolate_instance_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize);
+
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages,
+                      const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize);
+
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages,
+                      const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize);
+
+// ---------------------------------------------------------- FFT
+// Complex, interleaved re/im, in place.  Inverse is scaled by 1/fftLen, as CMSIS.
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag);
+
+arm_status arm_cfft_radix2_init_f32(arm_cfft_radix2_instance_f32 *S, uint16_t fftLen,
+                      uint8_t ifftFlag, uint8_t bitReverseFlag);
+void arm_cfft_radix2_f32(const arm_cfft_radix2_instance_f32 *S, float32_t *pSrc);
+arm_status arm_cfft_radix4_init_f32(arm_cfft_radix4_instance_f32 *S, uint16_t fftLen,
+                      uint8_t ifftFlag, uint8_t bitReverseFlag);
+void arm_cfft_radix4_f32(const arm_cfft_radix4_instance_f32 *S, float32_t *pSrc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
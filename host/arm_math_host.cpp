@@ -0,0 +1,443 @@
+/*
+ * arm_math_host.cpp  -  Portable (host) versions of the CMSIS-DSP functions
+ * used by OpenAudio_ArduinoLibrary.  See arm_math.h and readme.md in this
+ * directory.
+ *
+ * The loops are arranged so that a compiler can vectorize them for AVX2,
+ * AVX-512 or NEON (-O3 and -march=native or -mcpu=native) without changing
+ * the order that any one output is summed.  For the FIR filters this means
+ * the tap loop is outside and the sample loop is inside, so each output is
+ * still b[0]*x + b[1]*x + ... in the CMSIS order.  Compiled with
+ * -ffp-contract=off, the filter, vector and complex multiply results are
+ * then the same, bit for bit, as the CMSIS-DSP reference C code without
+ * fused multiply-add.  The FFT, sin and cos are accurate but are not the
+ * CMSIS algorithms and so differ in the last bits.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "arm_math.h"
+#include "arm_const_structs.h"
+
+// ---------------------------------------------------------- Vectors
+
+void arm_add_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = pSrcA[i] + pSrcB[i];
+}
+
+void arm_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = pSrcA[i] - pSrcB[i];
+}
+
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = pSrcA[i] * pSrcB[i];
+}
+
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = pSrc[i] * scale;
+}
+
+void arm_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = pSrc[i] + offset;
+}
+
+void arm_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = fabsf(pSrc[i]);
+}
+
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = value;
+}
+
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+    memmove(pDst, pSrc, blockSize*sizeof(float32_t));
+}
+
+// Sums are sequential, as the CMSIS reference.  These do not vectorize
+// unless -ffast-math is used, which gives up the bit accuracy.
+void arm_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *result) {
+    float32_t sum = 0.0f;
+    for (uint32_t i = 0; i < blockSize; i++)
+        sum += pSrcA[i] * pSrcB[i];
+    *result = sum;
+}
+
+void arm_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult) {
+    float32_t sum = 0.0f;
+    for (uint32_t i = 0; i < blockSize; i++)
+        sum += pSrc[i] * pSrc[i];
+    arm_sqrt_f32(sum / (float32_t)blockSize, pResult);
+}
+
+void arm_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult) {
+    float32_t sum = 0.0f;
+    for (uint32_t i = 0; i < blockSize; i++)
+        sum += pSrc[i];
+    *pResult = sum / (float32_t)blockSize;
+}
+
+// First occurrence, as CMSIS
+void arm_min_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex) {
+    float32_t out = pSrc[0];
+    uint32_t index = 0;
+    for (uint32_t i = 1; i < blockSize; i++) {
+        if (pSrc[i] < out) {
+            out = pSrc[i];
+            index = i;
+        }
+    }
+    *pResult = out;
+    *pIndex = index;
+}
+
+void arm_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex) {
+    float32_t out = pSrc[0];
+    uint32_t index = 0;
+    for (uint32_t i = 1; i < blockSize; i++) {
+        if (pSrc[i] > out) {
+            out = pSrc[i];
+            index = i;
+        }
+    }
+    *pResult = out;
+    *pIndex = index;
+}
+
+// Truncation and saturation as CMSIS without ARM_MATH_ROUNDING
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++) {
+        q31_t v = (q31_t)(pSrc[i] * 32768.0f);
+        if (v > 32767)  v = 32767;
+        if (v < -32768) v = -32768;
+        pDst[i] = (q15_t)v;
+    }
+}
+
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+    for (uint32_t i = 0; i < blockSize; i++)
+        pDst[i] = (float32_t)pSrc[i] / 32768.0f;
+}
+
+float32_t arm_sin_f32(float32_t x) { return sinf(x); }
+float32_t arm_cos_f32(float32_t x) { return cosf(x); }
+
+// ---------------------------------------------------------- Complex
+
+void arm_cmplx_mult_cmplx_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t numSamples) {
+    for (uint32_t i = 0; i < numSamples; i++) {
+        float32_t a = pSrcA[2*i];
+        float32_t b = pSrcA[2*i + 1];
+        float32_t c = pSrcB[2*i];
+        float32_t d = pSrcB[2*i + 1];
+        pDst[2*i]     = a*c - b*d;
+        pDst[2*i + 1] = a*d + b*c;
+    }
+}
+
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples) {
+    for (uint32_t i = 0; i < numSamples; i++) {
+        float32_t re = pSrc[2*i];
+        float32_t im = pSrc[2*i + 1];
+        pDst[i] = sqrtf(re*re + im*im);
+    }
+}
+
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples) {
+    for (uint32_t i = 0; i < numSamples; i++) {
+        float32_t re = pSrc[2*i];
+        float32_t im = pSrc[2*i + 1];
+        pDst[i] = re*re + im*im;
+    }
+}
+
+// ---------------------------------------------------------- FIR
+
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs,
+                      float32_t *pState, uint32_t blockSize) {
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, (numTaps + blockSize - 1u)*sizeof(float32_t));
+}
+
+// New samples go into the state after the numTaps-1 old ones.  Then for
+// each tap, that tap times the state is added to all the outputs.  The
+// inner loop is a multiply-add of two contiguous vectors.
+void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+    float32_t *pState = S->pState;
+    const float32_t *pCoeffs = S->pCoeffs;
+    uint32_t numTaps = S->numTaps;
+
+    memcpy(pState + numTaps - 1u, pSrc, blockSize*sizeof(float32_t));
+    for (uint32_t n = 0; n < blockSize; n++)
+        pDst[n] = 0.0f;
+    for (uint32_t k = 0; k < numTaps; k++) {
+        const float32_t c = pCoeffs[k];
+        const float32_t *px = pState + k;
+        for (uint32_t n = 0; n < blockSize; n++)
+            pDst[n] += px[n] * c;
+    }
+    memmove(pState, pState + blockSize, (numTaps - 1u)*sizeof(float32_t));
+}
+
+arm_status arm_fir_decimate_init_f32(arm_fir_decimate_instance_f32 *S, uint16_t numTaps, uint8_t M,
+                      const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize) {
+    if (M == 0 || (blockSize % M) != 0)
+        return ARM_MATH_LENGTH_ERROR;
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    S->M = M;
+    S->pState = pState;
+    memset(pState, 0, (numTaps + blockSize - 1u)*sizeof(float32_t));
+    return ARM_MATH_SUCCESS;
+}
+
+// Output j is the filter evaluated at input sample j*M, as CMSIS.
+void arm_fir_decimate_f32(const arm_fir_decimate_instance_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize) {
+    float32_t *pState = S->pState;
+    const float32_t *pCoeffs = S->pCoeffs;
+    uint32_t numTaps = S->numTaps;
+    uint32_t M = S->M;
+    uint32_t outBlockSize = blockSize / M;
+
+    memcpy(pState + numTaps - 1u, pSrc, blockSize*sizeof(float32_t));
+    for (uint32_t j = 0; j < outBlockSize; j++)
+        pDst[j] = 0.0f;
+    for (uint32_t k = 0; k < numTaps; k++) {
+        const float32_t c = pCoeffs[k];
+        const float32_t *px = pState + k;
+        for (uint32_t j = 0; j < outBlockSize; j++)
+            pDst[j] += px[j*M] * c;
+    }
+    memmove(pState, pState + blockSize, (numTaps - 1u)*sizeof(float32_t));
+}
+
+arm_status arm_fir_interpolate_init_f32(arm_fir_interpolate_instance_f32 *S, uint8_t L, uint16_t numTaps,
+                      const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize) {
+    if (L == 0 || (numTaps % L) != 0)
+        return ARM_MATH_LENGTH_ERROR;
+    S->L = L;
+    S->phaseLength = numTaps / L;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, (S->phaseLength + blockSize - 1u)*sizeof(float32_t));
+    return ARM_MATH_SUCCESS;
+}
+
+// Polyphase.  Output n*L+j-1 uses the coefficients L-j, 2L-j, ...
+void arm_fir_interpolate_f32(const arm_fir_interpolate_instance_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize) {
+    float32_t *pState = S->pState;
+    const float32_t *pCoeffs = S->pCoeffs;
+    uint32_t L = S->L;
+    uint32_t phaseLen = S->phaseLength;
+
+    memcpy(pState + phaseLen - 1u, pSrc, blockSize*sizeof(float32_t));
+    for (uint32_t j = 1; j <= L; j++) {
+        float32_t *py = pDst + (j - 1u);
+        for (uint32_t n = 0; n < blockSize; n++)
+            py[n*L] = 0.0f;
+        for (uint32_t k = 0; k < phaseLen; k++) {
+            const float32_t c = pCoeffs[(L - j) + k*L];
+            const float32_t *px = pState + k;
+            for (uint32_t n = 0; n < blockSize; n++)
+                py[n*L] += px[n] * c;
+        }
+    }
+    memmove(pState, pState + blockSize, (phaseLen - 1u)*sizeof(float32_t));
+}
+
+// ---------------------------------------------------------- Biquad
+// These are recursive and do not vectorize over samples.
+
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages,
+                      const float32_t *pCoeffs, float32_t *pState) {
+    S->numStages = numStages;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, 4u*numStages*sizeof(float32_t));
+}
+
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize) {
+    const float32_t *pIn = pSrc;
+    float32_t *pState = S->pState;
+    const float32_t *pCoeffs = S->pCoeffs;
+
+    for (uint32_t stage = 0; stage < S->numStages; stage++) {
+        float32_t b0 = pCoeffs[0], b1 = pCoeffs[1], b2 = pCoeffs[2];
+        float32_t a1 = pCoeffs[3], a2 = pCoeffs[4];
+        float32_t Xn1 = pState[0], Xn2 = pState[1];
+        float32_t Yn1 = pState[2], Yn2 = pState[3];
+        for (uint32_t n = 0; n < blockSize; n++) {
+            float32_t Xn = pIn[n];
+            float32_t acc = (b0 * Xn) + (b1 * Xn1) + (b2 * Xn2) + (a1 * Yn1) + (a2 * Yn2);
+            pDst[n] = acc;
+            Xn2 = Xn1;  Xn1 = Xn;
+            Yn2 = Yn1;  Yn1 = acc;
+        }
+        pState[0] = Xn1;  pState[1] = Xn2;
+        pState[2] = Yn1;  pState[3] = Yn2;
+        pState += 4;
+        pCoeffs += 5;
+        pIn = pDst;        // Later stages work in place
+    }
+}
+
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages,
+                      const float32_t *pCoeffs, float32_t *pState) {
+    S->numStages = numStages;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, 2u*numStages*sizeof(float32_t));
+}
+
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc,
+                      float32_t *pDst, uint32_t blockSize) {
+    const float32_t *pIn = pSrc;
+    float32_t *pState = S->pState;
+    const float32_t *pCoeffs = S->pCoeffs;
+
+    for (uint32_t stage = 0; stage < S->numStages; stage++) {
+        float32_t b0 = pCoeffs[0], b1 = pCoeffs[1], b2 = pCoeffs[2];
+        float32_t a1 = pCoeffs[3], a2 = pCoeffs[4];
+        float32_t d1 = pState[0], d2 = pState[1];
+        for (uint32_t n = 0; n < blockSize; n++) {
+            float32_t Xn = pIn[n];
+            float32_t acc = b0 * Xn + d1;
+            d1 = b1 * Xn + d2;
+            d1 += a1 * acc;
+            d2 = b2 * Xn;
+            d2 += a2 * acc;
+            pDst[n] = acc;
+        }
+        pState[0] = d1;  pState[1] = d2;
+        pState += 2;
+        pCoeffs += 5;
+        pIn = pDst;
+    }
+}
+
+// ---------------------------------------------------------- FFT
+
+#define HOST_FFT_MAX 4096
+
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len16   = {16,   NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len32   = {32,   NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len64   = {64,   NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len128  = {128,  NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len256  = {256,  NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len512  = {512,  NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len1024 = {1024, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len2048 = {2048, NULL, NULL, 0};
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len4096 = {4096, NULL, NULL, 0};
+
+// cos and sin of 2*pi*k/HOST_FFT_MAX, k=0 to HOST_FFT_MAX/2-1, calculated in
+// double the first time any FFT is run.
+static const float32_t* hostTwiddle(void) {
+    static float32_t tw[HOST_FFT_MAX];
+    static bool ready = false;
+    if (!ready) {
+        for (int k = 0; k < HOST_FFT_MAX/2; k++) {
+            double a = 6.283185307179586 * (double)k / (double)HOST_FFT_MAX;
+            tw[2*k]     = (float32_t)cos(a);
+            tw[2*k + 1] = (float32_t)sin(a);
+        }
+        ready = true;
+    }
+    return tw;
+}
+
+static void hostBitReverse(float32_t *p, uint32_t N) {
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < N - 1u; i++) {
+        if (i < j) {
+            float32_t t;
+            t = p[2*i];      p[2*i] = p[2*j];          p[2*j] = t;
+            t = p[2*i + 1];  p[2*i + 1] = p[2*j + 1];  p[2*j + 1] = t;
+        }
+        uint32_t m = N >> 1;
+        while (m >= 1u && j >= m) {
+            j -= m;
+            m >>= 1;
+        }
+        j += m;
+    }
+}
+
+// Radix-2 decimation in frequency.  Natural order in, bit reversed out.
+static void hostFFT(float32_t *p, uint32_t N, uint8_t ifftFlag, uint8_t bitReverseFlag) {
+    const float32_t *tw = hostTwiddle();
+    float32_t sgn = ifftFlag ? 1.0f : -1.0f;
+
+    if (N < 2u || N > HOST_FFT_MAX)
+        return;
+    for (uint32_t len = N; len >= 2u; len >>= 1) {
+        uint32_t half = len >> 1;
+        uint32_t step = HOST_FFT_MAX / len;
+        for (uint32_t k = 0; k < half; k++) {
+            float32_t wr = tw[2*k*step];
+            float32_t wi = sgn * tw[2*k*step + 1];
+            for (uint32_t s = 0; s < N; s += len) {
+                float32_t *a = p + 2u*(s + k);
+                float32_t *b = p + 2u*(s + k + half);
+                float32_t dr = a[0] - b[0];
+                float32_t di = a[1] - b[1];
+                a[0] += b[0];
+                a[1] += b[1];
+                b[0] = dr*wr - di*wi;
+                b[1] = dr*wi + di*wr;
+            }
+        }
+    }
+    if (bitReverseFlag)
+        hostBitReverse(p, N);
+    if (ifftFlag) {
+        float32_t scale = 1.0f / (float32_t)N;
+        for (uint32_t i = 0; i < 2u*N; i++)
+            p[i] *= scale;
+    }
+}
+
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag) {
+    hostFFT(p1, S->fftLen, ifftFlag, bitReverseFlag);
+}
+
+arm_status arm_cfft_radix2_init_f32(arm_cfft_radix2_instance_f32 *S, uint16_t fftLen,
+                      uint8_t ifftFlag, uint8_t bitReverseFlag) {
+    if (fftLen < 16u || fftLen > HOST_FFT_MAX || (fftLen & (fftLen - 1u)) != 0)
+        return ARM_MATH_ARGUMENT_ERROR;
+    S->fftLen = fftLen;
+    S->ifftFlag = ifftFlag;
+    S->bitReverseFlag = bitReverseFlag;
+    S->pTwiddle = NULL;
+    S->pBitRevTable = NULL;
+    S->twidCoefModifier = 1;
+    S->bitRevFactor = 1;
+    S->onebyfftLen = 1.0f / (float32_t)fftLen;
+    return ARM_MATH_SUCCESS;
+}
+
+void arm_cfft_radix2_f32(const arm_cfft_radix2_instance_f32 *S, float32_t *pSrc) {
+    hostFFT(pSrc, S->fftLen, S->ifftFlag, S->bitReverseFlag);
+}
+
+// CMSIS radix-4 only allows powers of 4
+arm_status arm_cfft_radix4_init_f32(arm_cfft_radix4_instance_f32 *S, uint16_t fftLen,
+                      uint8_t ifftFlag, uint8_t bitReverseFlag) {
+    if (fftLen != 16u && fftLen != 64u && fftLen != 256u && fftLen != 1024u && fftLen != 4096u)
+        return ARM_MATH_ARGUMENT_ERROR;
+    return arm_cfft_radix2_init_f32(S, fftLen, ifftFlag, bitReverseFlag);
+}
+
+void arm_cfft_radix4_f32(const arm_cfft_radix4_instance_f32 *S, float32_t *pSrc) {
+    hostFFT(pSrc, S->fftLen, S->ifftFlag, S->bitReverseFlag);
+}
@@ -0,0 +1,48 @@
+/*
+ * Arduino.h  -  Host stand-in for the few Teensy core functions that the
+ * audio classes use, so that they can be compiled and run in the host
+ * tests.  See ../readme.md.  Not used for Teensy builds.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Set by the test, to play the part of the clock
+extern uint32_t host_millis;
+
+static inline uint32_t millis(void) { return host_millis; }
+static inline uint32_t micros(void) { return host_millis*1000u; }
+static inline void delay(uint32_t ms) { host_millis += ms; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+
+// Microseconds since made, from the same clock
+class elapsedMicros {
+  public:
+    elapsedMicros(void) : start(micros()) {}
+    operator uint32_t() const { return micros() - start; }
+    elapsedMicros & operator = (uint32_t val) { start = micros() - val; return *this; }
+  private:
+    uint32_t start;
+};
+
+class HostSerial {
+  public:
+    void begin(long) {}
+    template<typename T> void print(T) {}
+    template<typename T> void print(T, int) {}
+    template<typename T> void println(T) {}
+    template<typename T> void println(T, int) {}
+    void println(void) {}
+};
+extern HostSerial Serial;
+
+#endif
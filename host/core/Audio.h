@@ -0,0 +1,2 @@
+// Host stand-in, see AudioStream.h in this directory
+#include "AudioStream.h"
@@ -0,0 +1,46 @@
+/*
+ * AudioStream.h  -  Host stand-in for the Teensy Audio Library base class.
+ * There is no audio interrupt.  The tests call update() themselves, in
+ * the order that the objects were connected.  See ../readme.md.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#ifndef _HOST_AUDIOSTREAM_H
+#define _HOST_AUDIOSTREAM_H
+
+#include "Arduino.h"
+
+#ifndef AUDIO_BLOCK_SAMPLES
+#define AUDIO_BLOCK_SAMPLES 128
+#endif
+#ifndef AUDIO_SAMPLE_RATE_EXACT
+#define AUDIO_SAMPLE_RATE_EXACT 44100.0f
+#endif
+#define AUDIO_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+
+#define AudioNoInterrupts()
+#define AudioInterrupts()
+
+typedef struct audio_block_struct {
+    uint8_t  ref_count;
+    uint8_t  reserved1;
+    uint16_t memory_pool_index;
+    int16_t  data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+class AudioStream {
+  public:
+    AudioStream(unsigned char ninput, audio_block_t **iqueue) :
+        num_inputs(ninput), inputQueue(iqueue) {}
+    virtual ~AudioStream() {}
+    static void update_all(void) {}
+    bool active = true;
+  protected:
+    static bool update_setup(void) { return false; }
+    static void update_stop(void) {}
+    unsigned char num_inputs;
+    audio_block_t **inputQueue;
+};
+
+#endif
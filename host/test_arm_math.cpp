@@ -0,0 +1,357 @@
+/*
+ * test_arm_math.cpp  -  Checks the host CMSIS-DSP subset against plain
+ * double precision reference code.
+ *
+ * Each test runs a shimmed function on random data, over several blocks
+ * so that the state is carried, and compares with a direct evaluation of
+ * the definition, as in the CMSIS-DSP documentation.  The largest error,
+ * relative to the largest reference output, is printed and must be below
+ * the limit for float.
+ *
+ * The FIR, biquad, vector and complex multiply functions are also
+ * compared, bit for bit, with scalar float code that sums each output in
+ * the same order as the CMSIS-DSP reference C.  This needs
+ * -ffp-contract=off, as set in the Makefile.  Build and run with
+ * "make test" in this directory.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include "arm_math.h"
+#include "arm_const_structs.h"
+
+#define BLOCK   128
+#define NBLOCKS 4
+#define NTOTAL  (BLOCK*NBLOCKS)
+
+static int failures = 0;
+
+static float32_t randf(void) {
+    return 2.0f*(float32_t)rand()/(float32_t)RAND_MAX - 1.0f;
+}
+
+static void fillRandom(float32_t *p, int n) {
+    for (int i = 0; i < n; i++)
+        p[i] = randf();
+}
+
+// Largest |got - ref| over the largest |ref|, checked against limit
+static void check(const char *name, const float32_t *got, const double *ref,
+                  int n, double limit) {
+    double errMax = 0.0, refMax = 1.0e-30;
+    for (int i = 0; i < n; i++) {
+        double e = fabs((double)got[i] - ref[i]);
+        if (e > errMax) errMax = e;
+        if (fabs(ref[i]) > refMax) refMax = fabs(ref[i]);
+    }
+    double rel = errMax/refMax;
+    bool ok = (rel <= limit);
+    printf("%-28s rel. error %9.3g  (limit %6.1g)  %s\n", name, rel, limit,
+           ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+// Number of outputs that differ in any bit, which must be none
+static void exact(const char *name, const float32_t *got, const float32_t *ref, int n) {
+    int nDiff = 0;
+    for (int i = 0; i < n; i++)
+        if (memcmp(&got[i], &ref[i], sizeof(float32_t)) != 0) nDiff++;
+    printf("%-28s %4d of %4d differ  (exact)      %s\n", name, nDiff, n,
+           nDiff ? "FAIL" : "ok");
+    if (nDiff) failures++;
+}
+
+// CMSIS reference C order for one FIR output, in float.  The state is
+// oldest first, so the sum is pCoeffs[0]*x[n-numTaps+1] + ... with zeros
+// before the first input.
+static float32_t firExact(const float32_t *x, int n, const float32_t *c, int numTaps) {
+    float32_t acc = 0.0f;
+    for (int k = 0; k < numTaps; k++) {
+        int m = n - numTaps + 1 + k;
+        acc += (m >= 0 ? x[m] : 0.0f) * c[k];
+    }
+    return acc;
+}
+
+// CMSIS coefficients are time reversed, so the impulse response is
+// h[m] = pCoeffs[numTaps-1-m]
+static double firRef(const float32_t *x, int n, const float32_t *c, int numTaps) {
+    double acc = 0.0;
+    for (int m = 0; m < numTaps && m <= n; m++)
+        acc += (double)c[numTaps - 1 - m] * (double)x[n - m];
+    return acc;
+}
+
+static void testFIR(void) {
+    const int numTaps = 37;
+    static float32_t c[numTaps], x[NTOTAL], y[NTOTAL];
+    static float32_t state[numTaps + BLOCK - 1];
+    static double ref[NTOTAL];
+    arm_fir_instance_f32 S;
+
+    fillRandom(c, numTaps);
+    fillRandom(x, NTOTAL);
+    arm_fir_init_f32(&S, numTaps, c, state, BLOCK);
+    for (int b = 0; b < NBLOCKS; b++)
+        arm_fir_f32(&S, &x[b*BLOCK], &y[b*BLOCK], BLOCK);
+    for (int n = 0; n < NTOTAL; n++)
+        ref[n] = firRef(x, n, c, numTaps);
+    check("arm_fir_f32", y, ref, NTOTAL, 1.0e-5);
+    static float32_t yx[NTOTAL];
+    for (int n = 0; n < NTOTAL; n++)
+        yx[n] = firExact(x, n, c, numTaps);
+    exact("arm_fir_f32", y, yx, NTOTAL);
+}
+
+static void testDecimate(void) {
+    const int numTaps = 48, M = 4;
+    static float32_t c[numTaps], x[NTOTAL], y[NTOTAL/M];
+    static float32_t state[numTaps + BLOCK - 1];
+    static double ref[NTOTAL/M];
+    arm_fir_decimate_instance_f32 S;
+
+    fillRandom(c, numTaps);
+    fillRandom(x, NTOTAL);
+    if (arm_fir_decimate_init_f32(&S, numTaps, M, c, state, BLOCK) != ARM_MATH_SUCCESS) {
+        printf("arm_fir_decimate_init_f32 failed\n");
+        failures++;
+        return;
+    }
+    for (int b = 0; b < NBLOCKS; b++)
+        arm_fir_decimate_f32(&S, &x[b*BLOCK], &y[b*BLOCK/M], BLOCK);
+    for (int j = 0; j < NTOTAL/M; j++)
+        ref[j] = firRef(x, j*M, c, numTaps);
+    check("arm_fir_decimate_f32", y, ref, NTOTAL/M, 1.0e-5);
+    static float32_t yx[NTOTAL/M];
+    for (int j = 0; j < NTOTAL/M; j++)
+        yx[j] = firExact(x, j*M, c, numTaps);
+    exact("arm_fir_decimate_f32", y, yx, NTOTAL/M);
+}
+
+static void testInterpolate(void) {
+    const int L = 4, numTaps = 48, nIn = BLOCK/L;
+    static float32_t c[numTaps], x[NBLOCKS*nIn], y[NTOTAL], u[NTOTAL];
+    static float32_t state[numTaps/L + nIn - 1];
+    static double ref[NTOTAL];
+    arm_fir_interpolate_instance_f32 S;
+
+    fillRandom(c, numTaps);
+    fillRandom(x, NBLOCKS*nIn);
+    if (arm_fir_interpolate_init_f32(&S, L, numTaps, c, state, nIn) != ARM_MATH_SUCCESS) {
+        printf("arm_fir_interpolate_init_f32 failed\n");
+        failures++;
+        return;
+    }
+    for (int b = 0; b < NBLOCKS; b++)
+        arm_fir_interpolate_f32(&S, &x[b*nIn], &y[b*BLOCK], nIn);
+    // Zero stuffed input, then the same FIR as above
+    for (int m = 0; m < NTOTAL; m++)
+        u[m] = (m % L == 0) ? x[m/L] : 0.0f;
+    for (int m = 0; m < NTOTAL; m++)
+        ref[m] = firRef(u, m, c, numTaps);
+    check("arm_fir_interpolate_f32", y, ref, NTOTAL, 1.0e-5);
+    // CMSIS order: output n*L+j-1 is the sum over k of the state times
+    // pCoeffs[(L-j) + k*L], oldest input first
+    static float32_t yx[NTOTAL];
+    const int phaseLen = numTaps/L;
+    for (int n = 0; n < NBLOCKS*nIn; n++) {
+        for (int j = 1; j <= L; j++) {
+            float32_t acc = 0.0f;
+            for (int k = 0; k < phaseLen; k++) {
+                int m = n - phaseLen + 1 + k;
+                acc += (m >= 0 ? x[m] : 0.0f) * c[(L - j) + k*L];
+            }
+            yx[n*L + j - 1] = acc;
+        }
+    }
+    exact("arm_fir_interpolate_f32", y, yx, NTOTAL);
+}
+
+// Two stages, a low-pass and a peaking section, CMSIS sign convention
+// y = b0 x + b1 x1 + b2 x2 + a1 y1 + a2 y2
+static const float32_t bqCoeffs[10] = {
+    0.0200834f, 0.0401667f, 0.0200834f, 1.5610181f, -0.6413515f,
+    1.0521250f, -1.8163740f, 0.8210340f, 1.8163740f, -0.8731590f };
+
+static void biquadRef(const float32_t *x, double *y, int n) {
+    static double t[NTOTAL];
+    for (int i = 0; i < n; i++) t[i] = x[i];
+    for (int s = 0; s < 2; s++) {
+        const float32_t *c = &bqCoeffs[5*s];
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (int i = 0; i < n; i++) {
+            double v = c[0]*t[i] + c[1]*x1 + c[2]*x2 + c[3]*y1 + c[4]*y2;
+            x2 = x1;  x1 = t[i];
+            y2 = y1;  y1 = v;
+            t[i] = v;
+        }
+    }
+    for (int i = 0; i < n; i++) y[i] = t[i];
+}
+
+// The CMSIS reference C sums, in float, over the whole signal at once
+static void biquadExact(const float32_t *x, float32_t *y1, float32_t *y2, int n) {
+    for (int i = 0; i < n; i++) y1[i] = y2[i] = x[i];
+    for (int s = 0; s < 2; s++) {
+        const float32_t *c = &bqCoeffs[5*s];
+        float32_t Xn1 = 0, Xn2 = 0, Yn1 = 0, Yn2 = 0, d1 = 0, d2 = 0;
+        for (int i = 0; i < n; i++) {
+            float32_t Xn = y1[i];
+            float32_t acc = (c[0] * Xn) + (c[1] * Xn1) + (c[2] * Xn2) + (c[3] * Yn1) + (c[4] * Yn2);
+            Xn2 = Xn1;  Xn1 = Xn;
+            Yn2 = Yn1;  Yn1 = acc;
+            y1[i] = acc;
+
+            Xn = y2[i];
+            acc = c[0] * Xn + d1;
+            d1 = c[1] * Xn + d2;
+            d1 += c[3] * acc;
+            d2 = c[2] * Xn;
+            d2 += c[4] * acc;
+            y2[i] = acc;
+        }
+    }
+}
+
+static void testBiquad(void) {
+    static float32_t x[NTOTAL], y[NTOTAL], state[8];
+    static float32_t yx1[NTOTAL], yx2[NTOTAL];
+    static double ref[NTOTAL];
+    arm_biquad_casd_df1_inst_f32 S1;
+    arm_biquad_cascade_df2T_instance_f32 S2;
+
+    fillRandom(x, NTOTAL);
+    biquadRef(x, ref, NTOTAL);
+    biquadExact(x, yx1, yx2, NTOTAL);
+
+    arm_biquad_cascade_df1_init_f32(&S1, 2, bqCoeffs, state);
+    for (int b = 0; b < NBLOCKS; b++)
+        arm_biquad_cascade_df1_f32(&S1, &x[b*BLOCK], &y[b*BLOCK], BLOCK);
+    check("arm_biquad_cascade_df1_f32", y, ref, NTOTAL, 1.0e-4);
+    exact("arm_biquad_cascade_df1_f32", y, yx1, NTOTAL);
+
+    arm_biquad_cascade_df2T_init_f32(&S2, 2, bqCoeffs, state);
+    for (int b = 0; b < NBLOCKS; b++)
+        arm_biquad_cascade_df2T_f32(&S2, &x[b*BLOCK], &y[b*BLOCK], BLOCK);
+    check("arm_biquad_cascade_df2T_f32", y, ref, NTOTAL, 1.0e-4);
+    exact("arm_biquad_cascade_df2T_f32", y, yx2, NTOTAL);
+}
+
+// Direct DFT, interleaved re/im.  The inverse is scaled by 1/N, as CMSIS.
+static void dftRef(const float32_t *x, double *X, int N, bool inverse) {
+    double sgn = inverse ? 1.0 : -1.0;
+    for (int k = 0; k < N; k++) {
+        double re = 0.0, im = 0.0;
+        for (int n = 0; n < N; n++) {
+            double a = sgn*2.0*M_PI*(double)((long)k*n % N)/(double)N;
+            re += x[2*n]*cos(a) - x[2*n+1]*sin(a);
+            im += x[2*n]*sin(a) + x[2*n+1]*cos(a);
+        }
+        X[2*k]   = inverse ? re/N : re;
+        X[2*k+1] = inverse ? im/N : im;
+    }
+}
+
+static void testFFT(void) {
+    static float32_t x[2*1024], buf[2*1024];
+    static double ref[2*1024];
+    static const arm_cfft_instance_f32 *inst[3] = {
+        &arm_cfft_sR_f32_len64, &arm_cfft_sR_f32_len256, &arm_cfft_sR_f32_len1024 };
+    char name[40];
+
+    for (int i = 0; i < 3; i++) {
+        int N = inst[i]->fftLen;
+        fillRandom(x, 2*N);
+        for (int inv = 0; inv < 2; inv++) {
+            for (int n = 0; n < 2*N; n++) buf[n] = x[n];
+            arm_cfft_f32(inst[i], buf, (uint8_t)inv, 1);
+            dftRef(x, ref, N, inv != 0);
+            snprintf(name, sizeof(name), "arm_cfft_f32 %d%s", N, inv ? " inverse" : "");
+            check(name, buf, ref, 2*N, 1.0e-5);
+        }
+    }
+
+    // The older radix 2 interface
+    const int N = 256;
+    arm_cfft_radix2_instance_f32 R;
+    fillRandom(x, 2*N);
+    for (int n = 0; n < 2*N; n++) buf[n] = x[n];
+    arm_cfft_radix2_init_f32(&R, N, 0, 1);
+    arm_cfft_radix2_f32(&R, buf);
+    dftRef(x, ref, N, false);
+    check("arm_cfft_radix2_f32 256", buf, ref, 2*N, 1.0e-5);
+}
+
+static void testVector(void) {
+    static float32_t a[2*BLOCK], b[2*BLOCK], y[2*BLOCK], yx[2*BLOCK];
+    static double ref[2*BLOCK];
+    float32_t r;
+
+    fillRandom(a, 2*BLOCK);
+    fillRandom(b, 2*BLOCK);
+
+    arm_cmplx_mult_cmplx_f32(a, b, y, BLOCK);
+    for (int n = 0; n < BLOCK; n++) {
+        ref[2*n]   = (double)a[2*n]*b[2*n] - (double)a[2*n+1]*b[2*n+1];
+        ref[2*n+1] = (double)a[2*n]*b[2*n+1] + (double)a[2*n+1]*b[2*n];
+    }
+    check("arm_cmplx_mult_cmplx_f32", y, ref, 2*BLOCK, 1.0e-6);
+    // The products are stored through volatile, as gcc 12 with -march=native
+    // makes this loop an fmaddsub even with -ffp-contract=off
+    for (int n = 0; n < BLOCK; n++) {
+        volatile float32_t ac = a[2*n] * b[2*n], bd = a[2*n+1] * b[2*n+1];
+        volatile float32_t ad = a[2*n] * b[2*n+1], bc = a[2*n+1] * b[2*n];
+        yx[2*n]   = ac - bd;
+        yx[2*n+1] = ad + bc;
+    }
+    exact("arm_cmplx_mult_cmplx_f32", y, yx, 2*BLOCK);
+
+    arm_mult_f32(a, b, y, 2*BLOCK);
+    for (int n = 0; n < 2*BLOCK; n++)
+        yx[n] = a[n] * b[n];
+    exact("arm_mult_f32", y, yx, 2*BLOCK);
+    arm_scale_f32(a, 0.3f, y, 2*BLOCK);
+    for (int n = 0; n < 2*BLOCK; n++)
+        yx[n] = a[n] * 0.3f;
+    exact("arm_scale_f32", y, yx, 2*BLOCK);
+    arm_add_f32(a, b, y, 2*BLOCK);
+    for (int n = 0; n < 2*BLOCK; n++)
+        yx[n] = a[n] + b[n];
+    exact("arm_add_f32", y, yx, 2*BLOCK);
+
+    arm_cmplx_mag_f32(a, y, BLOCK);
+    for (int n = 0; n < BLOCK; n++)
+        ref[n] = sqrt((double)a[2*n]*a[2*n] + (double)a[2*n+1]*a[2*n+1]);
+    check("arm_cmplx_mag_f32", y, ref, BLOCK, 1.0e-6);
+
+    double d = 0.0, s = 0.0;
+    for (int n = 0; n < BLOCK; n++) {
+        d += (double)a[n]*b[n];
+        s += (double)a[n]*a[n];
+    }
+    arm_dot_prod_f32(a, b, BLOCK, &r);
+    ref[0] = d;
+    check("arm_dot_prod_f32", &r, ref, 1, 1.0e-5);
+    arm_rms_f32(a, BLOCK, &r);
+    ref[0] = sqrt(s/BLOCK);
+    check("arm_rms_f32", &r, ref, 1, 1.0e-5);
+}
+
+int main(void) {
+    srand(12345);
+    testFIR();
+    testDecimate();
+    testInterpolate();
+    testBiquad();
+    testFFT();
+    testVector();
+    if (failures)
+        printf("%d test(s) FAILED\n", failures);
+    else
+        printf("All passed\n");
+    return failures ? 1 : 0;
+}
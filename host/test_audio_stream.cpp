@@ -0,0 +1,312 @@
+/*
+ * test_audio_stream.cpp  -  Host tests of the AudioStream_F32 block pool
+ * and block information, with the Teensy core stand-ins in core/.
+ *
+ * There is no audio interrupt, so each test calls update() of its objects
+ * in order, as update_all() would.  Build and run with "make test" in
+ * this directory.
+ *
+ * MIT License,  Use at your own risk.
+ */
+
+#include "Arduino.h"
+#include "AudioStream_F32.h"
+#include "AudioFilterDecimate_F32.h"
+#include "AudioMathMultiply_F32.h"
+#include "AudioFilterEqualizer_F32.h"
+#include "AudioFilter90Deg_F32.h"
+
+uint32_t host_millis = 0;
+HostSerial Serial;
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what) {
+    printf("%-60s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+// Sends a full block of a ramp, each update
+class TestSource : public AudioStream_F32 {
+  public:
+    TestSource(void) : AudioStream_F32(0, NULL) {}
+    void update(void) {
+        audio_block_f32_t *b = allocate_f32();
+        if (!b) return;
+        for (int i = 0; i < b->length; i++)
+            b->data[i] = (float32_t)(count++);
+        transmit(b);
+        release(b);
+    }
+  private:
+    uint32_t count = 0;
+};
+
+// Sends one value on control output 0, each update
+class TestControlSource : public AudioStream_F32 {
+  public:
+    TestControlSource(void) : AudioStream_F32(0, NULL) {}
+    void update(void) { transmitControl(&value, 1); }
+    float32_t value = 0.5f;
+};
+
+// Keeps the length, rate and some samples of the last block received
+class TestSink : public AudioStream_F32 {
+  public:
+    TestSink(void) : AudioStream_F32(1, inputQueueArray) {}
+    void update(void) {
+        audio_block_f32_t *b = receiveReadOnly_f32(0);
+        if (!b) return;
+        length = b->length;
+        fs_Hz = b->fs_Hz;
+        first = b->data[0];
+        mid = b->data[b->length/2];
+        blocks++;
+        release(b);
+    }
+    int length = 0;
+    float fs_Hz = 0.0f;
+    float32_t first = 0.0f, mid = 0.0f;
+    int blocks = 0;
+  private:
+    audio_block_f32_t *inputQueueArray[1];
+};
+
+// A decimator releases its short, low rate blocks to the pool.  The next
+// owner of such a block must get a full one, at the pool's rate.
+static void testAllocateAfterDecimate(void) {
+    TestSource src;
+    AudioFilterDecimate_F32 dec;
+    TestSink sink;
+    AudioConnection_F32 c1(src, 0, dec, 0);
+    AudioConnection_F32 c2(dec, 0, sink, 0);
+
+    expect(dec.begin(4) == 0, "decimate begin(4)");
+    for (int i = 0; i < 4; i++) {
+        src.update();
+        dec.update();
+        sink.update();
+    }
+    expect(sink.length == AUDIO_BLOCK_SAMPLES/4, "decimated block length is block_size/4");
+    expect(fabsf(sink.fs_Hz - AUDIO_SAMPLE_RATE/4.0f) < 0.01f, "decimated block fs_Hz is fs/4");
+    expect(AudioStream_F32::f32_memory_used == 0, "all blocks back in the pool");
+
+    // Every block in the pool, so the decimator's are included
+    audio_block_f32_t *b[8];
+    bool allFull = true;
+    for (int i = 0; i < 8; i++) {
+        b[i] = AudioStream_F32::allocate_f32();
+        if (!b[i] || b[i]->length != AUDIO_BLOCK_SAMPLES || b[i]->fs_Hz != AUDIO_SAMPLE_RATE)
+            allFull = false;
+    }
+    for (int i = 0; i < 8; i++)
+        if (b[i]) AudioStream_F32::release(b[i]);
+    expect(allFull, "allocate_f32() after decimate gives full length and rate");
+}
+
+// The first block on a control input starts at the first value, not at 0
+static void testControlFirstBlock(void) {
+    TestSource src;
+    TestControlSource ctl;
+    AudioMathMultiply_F32 mult;
+    TestSink sink;
+    AudioConnection_F32 c1(src, 0, mult, 0);
+    AudioControlConnection_F32 c2(ctl, 0, mult, 1);
+    AudioConnection_F32 c3(mult, 0, sink, 0);
+
+    // The source ramp is 0 to 127, so the middle sample is 64
+    src.update();
+    ctl.update();
+    mult.update();
+    sink.update();
+    expect(sink.blocks == 1, "multiply sends the first control block");
+    expect(fabsf(sink.mid - 0.5f*(AUDIO_BLOCK_SAMPLES/2)) < 1.0e-3f,
+           "first control block is 0.5 mid-block, not ramping from 0");
+}
+
+// No control value yet, so no output, rather than a ramp up from zero
+static void testControlNoValue(void) {
+    TestSource src;
+    TestControlSource ctl;
+    AudioMathMultiply_F32 mult;
+    TestSink sink;
+    AudioConnection_F32 c1(src, 0, mult, 0);
+    AudioControlConnection_F32 c2(ctl, 0, mult, 1);
+    AudioConnection_F32 c3(mult, 0, sink, 0);
+
+    src.update();
+    mult.update();
+    sink.update();
+    expect(sink.blocks == 0, "no multiply output before the first control value");
+    // The source ramp is 128 to 255 in its second block
+    src.update();
+    ctl.update();
+    mult.update();
+    sink.update();
+    expect(sink.blocks == 1 && fabsf(sink.first - 0.5f*AUDIO_BLOCK_SAMPLES) < 1.0e-3f,
+           "first control block is flat at the first value");
+}
+
+// A change during a crossfade is busy and leaves the equalizer, its .INO
+// array and its latency as they were, until update() ends the fade
+static void testEqualizerBusy(void) {
+    TestSource src;
+    AudioFilterEqualizer_F32 eq;
+    TestSink sink;
+    AudioConnection_F32 c1(src, 0, eq, 0);
+    AudioConnection_F32 c2(eq, 0, sink, 0);
+    float32_t fBand[] = {5000.0f, 22050.0f};
+    float32_t dbA[] = {0.0f, -20.0f};
+    float32_t dbB[] = {-20.0f, 0.0f};
+    static float32_t cA[51], cB[51];
+
+    expect(eq.equalizerNew(2, fBand, dbA, 51, cA, 60.0f) == 0, "equalizerNew() before audio");
+    src.update();  eq.update();  sink.update();
+    expect(eq.equalizerNew(2, fBand, dbB, 31, cA, 60.0f) == 0, "equalizerNew() while running");
+    src.update();  eq.update();  sink.update();      // Crossfade starts
+
+    for (int i = 0; i < 51; i++) cB[i] = 99.0f;
+    bool busy = eq.equalizerNew(2, fBand, dbA, 21, cB, 60.0f) == ERR_EQ_BUSY;
+    expect(busy && eq.getLatencySamples() == 15 && cB[10] == 99.0f,
+           "busy equalizerNew() changes nothing");
+
+    for (int b = 0; b < 4; b++) {
+        src.update();  eq.update();  sink.update();
+    }
+    expect(eq.equalizerNew(2, fBand, dbA, 21, cB, 60.0f) == 0 &&
+           eq.getLatencySamples() == 10 && cB[10] != 99.0f,
+           "equalizerNew() after the crossfade");
+
+    // With update() stopped, only endCrossfade() ends the fade
+    src.update();  eq.update();  sink.update();
+    expect(eq.equalizerNew(2, fBand, dbB, 21, cB, 60.0f) == ERR_EQ_BUSY,
+           "busy with update() stopped");
+    eq.endCrossfade();
+    expect(eq.equalizerNew(2, fBand, dbB, 21, cB, 60.0f) == 0,
+           "equalizerNew() after endCrossfade()");
+}
+
+// Sends a sine wave, each update
+class TestSine : public AudioStream_F32 {
+  public:
+    TestSine(void) : AudioStream_F32(0, NULL) {}
+    void update(void) {
+        audio_block_f32_t *b = allocate_f32();
+        if (!b) return;
+        for (int i = 0; i < b->length; i++)
+            b->data[i] = (float32_t)sin(2.0*M_PI*f*(double)(n++)/AUDIO_SAMPLE_RATE);
+        transmit(b);
+        release(b);
+    }
+    double f = 1000.0;
+    uint32_t n = 0;
+};
+
+// Keeps the samples received, up to REC_MAX
+#define REC_MAX 8192
+class TestRecorder : public AudioStream_F32 {
+  public:
+    TestRecorder(void) : AudioStream_F32(1, inputQueueArray) {}
+    void update(void) {
+        audio_block_f32_t *b = receiveReadOnly_f32(0);
+        if (!b) return;
+        for (int i = 0; i < b->length && n < REC_MAX; i++)
+            data[n++] = b->data[i];
+        release(b);
+    }
+    float32_t data[REC_MAX];
+    int n = 0;
+  private:
+    audio_block_f32_t *inputQueueArray[1];
+};
+
+// The sum of (x + jy)*exp(-j*w*k) over a Hann window, for the phase and
+// amplitude at w, in radians per sample.  y may be NULL.
+static void dft(const float32_t *x, const float32_t *y, int n, double w,
+                double *re, double *im) {
+    *re = 0.0;  *im = 0.0;
+    for (int k = 0; k < n; k++) {
+        double h = 0.5 - 0.5*cos(2.0*M_PI*(k + 0.5)/n);
+        double xr = h*x[k], xi = y ? h*y[k] : 0.0;
+        *re += xr*cos(w*k) + xi*sin(w*k);
+        *im += xi*cos(w*k) - xr*sin(w*k);
+    }
+}
+
+// Runs a sine through the IIR phase splitter, until it settles, and keeps
+// the last REC_MAX samples of each output
+static void run90Deg(AudioFilter90Deg_F32 &ph, double f, int nSettle,
+                     TestRecorder &r0, TestRecorder &r1) {
+    TestSine sine;
+    AudioConnection_F32 c1(sine, 0, ph, 0);
+    AudioConnection_F32 c2(sine, 0, ph, 1);
+    AudioConnection_F32 c3(ph, 0, r0, 0);
+    AudioConnection_F32 c4(ph, 1, r1, 0);
+    sine.f = f;
+    for (int b = 0; b < nSettle + 2*REC_MAX/AUDIO_BLOCK_SAMPLES; b++) {
+        sine.update();
+        ph.update();
+        if (b == nSettle)  r0.n = r1.n = 0;
+        r0.update();
+        r1.update();
+    }
+}
+
+// The IIR phase difference, from 200 Hz to fs/2 - 200 Hz, designed for
+// 0.5 degree.  Out 0 lags Out 1 by 90 degrees.
+static void test90DegPhase(void) {
+    const double fTest[] = {200.0, 500.0, 2000.0, 7000.0, 11025.0, 15000.0,
+                            20000.0, 21850.0};
+    double errMax = 0.0;
+    for (double f : fTest) {
+        AudioFilter90Deg_F32 ph;
+        TestRecorder r0, r1;
+        double re0, im0, re1, im1;
+        ph.beginIIR(200.0f, 0.5f, false);
+        run90Deg(ph, f, 200, r0, r1);
+        double w = 2.0*M_PI*f/AUDIO_SAMPLE_RATE;
+        dft(r0.data, NULL, r0.n, w, &re0, &im0);
+        dft(r1.data, NULL, r1.n, w, &re1, &im1);
+        double d = (atan2(im0, re0) - atan2(im1, re1))*180.0/M_PI;
+        d = fmod(d + 90.0 + 540.0, 360.0) - 180.0;
+        if (fabs(d) > errMax)  errMax = fabs(d);
+    }
+    printf("90 degree IIR, largest phase error %.3f degree\n", errMax);
+    expect(errMax < 0.35, "90 degree IIR within 0.35 degree, 200 Hz to 21.85 kHz");
+}
+
+// With decimate, I + jQ at fs/2 holds the positive frequencies.  The image
+// at -f is from the phase error, and is about 50 dB down.
+static void test90DegImage(void) {
+    const double fTest[] = {500.0, 2000.0, 5000.0, 9000.0};
+    double rejMin = 1000.0;
+    for (double f : fTest) {
+        AudioFilter90Deg_F32 ph;
+        TestRecorder r0, r1;
+        double reP, imP, reN, imN;
+        ph.beginIIR(200.0f, 0.5f, true);
+        run90Deg(ph, f, 200, r0, r1);
+        double w = 2.0*M_PI*f/(0.5*AUDIO_SAMPLE_RATE);
+        dft(r0.data, r1.data, r0.n, w, &reP, &imP);
+        dft(r0.data, r1.data, r0.n, -w, &reN, &imN);
+        double rej = 10.0*log10((reP*reP + imP*imP)/(reN*reN + imN*imN));
+        if (rej < rejMin)  rejMin = rej;
+    }
+    printf("90 degree IIR decimated, smallest image rejection %.1f dB\n", rejMin);
+    expect(rejMin > 48.0, "90 degree IIR decimated image rejection about 50 dB");
+}
+
+int main(void) {
+    AudioMemory_F32(8);
+    testAllocateAfterDecimate();
+    testControlFirstBlock();
+    testControlNoValue();
+    testEqualizerBusy();
+    test90DegPhase();
+    test90DegImage();
+    if (failures)
+        printf("%d test(s) FAILED\n", failures);
+    else
+        printf("All passed\n");
+    return failures ? 1 : 0;
+}
@@ -49,6 +49,7 @@ DMAChannel AudioInputI2S_F32::dma(false);
 
 int AudioInputI2S_F32::flag_out_of_memory = 0;
 unsigned long AudioInputI2S_F32::update_counter = 0;
+uint64_t AudioInputI2S_F32::sample_counter = 0;
 
 float AudioInputI2S_F32::sample_rate_Hz = AUDIO_SAMPLE_RATE;
 int AudioInputI2S_F32::audio_block_samples = AUDIO_BLOCK_SAMPLES;
@@ -124,6 +125,7 @@ void AudioInputI2S_F32::begin(bool transferUsing32bit) {
 	dma.attachInterrupt(isr);
 
 	update_counter = 0;
+	sample_counter = 0;
 }
 
 void AudioInputI2S_F32::isr(void)
@@ -201,6 +203,7 @@ void AudioInputI2S_F32::scale_i32_to_f32( float32_t *p_i32, float32_t *p_f32, in
 
 	//prepare to transmit by setting the update_counter (which helps tell if data is skipped or out-of-order)
 	out_f32->id = update_counter;
+	out_f32->sampleIndex = sample_counter - audio_block_samples;  // Counted in update()
 
 	//transmit the f32 data!
 	AudioStream_F32::transmit(out_f32,chan);
@@ -214,6 +217,8 @@ void AudioInputI2S_F32::update(void)
 	static bool flag_beenSuccessfullOnce = false;
 	audio_block_f32_t *new_left=NULL, *new_right=NULL, *out_left=NULL, *out_right=NULL;
 
+	// One update() per block period, whether or not blocks are available
+	sample_counter += audio_block_samples;
 	new_left = AudioStream_F32::allocate_f32();
 	new_right = AudioStream_F32::allocate_f32();
 	if ((!new_left) || (!new_right)) {
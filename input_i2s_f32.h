@@ -80,6 +80,7 @@ private:
 	static uint16_t block_offset;
 	static int flag_out_of_memory;
 	static unsigned long update_counter;
+	static uint64_t sample_counter;   // Samples per update(), for sampleIndex
 };
 
 class AudioInputI2Sslave_F32 : public AudioInputI2S_F32
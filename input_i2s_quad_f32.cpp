@@ -49,6 +49,8 @@ DMAChannel AudioInputI2SQuad_F32::dma(false);
 
 float AudioInputI2SQuad_F32::sample_rate_Hz = AUDIO_SAMPLE_RATE;
 int AudioInputI2SQuad_F32::audio_block_samples = AUDIO_BLOCK_SAMPLES;
+uint64_t AudioInputI2SQuad_F32::sample_counter = 0;
+unsigned long AudioInputI2SQuad_F32::update_counter = 0;
 
 void AudioInputI2SQuad_F32::begin(void) {
 	dma.begin(true); // Allocate the DMA channel first
@@ -94,6 +96,7 @@ void AudioInputI2SQuad_F32::isr(void) {
 		// DMA is receiving to the first half of the buffer
 		// need to remove data from the second half
 		src = (int32_t *)&i2s_rx_buffer[AUDIO_BLOCK_SAMPLES * 2];
+		update_counter++;  // As AudioInputI2S_F32, for block id
 		if(update_responsibility) update_all();
 	} else {
 		// DMA is receiving to the second half of the buffer
@@ -128,6 +131,8 @@ void AudioInputI2SQuad_F32::update(void) {
 	audio_block_f32_t *new1, *new2, *new3, *new4;
 	audio_block_f32_t *out1, *out2, *out3, *out4;
 
+	// One update() per block period, whether or not blocks are available
+	sample_counter += AUDIO_BLOCK_SAMPLES;
 	// allocate 4 new blocks
 	new1 = AudioStream_F32::allocate_f32();
 	new2 = AudioStream_F32::allocate_f32();
@@ -173,6 +178,15 @@ void AudioInputI2SQuad_F32::update(void) {
 	  scale_i32_to_f32(out3->data, out3->data, AUDIO_BLOCK_SAMPLES);
 	  scale_i32_to_f32(out4->data, out4->data, AUDIO_BLOCK_SAMPLES);
 
+	  out1->sampleIndex = sample_counter - AUDIO_BLOCK_SAMPLES;
+	  out2->sampleIndex = out1->sampleIndex;
+	  out3->sampleIndex = out1->sampleIndex;
+	  out4->sampleIndex = out1->sampleIndex;
+	  out1->id = update_counter;
+	  out2->id = update_counter;
+	  out3->id = update_counter;
+	  out4->id = update_counter;
+
     // then transmit the DMA's former blocks
 		AudioStream_F32::transmit(out1, 0);
 		AudioStream_F32::release(out1);
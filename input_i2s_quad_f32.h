@@ -70,6 +70,8 @@ private:
 	static uint32_t block_offset;
 	static float sample_rate_Hz;
 	static int audio_block_samples;
+	static uint64_t sample_counter;   // Samples per update(), for sampleIndex
+	static unsigned long update_counter;  // Counted in isr(), for id
 };
 
 
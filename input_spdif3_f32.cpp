@@ -46,6 +46,8 @@ static uint32_t spdif_rx_buffer[AUDIO_BLOCK_SAMPLES * 4];
 audio_block_f32_t * AudioInputSPDIF3_F32::block_left = NULL;
 audio_block_f32_t * AudioInputSPDIF3_F32::block_right = NULL;
 uint16_t AudioInputSPDIF3_F32::block_offset = 0;
+uint64_t AudioInputSPDIF3_F32::sample_counter = 0;
+unsigned long AudioInputSPDIF3_F32::block_counter = 0;
 bool AudioInputSPDIF3_F32::update_responsibility = false;
 DMAChannel AudioInputSPDIF3_F32::dma(false);
 
@@ -200,6 +202,8 @@ void AudioInputSPDIF3_F32::update(void)
 {
 	audio_block_f32_t *new_left=NULL, *new_right=NULL, *out_left=NULL, *out_right=NULL;
 
+	// One update() per block period, whether or not blocks are available
+	sample_counter += AUDIO_BLOCK_SAMPLES;
 	// allocate 2 new blocks, but if one fails, allocate neither
 	new_left = allocate_f32();
 	if (new_left != NULL) {
@@ -219,6 +223,10 @@ void AudioInputSPDIF3_F32::update(void)
 		block_right = new_right;
 		block_offset = 0;
 		__enable_irq();
+		out_left->sampleIndex = sample_counter - AUDIO_BLOCK_SAMPLES;
+		out_right->sampleIndex = out_left->sampleIndex;
+		out_left->id = block_counter;
+		out_right->id = block_counter++;
 		// then transmit the DMA's former blocks
 		transmit(out_left, 0);
 		release(out_left);
@@ -54,6 +54,8 @@ private:
 	static audio_block_f32_t *block_right;
 	static uint16_t block_offset;
 	static float sample_rate_Hz;
+	static uint64_t sample_counter;   // Samples per update(), for sampleIndex
+	static unsigned long block_counter;
 };
 
 #endif
@@ -199,6 +199,39 @@ void AudioPlayQueue_F32::playAudioBlock(audio_block_f32_t *audio_block) {
     userblock = NULL;
 }
 
+uint16_t AudioPlayQueue_F32::availableForWrite(void)
+{
+	uint32_t h = head;
+	uint32_t t = tail;
+	uint32_t used = (h >= t) ? h - t : max_buffers + h - t;
+	return max_buffers - 1 - used;
+}
+
+uint32_t AudioPlayQueue_F32::writeSamples(const float32_t *data, uint32_t count)
+{
+	behaviour_e saveBehave = behaviour;
+	behaviour = NON_STALLING;
+	uint32_t nLeft = play(data, count);
+	behaviour = saveBehave;
+	return count - nLeft;
+}
+
+int AudioPlayQueue_F32::writeBlocks(audio_block_f32_t **blocks, int n)
+{
+	uint32_t h;
+	int i;
+
+	for (i=0; i<n; i++) {
+		if (blocks[i] == NULL) continue;
+		h = head + 1;
+		if (h >= max_buffers) h = 0;
+		if (tail == h) break;      // Full, try the rest later
+		queue[h] = blocks[i];
+		head = h;
+	}
+	return i;
+}
+
 void AudioPlayQueue_F32::update(void)
 {
     audio_block_f32_t *block;
@@ -209,8 +242,12 @@ void AudioPlayQueue_F32::update(void)
 		if (++t >= max_buffers) t = 0; // tail is advanced 1, circularly
 		block = queue[t];   // pointer to next block
 		tail = t;
+		samplesPlayed += block->length;
 		AudioStream_F32::transmit(block);
 		AudioStream_F32::release(block);	 // we've lost interest in this block...
 		queue[t] = NULL; // ...forget it here, too
 	}
+	else if (samplesPlayed > 0) {
+		underruns++;
+	}
 }
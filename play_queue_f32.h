@@ -10,6 +10,12 @@
  * Teensy Audio library.  Thanks toJonathan Oakley for the improvements.
  * Bob Larkin bob@janbob.com
  *
+ * Oct 2026 - Added bulk, never-stalling writeSamples() and writeBlocks(),
+ * availableForWrite(), and counts of samples transmitted and of
+ * underruns (update() with nothing queued).  As before, only the INO side
+ * writes head and only update() writes tail, so there is no interrupt
+ * disabling.
+ *
  *     Audio Library for Teensy 3.X
  * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
  *
@@ -70,6 +76,23 @@ public:
 	uint32_t playBuffer(void);
 	void stop(void);
 	void setMaxBuffers(uint8_t);
+	// Queue up to count samples, never stalling.  Returns the number accepted,
+	// the remainder should be offered again later.
+	uint32_t writeSamples(const float32_t *data, uint32_t count);
+	// Queue up to n blocks owned by the caller, never stalling.  This object
+	// takes ownership of each block queued.  Returns the number queued.
+	int writeBlocks(audio_block_f32_t **blocks, int n);
+	// Number of blocks that can be queued without stalling
+	uint16_t availableForWrite(void);
+	// Sample index of the next sample update() will transmit
+	uint64_t getSamplesPlayed(void) {
+		__disable_irq();
+		uint64_t n = samplesPlayed;
+		__enable_irq();
+		return n;
+	}
+	// Updates with no block queued, after the first block was played
+	uint32_t getUnderruns(void) { return underruns; }
 	virtual void update(void);
 	enum behaviour_e {ORIGINAL,NON_STALLING};
 	void setBehaviour(behaviour_e behave)
@@ -82,6 +105,8 @@ private:
 	unsigned int uptr; // actually an index, NOT a pointer!
 	volatile uint8_t head, tail;
 	volatile uint8_t max_buffers;
-	behaviour_e behaviour;
+	behaviour_e behaviour = ORIGINAL;
+	uint64_t samplesPlayed = 0;         // Written only by update()
+	volatile uint32_t underruns = 0;
 };
 #endif
@@ -67,12 +67,12 @@ void radioCESSB_Z_transmit_F32::update(void)  {
 
    // Decimate 48 ksps to 12 ksps, 128 to 32 samples
    //       or 96 ksps to 12 ksps, 128 to 16 samples
-   arm_fir_decimate_f32(&decimateInst, &(blockIn->data[0]),
+   decimateInst.process(&(blockIn->data[0]),
                         &HilbertIn[0], 128);
   // We now have nW=32 (for 48 ksps) or 16 (for 96 ksps) samples to process
 
   // Apply the Hilbert transform FIR.
-  arm_fir_f32(&firInstHilbertI, &HilbertIn[0], &workingDataI[0], nW);
+  firInstHilbertI.process(&HilbertIn[0], &workingDataI[0], nW);
 
      /* ======= Sidebar:  Circular 2^n length delay arrays ========
       *
@@ -145,8 +145,8 @@ void radioCESSB_Z_transmit_F32::update(void)  {
       }
 
    // LPF with gain of 2 built into coefficients, correct for added zeros.
-   arm_fir_f32(&firInstInterpolate1I,  workingDataI, workingDataI, nC);
-   arm_fir_f32(&firInstInterpolate1Q,  workingDataQ, workingDataQ, nC);
+   firInstInterpolate1I.process(workingDataI, workingDataI, nC);
+   firInstInterpolate1Q.process(workingDataQ, workingDataQ, nC);
 
    // WorkingDataI and Q are now at 24 ksps and ready for clipping
    // For input 48 ksps this produces 64 numbers
@@ -167,8 +167,8 @@ void radioCESSB_Z_transmit_F32::update(void)  {
 
       // clipperIn needs spectrum control, so LP filter it.
       // Both BW of the signal and the sample rate have been doubled.
-      arm_fir_f32(&firInstClipperI, workingDataI, workingDataI, nC);
-      arm_fir_f32(&firInstClipperQ, workingDataQ, workingDataQ, nC);
+      firInstClipperI.process(workingDataI, workingDataI, nC);
+      firInstClipperQ.process(workingDataQ, workingDataQ, nC);
       // Ready to compensate for filter overshoots
       for (int k=0; k<nC; k++)
          {
@@ -209,8 +209,8 @@ void radioCESSB_Z_transmit_F32::update(void)  {
          }  // End, for k=0 to 63
 
       // Filter the differences, osFilter has 123 taps and 61 delay
-      arm_fir_f32(&firInstOShootI, diffI, diffI, nC);
-      arm_fir_f32(&firInstOShootQ, diffQ, diffQ, nC);
+      firInstOShootI.process(diffI, diffI, nC);
+      firInstOShootQ.process(diffQ, diffQ, nC);
 
       // Do the overshoot compensation
       for(int k=0; k<nC; k++)
@@ -256,8 +256,8 @@ void radioCESSB_Z_transmit_F32::update(void)  {
       workingDataQ[k2-1] = gainOut*workingDataQ[nC-k-1];  // ...it just scales the level
       }
    // LPF with gain of 2 built into coefficients, correct for zeros.
-   arm_fir_f32(&firInstInterpolate2I,  workingDataI, &blockOutI->data[0], 128);
-   arm_fir_f32(&firInstInterpolate2Q,  workingDataQ, &blockOutQ->data[0], 128);
+   firInstInterpolate2I.process(workingDataI, &blockOutI->data[0], 128);
+   firInstInterpolate2Q.process(workingDataQ, &blockOutQ->data[0], 128);
    // Voltage gain from blockIn->data to here for small sine wave is 1.0
 
     AudioStream_F32::transmit(blockOutI, 0); // send the outputs
@@ -113,6 +113,7 @@
 #include "Arduino.h"
 #include "AudioStream_F32.h"
 #include "arm_math.h"
+#include "FIRKernel_F32.h"
 #include "mathDSP_F32.h"
 
 #define SAMPLE_RATE_0      0
@@ -183,30 +184,30 @@ public:
             countLevelMax = 37;  // About 0.1 sec for 48 ksps
             inverseMaxCount = 1.0f/(float32_t)countLevelMax;
 
-            arm_fir_decimate_init_f32(&decimateInst, 65, 4,
+            decimateInst.initDecimate(65, 4,
                    (float32_t*)decimateFilter48, &pStateDecimate[0], 128);
 
-            arm_fir_init_f32(&firInstHilbertI, 201, (float32_t*)hilbert201_130Hz12000Hz,
+            firInstHilbertI.init(201, (float32_t*)hilbert201_130Hz12000Hz,
                    &pStateHilbertI[0], nW);
 
-            arm_fir_init_f32(&firInstInterpolate1I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate1I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate1I[0], nC);
-            arm_fir_init_f32(&firInstInterpolate1Q, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate1Q.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate1Q[0], nC);
 
-            arm_fir_init_f32(&firInstClipperI, 123, (float32_t*)clipperOut,
+            firInstClipperI.init(123, (float32_t*)clipperOut,
                    &pStateClipperI[0], nC);
-            arm_fir_init_f32(&firInstClipperQ, 123, (float32_t*)clipperOut,
+            firInstClipperQ.init(123, (float32_t*)clipperOut,
                    &pStateClipperQ[0], nC);
 
-            arm_fir_init_f32(&firInstOShootI, 123, (float32_t*)clipperOut,
+            firInstOShootI.init(123, (float32_t*)clipperOut,
                    &pStateOShootI[0], nC);
-            arm_fir_init_f32(&firInstOShootQ, 123, (float32_t*)clipperOut,
+            firInstOShootQ.init(123, (float32_t*)clipperOut,
                    &pStateOShootQ[0], nC);
 
-            arm_fir_init_f32(&firInstInterpolate2I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate2I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate2I[0], nC);
-            arm_fir_init_f32(&firInstInterpolate2Q, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate2Q.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate2Q[0], nC);
 		    }
 		else if(sample_rate_Hz>88000.0f && sample_rate_Hz<100100.0f)
@@ -218,9 +219,9 @@ public:
             nC = 32;
             countLevelMax = 75;  // About 0.1 sec for 96 ksps
             inverseMaxCount = 1.0f/(float32_t)countLevelMax;
-            arm_fir_decimate_init_f32 (&decimateInst, 55, 4,
+            decimateInst.initDecimate(55, 4,
                    (float32_t*)decimateFilter48, pStateDecimate, 128);
-            arm_fir_init_f32(&firInstClipper, 199, basebandFilter,
+            firInstClipper.init(199, basebandFilter,
                    &StateFirClipperF32[0], 128);
  */
 		    }
@@ -307,32 +308,32 @@ private:
     float32_t crossQI = 0.0f;
 
     float32_t pStateDecimate[128 + 65 - 1];    // Goes with CMSIS decimate function
-    arm_fir_decimate_instance_f32 decimateInst;
+    FIRKernel_F32 decimateInst;
 
     float32_t pStateHilbertI[32 + 201 - 1];
-    arm_fir_instance_f32 firInstHilbertI;
+    FIRKernel_F32 firInstHilbertI;
 
     float32_t pStateInterpolate1I[64 + 23 - 1];  // For interpolate 12 to 24 ksps
-    arm_fir_instance_f32 firInstInterpolate1I;
+    FIRKernel_F32 firInstInterpolate1I;
     float32_t pStateInterpolate1Q[64 + 23 - 1];
-    arm_fir_instance_f32 firInstInterpolate1Q;
+    FIRKernel_F32 firInstInterpolate1Q;
 
 
     float32_t pStateClipperI[64 + 123 - 1];    // Goes with Clipper filter
-    arm_fir_instance_f32 firInstClipperI;      // at 24 ksps
+    FIRKernel_F32 firInstClipperI;      // at 24 ksps
     float32_t pStateClipperQ[64 + 123 - 1];
-    arm_fir_instance_f32 firInstClipperQ;
+    FIRKernel_F32 firInstClipperQ;
 
 
     float32_t pStateOShootI[64+123-1];
-    arm_fir_instance_f32 firInstOShootI;
+    FIRKernel_F32 firInstOShootI;
     float32_t pStateOShootQ[64+123-1];
-    arm_fir_instance_f32 firInstOShootQ;
+    FIRKernel_F32 firInstOShootQ;
 
     float32_t pStateInterpolate2I[128 + 23 - 1];  // For interpolate 12 to 24 ksps
-    arm_fir_instance_f32 firInstInterpolate2I;
+    FIRKernel_F32 firInstInterpolate2I;
     float32_t pStateInterpolate2Q[128 + 23 - 1];
-    arm_fir_instance_f32 firInstInterpolate2Q;
+    FIRKernel_F32 firInstInterpolate2Q;
 
 //    float32_t sn, cs;
     float32_t gainIn = 1.0f;
@@ -91,7 +91,7 @@ void radioCESSBtransmit_F32::update(void)  {
 
    // Decimate 48 ksps to 12 ksps, 128 to 32 samples
    //       or 96 ksps to 12 ksps, 128 to 16 samples (not yet)
-   arm_fir_decimate_f32(&decimateInst, &(blockIn->data[0]),
+   decimateInst.process(&(blockIn->data[0]),
                         &weaverIn[0], 128);
 
    // We now have 32 or 16 samples to process and interpolate out
@@ -113,8 +113,8 @@ void radioCESSBtransmit_F32::update(void)  {
 
    // Filter Weaver I and Q using first half of Out array.
    // Bandwidth at this point is 0 to 1350 Hz.
-   arm_fir_f32(&firInstWeaverI, weaverMI, workingDataI, nW);
-   arm_fir_f32(&firInstWeaverQ, weaverMQ, workingDataQ, nW);
+   firInstWeaverI.process(weaverMI, workingDataI, nW);
+   firInstWeaverQ.process(weaverMQ, workingDataQ, nW);
    // Note: Sine wave envelope gain from blockIn->data[kk] to here is gainIn
 
    // Measure input power and peak envelope, SSB before any CESSB processing
@@ -140,8 +140,8 @@ void radioCESSBtransmit_F32::update(void)  {
       }
 
    // LPF with gain of 2 built into coefficients, correct for zeros.
-   arm_fir_f32(&firInstInterpolate1I,  workingDataI, workingDataI, nC);
-   arm_fir_f32(&firInstInterpolate1Q,  workingDataQ, workingDataQ, nC);
+   firInstInterpolate1I.process(workingDataI, workingDataI, nC);
+   firInstInterpolate1Q.process(workingDataQ, workingDataQ, nC);
 
    // WorkingDataI and Q are now at 24 ksps and ready for clipping
    // For input 48 ksps this produces 64 numbers
@@ -169,8 +169,8 @@ void radioCESSBtransmit_F32::update(void)  {
 
       // clipperIn needs spectrum control, so LP filter it.  Same filter coeffs as Weaver.
       // Both BW of the signal and the sample rate have been doubled.
-      arm_fir_f32(&firInstClipperI, workingDataI, workingDataI, nC);
-      arm_fir_f32(&firInstClipperQ, workingDataQ, workingDataQ, nC);
+      firInstClipperI.process(workingDataI, workingDataI, nC);
+      firInstClipperQ.process(workingDataQ, workingDataQ, nC);
 
       // Ready to compensate for filter overshoots
       for (int k=0; k<64; k++)
@@ -236,8 +236,8 @@ void radioCESSBtransmit_F32::update(void)  {
          }  // End, for k=0 to 63
 
       // Filter the differences, osFilter has 129 taps and 64 delay
-      arm_fir_f32(&firInstOShootI, diffI, diffI, nC);
-      arm_fir_f32(&firInstOShootQ, diffQ, diffQ, nC);
+      firInstOShootI.process(diffI, diffI, nC);
+      firInstOShootQ.process(diffQ, diffQ, nC);
 
       // Do the overshoot compensation
       for(int k=0; k<64; k++)
@@ -259,8 +259,8 @@ void radioCESSBtransmit_F32::update(void)  {
       workingDataQ[k2-1] = workingDataQ[nC-k-1];
       }
    // LPF with gain of 2 built into coefficients, correct for zeros.
-   arm_fir_f32(&firInstInterpolate2I,  workingDataI, &blockOutI->data[0], 2*nC);
-   arm_fir_f32(&firInstInterpolate2Q,  workingDataQ, &blockOutQ->data[0], 2*nC);
+   firInstInterpolate2I.process(workingDataI, &blockOutI->data[0], 2*nC);
+   firInstInterpolate2Q.process(workingDataQ, &blockOutQ->data[0], 2*nC);
    // Voltage gain from blockIn->data to here for small sine wave is 1.0
 
    // Measure output power and peak envelope, after CESSB
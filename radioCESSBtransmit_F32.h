@@ -47,6 +47,7 @@
 #include "Arduino.h"
 #include "AudioStream_F32.h"
 #include "arm_math.h"
+#include "FIRKernel_F32.h"
 #include "mathDSP_F32.h"
 
 #define SAMPLE_RATE_0      0
@@ -116,35 +117,35 @@ public:
             nC = 64;
             countLevelMax = 37;  // About 0.1 sec for 48 ksps
             inverseMaxCount = 1.0f/(float32_t)countLevelMax;
-		    Serial.print("Status, decimate init = ");  Serial.println(
-                arm_fir_decimate_init_f32(&decimateInst, 65, 4,
+		    Serial.print("Decimate FIR type = ");  Serial.println(
+                decimateInst.initDecimate(65, 4,
                    (float32_t*)decimateFilter48, &pStateDecimate[0], 128) );
 
             // Putting this init stuff here is in anticipation of
             // adding 96 ksps support later.
-            arm_fir_init_f32(&firInstWeaverI, 213, (float32_t*)weaverFilter,
+            firInstWeaverI.init(213, (float32_t*)weaverFilter,
                    &pStateWeaverI[0], nW);
-            arm_fir_init_f32(&firInstWeaverQ, 213, (float32_t*)weaverFilter,
+            firInstWeaverQ.init(213, (float32_t*)weaverFilter,
                    &pStateWeaverQ[0], nW);
 
-            arm_fir_init_f32(&firInstInterpolate1I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate1I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate1I[0], nC);
-            arm_fir_init_f32(&firInstInterpolate1Q, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate1Q.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate1Q[0], nC);
 
-            arm_fir_init_f32(&firInstClipperI, 213, (float32_t*)weaverFilter,
+            firInstClipperI.init(213, (float32_t*)weaverFilter,
                    &pStateClipperI[0], nC);
-            arm_fir_init_f32(&firInstClipperQ, 213, (float32_t*)weaverFilter,
+            firInstClipperQ.init(213, (float32_t*)weaverFilter,
                    &pStateClipperQ[0], nC);
 
-            arm_fir_init_f32(&firInstOShootI, 125, (float32_t*)osFilter,
+            firInstOShootI.init(125, (float32_t*)osFilter,
                    &pStateOShootI[0], nC);
-            arm_fir_init_f32(&firInstOShootQ, 125, (float32_t*)osFilter,
+            firInstOShootQ.init(125, (float32_t*)osFilter,
                    &pStateOShootQ[0], nC);
 
-            arm_fir_init_f32(&firInstInterpolate2I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate2I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate2I[0], nC);
-            arm_fir_init_f32(&firInstInterpolate2Q, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate2Q.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate2Q[0], nC);
 
 		    }
@@ -226,35 +227,35 @@ private:
     bool sidebandReverse = false;
 
     float32_t pStateDecimate[128 + 65 - 1];    // Goes with CMSIS decimate function
-    arm_fir_decimate_instance_f32 decimateInst;
+    FIRKernel_F32 decimateInst;
 
     float32_t pStateWeaverI[32 + 213 - 1];    // Goes with Weaver filter out
-    arm_fir_instance_f32 firInstWeaverI;      // at 12 ksps
+    FIRKernel_F32 firInstWeaverI;      // at 12 ksps
     float32_t pStateWeaverQ[32 + 213 - 1];
-    arm_fir_instance_f32 firInstWeaverQ;
+    FIRKernel_F32 firInstWeaverQ;
 
 
     float32_t pStateInterpolate1I[64 + 23 - 1];  // For interpolate 12 to 24 ksps
-    arm_fir_instance_f32 firInstInterpolate1I;
+    FIRKernel_F32 firInstInterpolate1I;
     float32_t pStateInterpolate1Q[64 + 23 - 1];
-    arm_fir_instance_f32 firInstInterpolate1Q;
+    FIRKernel_F32 firInstInterpolate1Q;
 
 
     float32_t pStateClipperI[64 + 213 - 1];    // Goes with Clipper filter
-    arm_fir_instance_f32 firInstClipperI;      // at 24 ksps
+    FIRKernel_F32 firInstClipperI;      // at 24 ksps
     float32_t pStateClipperQ[64 + 213 - 1];
-    arm_fir_instance_f32 firInstClipperQ;
+    FIRKernel_F32 firInstClipperQ;
 
 
     float32_t pStateOShootI[64+125-1];  // 129-1];
-    arm_fir_instance_f32 firInstOShootI;
+    FIRKernel_F32 firInstOShootI;
     float32_t pStateOShootQ[64+125-1];
-    arm_fir_instance_f32 firInstOShootQ;
+    FIRKernel_F32 firInstOShootQ;
 
     float32_t pStateInterpolate2I[128 + 23 - 1];  // For interpolate 12 to 24 ksps
-    arm_fir_instance_f32 firInstInterpolate2I;
+    FIRKernel_F32 firInstInterpolate2I;
     float32_t pStateInterpolate2Q[128 + 23 - 1];
-    arm_fir_instance_f32 firInstInterpolate2Q;
+    FIRKernel_F32 firInstInterpolate2Q;
 
     float32_t sn, cs;
     float32_t gainIn = 1.0f;
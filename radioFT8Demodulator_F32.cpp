@@ -167,11 +167,37 @@ void RadioFT8Demodulator_F32::decimate15(void)  {
 void RadioFT8Demodulator_F32::update(void)  {
    audio_block_f32_t *block_in;
 
-   if(!gettingData)
-      return;
-
-   block_in = receiveReadOnly_f32(0);
+#ifndef W5BAA_INTERFACE
+   if(waitingForIndex)   // From startDataCollectAt()
+      {
+      block_in = receiveReadOnly_f32(0);
+      if(!block_in)
+         return;
+      // Un-stamped input can not be aligned, so just start
+      if(block_in->sampleIndex != AUDIO_F32_NO_SAMPLE_INDEX &&
+         block_in->sampleIndex + 128 <= collectStartIndex)
+         {
+         AudioStream_F32::release(block_in);
+         return;
+         }
+      waitingForIndex = false;
+      startDataCollect();
+      }
+   else
+#endif
+      {
+      if(!gettingData)
+         return;
+      block_in = receiveReadOnly_f32(0);
+      }
    if (srIndex==SR_NONE || !block_in) { Serial.println("Block error"); return; }
+#ifndef W5BAA_INTERFACE
+   if(firstBlock)
+      {
+      dataStartIndex = block_in->sampleIndex;
+      firstBlock = false;
+      }
+#endif
 // ttt=micros();
    // Here every 2.6667 millisec for 48 kHz, 128 pts
    current128Used1 = false;   // There are 128 new input data to use
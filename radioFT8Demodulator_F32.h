@@ -71,7 +71,11 @@
  * 4. This class does not provide true (absolute) clock timing.
  * The startReceive() function should be called when it is time
  * for a new reception period.  This class will start that at the
- * next 128 audio sample period.
+ * next 128 audio sample period.  Alternatively, startDataCollectAt()
+ * starts with the block holding a given input sample index (see
+ * sampleIndex in AudioStream_F32.h).  With the slot boundaries
+ * known as sample indices, say from a GPS PPS, there is no need for
+ * millis() timing.  Resolution is one 128 sample block.
  *
  * 5. Update time required for a T4.x is    uSec.
  */
@@ -232,6 +236,7 @@ public:
    // Start a new 14.7 sec data gather
    void startDataCollect(void)  {
       gettingData = true;
+      firstBlock = true;
       FFTCount = 0;
       dec1Count = 0;
       dec2Count = 0;
@@ -246,8 +251,23 @@ public:
       index2 = 0;        // Runs 0,511 on outputs
       }
 
+   // Start a new data gather at the input block that holds sample index
+   // startIndex.  Needs an input class that stamps sampleIndex.
+   void startDataCollectAt(uint64_t startIndex)  {
+      gettingData = false;
+      collectStartIndex = startIndex;
+      waitingForIndex = true;
+      }
+
+   // Input sample index of the first sample used by the current gather, or
+   // AUDIO_F32_NO_SAMPLE_INDEX if the input is not stamped.
+   uint64_t getDataStartSampleIndex(void)  {
+      return dataStartIndex;
+      }
+
    // Cancel the data gather
    void cancelDataCollect(void)  {
+      waitingForIndex = false;
       gettingData = false;
       // Getting started again from here is by startDataCollect()
       }
@@ -324,6 +344,10 @@ int32_t kkk;
 #else
    int16_t FFTCount = 0;
    int FFTOld = 0;
+   bool waitingForIndex = false;
+   uint64_t collectStartIndex = 0;
+   uint64_t dataStartIndex = AUDIO_F32_NO_SAMPLE_INDEX;
+   bool firstBlock = false;
    int16_t block128Count = 0;
    int16_t index2 = 0;        // Runs 0,511 on outputs
    float32_t data2K[2048];    // Output time array to FFT 2048+512
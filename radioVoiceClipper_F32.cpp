@@ -48,8 +48,8 @@ void radioVoiceClipper_F32::update(void)  {
       {
       // Decimate 48 ksps to 12 ksps, 128 to 32 samples
       //       or 96 ksps to 12 ksps, 128 to 16 samples
-      arm_fir_decimate_f32(&decimateInst, &(blockIn->data[0]),
-                        &workingData[0], 128);
+      decimateInst.process(&(blockIn->data[0]),
+                           &workingData[0], 128);
       // We now have nW=32 (for 48 ksps) or 16 (for 96 ksps) samples to process
       }
    // Measure input power and peak envelope, before any clipping.
@@ -79,7 +79,7 @@ void radioVoiceClipper_F32::update(void)  {
       }
 
    // LPF with gain of 2 built into coefficients, correct for added zeros.
-   arm_fir_f32(&firInstInterpolate1I,  workingData, workingData, nC);
+   firInstInterpolate1I.process(workingData, workingData, nC);
    // workingData are now at 24 ksps and ready for clipping
    // For input 48 ksps this produces 64 numbers
 
@@ -95,7 +95,7 @@ void radioVoiceClipper_F32::update(void)  {
 
    // clipperIn needs spectrum control, so LP filter it.
    // Both BW of the signal and the sample rate have been doubled.
-   arm_fir_f32(&firInstClipperI, workingData, workingData, nC);
+   firInstClipperI.process(workingData, workingData, nC);
 
    // Ready to compensate for filter overshoots
    for (int k=0; k<nC; k++)
@@ -133,7 +133,7 @@ void radioVoiceClipper_F32::update(void)  {
       }  // End, for k=0 to 63
 
    // Filter the differences, osFilter has 123 taps and 61 delay
-   arm_fir_f32(&firInstOShootI, diffI, diffI, nC);
+   firInstOShootI.process(diffI, diffI, nC);
 
     // Do the overshoot compensation
    for(int k=0; k<nC; k++)
@@ -172,7 +172,7 @@ void radioVoiceClipper_F32::update(void)  {
          workingData[k2-1] = gainOut*workingData[nC-k-1];  // gainOut does not change CESSB
          }
       // LPF with gain of 2 built into coefficients, correct for zeros.
-      arm_fir_f32(&firInstInterpolate2I,  workingData, &blockOut->data[0], 128);
+      firInstInterpolate2I.process(workingData, &blockOut->data[0], 128);
       // Voltage gain from blockIn->data to here for small sine wave is 1.0
       }
    AudioStream_F32::transmit(blockOut, 0); // send the outputs
@@ -75,6 +75,7 @@
 #include "Arduino.h"
 #include "AudioStream_F32.h"
 #include "arm_math.h"
+#include "FIRKernel_F32.h"
 #include "mathDSP_F32.h"
 
 #define VC_SAMPLE_RATE_0      0
@@ -136,11 +137,11 @@ public:
             nC = 256;
             countLevelMax = 10;  // About 0.1 sec for 12 ksps 
             inverseMaxCount = 1.0f/(float32_t)countLevelMax;
-            arm_fir_init_f32(&firInstInterpolate1I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate1I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate1I[0], nC);
-            arm_fir_init_f32(&firInstClipperI, 123, (float32_t*)clipperOut,
+            firInstClipperI.init(123, (float32_t*)clipperOut,
                    &pStateClipperI[0], nC);
-            arm_fir_init_f32(&firInstOShootI, 123, (float32_t*)clipperOut,
+            firInstOShootI.init(123, (float32_t*)clipperOut,
                    &pStateOShootI[0], nC);
 		    }
         else if(sample_rate_Hz>43900.0f && sample_rate_Hz<50100.0f)
@@ -151,15 +152,15 @@ public:
             nC = 64;
             countLevelMax = 37;  // About 0.1 sec for 48 ksps
             inverseMaxCount = 1.0f/(float32_t)countLevelMax;
-            arm_fir_decimate_init_f32(&decimateInst, 65, 4,
+            decimateInst.initDecimate(65, 4,
                    (float32_t*)decimateFilter48, &pStateDecimate[0], 128);
-            arm_fir_init_f32(&firInstInterpolate1I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate1I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate1I[0], nC);
-            arm_fir_init_f32(&firInstClipperI, 123, (float32_t*)clipperOut,
+            firInstClipperI.init(123, (float32_t*)clipperOut,
                    &pStateClipperI[0], nC);
-            arm_fir_init_f32(&firInstOShootI, 123, (float32_t*)clipperOut,
+            firInstOShootI.init(123, (float32_t*)clipperOut,
                    &pStateOShootI[0], nC);
-            arm_fir_init_f32(&firInstInterpolate2I, 23, (float32_t*)interpolateFilter1,
+            firInstInterpolate2I.init(23, (float32_t*)interpolateFilter1,
                    &pStateInterpolate2I[0], nC);
 		    }
 		else if(sample_rate_Hz>88000.0f && sample_rate_Hz<100100.0f)
@@ -171,9 +172,9 @@ public:
             nC = 32;
             countLevelMax = 75;  // About 0.1 sec for 96 ksps
             inverseMaxCount = 1.0f/(float32_t)countLevelMax;
-            arm_fir_decimate_init_f32 (&decimateInst, 55, 4,
+            decimateInst.initDecimate(55, 4,
                    (float32_t*)decimateFilter48, pStateDecimate, 128);
-            arm_fir_init_f32(&firInstClipper, 199, basebandFilter,
+            firInstClipper.init(199, basebandFilter,
                    &StateFirClipperF32[0], 128);
  */
 		    }
@@ -236,20 +237,20 @@ private:
     uint16_t  block_length = 128;
 
     float32_t pStateDecimate[128 + 65 - 1];    // Goes with CMSIS decimate function
-    arm_fir_decimate_instance_f32 decimateInst;
+    FIRKernel_F32 decimateInst;
 
     // For 12 ksps case, 24 kHz clipper uses 256 points 
     float32_t pStateInterpolate1I[256 + 23 - 1];  // For interpolate 12 to 24 ksps
-    arm_fir_instance_f32 firInstInterpolate1I;
+    FIRKernel_F32 firInstInterpolate1I;
 
     float32_t pStateClipperI[256 + 123 - 1];    // Goes with Clipper filter
-    arm_fir_instance_f32 firInstClipperI;      // at 24 ksps
+    FIRKernel_F32 firInstClipperI;      // at 24 ksps
 
     float32_t pStateOShootI[256+123-1];
-    arm_fir_instance_f32 firInstOShootI;
+    FIRKernel_F32 firInstOShootI;
 
     float32_t pStateInterpolate2I[256 + 23 - 1];  // For interpolate 12 to 24 ksps
-    arm_fir_instance_f32 firInstInterpolate2I;
+    FIRKernel_F32 firInstInterpolate2I;
 
     float32_t gainIn = 1.0f;
     float32_t gainCompensate = 1.4f;
@@ -27,6 +27,23 @@
 #include "record_queue_f32.h"
 #include "utility/dspinst.h"
 
+// Only update() writes head, and only the INO side writes tail.  The block
+// pointer and its sample index are stored before head is advanced.
+
+void AudioRecordQueue_F32::setMaxBuffers(uint16_t maxb)
+{
+	if (maxb < 2) maxb = 2;
+	if (maxb > MAX_BUFFERS) maxb = MAX_BUFFERS;
+	uint8_t e = enabled;
+	enabled = 0;
+	clear();
+	__disable_irq();   // Rare, so re-sizing can use the simple way
+	head = 0;
+	tail = 0;
+	max_buffers = maxb;
+	__enable_irq();
+	enabled = e;
+}
 
 int AudioRecordQueue_F32::available(void)
 {
@@ -35,7 +52,7 @@ int AudioRecordQueue_F32::available(void)
 	h = head;
 	t = tail;
 	if (h >= t) return h - t;
-	return 53 + h - t;
+	return max_buffers + h - t;
 }
 
 void AudioRecordQueue_F32::clear(void)
@@ -46,38 +63,43 @@ void AudioRecordQueue_F32::clear(void)
 		AudioStream_F32::release(userblock);
 		userblock = NULL;
 	}
+	if (partialBlock) {
+		AudioStream_F32::release(partialBlock);
+		partialBlock = NULL;
+	}
 	t = tail;
 	while (t != head) {
-		if (++t >= 53) t = 0;
+		if (++t >= max_buffers) t = 0;
 		AudioStream_F32::release(queue[t]);
 	}
 	tail = t;
 }
 
+// Remove the oldest block from the queue. Returns 0 if empty.
+int AudioRecordQueue_F32::nextBlock(audio_block_f32_t **pBlock, uint64_t *pIndex)
+{
+	uint32_t t;
+
+	t = tail;
+	if (t == head) return 0;
+	if (++t >= max_buffers) t = 0;
+	*pBlock = queue[t];
+	if (pIndex) *pIndex = queueSampleIndex[t];
+	tail = t;
+	return 1;
+}
+
 float32_t * AudioRecordQueue_F32::readBuffer(void)
 {
-//	uint32_t t;
-//
-//	if (userblock) return NULL;
-//	t = tail;
-//	if (t == head) return NULL;
-//	if (++t >= 53) t = 0;
-//	userblock = queue[t];
-//	tail = t;
-//	return userblock->data;
-	return getAudioBlock()->data;
+	audio_block_f32_t *block = getAudioBlock();
+	if (block == NULL) return NULL;
+	return block->data;
 }
 
 audio_block_f32_t * AudioRecordQueue_F32::getAudioBlock(void)
 {
-	uint32_t t;
-
 	if (userblock != NULL) return NULL;
-	t = tail;
-	if (t == head) return NULL;
-	if (++t >= 53) t = 0;
-	userblock = queue[t];
-	tail = t;
+	if (!nextBlock(&userblock, &userSampleIndex)) return NULL;
 	return userblock;
 }
 
@@ -92,10 +114,47 @@ void AudioRecordQueue_F32::freeAudioBlock(void) {
 	freeBuffer();
 }
 
+int AudioRecordQueue_F32::readBlocks(audio_block_f32_t **blocks, uint64_t *pSampleIndex, int n)
+{
+	int i;
+
+	for (i=0; i<n; i++) {
+		if (!nextBlock(&blocks[i], pSampleIndex ? &pSampleIndex[i] : NULL))
+			break;
+	}
+	return i;
+}
+
+uint32_t AudioRecordQueue_F32::readSamples(float32_t *dest, uint32_t count, uint64_t *pSampleIndex)
+{
+	uint32_t nCopied = 0;
+	uint32_t n;
+
+	while (nCopied < count) {
+		if (partialBlock == NULL) {
+			if (!nextBlock(&partialBlock, &partialSampleIndex)) break;
+			partialOffset = 0;
+		}
+		if (nCopied == 0 && pSampleIndex)
+			*pSampleIndex = partialSampleIndex + partialOffset;
+		n = partialBlock->length - partialOffset;
+		if (n > count - nCopied) n = count - nCopied;
+		memcpy(dest + nCopied, partialBlock->data + partialOffset, n*sizeof(float32_t));
+		nCopied += n;
+		partialOffset += n;
+		if (partialOffset >= partialBlock->length) {
+			AudioStream_F32::release(partialBlock);
+			partialBlock = NULL;
+		}
+	}
+	return nCopied;
+}
+
 void AudioRecordQueue_F32::update(void)
 {
 	audio_block_f32_t *block;
 	uint32_t h;
+	uint64_t index;
 
 	block = receiveReadOnly_f32();
 	if (block==NULL) return;
@@ -103,14 +162,20 @@ void AudioRecordQueue_F32::update(void)
 		AudioStream_F32::release(block);
 		return;
 	}
+	// Use the block's own sampleIndex, if the source stamped it
+	if (block->sampleIndex != AUDIO_F32_NO_SAMPLE_INDEX)
+		index = block->sampleIndex;
+	else
+		index = sampleCount;
+	sampleCount = index + block->length;
 	h = head + 1;
-	if (h >= 53) h = 0;
+	if (h >= max_buffers) h = 0;
 	if (h == tail) {
+		droppedBlocks++;
 		AudioStream_F32::release(block);
 	} else {
 		queue[h] = block;
+		queueSampleIndex[h] = index;
 		head = h;
 	}
 }
-
-
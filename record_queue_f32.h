@@ -1,10 +1,22 @@
-/* 
+/*
 *	AudioRecordQueue_F32
 *
 *	Created: Chip Audette (OpenAudio), Feb 2017
 *       Extended from on Teensy Audio Library
 *
 *	License: MIT License.  Use at your own risk.
+*
+* Oct 2026 - The queue depth is now set at run time by setMaxBuffers(), up
+* to MAX_BUFFERS.  The default remains 53.  The queue is single-producer
+* (update()) single-consumer (the INO) and only the producer writes head
+* and only the consumer writes tail, so no interrupt disabling is needed.
+* Every block received is given a sample index, the count of samples
+* that came into the queue before it, including blocks dropped because the
+* queue was full.  Thus a jump in the sample index shows a gap.  Blocks
+* can be read in bulk with readBlocks() and an arbitrary number of samples
+* can be copied out with readSamples().  The original one block at a time
+* readBuffer()/freeBuffer() are unchanged.  If the block arrives with a
+* sampleIndex stamped by an input class, that is used instead of the count.
 */
 
 
@@ -17,6 +29,13 @@
 class AudioRecordQueue_F32 : public AudioStream_F32
 {
 //GUI: inputs:1, outputs:0 //this line used for automatic generation of GUI node
+private:
+#if defined(__IMXRT1062__) || defined(__MK66FX1M0__) || defined(__MK64FX512__)
+	static const unsigned int MAX_BUFFERS = 128;
+#else
+	static const unsigned int MAX_BUFFERS = 53;
+#endif
+
 public:
 	AudioRecordQueue_F32(void) : AudioStream_F32(1, inputQueueArray),
 		userblock(NULL), head(0), tail(0), enabled(0) { }
@@ -33,15 +52,40 @@ public:
 	audio_block_f32_t *getAudioBlock(void);
 	void freeBuffer(void);
 	void freeAudioBlock(void);
+	// Sample index of the first sample of the block last returned by
+	// readBuffer() or getAudioBlock()
+	uint64_t getBufferSampleIndex(void) { return userSampleIndex; }
+	// Bulk read.  Up to n blocks are removed from the queue.  The caller now
+	// owns them and must give each back with AudioStream_F32::release().
+	// pSampleIndex, if not NULL, gets the sample index of each block.
+	int readBlocks(audio_block_f32_t **blocks, uint64_t *pSampleIndex, int n);
+	// Copy up to count samples, crossing block boundaries as needed.  Returns
+	// the number copied.  pSampleIndex, if not NULL, gets the index of the first.
+	uint32_t readSamples(float32_t *dest, uint32_t count, uint64_t *pSampleIndex = NULL);
+	// Queue depth, 2 to MAX_BUFFERS.  Clears the queue.
+	void setMaxBuffers(uint16_t maxb);
+	uint16_t getMaxBuffers(void) { return max_buffers; }
+	// Blocks lost because the queue was full
+	uint32_t getDroppedBlocks(void) { return droppedBlocks; }
 	void end(void) {
 		enabled = 0;
 	}
 	virtual void update(void);
 private:
 	audio_block_f32_t *inputQueueArray[1];
-	audio_block_f32_t * volatile queue[53];
+	audio_block_f32_t * volatile queue[MAX_BUFFERS];
+	volatile uint64_t queueSampleIndex[MAX_BUFFERS];
 	audio_block_f32_t *userblock;
+	uint64_t userSampleIndex = 0;
+	// Block partly consumed by readSamples()
+	audio_block_f32_t *partialBlock = NULL;
+	uint16_t partialOffset = 0;
+	uint64_t partialSampleIndex = 0;
 	volatile uint8_t head, tail, enabled;
+	volatile uint16_t max_buffers = 53;
+	uint64_t sampleCount = 0;         // Written only by update()
+	volatile uint32_t droppedBlocks = 0;
+	int nextBlock(audio_block_f32_t **pBlock, uint64_t *pIndex);
 };
 
 #endif